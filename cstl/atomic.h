@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2006-2010, KATO Noriaki
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*!
+ * \file atomic.h
+ * \brief アトミック操作
+ * \author KATO Noriaki <katono@users.sourceforge.jp>
+ * \date 2026-10-19
+ * $URL$
+ * $Id$
+ *
+ * このファイルを直接インクルードしないこと
+ */
+#ifndef CSTL_ATOMIC_H_INCLUDED
+#define CSTL_ATOMIC_H_INCLUDED
+
+/*
+ * アトミック操作
+ * LOAD/STOREはacquire/release、LOAD_SC/STORE_SC/ADDは逐次一貫性を持つ。
+ * 対象の変数はvolatile修飾しておく。
+ * CSTL_ATOMIC_LOADを定義済みならば、利用者の定義を使う。
+ */
+#ifndef CSTL_ATOMIC_LOAD
+#if defined(__GNUC__)
+#define CSTL_ATOMIC_LOAD(p)			__atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define CSTL_ATOMIC_STORE(p, v)		__atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define CSTL_ATOMIC_LOAD_SC(p)		__atomic_load_n(p, __ATOMIC_SEQ_CST)
+#define CSTL_ATOMIC_STORE_SC(p, v)	__atomic_store_n(p, v, __ATOMIC_SEQ_CST)
+#define CSTL_ATOMIC_ADD(p, v)		__atomic_fetch_add(p, v, __ATOMIC_SEQ_CST)
+#elif defined(_MSC_VER)
+/* MSVCのvolatileアクセスはacquire/releaseの意味を持つ */
+#include <windows.h>
+#define CSTL_ATOMIC_LOAD(p)			(*(p))
+#define CSTL_ATOMIC_STORE(p, v)		(*(p) = (v))
+#define CSTL_ATOMIC_LOAD_SC(p)		(MemoryBarrier(), *(p))
+#define CSTL_ATOMIC_STORE_SC(p, v)	(*(p) = (v), MemoryBarrier())
+#define CSTL_ATOMIC_ADD(p, v)		InterlockedExchangeAdd((LONG volatile *) (p), (v))
+#else
+#error "atomic.h: define CSTL_ATOMIC_LOAD, CSTL_ATOMIC_STORE, CSTL_ATOMIC_LOAD_SC, CSTL_ATOMIC_STORE_SC and CSTL_ATOMIC_ADD"
+#endif
+#endif
+
+
+#endif /* CSTL_ATOMIC_H_INCLUDED */
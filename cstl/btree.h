@@ -0,0 +1,1007 @@
+/*
+ * Copyright (c) 2006-2010, KATO Noriaki
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*!
+ * \file btree.h
+ * \brief B木によるset/mapコンテナ
+ * \author KATO Noriaki <katono@users.sourceforge.jp>
+ * \date 2026-10-19
+ * $URL$
+ * $Id$
+ */
+#ifndef CSTL_BTREE_H_INCLUDED
+#define CSTL_BTREE_H_INCLUDED
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "common.h"
+
+
+#define CSTL_LESS(x, y)		((x) == (y) ? 0 : (x) < (y) ? -1 : 1)
+#define CSTL_GREATER(x, y)	((x) == (y) ? 0 : (x) > (y) ? -1 : 1)
+
+
+#ifndef CSTL_BTREE_NODE_SIZE
+/* ノード1つのおおよそのバイト数 */
+#define CSTL_BTREE_NODE_SIZE	256
+#endif
+
+/* ノードに格納する要素数(最低4) */
+#define CSTL_BTREE_CAPACITY(header, size)	\
+	((CSTL_BTREE_NODE_SIZE - (header)) / (size) > 4 ? (CSTL_BTREE_NODE_SIZE - (header)) / (size) : 4)
+
+/* size以上の2のべき乗 */
+#define CSTL_BTREE_ALIGN(size)	\
+	((size) <= CSTL_BTREE_NODE_SIZE ? CSTL_BTREE_NODE_SIZE :\
+	 (size) <= CSTL_BTREE_NODE_SIZE * 2 ? CSTL_BTREE_NODE_SIZE * 2 :\
+	 (size) <= CSTL_BTREE_NODE_SIZE * 4 ? CSTL_BTREE_NODE_SIZE * 4 :\
+	 (size) <= CSTL_BTREE_NODE_SIZE * 8 ? CSTL_BTREE_NODE_SIZE * 8 :\
+	 (size) <= CSTL_BTREE_NODE_SIZE * 16 ? CSTL_BTREE_NODE_SIZE * 16 :\
+	 (size) <= CSTL_BTREE_NODE_SIZE * 32 ? CSTL_BTREE_NODE_SIZE * 32 :\
+	 (size) <= CSTL_BTREE_NODE_SIZE * 64 ? CSTL_BTREE_NODE_SIZE * 64 :\
+	 (size) <= CSTL_BTREE_NODE_SIZE * 128 ? CSTL_BTREE_NODE_SIZE * 128 :\
+	 (size) <= CSTL_BTREE_NODE_SIZE * 256 ? CSTL_BTREE_NODE_SIZE * 256 :\
+	 CSTL_BTREE_NODE_SIZE * 512)
+
+/* 木の高さの上限 */
+#define CSTL_BTREE_MAX_DEPTH	(sizeof(size_t) * CHAR_BIT)
+
+/* 1回に確保する葉の最大数 */
+#define CSTL_BTREE_SLAB_MAX		64
+
+
+#define CSTL_BTREE_WRAPPER_INTERFACE(Name, KeyType, ValueType)	\
+\
+typedef struct Name Name;\
+typedef struct Name##BTreeElem *Name##Iterator;\
+\
+Name *Name##_new(void);\
+void Name##_delete(Name *self);\
+void Name##_clear(Name *self);\
+int Name##_empty(Name *self);\
+size_t Name##_size(Name *self);\
+int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last);\
+Name##Iterator Name##_erase(Name *self, Name##Iterator pos);\
+Name##Iterator Name##_erase_range(Name *self, Name##Iterator first, Name##Iterator last);\
+size_t Name##_erase_key(Name *self, KeyType key);\
+size_t Name##_count(Name *self, KeyType key);\
+Name##Iterator Name##_find(Name *self, KeyType key);\
+Name##Iterator Name##_lower_bound(Name *self, KeyType key);\
+Name##Iterator Name##_upper_bound(Name *self, KeyType key);\
+void Name##_equal_range(Name *self, KeyType key, Name##Iterator *first, Name##Iterator *last);\
+Name##Iterator Name##_begin(Name *self);\
+Name##Iterator Name##_end(Name *self);\
+Name##Iterator Name##_rbegin(Name *self);\
+Name##Iterator Name##_rend(Name *self);\
+Name##Iterator Name##_next(Name##Iterator pos);\
+Name##Iterator Name##_prev(Name##Iterator pos);\
+void Name##_swap(Name *self, Name *x);\
+
+
+#define CSTL_BTREE_WRAPPER_IMPLEMENT(Name, KeyType, ValueType, Compare)	\
+\
+typedef struct Name##BTreeElem Name##BTreeElem;\
+typedef struct Name##BTreeLeaf Name##BTreeLeaf;\
+typedef struct Name##BTreeInner Name##BTreeInner;\
+typedef struct Name##BTreeSlab Name##BTreeSlab;\
+\
+enum {\
+	/* 葉に格納する要素数 */\
+	Name##_LEAF_CAP = CSTL_BTREE_CAPACITY(4 * sizeof(void *), sizeof(Name##BTreeElem)),\
+	/* 内部ノードに格納するキーの数 */\
+	Name##_INNER_CAP = CSTL_BTREE_CAPACITY(2 * sizeof(void *), sizeof(KeyType) + sizeof(void *))\
+};\
+\
+/*! \
+ * \brief B木の葉\
+ *\
+ * 要素は全て葉に格納し、葉同士は昇順に双方向リストでつなぐ。\
+ * 葉は Name##_LEAF_ALIGN 境界に配置するので、要素のアドレスから葉を求めることができる。\
+ */\
+struct Name##BTreeLeaf {\
+	Name##BTreeLeaf *next;\
+	Name##BTreeLeaf *prev;\
+	size_t size;\
+	CSTL_MAGIC(Name##BTreeLeaf *magic;)\
+	Name##BTreeElem elems[Name##_LEAF_CAP];\
+};\
+\
+/*! \
+ * \brief B木の内部ノード\
+ *\
+ * children[i]の全ての要素 < keys[i] <= children[i+1]の全ての要素\
+ */\
+struct Name##BTreeInner {\
+	size_t size; /* キーの数 */\
+	KeyType keys[Name##_INNER_CAP];\
+	void *children[Name##_INNER_CAP + 1];\
+};\
+\
+/*! \
+ * \brief 葉をまとめて確保するメモリブロック\
+ */\
+struct Name##BTreeSlab {\
+	Name##BTreeSlab *next;\
+};\
+\
+enum {\
+	Name##_LEAF_ALIGN = CSTL_BTREE_ALIGN(sizeof(Name##BTreeLeaf)),\
+	Name##_LEAF_MIN = Name##_LEAF_CAP / 2,\
+	Name##_INNER_MIN = Name##_INNER_CAP / 2\
+};\
+\
+/* 葉がName##_LEAF_ALIGNに収まらない場合はコンパイルエラー(配列のサイズが負)にする */\
+typedef char Name##BTree_leaf_fits_align[sizeof(Name##BTreeLeaf) <= Name##_LEAF_ALIGN ? 1 : -1];\
+\
+/*! \
+ * \brief set/map構造体\
+ */\
+struct Name {\
+	Name##BTreeLeaf *head; /* end()を表す葉。nextが先頭の葉、prevが末尾の葉 */\
+	Name##BTreeSlab *head_slab;\
+	void *root;\
+	size_t height; /* 0ならrootは葉 */\
+	size_t size;\
+	Name##BTreeLeaf *free_leaves; /* 未使用の葉のリスト(nextでつなぐ) */\
+	Name##BTreeSlab *slabs;\
+	size_t nslab; /* 次に確保する葉の数 */\
+	CSTL_MAGIC(Name *magic;)\
+};\
+\
+static Name##BTreeLeaf *Name##BTree_leaf_of(Name##Iterator pos)\
+{\
+	return (Name##BTreeLeaf *) ((char *) pos - ((size_t) pos & (Name##_LEAF_ALIGN - 1)));\
+}\
+\
+static char *Name##BTree_alloc_slab(Name##BTreeSlab **slab, size_t n)\
+{\
+	char *p;\
+	*slab = (Name##BTreeSlab *) malloc(sizeof(Name##BTreeSlab) + Name##_LEAF_ALIGN - 1 + Name##_LEAF_ALIGN * n);\
+	if (!*slab) return 0;\
+	p = (char *) *slab + sizeof(Name##BTreeSlab);\
+	return p + ((Name##_LEAF_ALIGN - ((size_t) p & (Name##_LEAF_ALIGN - 1))) & (Name##_LEAF_ALIGN - 1));\
+}\
+\
+static Name##BTreeLeaf *Name##BTree_new_leaf(Name *self)\
+{\
+	Name##BTreeLeaf *leaf;\
+	if (!self->free_leaves) {\
+		Name##BTreeSlab *slab;\
+		size_t i;\
+		char *p = Name##BTree_alloc_slab(&slab, self->nslab);\
+		if (!p) return 0;\
+		slab->next = self->slabs;\
+		self->slabs = slab;\
+		for (i = 0; i < self->nslab; i++) {\
+			leaf = (Name##BTreeLeaf *) (p + Name##_LEAF_ALIGN * i);\
+			leaf->next = self->free_leaves;\
+			self->free_leaves = leaf;\
+		}\
+		if (self->nslab < CSTL_BTREE_SLAB_MAX) self->nslab *= 2;\
+	}\
+	leaf = self->free_leaves;\
+	self->free_leaves = leaf->next;\
+	leaf->size = 0;\
+	CSTL_MAGIC(leaf->magic = self->head);\
+	return leaf;\
+}\
+\
+static void Name##BTree_free_leaf(Name *self, Name##BTreeLeaf *leaf)\
+{\
+	CSTL_MAGIC(leaf->magic = 0);\
+	leaf->next = self->free_leaves;\
+	self->free_leaves = leaf;\
+}\
+\
+static void Name##BTree_free_nodes(void *node, size_t height)\
+{\
+	size_t i;\
+	Name##BTreeInner *inner;\
+	if (height == 0) return;\
+	inner = (Name##BTreeInner *) node;\
+	for (i = 0; i <= inner->size; i++) {\
+		Name##BTree_free_nodes(inner->children[i], height - 1);\
+	}\
+	free(inner);\
+}\
+\
+static size_t Name##BTree_inner_index(Name##BTreeInner *node, KeyType key)\
+{\
+	register size_t lo = 0;\
+	register size_t hi = node->size;\
+	register size_t mid;\
+	while (lo < hi) {\
+		mid = (lo + hi) / 2;\
+		if (Compare(key, node->keys[mid]) < 0) {\
+			hi = mid;\
+		} else {\
+			lo = mid + 1;\
+		}\
+	}\
+	return lo;\
+}\
+\
+static size_t Name##BTree_leaf_lower(Name##BTreeLeaf *leaf, KeyType key)\
+{\
+	register size_t lo = 0;\
+	register size_t hi = leaf->size;\
+	register size_t mid;\
+	while (lo < hi) {\
+		mid = (lo + hi) / 2;\
+		if (Compare(leaf->elems[mid].key, key) < 0) {\
+			lo = mid + 1;\
+		} else {\
+			hi = mid;\
+		}\
+	}\
+	return lo;\
+}\
+\
+static size_t Name##BTree_leaf_upper(Name##BTreeLeaf *leaf, KeyType key)\
+{\
+	register size_t lo = 0;\
+	register size_t hi = leaf->size;\
+	register size_t mid;\
+	while (lo < hi) {\
+		mid = (lo + hi) / 2;\
+		if (Compare(key, leaf->elems[mid].key) < 0) {\
+			hi = mid;\
+		} else {\
+			lo = mid + 1;\
+		}\
+	}\
+	return lo;\
+}\
+\
+/* keyを含み得る葉を探す。pathとidxには各高さの内部ノードと辿った子の位置を格納する */\
+static Name##BTreeLeaf *Name##BTree_find_leaf(Name *self, KeyType key, Name##BTreeInner **path, size_t *idx)\
+{\
+	register void *t = self->root;\
+	register size_t h = self->height;\
+	register size_t i;\
+	while (h > 0) {\
+		h--;\
+		i = Name##BTree_inner_index((Name##BTreeInner *) t, key);\
+		if (path) {\
+			path[h] = (Name##BTreeInner *) t;\
+			idx[h] = i;\
+		}\
+		t = ((Name##BTreeInner *) t)->children[i];\
+	}\
+	return (Name##BTreeLeaf *) t;\
+}\
+\
+static void Name##BTree_link_leaf(Name##BTreeLeaf *pos, Name##BTreeLeaf *leaf)\
+{\
+	leaf->prev = pos;\
+	leaf->next = pos->next;\
+	pos->next->prev = leaf;\
+	pos->next = leaf;\
+}\
+\
+static void Name##BTree_unlink_leaf(Name##BTreeLeaf *leaf)\
+{\
+	leaf->prev->next = leaf->next;\
+	leaf->next->prev = leaf->prev;\
+}\
+\
+/* keyの要素の位置を返す。既に存在すればその要素を返し*insertedを0にする。メモリ不足なら0を返す */\
+static Name##BTreeElem *Name##BTree_insert(Name *self, KeyType key, int *inserted)\
+{\
+	Name##BTreeInner *path[CSTL_BTREE_MAX_DEPTH];\
+	size_t idx[CSTL_BTREE_MAX_DEPTH];\
+	Name##BTreeInner *nodes[CSTL_BTREE_MAX_DEPTH + 1];\
+	size_t nnodes = 0;\
+	Name##BTreeLeaf *leaf;\
+	Name##BTreeLeaf *right;\
+	Name##BTreeElem *elem;\
+	void *child;\
+	KeyType sep;\
+	size_t i, h, lsize;\
+	*inserted = 0;\
+	if (!self->root) {\
+		leaf = Name##BTree_new_leaf(self);\
+		if (!leaf) return 0;\
+		Name##BTree_link_leaf(self->head, leaf);\
+		self->root = leaf;\
+		self->height = 0;\
+	}\
+	leaf = Name##BTree_find_leaf(self, key, path, idx);\
+	i = Name##BTree_leaf_lower(leaf, key);\
+	if (i < leaf->size && Compare(key, leaf->elems[i].key) == 0) {\
+		return &leaf->elems[i];\
+	}\
+	if (leaf->size < Name##_LEAF_CAP) {\
+		memmove(&leaf->elems[i + 1], &leaf->elems[i], sizeof(Name##BTreeElem) * (leaf->size - i));\
+		leaf->elems[i].key = key;\
+		leaf->size++;\
+		self->size++;\
+		*inserted = 1;\
+		return &leaf->elems[i];\
+	}\
+	/* 分割に必要なノードを先に確保する */\
+	for (h = 0; h < self->height && path[h]->size == Name##_INNER_CAP; h++) ;\
+	nnodes = (h == self->height) ? h + 1 : h;\
+	for (h = 0; h < nnodes; h++) {\
+		nodes[h] = (Name##BTreeInner *) malloc(sizeof(Name##BTreeInner));\
+		if (!nodes[h]) break;\
+	}\
+	right = (h == nnodes) ? Name##BTree_new_leaf(self) : 0;\
+	if (!right) {\
+		while (h > 0) {\
+			h--;\
+			free(nodes[h]);\
+		}\
+		return 0;\
+	}\
+	/* 葉を分割する。端への追加が続く場合は詰めたままにする */\
+	if (i == Name##_LEAF_CAP && leaf->next == self->head) {\
+		lsize = Name##_LEAF_CAP;\
+	} else if (i == 0 && leaf->prev == self->head) {\
+		lsize = 1;\
+	} else {\
+		lsize = (Name##_LEAF_CAP + 1) / 2;\
+	}\
+	if (i < lsize) {\
+		right->size = Name##_LEAF_CAP - lsize + 1;\
+		memcpy(right->elems, &leaf->elems[lsize - 1], sizeof(Name##BTreeElem) * right->size);\
+		memmove(&leaf->elems[i + 1], &leaf->elems[i], sizeof(Name##BTreeElem) * (lsize - 1 - i));\
+		elem = &leaf->elems[i];\
+	} else {\
+		right->size = Name##_LEAF_CAP - lsize + 1;\
+		memcpy(right->elems, &leaf->elems[lsize], sizeof(Name##BTreeElem) * (i - lsize));\
+		memcpy(&right->elems[i - lsize + 1], &leaf->elems[i], sizeof(Name##BTreeElem) * (Name##_LEAF_CAP - i));\
+		elem = &right->elems[i - lsize];\
+	}\
+	leaf->size = lsize;\
+	elem->key = key;\
+	Name##BTree_link_leaf(leaf, right);\
+	/* 親に区切りのキーを追加する */\
+	sep = right->elems[0].key;\
+	child = right;\
+	for (h = 0; ; h++) {\
+		Name##BTreeInner *node;\
+		Name##BTreeInner *sib;\
+		size_t ci, mid;\
+		KeyType keys[Name##_INNER_CAP + 1];\
+		void *children[Name##_INNER_CAP + 2];\
+		if (h == self->height) {\
+			node = nodes[--nnodes];\
+			node->size = 1;\
+			node->keys[0] = sep;\
+			node->children[0] = self->root;\
+			node->children[1] = child;\
+			self->root = node;\
+			self->height++;\
+			break;\
+		}\
+		node = path[h];\
+		ci = idx[h];\
+		if (node->size < Name##_INNER_CAP) {\
+			memmove(&node->keys[ci + 1], &node->keys[ci], sizeof(KeyType) * (node->size - ci));\
+			memmove(&node->children[ci + 2], &node->children[ci + 1], sizeof(void *) * (node->size - ci));\
+			node->keys[ci] = sep;\
+			node->children[ci + 1] = child;\
+			node->size++;\
+			break;\
+		}\
+		/* 内部ノードを分割して中央のキーを親に送る */\
+		memcpy(keys, node->keys, sizeof(KeyType) * ci);\
+		keys[ci] = sep;\
+		memcpy(&keys[ci + 1], &node->keys[ci], sizeof(KeyType) * (Name##_INNER_CAP - ci));\
+		memcpy(children, node->children, sizeof(void *) * (ci + 1));\
+		children[ci + 1] = child;\
+		memcpy(&children[ci + 2], &node->children[ci + 1], sizeof(void *) * (Name##_INNER_CAP - ci));\
+		mid = (Name##_INNER_CAP + 1) / 2;\
+		sib = nodes[--nnodes];\
+		node->size = mid;\
+		memcpy(node->keys, keys, sizeof(KeyType) * mid);\
+		memcpy(node->children, children, sizeof(void *) * (mid + 1));\
+		sib->size = Name##_INNER_CAP - mid;\
+		memcpy(sib->keys, &keys[mid + 1], sizeof(KeyType) * sib->size);\
+		memcpy(sib->children, &children[mid + 1], sizeof(void *) * (sib->size + 1));\
+		sep = keys[mid];\
+		child = sib;\
+	}\
+	self->size++;\
+	*inserted = 1;\
+	return elem;\
+}\
+\
+static void Name##BTree_inner_remove(Name##BTreeInner *node, size_t k)\
+{\
+	memmove(&node->keys[k], &node->keys[k + 1], sizeof(KeyType) * (node->size - k - 1));\
+	memmove(&node->children[k + 1], &node->children[k + 2], sizeof(void *) * (node->size - k - 1));\
+	node->size--;\
+}\
+\
+/* 内部ノードの要素数の下限を満たすように親から順に修正する */\
+static void Name##BTree_rebalance(Name *self, Name##BTreeInner **path, size_t *idx)\
+{\
+	size_t h;\
+	for (h = 0; h < self->height; h++) {\
+		Name##BTreeInner *node = path[h];\
+		Name##BTreeInner *parent;\
+		Name##BTreeInner *left;\
+		Name##BTreeInner *right;\
+		size_t ci;\
+		if (h == self->height - 1) {\
+			if (node->size == 0) {\
+				self->root = node->children[0];\
+				self->height--;\
+				free(node);\
+			}\
+			break;\
+		}\
+		if (node->size >= Name##_INNER_MIN) break;\
+		parent = path[h + 1];\
+		ci = idx[h + 1];\
+		left = (ci > 0) ? (Name##BTreeInner *) parent->children[ci - 1] : 0;\
+		right = (ci < parent->size) ? (Name##BTreeInner *) parent->children[ci + 1] : 0;\
+		if (left && left->size > Name##_INNER_MIN) {\
+			memmove(&node->keys[1], &node->keys[0], sizeof(KeyType) * node->size);\
+			memmove(&node->children[1], &node->children[0], sizeof(void *) * (node->size + 1));\
+			node->keys[0] = parent->keys[ci - 1];\
+			node->children[0] = left->children[left->size];\
+			parent->keys[ci - 1] = left->keys[left->size - 1];\
+			left->size--;\
+			node->size++;\
+			break;\
+		} else if (right && right->size > Name##_INNER_MIN) {\
+			node->keys[node->size] = parent->keys[ci];\
+			node->children[node->size + 1] = right->children[0];\
+			parent->keys[ci] = right->keys[0];\
+			memmove(&right->keys[0], &right->keys[1], sizeof(KeyType) * (right->size - 1));\
+			memmove(&right->children[0], &right->children[1], sizeof(void *) * right->size);\
+			right->size--;\
+			node->size++;\
+			break;\
+		} else if (left) {\
+			left->keys[left->size] = parent->keys[ci - 1];\
+			memcpy(&left->keys[left->size + 1], node->keys, sizeof(KeyType) * node->size);\
+			memcpy(&left->children[left->size + 1], node->children, sizeof(void *) * (node->size + 1));\
+			left->size += node->size + 1;\
+			free(node);\
+			Name##BTree_inner_remove(parent, ci - 1);\
+		} else {\
+			node->keys[node->size] = parent->keys[ci];\
+			memcpy(&node->keys[node->size + 1], right->keys, sizeof(KeyType) * right->size);\
+			memcpy(&node->children[node->size + 1], right->children, sizeof(void *) * (right->size + 1));\
+			node->size += right->size + 1;\
+			free(right);\
+			Name##BTree_inner_remove(parent, ci);\
+		}\
+	}\
+}\
+\
+/* posの要素を削除し、次の要素の位置を返す */\
+static Name##Iterator Name##BTree_erase(Name *self, Name##Iterator pos)\
+{\
+	Name##BTreeInner *path[CSTL_BTREE_MAX_DEPTH];\
+	size_t idx[CSTL_BTREE_MAX_DEPTH];\
+	Name##BTreeLeaf *leaf;\
+	Name##BTreeLeaf *left;\
+	Name##BTreeLeaf *right;\
+	Name##BTreeInner *parent;\
+	size_t i, ci;\
+	leaf = Name##BTree_find_leaf(self, pos->key, path, idx);\
+	CSTL_ASSERT(leaf == Name##BTree_leaf_of(pos) && "BTree_erase");\
+	i = (size_t) (pos - leaf->elems);\
+	memmove(&leaf->elems[i], &leaf->elems[i + 1], sizeof(Name##BTreeElem) * (leaf->size - i - 1));\
+	leaf->size--;\
+	self->size--;\
+	if (self->height == 0) {\
+		if (leaf->size == 0) {\
+			Name##BTree_unlink_leaf(leaf);\
+			Name##BTree_free_leaf(self, leaf);\
+			self->root = 0;\
+			return self->head->elems;\
+		}\
+		return (i < leaf->size) ? &leaf->elems[i] : leaf->next->elems;\
+	}\
+	if (leaf->size >= Name##_LEAF_MIN) {\
+		return (i < leaf->size) ? &leaf->elems[i] : leaf->next->elems;\
+	}\
+	parent = path[0];\
+	ci = idx[0];\
+	left = (ci > 0) ? (Name##BTreeLeaf *) parent->children[ci - 1] : 0;\
+	right = (ci < parent->size) ? (Name##BTreeLeaf *) parent->children[ci + 1] : 0;\
+	if (left && left->size > Name##_LEAF_MIN) {\
+		/* 左の葉から1つ借りる */\
+		memmove(&leaf->elems[1], &leaf->elems[0], sizeof(Name##BTreeElem) * leaf->size);\
+		leaf->elems[0] = left->elems[left->size - 1];\
+		left->size--;\
+		leaf->size++;\
+		parent->keys[ci - 1] = leaf->elems[0].key;\
+		i++;\
+		return (i < leaf->size) ? &leaf->elems[i] : leaf->next->elems;\
+	} else if (right && right->size > Name##_LEAF_MIN) {\
+		/* 右の葉から1つ借りる */\
+		leaf->elems[leaf->size] = right->elems[0];\
+		leaf->size++;\
+		memmove(&right->elems[0], &right->elems[1], sizeof(Name##BTreeElem) * (right->size - 1));\
+		right->size--;\
+		parent->keys[ci] = right->elems[0].key;\
+		pos = &leaf->elems[i];\
+	} else if (left) {\
+		/* 左の葉に併合する */\
+		memcpy(&left->elems[left->size], leaf->elems, sizeof(Name##BTreeElem) * leaf->size);\
+		i += left->size;\
+		left->size += leaf->size;\
+		Name##BTree_unlink_leaf(leaf);\
+		Name##BTree_free_leaf(self, leaf);\
+		Name##BTree_inner_remove(parent, ci - 1);\
+		pos = (i < left->size) ? &left->elems[i] : left->next->elems;\
+	} else {\
+		/* 右の葉を併合する */\
+		memcpy(&leaf->elems[leaf->size], right->elems, sizeof(Name##BTreeElem) * right->size);\
+		leaf->size += right->size;\
+		Name##BTree_unlink_leaf(right);\
+		Name##BTree_free_leaf(self, right);\
+		Name##BTree_inner_remove(parent, ci);\
+		pos = &leaf->elems[i];\
+	}\
+	Name##BTree_rebalance(self, path, idx);\
+	return pos;\
+}\
+\
+Name *Name##_new(void)\
+{\
+	Name *self;\
+	self = (Name *) malloc(sizeof(Name));\
+	if (!self) return 0;\
+	self->head = (Name##BTreeLeaf *) Name##BTree_alloc_slab(&self->head_slab, 1);\
+	if (!self->head) {\
+		free(self);\
+		return 0;\
+	}\
+	self->head->next = self->head;\
+	self->head->prev = self->head;\
+	self->head->size = 0;\
+	CSTL_MAGIC(self->head->magic = self->head);\
+	self->root = 0;\
+	self->height = 0;\
+	self->size = 0;\
+	self->free_leaves = 0;\
+	self->slabs = 0;\
+	self->nslab = 1;\
+	CSTL_MAGIC(self->magic = self);\
+	return self;\
+}\
+\
+void Name##_delete(Name *self)\
+{\
+	if (!self) return;\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_delete");\
+	Name##_clear(self);\
+	free(self->head_slab);\
+	CSTL_MAGIC(self->magic = 0);\
+	free(self);\
+}\
+\
+void Name##_clear(Name *self)\
+{\
+	Name##BTreeSlab *slab;\
+	CSTL_ASSERT(self && "BTree(Set|Map)_clear");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_clear");\
+	if (self->root) {\
+		Name##BTree_free_nodes(self->root, self->height);\
+	}\
+	while (self->slabs) {\
+		slab = self->slabs;\
+		self->slabs = slab->next;\
+		free(slab);\
+	}\
+	self->head->next = self->head;\
+	self->head->prev = self->head;\
+	self->root = 0;\
+	self->height = 0;\
+	self->size = 0;\
+	self->free_leaves = 0;\
+	self->nslab = 1;\
+}\
+\
+int Name##_empty(Name *self)\
+{\
+	CSTL_ASSERT(self && "BTree(Set|Map)_empty");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_empty");\
+	return self->size == 0;\
+}\
+\
+size_t Name##_size(Name *self)\
+{\
+	CSTL_ASSERT(self && "BTree(Set|Map)_size");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_size");\
+	return self->size;\
+}\
+\
+int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
+{\
+	register Name##Iterator pos;\
+	Name##BTreeElem *elem;\
+	unsigned char *inserted;\
+	size_t n = 0;\
+	size_t i;\
+	int success;\
+	CSTL_ASSERT(self && "BTree(Set|Map)_insert_range");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_insert_range");\
+	CSTL_ASSERT(first && "BTree(Set|Map)_insert_range");\
+	CSTL_ASSERT(last && "BTree(Set|Map)_insert_range");\
+	CSTL_ASSERT(Name##BTree_leaf_of(first)->magic && "BTree(Set|Map)_insert_range");\
+	CSTL_ASSERT(Name##BTree_leaf_of(last)->magic && "BTree(Set|Map)_insert_range");\
+	for (pos = first; pos != last; pos = Name##_next(pos)) {\
+		n++;\
+	}\
+	if (n == 0) return 1;\
+	/* メモリ不足の時に元に戻すため、追加した要素を記録する */\
+	inserted = (unsigned char *) malloc(n);\
+	if (!inserted) return 0;\
+	for (pos = first, i = 0; i < n; pos = Name##_next(pos), i++) {\
+		elem = Name##BTree_insert(self, pos->key, &success);\
+		if (!elem) break;\
+		if (success) *elem = *pos;\
+		inserted[i] = (unsigned char) success;\
+	}\
+	if (i < n) {\
+		size_t j;\
+		for (pos = first, j = 0; j < i; pos = Name##_next(pos), j++) {\
+			if (inserted[j]) {\
+				Name##_erase_key(self, pos->key);\
+			}\
+		}\
+		free(inserted);\
+		return 0;\
+	}\
+	free(inserted);\
+	return 1;\
+}\
+\
+Name##Iterator Name##_erase(Name *self, Name##Iterator pos)\
+{\
+	CSTL_ASSERT(self && "BTree(Set|Map)_erase");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_erase");\
+	CSTL_ASSERT(pos && "BTree(Set|Map)_erase");\
+	CSTL_ASSERT(pos != self->head->elems && "BTree(Set|Map)_erase");\
+	CSTL_ASSERT(Name##BTree_leaf_of(pos)->magic == self->head && "BTree(Set|Map)_erase");\
+	return Name##BTree_erase(self, pos);\
+}\
+\
+Name##Iterator Name##_erase_range(Name *self, Name##Iterator first, Name##Iterator last)\
+{\
+	register Name##Iterator pos;\
+	register size_t n = 0;\
+	CSTL_ASSERT(self && "BTree(Set|Map)_erase_range");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_erase_range");\
+	CSTL_ASSERT(first && "BTree(Set|Map)_erase_range");\
+	CSTL_ASSERT(last && "BTree(Set|Map)_erase_range");\
+	CSTL_ASSERT(Name##BTree_leaf_of(first)->magic == self->head && "BTree(Set|Map)_erase_range");\
+	CSTL_ASSERT(Name##BTree_leaf_of(last)->magic == self->head && "BTree(Set|Map)_erase_range");\
+	/* 削除によってlastが無効になるため、先に要素数を数える */\
+	for (pos = first; pos != last; pos = Name##_next(pos)) {\
+		n++;\
+	}\
+	pos = first;\
+	while (n > 0) {\
+		CSTL_ASSERT(!Name##_empty(self) && "BTree(Set|Map)_erase_range");\
+		pos = Name##BTree_erase(self, pos);\
+		n--;\
+	}\
+	return pos;\
+}\
+\
+size_t Name##_erase_key(Name *self, KeyType key)\
+{\
+	Name##Iterator pos;\
+	CSTL_ASSERT(self && "BTree(Set|Map)_erase_key");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_erase_key");\
+	pos = Name##_find(self, key);\
+	if (pos == self->head->elems) return 0;\
+	Name##BTree_erase(self, pos);\
+	return 1;\
+}\
+\
+size_t Name##_count(Name *self, KeyType key)\
+{\
+	CSTL_ASSERT(self && "BTree(Set|Map)_count");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_count");\
+	return Name##_find(self, key) != self->head->elems;\
+}\
+\
+Name##Iterator Name##_find(Name *self, KeyType key)\
+{\
+	Name##BTreeLeaf *leaf;\
+	size_t i;\
+	CSTL_ASSERT(self && "BTree(Set|Map)_find");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_find");\
+	if (!self->root) return self->head->elems;\
+	leaf = Name##BTree_find_leaf(self, key, 0, 0);\
+	i = Name##BTree_leaf_lower(leaf, key);\
+	if (i < leaf->size && Compare(key, leaf->elems[i].key) == 0) {\
+		return &leaf->elems[i];\
+	}\
+	return self->head->elems;\
+}\
+\
+Name##Iterator Name##_lower_bound(Name *self, KeyType key)\
+{\
+	Name##BTreeLeaf *leaf;\
+	size_t i;\
+	CSTL_ASSERT(self && "BTree(Set|Map)_lower_bound");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_lower_bound");\
+	if (!self->root) return self->head->elems;\
+	leaf = Name##BTree_find_leaf(self, key, 0, 0);\
+	i = Name##BTree_leaf_lower(leaf, key);\
+	return (i < leaf->size) ? &leaf->elems[i] : leaf->next->elems;\
+}\
+\
+Name##Iterator Name##_upper_bound(Name *self, KeyType key)\
+{\
+	Name##BTreeLeaf *leaf;\
+	size_t i;\
+	CSTL_ASSERT(self && "BTree(Set|Map)_upper_bound");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_upper_bound");\
+	if (!self->root) return self->head->elems;\
+	leaf = Name##BTree_find_leaf(self, key, 0, 0);\
+	i = Name##BTree_leaf_upper(leaf, key);\
+	return (i < leaf->size) ? &leaf->elems[i] : leaf->next->elems;\
+}\
+\
+void Name##_equal_range(Name *self, KeyType key, Name##Iterator *first, Name##Iterator *last)\
+{\
+	CSTL_ASSERT(self && "BTree(Set|Map)_equal_range");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_equal_range");\
+	CSTL_ASSERT(first && "BTree(Set|Map)_equal_range");\
+	CSTL_ASSERT(last && "BTree(Set|Map)_equal_range");\
+	*first = Name##_lower_bound(self, key);\
+	*last = (*first != self->head->elems && Compare(key, (*first)->key) == 0) ? Name##_next(*first) : *first;\
+}\
+\
+Name##Iterator Name##_begin(Name *self)\
+{\
+	CSTL_ASSERT(self && "BTree(Set|Map)_begin");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_begin");\
+	return self->head->next->elems;\
+}\
+\
+Name##Iterator Name##_end(Name *self)\
+{\
+	CSTL_ASSERT(self && "BTree(Set|Map)_end");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_end");\
+	return self->head->elems;\
+}\
+\
+Name##Iterator Name##_rbegin(Name *self)\
+{\
+	Name##BTreeLeaf *leaf;\
+	CSTL_ASSERT(self && "BTree(Set|Map)_rbegin");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_rbegin");\
+	leaf = self->head->prev;\
+	return (leaf == self->head) ? self->head->elems : &leaf->elems[leaf->size - 1];\
+}\
+\
+Name##Iterator Name##_rend(Name *self)\
+{\
+	CSTL_ASSERT(self && "BTree(Set|Map)_rend");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_rend");\
+	return self->head->elems;\
+}\
+\
+Name##Iterator Name##_next(Name##Iterator pos)\
+{\
+	Name##BTreeLeaf *leaf;\
+	CSTL_ASSERT(pos && "BTree(Set|Map)_next");\
+	leaf = Name##BTree_leaf_of(pos);\
+	CSTL_ASSERT(leaf->magic && "BTree(Set|Map)_next");\
+	CSTL_ASSERT(pos < &leaf->elems[leaf->size] && "BTree(Set|Map)_next");\
+	if (pos + 1 < &leaf->elems[leaf->size]) {\
+		return pos + 1;\
+	}\
+	/* 末尾の葉の次はend()を表す葉になる */\
+	return leaf->next->elems;\
+}\
+\
+Name##Iterator Name##_prev(Name##Iterator pos)\
+{\
+	Name##BTreeLeaf *leaf;\
+	CSTL_ASSERT(pos && "BTree(Set|Map)_prev");\
+	leaf = Name##BTree_leaf_of(pos);\
+	CSTL_ASSERT(leaf->magic && "BTree(Set|Map)_prev");\
+	CSTL_ASSERT(leaf->size > 0 && "BTree(Set|Map)_prev");\
+	if (pos > leaf->elems) {\
+		return pos - 1;\
+	}\
+	leaf = leaf->prev;\
+	/* 先頭の葉の前はrend()を表す葉になる */\
+	return (leaf->size > 0) ? &leaf->elems[leaf->size - 1] : leaf->elems;\
+}\
+\
+void Name##_swap(Name *self, Name *x)\
+{\
+	Name tmp;\
+	CSTL_ASSERT(self && "BTree(Set|Map)_swap");\
+	CSTL_ASSERT(x && "BTree(Set|Map)_swap");\
+	CSTL_ASSERT(self->magic == self && "BTree(Set|Map)_swap");\
+	CSTL_ASSERT(x->magic == x && "BTree(Set|Map)_swap");\
+	tmp = *self;\
+	*self = *x;\
+	*x = tmp;\
+	CSTL_MAGIC(self->magic = self);\
+	CSTL_MAGIC(x->magic = x);\
+}\
+\
+
+
+/*!
+ * \brief インターフェイスマクロ
+ *
+ * \param Name コンテナ名
+ * \param Type 要素の型
+ */
+#define CSTL_BTREE_SET_INTERFACE(Name, Type)	\
+\
+CSTL_EXTERN_C_BEGIN()\
+CSTL_BTREE_WRAPPER_INTERFACE(Name, Type, Type)\
+Name##Iterator Name##_insert(Name *self, Type data, int *success);\
+Type const *Name##_data(Name##Iterator pos);\
+CSTL_EXTERN_C_END()\
+
+/*!
+ * \brief 実装マクロ
+ *
+ * \param Name コンテナ名
+ * \param Type 要素の型
+ * \param Compare 要素の比較ルーチン
+ */
+#define CSTL_BTREE_SET_IMPLEMENT(Name, Type, Compare)	\
+/*! \
+ * \brief set要素構造体\
+ */\
+struct Name##BTreeElem {\
+	Type key;\
+};\
+\
+CSTL_BTREE_WRAPPER_IMPLEMENT(Name, Type, Type, Compare)\
+\
+Name##Iterator Name##_insert(Name *self, Type data, int *success)\
+{\
+	Name##Iterator pos;\
+	int inserted;\
+	CSTL_ASSERT(self && "BTreeSet_insert");\
+	CSTL_ASSERT(self->magic == self && "BTreeSet_insert");\
+	pos = Name##BTree_insert(self, data, &inserted);\
+	if (success) *success = inserted;\
+	return pos;\
+}\
+\
+Type const *Name##_data(Name##Iterator pos)\
+{\
+	CSTL_ASSERT(pos && "BTreeSet_data");\
+	CSTL_ASSERT(Name##BTree_leaf_of(pos)->magic && "BTreeSet_data");\
+	CSTL_ASSERT(Name##BTree_leaf_of(pos)->size > 0 && "BTreeSet_data");\
+	return &pos->key;\
+}\
+\
+
+
+/*!
+ * \brief インターフェイスマクロ
+ *
+ * \param Name コンテナ名
+ * \param KeyType 要素のキーの型
+ * \param ValueType 要素の値の型
+ */
+#define CSTL_BTREE_MAP_INTERFACE(Name, KeyType, ValueType)	\
+\
+CSTL_EXTERN_C_BEGIN()\
+CSTL_BTREE_WRAPPER_INTERFACE(Name, KeyType, ValueType)\
+Name##Iterator Name##_insert(Name *self, KeyType key, ValueType value, int *success);\
+Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value, int *success);\
+KeyType const *Name##_key(Name##Iterator pos);\
+ValueType *Name##_value(Name##Iterator pos);\
+ValueType *Name##_at(Name *self, KeyType key);\
+CSTL_EXTERN_C_END()\
+
+/*!
+ * \brief 実装マクロ
+ *
+ * \param Name コンテナ名
+ * \param KeyType 要素のキーの型
+ * \param ValueType 要素の値の型
+ * \param Compare 要素の比較ルーチン
+ */
+#define CSTL_BTREE_MAP_IMPLEMENT(Name, KeyType, ValueType, Compare)	\
+/*! \
+ * \brief map要素構造体\
+ */\
+struct Name##BTreeElem {\
+	KeyType key;\
+	ValueType value;\
+};\
+\
+CSTL_BTREE_WRAPPER_IMPLEMENT(Name, KeyType, ValueType, Compare)\
+\
+/* Name##_at()で追加する要素の値 */\
+static const struct {\
+	void *dummy;\
+	ValueType value;\
+} Name##BTree_nil = {0};\
+\
+Name##Iterator Name##_insert(Name *self, KeyType key, ValueType value, int *success)\
+{\
+	CSTL_ASSERT(self && "BTreeMap_insert");\
+	CSTL_ASSERT(self->magic == self && "BTreeMap_insert");\
+	return Name##_insert_ref(self, key, &value, success);\
+}\
+\
+Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value, int *success)\
+{\
+	Name##Iterator pos;\
+	int inserted;\
+	CSTL_ASSERT(self && "BTreeMap_insert_ref");\
+	CSTL_ASSERT(self->magic == self && "BTreeMap_insert_ref");\
+	CSTL_ASSERT(value && "BTreeMap_insert_ref");\
+	pos = Name##BTree_insert(self, key, &inserted);\
+	if (inserted) pos->value = *value;\
+	if (success) *success = inserted;\
+	return pos;\
+}\
+\
+KeyType const *Name##_key(Name##Iterator pos)\
+{\
+	CSTL_ASSERT(pos && "BTreeMap_key");\
+	CSTL_ASSERT(Name##BTree_leaf_of(pos)->magic && "BTreeMap_key");\
+	CSTL_ASSERT(Name##BTree_leaf_of(pos)->size > 0 && "BTreeMap_key");\
+	return &pos->key;\
+}\
+\
+ValueType *Name##_value(Name##Iterator pos)\
+{\
+	CSTL_ASSERT(pos && "BTreeMap_value");\
+	CSTL_ASSERT(Name##BTree_leaf_of(pos)->magic && "BTreeMap_value");\
+	CSTL_ASSERT(Name##BTree_leaf_of(pos)->size > 0 && "BTreeMap_value");\
+	return &pos->value;\
+}\
+\
+ValueType *Name##_at(Name *self, KeyType key)\
+{\
+	Name##Iterator pos;\
+	int inserted;\
+	CSTL_ASSERT(self && "BTreeMap_at");\
+	CSTL_ASSERT(self->magic == self && "BTreeMap_at");\
+	pos = Name##BTree_insert(self, key, &inserted);\
+	if (!pos) {\
+		/* メモリ不足 */\
+		return 0;\
+	}\
+	if (inserted) {\
+		/* 新しい要素の値にはnilの値を使用 */\
+		pos->value = Name##BTree_nil.value;\
+	}\
+	return &pos->value;\
+}\
+\
+
+
+#endif /* CSTL_BTREE_H_INCLUDED */
@@ -53,5 +53,18 @@
 
 #define CSTL_UNUSED_PARAM(x)	(void) x
 
+/* 
+ * xの指すアドレスを含むキャッシュラインを先読みする。
+ * 対応していないコンパイラでは何もしない。
+ */
+#if defined(__GNUC__)
+#define CSTL_PREFETCH(x)	__builtin_prefetch(x)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#define CSTL_PREFETCH(x)	_mm_prefetch((const char *) (x), _MM_HINT_T0)
+#else
+#define CSTL_PREFETCH(x)	((void) 0)
+#endif
+
 
 #endif /* CSTL_COMMON_H_INCLUDED */
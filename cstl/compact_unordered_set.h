@@ -0,0 +1,464 @@
+/*
+ * Copyright (c) 2006-2010, KATO Noriaki
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*!
+ * \file compact_unordered_set.h
+ * \brief ノードを配列に詰めたメモリ効率のよいunordered_set
+ * \author KATO Noriaki <katono@users.sourceforge.jp>
+ * \date 2026-10-19
+ * $URL$
+ * $Id$
+ */
+#ifndef CSTL_COMPACT_UNORDERED_SET_H_INCLUDED
+#define CSTL_COMPACT_UNORDERED_SET_H_INCLUDED
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "common.h"
+#include "vector.h"
+#include "hashtable.h"
+
+
+/* バケット数の最小値の2を底とする対数 */
+#define CSTL_COMPACT_UNORDERED_SET_MIN_BITS	3
+
+
+/*!
+ * \brief インターフェイスマクロ
+ *
+ * \param Name コンテナ名
+ * \param Type 要素の型
+ */
+#define CSTL_COMPACT_UNORDERED_SET_INTERFACE(Name, Type)	\
+typedef struct Name Name;\
+typedef struct Name##Node *Name##Iterator;\
+\
+CSTL_EXTERN_C_BEGIN()\
+CSTL_HASH_INTEGER_INTERFACE(Name)\
+Name *Name##_new(void);\
+void Name##_delete(Name *self);\
+void Name##_clear(Name *self);\
+int Name##_empty(Name *self);\
+size_t Name##_size(Name *self);\
+Name##Iterator Name##_insert(Name *self, Type data, int *success);\
+Name##Iterator Name##_erase(Name *self, Name##Iterator pos);\
+size_t Name##_erase_key(Name *self, Type key);\
+size_t Name##_count(Name *self, Type key);\
+Name##Iterator Name##_find(Name *self, Type key);\
+Name##Iterator Name##_begin(Name *self);\
+Name##Iterator Name##_end(Name *self);\
+Name##Iterator Name##_next(Name##Iterator pos);\
+Type const *Name##_data(Name##Iterator pos);\
+void Name##_swap(Name *self, Name *x);\
+size_t Name##_bucket_count(Name *self);\
+float Name##_load_factor(Name *self);\
+float Name##_get_max_load_factor(Name *self);\
+void Name##_set_max_load_factor(Name *self, float z);\
+int Name##_rehash(Name *self, size_t n);\
+int Name##_reserve(Name *self, size_t n);\
+int Name##_shrink_to_fit(Name *self);\
+CSTL_EXTERN_C_END()\
+
+
+/*!
+ * \brief 実装マクロ
+ *
+ * \param Name コンテナ名
+ * \param Type 要素の型
+ * \param Hasher ハッシュ関数
+ * \param Compare 要素の比較ルーチン
+ */
+#define CSTL_COMPACT_UNORDERED_SET_IMPLEMENT(Name, Type, Hasher, Compare)	\
+\
+typedef struct Name##Node Name##Node;\
+/*! \
+ * \brief compact_unordered_setノード構造体\
+ *\
+ * ノードは1つの配列に詰めて格納し、互いを32bitのインデックスで指す。\
+ * バケットへのポインタや直前のノードへのポインタは持たない。\
+ */\
+struct Name##Node {\
+	unsigned int next; /* 同じバケットの次のノードのインデックス+1。0ならば終端 */\
+	Type key;\
+};\
+\
+CSTL_VECTOR_INTERFACE(Name##_NodeVector, Name##Node)\
+CSTL_VECTOR_IMPLEMENT_BASE(Name##_NodeVector, Name##Node)\
+CSTL_VECTOR_IMPLEMENT_RESERVE(Name##_NodeVector, Name##Node)\
+CSTL_VECTOR_IMPLEMENT_PUSH_BACK(Name##_NodeVector, Name##Node)\
+CSTL_VECTOR_IMPLEMENT_POP_BACK(Name##_NodeVector, Name##Node)\
+CSTL_VECTOR_IMPLEMENT_SHRINK(Name##_NodeVector, Name##Node)\
+CSTL_VECTOR_IMPLEMENT_SWAP(Name##_NodeVector, Name##Node)\
+\
+/*! \
+ * \brief compact_unordered_set構造体\
+ */\
+struct Name {\
+	Name##_NodeVector *nodes;\
+	unsigned int *buckets; /* 各バケットの先頭のノードのインデックス+1。0ならば空 */\
+	size_t shift; /* ハッシュ値にCSTL_HASH_K1を掛けて右シフトするビット数 */\
+	float max_load_factor;\
+	CSTL_MAGIC(Name *magic;)\
+};\
+\
+static const float Name##_minimum_mlf = 1e-3f;\
+\
+CSTL_HASH_INTEGER_IMPLEMENT(Name)\
+\
+/* バケット数は2のべき乗なので、ハッシュ値の上位ビットを使うよう混ぜてから選ぶ */\
+static size_t Name##_bucket_index(Name *self, Type const *key)\
+{\
+	return ((size_t) Hasher(*key) * CSTL_HASH_K1) >> self->shift;\
+}\
+\
+/* n個の要素をロードファクターの上限以下で格納できるバケット数の対数 */\
+static size_t Name##_bucket_bits(Name *self, size_t n)\
+{\
+	size_t bits = CSTL_COMPACT_UNORDERED_SET_MIN_BITS;\
+	while (bits < CSTL_HASH_BITS - 1 && (double) ((size_t) 1 << bits) * self->max_load_factor < (double) n) {\
+		bits++;\
+	}\
+	return bits;\
+}\
+\
+/* idx番目のバケットからkeyのノードを探し、インデックス+1を返す。見つからなければ0を返す */\
+static unsigned int Name##_find_index(Name *self, size_t idx, Type const *key)\
+{\
+	register unsigned int i;\
+	for (i = self->buckets[idx]; i; i = CSTL_VECTOR_AT(self->nodes, i - 1).next) {\
+		if (Compare(CSTL_VECTOR_AT(self->nodes, i - 1).key, *key) == 0) {\
+			return i;\
+		}\
+	}\
+	return 0;\
+}\
+\
+/* idx番目のバケットのリストで、インデックス+1がiのノードを指しているリンクのアドレスを返す */\
+static unsigned int *Name##_link(Name *self, size_t idx, unsigned int i)\
+{\
+	unsigned int *link = &self->buckets[idx];\
+	while (*link != i) {\
+		CSTL_ASSERT(*link && "CompactUnorderedSet_link");\
+		link = &CSTL_VECTOR_AT(self->nodes, *link - 1).next;\
+	}\
+	return link;\
+}\
+\
+/* バケット数を2のbits乗にして、全ノードをつなぎ直す。失敗した場合は何も変更しない */\
+static int Name##_rebuild(Name *self, size_t bits)\
+{\
+	unsigned int *buckets;\
+	size_t nbuckets = (size_t) 1 << bits;\
+	size_t i, idx;\
+	if (nbuckets > ((size_t) -1) / sizeof(unsigned int)) {\
+		return 0;\
+	}\
+	buckets = (unsigned int *) malloc(sizeof(unsigned int) * nbuckets);\
+	if (!buckets) return 0;\
+	memset(buckets, 0, sizeof(unsigned int) * nbuckets);\
+	free(self->buckets);\
+	self->buckets = buckets;\
+	self->shift = CSTL_HASH_BITS - bits;\
+	for (i = 0; i < CSTL_VECTOR_SIZE(self->nodes); i++) {\
+		idx = Name##_bucket_index(self, &CSTL_VECTOR_AT(self->nodes, i).key);\
+		CSTL_VECTOR_AT(self->nodes, i).next = buckets[idx];\
+		buckets[idx] = (unsigned int) (i + 1);\
+	}\
+	return 1;\
+}\
+\
+Name *Name##_new(void)\
+{\
+	Name *self;\
+	self = (Name *) malloc(sizeof(Name));\
+	if (!self) return 0;\
+	self->nodes = Name##_NodeVector_new();\
+	if (!self->nodes) {\
+		free(self);\
+		return 0;\
+	}\
+	self->buckets = 0;\
+	self->max_load_factor = 1.0f;\
+	if (!Name##_rebuild(self, CSTL_COMPACT_UNORDERED_SET_MIN_BITS)) {\
+		Name##_NodeVector_delete(self->nodes);\
+		free(self);\
+		return 0;\
+	}\
+	CSTL_MAGIC(self->magic = self);\
+	return self;\
+}\
+\
+void Name##_delete(Name *self)\
+{\
+	if (!self) return;\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_delete");\
+	Name##_NodeVector_delete(self->nodes);\
+	free(self->buckets);\
+	CSTL_MAGIC(self->magic = 0);\
+	free(self);\
+}\
+\
+void Name##_clear(Name *self)\
+{\
+	CSTL_ASSERT(self && "CompactUnorderedSet_clear");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_clear");\
+	CSTL_VECTOR_CLEAR(self->nodes);\
+	memset(self->buckets, 0, sizeof(unsigned int) * Name##_bucket_count(self));\
+}\
+\
+int Name##_empty(Name *self)\
+{\
+	CSTL_ASSERT(self && "CompactUnorderedSet_empty");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_empty");\
+	return CSTL_VECTOR_EMPTY(self->nodes);\
+}\
+\
+size_t Name##_size(Name *self)\
+{\
+	CSTL_ASSERT(self && "CompactUnorderedSet_size");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_size");\
+	return CSTL_VECTOR_SIZE(self->nodes);\
+}\
+\
+Name##Iterator Name##_insert(Name *self, Type data, int *success)\
+{\
+	Name##Node node;\
+	size_t size;\
+	size_t idx;\
+	unsigned int i;\
+	CSTL_ASSERT(self && "CompactUnorderedSet_insert");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_insert");\
+	idx = Name##_bucket_index(self, &data);\
+	i = Name##_find_index(self, idx, &data);\
+	if (i) {\
+		if (success) *success = 0;\
+		return &CSTL_VECTOR_AT(self->nodes, i - 1);\
+	}\
+	size = CSTL_VECTOR_SIZE(self->nodes);\
+	if (size >= (size_t) UINT_MAX) {\
+		/* インデックス+1がunsigned intに収まらない */\
+		if (success) *success = 0;\
+		return 0;\
+	}\
+	if ((double) (size + 1) > (double) Name##_bucket_count(self) * self->max_load_factor) {\
+		/* バケットを増やせなくても挿入は続ける */\
+		if (Name##_rebuild(self, Name##_bucket_bits(self, size + 1))) {\
+			idx = Name##_bucket_index(self, &data);\
+		}\
+	}\
+	node.next = self->buckets[idx];\
+	node.key = data;\
+	if (!Name##_NodeVector_push_back_ref(self->nodes, &node)) {\
+		if (success) *success = 0;\
+		return 0;\
+	}\
+	self->buckets[idx] = (unsigned int) (size + 1);\
+	if (success) *success = 1;\
+	return &CSTL_VECTOR_AT(self->nodes, size);\
+}\
+\
+Name##Iterator Name##_erase(Name *self, Name##Iterator pos)\
+{\
+	size_t i;\
+	size_t last;\
+	unsigned int *link;\
+	CSTL_ASSERT(self && "CompactUnorderedSet_erase");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_erase");\
+	CSTL_ASSERT(pos && "CompactUnorderedSet_erase");\
+	CSTL_ASSERT(!CSTL_VECTOR_EMPTY(self->nodes) && "CompactUnorderedSet_erase");\
+	CSTL_ASSERT(pos >= &CSTL_VECTOR_AT(self->nodes, 0) && "CompactUnorderedSet_erase");\
+	CSTL_ASSERT(pos < &CSTL_VECTOR_AT(self->nodes, 0) + CSTL_VECTOR_SIZE(self->nodes) && "CompactUnorderedSet_erase");\
+	i = (size_t) (pos - &CSTL_VECTOR_AT(self->nodes, 0));\
+	last = CSTL_VECTOR_SIZE(self->nodes) - 1;\
+	link = Name##_link(self, Name##_bucket_index(self, &pos->key), (unsigned int) (i + 1));\
+	*link = pos->next;\
+	if (i != last) {\
+		/* 末尾のノードを空いた位置に移し、それを指すリンクを付け替える */\
+		link = Name##_link(self, Name##_bucket_index(self, &CSTL_VECTOR_AT(self->nodes, last).key), (unsigned int) (last + 1));\
+		*link = (unsigned int) (i + 1);\
+		*pos = CSTL_VECTOR_AT(self->nodes, last);\
+	}\
+	Name##_NodeVector_pop_back(self->nodes);\
+	return pos;\
+}\
+\
+size_t Name##_erase_key(Name *self, Type key)\
+{\
+	Name##Iterator pos;\
+	CSTL_ASSERT(self && "CompactUnorderedSet_erase_key");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_erase_key");\
+	pos = Name##_find(self, key);\
+	if (pos == Name##_end(self)) {\
+		return 0;\
+	}\
+	Name##_erase(self, pos);\
+	return 1;\
+}\
+\
+size_t Name##_count(Name *self, Type key)\
+{\
+	CSTL_ASSERT(self && "CompactUnorderedSet_count");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_count");\
+	return Name##_find_index(self, Name##_bucket_index(self, &key), &key) != 0;\
+}\
+\
+Name##Iterator Name##_find(Name *self, Type key)\
+{\
+	unsigned int i;\
+	CSTL_ASSERT(self && "CompactUnorderedSet_find");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_find");\
+	i = Name##_find_index(self, Name##_bucket_index(self, &key), &key);\
+	if (!i) {\
+		return Name##_end(self);\
+	}\
+	return &CSTL_VECTOR_AT(self->nodes, i - 1);\
+}\
+\
+Name##Iterator Name##_begin(Name *self)\
+{\
+	CSTL_ASSERT(self && "CompactUnorderedSet_begin");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_begin");\
+	return self->nodes->buf;\
+}\
+\
+Name##Iterator Name##_end(Name *self)\
+{\
+	CSTL_ASSERT(self && "CompactUnorderedSet_end");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_end");\
+	if (CSTL_VECTOR_EMPTY(self->nodes)) {\
+		return self->nodes->buf;\
+	}\
+	return &CSTL_VECTOR_AT(self->nodes, 0) + CSTL_VECTOR_SIZE(self->nodes);\
+}\
+\
+Name##Iterator Name##_next(Name##Iterator pos)\
+{\
+	CSTL_ASSERT(pos && "CompactUnorderedSet_next");\
+	return pos + 1;\
+}\
+\
+Type const *Name##_data(Name##Iterator pos)\
+{\
+	CSTL_ASSERT(pos && "CompactUnorderedSet_data");\
+	return &pos->key;\
+}\
+\
+void Name##_swap(Name *self, Name *x)\
+{\
+	unsigned int *tmp_buckets;\
+	size_t tmp_shift;\
+	float tmp_max_load_factor;\
+	CSTL_ASSERT(self && "CompactUnorderedSet_swap");\
+	CSTL_ASSERT(x && "CompactUnorderedSet_swap");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_swap");\
+	CSTL_ASSERT(x->magic == x && "CompactUnorderedSet_swap");\
+	Name##_NodeVector_swap(self->nodes, x->nodes);\
+	tmp_buckets = self->buckets;\
+	tmp_shift = self->shift;\
+	tmp_max_load_factor = self->max_load_factor;\
+	self->buckets = x->buckets;\
+	self->shift = x->shift;\
+	self->max_load_factor = x->max_load_factor;\
+	x->buckets = tmp_buckets;\
+	x->shift = tmp_shift;\
+	x->max_load_factor = tmp_max_load_factor;\
+}\
+\
+size_t Name##_bucket_count(Name *self)\
+{\
+	CSTL_ASSERT(self && "CompactUnorderedSet_bucket_count");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_bucket_count");\
+	return (size_t) 1 << (CSTL_HASH_BITS - self->shift);\
+}\
+\
+float Name##_load_factor(Name *self)\
+{\
+	CSTL_ASSERT(self && "CompactUnorderedSet_load_factor");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_load_factor");\
+	return (float) CSTL_VECTOR_SIZE(self->nodes) / (float) Name##_bucket_count(self);\
+}\
+\
+float Name##_get_max_load_factor(Name *self)\
+{\
+	CSTL_ASSERT(self && "CompactUnorderedSet_get_max_load_factor");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_get_max_load_factor");\
+	return self->max_load_factor;\
+}\
+\
+void Name##_set_max_load_factor(Name *self, float z)\
+{\
+	CSTL_ASSERT(self && "CompactUnorderedSet_set_max_load_factor");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_set_max_load_factor");\
+	self->max_load_factor = (z < Name##_minimum_mlf) ? Name##_minimum_mlf : z;\
+}\
+\
+int Name##_rehash(Name *self, size_t n)\
+{\
+	size_t bits;\
+	CSTL_ASSERT(self && "CompactUnorderedSet_rehash");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_rehash");\
+	bits = Name##_bucket_bits(self, CSTL_VECTOR_SIZE(self->nodes));\
+	while (bits < CSTL_HASH_BITS - 1 && ((size_t) 1 << bits) < n) {\
+		bits++;\
+	}\
+	if (((size_t) 1 << bits) <= Name##_bucket_count(self)) {\
+		return 1;\
+	}\
+	return Name##_rebuild(self, bits);\
+}\
+\
+int Name##_reserve(Name *self, size_t n)\
+{\
+	size_t bits;\
+	CSTL_ASSERT(self && "CompactUnorderedSet_reserve");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_reserve");\
+	if (n > (size_t) UINT_MAX) {\
+		return 0;\
+	}\
+	if (!Name##_NodeVector_reserve(self->nodes, n)) {\
+		return 0;\
+	}\
+	bits = Name##_bucket_bits(self, n);\
+	if (((size_t) 1 << bits) <= Name##_bucket_count(self)) {\
+		return 1;\
+	}\
+	return Name##_rebuild(self, bits);\
+}\
+\
+int Name##_shrink_to_fit(Name *self)\
+{\
+	size_t bits;\
+	CSTL_ASSERT(self && "CompactUnorderedSet_shrink_to_fit");\
+	CSTL_ASSERT(self->magic == self && "CompactUnorderedSet_shrink_to_fit");\
+	Name##_NodeVector_shrink(self->nodes, CSTL_VECTOR_SIZE(self->nodes));\
+	bits = Name##_bucket_bits(self, CSTL_VECTOR_SIZE(self->nodes));\
+	if (((size_t) 1 << bits) >= Name##_bucket_count(self)) {\
+		return 1;\
+	}\
+	return Name##_rebuild(self, bits);\
+}\
+
+
+#endif /* CSTL_COMPACT_UNORDERED_SET_H_INCLUDED */
@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2006-2010, KATO Noriaki
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*!
+ * \file concurrent_unordered_map.h
+ * \brief シャード分割によるスレッドセーフなunordered_map
+ * \author KATO Noriaki <katono@users.sourceforge.jp>
+ * \date 2026-10-19
+ * $URL$
+ * $Id$
+ */
+#ifndef CSTL_CONCURRENT_UNORDERED_MAP_H_INCLUDED
+#define CSTL_CONCURRENT_UNORDERED_MAP_H_INCLUDED
+
+#include <stdlib.h>
+#include "common.h"
+#include "unordered_map.h"
+
+/*
+ * 読み書きロック
+ * CSTL_RWLOCK_Tを定義済みならば、利用者の定義を使う。
+ */
+#ifndef CSTL_RWLOCK_T
+#ifdef _WIN32
+#include <windows.h>
+#define CSTL_RWLOCK_T				SRWLOCK
+#define CSTL_RWLOCK_INIT(l)			(InitializeSRWLock(l), 1)
+#define CSTL_RWLOCK_DESTROY(l)		((void) (l))
+#define CSTL_RWLOCK_RDLOCK(l)		AcquireSRWLockShared(l)
+#define CSTL_RWLOCK_RDUNLOCK(l)		ReleaseSRWLockShared(l)
+#define CSTL_RWLOCK_WRLOCK(l)		AcquireSRWLockExclusive(l)
+#define CSTL_RWLOCK_WRUNLOCK(l)		ReleaseSRWLockExclusive(l)
+#else
+#include <pthread.h>
+#define CSTL_RWLOCK_T				pthread_rwlock_t
+#define CSTL_RWLOCK_INIT(l)			(pthread_rwlock_init(l, 0) == 0)
+#define CSTL_RWLOCK_DESTROY(l)		pthread_rwlock_destroy(l)
+#define CSTL_RWLOCK_RDLOCK(l)		pthread_rwlock_rdlock(l)
+#define CSTL_RWLOCK_RDUNLOCK(l)		pthread_rwlock_unlock(l)
+#define CSTL_RWLOCK_WRLOCK(l)		pthread_rwlock_wrlock(l)
+#define CSTL_RWLOCK_WRUNLOCK(l)		pthread_rwlock_unlock(l)
+#endif
+#endif
+
+/* シャード数の省略値 */
+#define CSTL_CONCURRENT_SHARD_COUNT		16
+/* 隣のシャードとキャッシュラインを共有しないための詰め物 */
+#define CSTL_CONCURRENT_CACHE_LINE		64
+
+
+/*!
+ * \brief インターフェイスマクロ
+ *
+ * \param Name コンテナ名
+ * \param KeyType 要素のキーの型
+ * \param ValueType 要素の値の型
+ */
+#define CSTL_CONCURRENT_UNORDERED_MAP_INTERFACE(Name, KeyType, ValueType)	\
+typedef struct Name Name;\
+\
+CSTL_EXTERN_C_BEGIN()\
+Name *Name##_new(size_t shard_count);\
+void Name##_delete(Name *self);\
+void Name##_clear(Name *self);\
+int Name##_empty(Name *self);\
+size_t Name##_size(Name *self);\
+int Name##_insert(Name *self, KeyType key, ValueType value, int *success);\
+int Name##_find(Name *self, KeyType key, ValueType *value);\
+size_t Name##_erase_key(Name *self, KeyType key);\
+int Name##_at(Name *self, KeyType key, void (*func)(ValueType *value, int inserted, void *arg), void *arg);\
+size_t Name##_shard_count(Name *self);\
+size_t Name##_shard(Name *self, KeyType key);\
+void Name##_for_each_shard(Name *self, size_t idx, void (*func)(KeyType const *key, ValueType *value, void *arg), void *arg);\
+void Name##_for_each(Name *self, void (*func)(KeyType const *key, ValueType *value, void *arg), void *arg);\
+CSTL_EXTERN_C_END()\
+
+
+/*!
+ * \brief 実装マクロ
+ *
+ * \param Name コンテナ名
+ * \param KeyType 要素のキーの型
+ * \param ValueType 要素の値の型
+ * \param Hasher ハッシュ関数
+ * \param Compare 要素の比較ルーチン
+ */
+#define CSTL_CONCURRENT_UNORDERED_MAP_IMPLEMENT(Name, KeyType, ValueType, Hasher, Compare)	\
+\
+CSTL_UNORDERED_MAP_INTERFACE(Name##_ShardMap, KeyType, ValueType)\
+CSTL_UNORDERED_MAP_IMPLEMENT(Name##_ShardMap, KeyType, ValueType, Hasher, Compare)\
+\
+/*! \
+ * \brief シャード\
+ */\
+typedef struct Name##Shard {\
+	CSTL_RWLOCK_T lock;\
+	Name##_ShardMap *map;\
+	char pad[CSTL_CONCURRENT_CACHE_LINE];\
+} Name##Shard;\
+\
+/*! \
+ * \brief concurrent_unordered_map構造体\
+ */\
+struct Name {\
+	Name##Shard *shards;\
+	size_t mask;\
+	CSTL_MAGIC(Name *magic;)\
+};\
+\
+/* シャード内のバケット選択と相関しないよう、ハッシュ値を混ぜてから選ぶ */\
+static size_t Name##_shard_index(Name *self, KeyType const *key)\
+{\
+	register size_t h = Hasher(*key);\
+	h ^= h >> 16;\
+	h *= 0x45d9f3b;\
+	h ^= h >> 16;\
+	return h & self->mask;\
+}\
+\
+Name *Name##_new(size_t shard_count)\
+{\
+	Name *self;\
+	size_t n;\
+	size_t i;\
+	if (!shard_count) {\
+		shard_count = CSTL_CONCURRENT_SHARD_COUNT;\
+	}\
+	for (n = 1; n < shard_count; n <<= 1) ;\
+	self = (Name *) malloc(sizeof(Name));\
+	if (!self) return 0;\
+	self->shards = (Name##Shard *) malloc(sizeof(Name##Shard) * n);\
+	if (!self->shards) {\
+		free(self);\
+		return 0;\
+	}\
+	for (i = 0; i < n; i++) {\
+		self->shards[i].map = Name##_ShardMap_new();\
+		if (!self->shards[i].map) {\
+			goto error;\
+		}\
+		if (!CSTL_RWLOCK_INIT(&self->shards[i].lock)) {\
+			Name##_ShardMap_delete(self->shards[i].map);\
+			goto error;\
+		}\
+	}\
+	self->mask = n - 1;\
+	CSTL_MAGIC(self->magic = self);\
+	return self;\
+error:\
+	while (i > 0) {\
+		i--;\
+		CSTL_RWLOCK_DESTROY(&self->shards[i].lock);\
+		Name##_ShardMap_delete(self->shards[i].map);\
+	}\
+	free(self->shards);\
+	free(self);\
+	return 0;\
+}\
+\
+void Name##_delete(Name *self)\
+{\
+	size_t i;\
+	if (!self) return;\
+	CSTL_ASSERT(self->magic == self && "ConcurrentUnorderedMap_delete");\
+	for (i = 0; i <= self->mask; i++) {\
+		CSTL_RWLOCK_DESTROY(&self->shards[i].lock);\
+		Name##_ShardMap_delete(self->shards[i].map);\
+	}\
+	free(self->shards);\
+	CSTL_MAGIC(self->magic = 0);\
+	free(self);\
+}\
+\
+void Name##_clear(Name *self)\
+{\
+	size_t i;\
+	CSTL_ASSERT(self && "ConcurrentUnorderedMap_clear");\
+	CSTL_ASSERT(self->magic == self && "ConcurrentUnorderedMap_clear");\
+	for (i = 0; i <= self->mask; i++) {\
+		CSTL_RWLOCK_WRLOCK(&self->shards[i].lock);\
+		Name##_ShardMap_clear(self->shards[i].map);\
+		CSTL_RWLOCK_WRUNLOCK(&self->shards[i].lock);\
+	}\
+}\
+\
+int Name##_empty(Name *self)\
+{\
+	CSTL_ASSERT(self && "ConcurrentUnorderedMap_empty");\
+	CSTL_ASSERT(self->magic == self && "ConcurrentUnorderedMap_empty");\
+	return Name##_size(self) == 0;\
+}\
+\
+size_t Name##_size(Name *self)\
+{\
+	size_t i;\
+	size_t size = 0;\
+	CSTL_ASSERT(self && "ConcurrentUnorderedMap_size");\
+	CSTL_ASSERT(self->magic == self && "ConcurrentUnorderedMap_size");\
+	for (i = 0; i <= self->mask; i++) {\
+		CSTL_RWLOCK_RDLOCK(&self->shards[i].lock);\
+		size += Name##_ShardMap_size(self->shards[i].map);\
+		CSTL_RWLOCK_RDUNLOCK(&self->shards[i].lock);\
+	}\
+	return size;\
+}\
+\
+int Name##_insert(Name *self, KeyType key, ValueType value, int *success)\
+{\
+	Name##Shard *shard;\
+	Name##_ShardMapIterator pos;\
+	CSTL_ASSERT(self && "ConcurrentUnorderedMap_insert");\
+	CSTL_ASSERT(self->magic == self && "ConcurrentUnorderedMap_insert");\
+	shard = &self->shards[Name##_shard_index(self, &key)];\
+	CSTL_RWLOCK_WRLOCK(&shard->lock);\
+	pos = Name##_ShardMap_insert_ref(shard->map, key, &value, success);\
+	CSTL_RWLOCK_WRUNLOCK(&shard->lock);\
+	return pos != 0;\
+}\
+\
+int Name##_find(Name *self, KeyType key, ValueType *value)\
+{\
+	Name##Shard *shard;\
+	Name##_ShardMapIterator pos;\
+	int found;\
+	CSTL_ASSERT(self && "ConcurrentUnorderedMap_find");\
+	CSTL_ASSERT(self->magic == self && "ConcurrentUnorderedMap_find");\
+	shard = &self->shards[Name##_shard_index(self, &key)];\
+	CSTL_RWLOCK_RDLOCK(&shard->lock);\
+	pos = Name##_ShardMap_find_ref(shard->map, &key);\
+	found = (pos != Name##_ShardMap_end(shard->map));\
+	if (found && value) {\
+		*value = *Name##_ShardMap_value(pos);\
+	}\
+	CSTL_RWLOCK_RDUNLOCK(&shard->lock);\
+	return found;\
+}\
+\
+size_t Name##_erase_key(Name *self, KeyType key)\
+{\
+	Name##Shard *shard;\
+	size_t count;\
+	CSTL_ASSERT(self && "ConcurrentUnorderedMap_erase_key");\
+	CSTL_ASSERT(self->magic == self && "ConcurrentUnorderedMap_erase_key");\
+	shard = &self->shards[Name##_shard_index(self, &key)];\
+	CSTL_RWLOCK_WRLOCK(&shard->lock);\
+	count = Name##_ShardMap_erase_key(shard->map, key);\
+	CSTL_RWLOCK_WRUNLOCK(&shard->lock);\
+	return count;\
+}\
+\
+int Name##_at(Name *self, KeyType key, void (*func)(ValueType *value, int inserted, void *arg), void *arg)\
+{\
+	Name##Shard *shard;\
+	ValueType *value;\
+	size_t size;\
+	CSTL_ASSERT(self && "ConcurrentUnorderedMap_at");\
+	CSTL_ASSERT(self->magic == self && "ConcurrentUnorderedMap_at");\
+	CSTL_ASSERT(func && "ConcurrentUnorderedMap_at");\
+	shard = &self->shards[Name##_shard_index(self, &key)];\
+	CSTL_RWLOCK_WRLOCK(&shard->lock);\
+	size = Name##_ShardMap_size(shard->map);\
+	value = Name##_ShardMap_at_ref(shard->map, &key);\
+	if (value) {\
+		/* 挿入したばかりの要素の値は不定なので、funcに知らせる */\
+		func(value, Name##_ShardMap_size(shard->map) != size, arg);\
+	}\
+	CSTL_RWLOCK_WRUNLOCK(&shard->lock);\
+	return value != 0;\
+}\
+\
+size_t Name##_shard_count(Name *self)\
+{\
+	CSTL_ASSERT(self && "ConcurrentUnorderedMap_shard_count");\
+	CSTL_ASSERT(self->magic == self && "ConcurrentUnorderedMap_shard_count");\
+	return self->mask + 1;\
+}\
+\
+size_t Name##_shard(Name *self, KeyType key)\
+{\
+	CSTL_ASSERT(self && "ConcurrentUnorderedMap_shard");\
+	CSTL_ASSERT(self->magic == self && "ConcurrentUnorderedMap_shard");\
+	return Name##_shard_index(self, &key);\
+}\
+\
+void Name##_for_each_shard(Name *self, size_t idx, void (*func)(KeyType const *key, ValueType *value, void *arg), void *arg)\
+{\
+	Name##Shard *shard;\
+	Name##_ShardMapIterator pos;\
+	CSTL_ASSERT(self && "ConcurrentUnorderedMap_for_each_shard");\
+	CSTL_ASSERT(self->magic == self && "ConcurrentUnorderedMap_for_each_shard");\
+	CSTL_ASSERT(idx <= self->mask && "ConcurrentUnorderedMap_for_each_shard");\
+	CSTL_ASSERT(func && "ConcurrentUnorderedMap_for_each_shard");\
+	shard = &self->shards[idx];\
+	CSTL_RWLOCK_WRLOCK(&shard->lock);\
+	for (pos = Name##_ShardMap_begin(shard->map); pos != Name##_ShardMap_end(shard->map);\
+			pos = Name##_ShardMap_next(pos)) {\
+		func(Name##_ShardMap_key(pos), Name##_ShardMap_value(pos), arg);\
+	}\
+	CSTL_RWLOCK_WRUNLOCK(&shard->lock);\
+}\
+\
+void Name##_for_each(Name *self, void (*func)(KeyType const *key, ValueType *value, void *arg), void *arg)\
+{\
+	size_t i;\
+	CSTL_ASSERT(self && "ConcurrentUnorderedMap_for_each");\
+	CSTL_ASSERT(self->magic == self && "ConcurrentUnorderedMap_for_each");\
+	CSTL_ASSERT(func && "ConcurrentUnorderedMap_for_each");\
+	for (i = 0; i <= self->mask; i++) {\
+		Name##_for_each_shard(self, i, func, arg);\
+	}\
+}\
+
+
+#endif /* CSTL_CONCURRENT_UNORDERED_MAP_H_INCLUDED */
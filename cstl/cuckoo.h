@@ -0,0 +1,619 @@
+/*
+ * Copyright (c) 2006-2010, KATO Noriaki
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*!
+ * \file cuckoo.h
+ * \brief カッコウハッシュによるcuckoo_set/cuckoo_mapコンテナ
+ * \author KATO Noriaki <katono@users.sourceforge.jp>
+ * \date 2026-10-19
+ * $URL$
+ * $Id$
+ */
+#ifndef CSTL_CUCKOO_H_INCLUDED
+#define CSTL_CUCKOO_H_INCLUDED
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "common.h"
+#include "hashtable.h"
+
+
+/* 1バケットのスロット数 */
+#define CSTL_CUCKOO_SLOTS			4
+/* バケット配列の境界を合わせるキャッシュラインのサイズ */
+#define CSTL_CUCKOO_CACHE_LINE		64
+/* バケット数の最小値の2を底とする対数 */
+#define CSTL_CUCKOO_MIN_BITS		1
+/* 空きスロットを探して要素を追い出していく経路の最大長と、やり直す回数 */
+#define CSTL_CUCKOO_MAX_PATH		64
+#define CSTL_CUCKOO_MAX_WALKS		8
+/* 要素を置き直せないときにバケット数を倍にしてやり直す回数 */
+#define CSTL_CUCKOO_MAX_REBUILDS	3
+
+
+/*
+ * cuckoo_set/cuckoo_mapの共通部分。
+ * Name##Slot型(メンバkeyを持つ)を定義してから展開する。
+ */
+#define CSTL_CUCKOO_IMPLEMENT(Name, KeyType, Hasher, Compare)	\
+\
+/*! \
+ * \brief バケット\
+ *\
+ * tagsが0のスロットは空。それ以外はキーのハッシュ値から作った1～255の値。\
+ * スロットが小さければ、詰め物によって1バケットがちょうど1キャッシュラインになる。\
+ */\
+typedef union Name##Bucket {\
+	struct {\
+		unsigned char tags[CSTL_CUCKOO_SLOTS];\
+		Name##Slot slots[CSTL_CUCKOO_SLOTS];\
+	} u;\
+	char pad[CSTL_CUCKOO_CACHE_LINE];\
+} Name##Bucket;\
+\
+/*! \
+ * \brief cuckoo_set/cuckoo_map構造体\
+ */\
+struct Name {\
+	void *raw; /* mallocで確保した領域。bucketsはこれをキャッシュラインの境界に合わせたもの */\
+	Name##Bucket *buckets;\
+	size_t shift; /* ハッシュ値に定数を掛けて右シフトするビット数 */\
+	size_t size;\
+	size_t seed; /* 追い出すスロットを選ぶ乱数の状態 */\
+	CSTL_MAGIC(Name *magic;)\
+};\
+\
+CSTL_HASH_INTEGER_IMPLEMENT(Name)\
+\
+/* \
+ * 1つのハッシュ値から、2つの候補のバケットとタグを作る。\
+ * 2つ目のバケットは1つ目と必ず異なる。\
+ */\
+static size_t Name##_bucket1(Name *self, size_t hash_val)\
+{\
+	return (hash_val * CSTL_HASH_K1) >> self->shift;\
+}\
+\
+static size_t Name##_bucket2(Name *self, size_t hash_val)\
+{\
+	return Name##_bucket1(self, hash_val) ^ (((hash_val * CSTL_HASH_K2) >> self->shift) | 1);\
+}\
+\
+static unsigned char Name##_tag(size_t hash_val)\
+{\
+	unsigned char tag = (unsigned char) ((hash_val * CSTL_HASH_K3) >> (CSTL_HASH_BITS - 8));\
+	return tag ? tag : 1;\
+}\
+\
+static size_t Name##_bucket_count_bits(Name *self)\
+{\
+	return CSTL_HASH_BITS - self->shift;\
+}\
+\
+/* バケットidxからキーkeyのスロットを探す。見つからなければ-1を返す */\
+static int Name##_find_slot(Name *self, size_t idx, unsigned char tag, KeyType const *key)\
+{\
+	register Name##Bucket *bucket = &self->buckets[idx];\
+	register int i;\
+	for (i = 0; i < CSTL_CUCKOO_SLOTS; i++) {\
+		if (bucket->u.tags[i] == tag && Compare(bucket->u.slots[i].key, *key) == 0) {\
+			return i;\
+		}\
+	}\
+	return -1;\
+}\
+\
+/* キーkeyのスロットを2つのバケットから探す。見つからなければ0を返す */\
+static Name##Slot *Name##_lookup(Name *self, KeyType const *key)\
+{\
+	size_t hash_val = Hasher(*key);\
+	unsigned char tag = Name##_tag(hash_val);\
+	size_t idx;\
+	int i;\
+	idx = Name##_bucket1(self, hash_val);\
+	i = Name##_find_slot(self, idx, tag, key);\
+	if (i >= 0) return &self->buckets[idx].u.slots[i];\
+	idx = Name##_bucket2(self, hash_val);\
+	i = Name##_find_slot(self, idx, tag, key);\
+	if (i >= 0) return &self->buckets[idx].u.slots[i];\
+	return 0;\
+}\
+\
+static int Name##_empty_slot(Name *self, size_t idx)\
+{\
+	int i;\
+	for (i = 0; i < CSTL_CUCKOO_SLOTS; i++) {\
+		if (!self->buckets[idx].u.tags[i]) return i;\
+	}\
+	return -1;\
+}\
+\
+static size_t Name##_random(Name *self)\
+{\
+	/* xorshift */\
+	size_t x = self->seed;\
+	x ^= x << 13;\
+	x ^= x >> 7;\
+	x ^= x << 17;\
+	self->seed = x;\
+	return x;\
+}\
+\
+/* \
+ * スロットslotの要素を2つのバケットのどちらかに置く。\
+ * 両方とも満杯ならば、置き場所が空くまで既存の要素をもう1つのバケットへ追い出していく。\
+ * 追い出す経路は動かす前に決めるので、失敗した場合は何も変更しない。\
+ */\
+static int Name##_place(Name *self, Name##Slot const *slot, size_t hash_val)\
+{\
+	size_t path_idx[CSTL_CUCKOO_MAX_PATH];\
+	int path_slot[CSTL_CUCKOO_MAX_PATH];\
+	unsigned char tag = Name##_tag(hash_val);\
+	size_t idx[2];\
+	size_t victim_hash;\
+	size_t alt;\
+	int walk, n, i, j, k, s, e;\
+	idx[0] = Name##_bucket1(self, hash_val);\
+	idx[1] = Name##_bucket2(self, hash_val);\
+	for (i = 0; i < 2; i++) {\
+		e = Name##_empty_slot(self, idx[i]);\
+		if (e >= 0) {\
+			self->buckets[idx[i]].u.tags[e] = tag;\
+			self->buckets[idx[i]].u.slots[e] = *slot;\
+			return 1;\
+		}\
+	}\
+	for (walk = 0; walk < CSTL_CUCKOO_MAX_WALKS; walk++) {\
+		alt = idx[Name##_random(self) & 1];\
+		for (n = 0; n < CSTL_CUCKOO_MAX_PATH; n++) {\
+			/* 経路に同じスロットが2度現れると正しく動かせないので、未使用のスロットを選ぶ */\
+			s = (int) (Name##_random(self) % CSTL_CUCKOO_SLOTS);\
+			for (j = 0; j < CSTL_CUCKOO_SLOTS; j++, s = (s + 1) % CSTL_CUCKOO_SLOTS) {\
+				for (k = 0; k < n; k++) {\
+					if (path_idx[k] == alt && path_slot[k] == s) break;\
+				}\
+				if (k == n) break;\
+			}\
+			if (j == CSTL_CUCKOO_SLOTS) break;\
+			path_idx[n] = alt;\
+			path_slot[n] = s;\
+			victim_hash = Hasher(self->buckets[alt].u.slots[s].key);\
+			alt = (Name##_bucket1(self, victim_hash) == alt) ?\
+				Name##_bucket2(self, victim_hash) : Name##_bucket1(self, victim_hash);\
+			e = Name##_empty_slot(self, alt);\
+			if (e < 0) continue;\
+			/* 経路の末尾から順に、要素を1つずつ先へ動かす */\
+			self->buckets[alt].u.tags[e] = self->buckets[path_idx[n]].u.tags[path_slot[n]];\
+			self->buckets[alt].u.slots[e] = self->buckets[path_idx[n]].u.slots[path_slot[n]];\
+			for (k = n; k > 0; k--) {\
+				self->buckets[path_idx[k]].u.tags[path_slot[k]] = self->buckets[path_idx[k - 1]].u.tags[path_slot[k - 1]];\
+				self->buckets[path_idx[k]].u.slots[path_slot[k]] = self->buckets[path_idx[k - 1]].u.slots[path_slot[k - 1]];\
+			}\
+			self->buckets[path_idx[0]].u.tags[path_slot[0]] = tag;\
+			self->buckets[path_idx[0]].u.slots[path_slot[0]] = *slot;\
+			return 1;\
+		}\
+	}\
+	return 0;\
+}\
+\
+/* 2のbits乗個のバケット配列を確保する */\
+static int Name##_alloc_buckets(Name *self, size_t bits)\
+{\
+	size_t nbuckets = (size_t) 1 << bits;\
+	if (nbuckets > (((size_t) -1) - CSTL_CUCKOO_CACHE_LINE) / sizeof(Name##Bucket)) {\
+		return 0;\
+	}\
+	self->raw = malloc(sizeof(Name##Bucket) * nbuckets + CSTL_CUCKOO_CACHE_LINE);\
+	if (!self->raw) return 0;\
+	self->buckets = (Name##Bucket *) (((size_t) self->raw + CSTL_CUCKOO_CACHE_LINE - 1) &\
+			~((size_t) CSTL_CUCKOO_CACHE_LINE - 1));\
+	memset(self->buckets, 0, sizeof(Name##Bucket) * nbuckets);\
+	self->shift = CSTL_HASH_BITS - bits;\
+	return 1;\
+}\
+\
+/* \
+ * バケット数を2のbits乗以上にして、全要素を置き直す。\
+ * 置き直しに失敗した場合は、さらにバケット数を倍にしてやり直す(CSTL_CUCKOO_MAX_REBUILDS回まで)。\
+ * 失敗した場合は何も変更せず0を返す。\
+ */\
+static int Name##_rebuild(Name *self, size_t bits)\
+{\
+	void *old_raw = self->raw;\
+	Name##Bucket *old_buckets = self->buckets;\
+	size_t old_shift = self->shift;\
+	size_t nbuckets = (size_t) 1 << (CSTL_HASH_BITS - old_shift);\
+	size_t last = bits + CSTL_CUCKOO_MAX_REBUILDS;\
+	size_t i;\
+	int j;\
+	for (; bits < last && bits < CSTL_HASH_BITS - 1; bits++) {\
+		if (!Name##_alloc_buckets(self, bits)) break;\
+		for (i = 0; i < nbuckets; i++) {\
+			for (j = 0; j < CSTL_CUCKOO_SLOTS; j++) {\
+				if (old_buckets[i].u.tags[j] &&\
+						!Name##_place(self, &old_buckets[i].u.slots[j], Hasher(old_buckets[i].u.slots[j].key))) {\
+					goto retry;\
+				}\
+			}\
+		}\
+		free(old_raw);\
+		return 1;\
+retry:\
+		free(self->raw);\
+	}\
+	self->raw = old_raw;\
+	self->buckets = old_buckets;\
+	self->shift = old_shift;\
+	return 0;\
+}\
+\
+/* n個の要素を置くのに十分なバケット数の対数。満杯に近いと追い出しが長くなるので9割までとする */\
+static size_t Name##_bits_for(size_t n)\
+{\
+	size_t bits = CSTL_CUCKOO_MIN_BITS;\
+	while (bits < CSTL_HASH_BITS - 2 && (((size_t) CSTL_CUCKOO_SLOTS << bits) / 10) * 9 < n) {\
+		bits++;\
+	}\
+	return bits;\
+}\
+\
+/* 要素slotを挿入する。キーが重複していないこと */\
+static int Name##_insert_slot(Name *self, Name##Slot const *slot, size_t hash_val)\
+{\
+	size_t bits = Name##_bucket_count_bits(self);\
+	if (self->size >= (((size_t) CSTL_CUCKOO_SLOTS << bits) / 10) * 9) {\
+		if (!Name##_rebuild(self, bits + 1)) return 0;\
+	}\
+	if (!Name##_place(self, slot, hash_val)) {\
+		/* \
+		 * バケットを増やしても置けない場合は、ハッシュ値が偏っていて\
+		 * 2つの候補のバケットを共有するキーが多すぎるので諦める。\
+		 */\
+		if (!Name##_rebuild(self, Name##_bucket_count_bits(self) + 1)) return 0;\
+		if (!Name##_place(self, slot, hash_val)) return 0;\
+	}\
+	self->size++;\
+	return 1;\
+}\
+\
+Name *Name##_new(void)\
+{\
+	Name *self;\
+	self = (Name *) malloc(sizeof(Name));\
+	if (!self) return 0;\
+	if (!Name##_alloc_buckets(self, CSTL_CUCKOO_MIN_BITS)) {\
+		free(self);\
+		return 0;\
+	}\
+	self->size = 0;\
+	self->seed = 0x2545F491;\
+	CSTL_MAGIC(self->magic = self);\
+	return self;\
+}\
+\
+void Name##_delete(Name *self)\
+{\
+	if (!self) return;\
+	CSTL_ASSERT(self->magic == self && "Cuckoo(Set|Map)_delete");\
+	free(self->raw);\
+	CSTL_MAGIC(self->magic = 0);\
+	free(self);\
+}\
+\
+void Name##_clear(Name *self)\
+{\
+	CSTL_ASSERT(self && "Cuckoo(Set|Map)_clear");\
+	CSTL_ASSERT(self->magic == self && "Cuckoo(Set|Map)_clear");\
+	memset(self->buckets, 0, sizeof(Name##Bucket) * Name##_bucket_count(self));\
+	self->size = 0;\
+}\
+\
+int Name##_empty(Name *self)\
+{\
+	CSTL_ASSERT(self && "Cuckoo(Set|Map)_empty");\
+	CSTL_ASSERT(self->magic == self && "Cuckoo(Set|Map)_empty");\
+	return self->size == 0;\
+}\
+\
+size_t Name##_size(Name *self)\
+{\
+	CSTL_ASSERT(self && "Cuckoo(Set|Map)_size");\
+	CSTL_ASSERT(self->magic == self && "Cuckoo(Set|Map)_size");\
+	return self->size;\
+}\
+\
+size_t Name##_erase_key(Name *self, KeyType key)\
+{\
+	size_t hash_val;\
+	unsigned char tag;\
+	size_t idx;\
+	int i;\
+	CSTL_ASSERT(self && "Cuckoo(Set|Map)_erase_key");\
+	CSTL_ASSERT(self->magic == self && "Cuckoo(Set|Map)_erase_key");\
+	hash_val = Hasher(key);\
+	tag = Name##_tag(hash_val);\
+	idx = Name##_bucket1(self, hash_val);\
+	i = Name##_find_slot(self, idx, tag, &key);\
+	if (i < 0) {\
+		idx = Name##_bucket2(self, hash_val);\
+		i = Name##_find_slot(self, idx, tag, &key);\
+		if (i < 0) return 0;\
+	}\
+	self->buckets[idx].u.tags[i] = 0;\
+	self->size--;\
+	return 1;\
+}\
+\
+size_t Name##_count(Name *self, KeyType key)\
+{\
+	CSTL_ASSERT(self && "Cuckoo(Set|Map)_count");\
+	CSTL_ASSERT(self->magic == self && "Cuckoo(Set|Map)_count");\
+	return Name##_lookup(self, &key) != 0;\
+}\
+\
+void Name##_swap(Name *self, Name *x)\
+{\
+	Name tmp;\
+	CSTL_ASSERT(self && "Cuckoo(Set|Map)_swap");\
+	CSTL_ASSERT(x && "Cuckoo(Set|Map)_swap");\
+	CSTL_ASSERT(self->magic == self && "Cuckoo(Set|Map)_swap");\
+	CSTL_ASSERT(x->magic == x && "Cuckoo(Set|Map)_swap");\
+	tmp = *self;\
+	*self = *x;\
+	*x = tmp;\
+	CSTL_MAGIC(self->magic = self);\
+	CSTL_MAGIC(x->magic = x);\
+}\
+\
+size_t Name##_bucket_count(Name *self)\
+{\
+	CSTL_ASSERT(self && "Cuckoo(Set|Map)_bucket_count");\
+	CSTL_ASSERT(self->magic == self && "Cuckoo(Set|Map)_bucket_count");\
+	return (size_t) 1 << Name##_bucket_count_bits(self);\
+}\
+\
+size_t Name##_capacity(Name *self)\
+{\
+	CSTL_ASSERT(self && "Cuckoo(Set|Map)_capacity");\
+	CSTL_ASSERT(self->magic == self && "Cuckoo(Set|Map)_capacity");\
+	return Name##_bucket_count(self) * CSTL_CUCKOO_SLOTS;\
+}\
+\
+float Name##_load_factor(Name *self)\
+{\
+	CSTL_ASSERT(self && "Cuckoo(Set|Map)_load_factor");\
+	CSTL_ASSERT(self->magic == self && "Cuckoo(Set|Map)_load_factor");\
+	return (float) self->size / (float) Name##_capacity(self);\
+}\
+\
+int Name##_reserve(Name *self, size_t n)\
+{\
+	size_t bits;\
+	CSTL_ASSERT(self && "Cuckoo(Set|Map)_reserve");\
+	CSTL_ASSERT(self->magic == self && "Cuckoo(Set|Map)_reserve");\
+	bits = Name##_bits_for(n);\
+	if (bits <= Name##_bucket_count_bits(self)) {\
+		return 1;\
+	}\
+	return Name##_rebuild(self, bits);\
+}\
+
+
+#define CSTL_CUCKOO_COMMON_INTERFACE(Name, KeyType)	\
+CSTL_HASH_INTEGER_INTERFACE(Name)\
+Name *Name##_new(void);\
+void Name##_delete(Name *self);\
+void Name##_clear(Name *self);\
+int Name##_empty(Name *self);\
+size_t Name##_size(Name *self);\
+size_t Name##_erase_key(Name *self, KeyType key);\
+size_t Name##_count(Name *self, KeyType key);\
+void Name##_swap(Name *self, Name *x);\
+size_t Name##_bucket_count(Name *self);\
+size_t Name##_capacity(Name *self);\
+float Name##_load_factor(Name *self);\
+int Name##_reserve(Name *self, size_t n);\
+
+
+/*!
+ * \brief cuckoo_setインターフェイスマクロ
+ *
+ * \param Name コンテナ名
+ * \param Type 要素の型
+ */
+#define CSTL_CUCKOO_SET_INTERFACE(Name, Type)	\
+typedef struct Name Name;\
+\
+CSTL_EXTERN_C_BEGIN()\
+CSTL_CUCKOO_COMMON_INTERFACE(Name, Type)\
+int Name##_insert(Name *self, Type data, int *success);\
+Type const *Name##_find(Name *self, Type key);\
+void Name##_for_each(Name *self, void (*func)(Type const *data, void *arg), void *arg);\
+CSTL_EXTERN_C_END()\
+
+
+/*!
+ * \brief cuckoo_set実装マクロ
+ *
+ * \param Name コンテナ名
+ * \param Type 要素の型
+ * \param Hasher ハッシュ関数
+ * \param Compare 要素の比較ルーチン
+ */
+#define CSTL_CUCKOO_SET_IMPLEMENT(Name, Type, Hasher, Compare)	\
+\
+typedef struct Name##Slot {\
+	Type key;\
+} Name##Slot;\
+\
+CSTL_CUCKOO_IMPLEMENT(Name, Type, Hasher, Compare)\
+\
+int Name##_insert(Name *self, Type data, int *success)\
+{\
+	Name##Slot slot;\
+	CSTL_ASSERT(self && "CuckooSet_insert");\
+	CSTL_ASSERT(self->magic == self && "CuckooSet_insert");\
+	if (success) *success = 0;\
+	if (Name##_lookup(self, &data)) {\
+		return 1;\
+	}\
+	slot.key = data;\
+	if (!Name##_insert_slot(self, &slot, Hasher(data))) {\
+		return 0;\
+	}\
+	if (success) *success = 1;\
+	return 1;\
+}\
+\
+Type const *Name##_find(Name *self, Type key)\
+{\
+	Name##Slot *slot;\
+	CSTL_ASSERT(self && "CuckooSet_find");\
+	CSTL_ASSERT(self->magic == self && "CuckooSet_find");\
+	slot = Name##_lookup(self, &key);\
+	return slot ? &slot->key : 0;\
+}\
+\
+void Name##_for_each(Name *self, void (*func)(Type const *data, void *arg), void *arg)\
+{\
+	size_t i;\
+	int j;\
+	CSTL_ASSERT(self && "CuckooSet_for_each");\
+	CSTL_ASSERT(self->magic == self && "CuckooSet_for_each");\
+	CSTL_ASSERT(func && "CuckooSet_for_each");\
+	for (i = 0; i < Name##_bucket_count(self); i++) {\
+		for (j = 0; j < CSTL_CUCKOO_SLOTS; j++) {\
+			if (self->buckets[i].u.tags[j]) {\
+				func(&self->buckets[i].u.slots[j].key, arg);\
+			}\
+		}\
+	}\
+}\
+
+
+/*!
+ * \brief cuckoo_mapインターフェイスマクロ
+ *
+ * \param Name コンテナ名
+ * \param KeyType 要素のキーの型
+ * \param ValueType 要素の値の型
+ */
+#define CSTL_CUCKOO_MAP_INTERFACE(Name, KeyType, ValueType)	\
+typedef struct Name Name;\
+\
+CSTL_EXTERN_C_BEGIN()\
+CSTL_CUCKOO_COMMON_INTERFACE(Name, KeyType)\
+int Name##_insert(Name *self, KeyType key, ValueType value, int *success);\
+ValueType *Name##_find(Name *self, KeyType key);\
+ValueType *Name##_at(Name *self, KeyType key);\
+void Name##_for_each(Name *self, void (*func)(KeyType const *key, ValueType *value, void *arg), void *arg);\
+CSTL_EXTERN_C_END()\
+
+
+/*!
+ * \brief cuckoo_map実装マクロ
+ *
+ * \param Name コンテナ名
+ * \param KeyType 要素のキーの型
+ * \param ValueType 要素の値の型
+ * \param Hasher ハッシュ関数
+ * \param Compare 要素の比較ルーチン
+ */
+#define CSTL_CUCKOO_MAP_IMPLEMENT(Name, KeyType, ValueType, Hasher, Compare)	\
+\
+typedef struct Name##Slot {\
+	KeyType key;\
+	ValueType value;\
+} Name##Slot;\
+\
+CSTL_CUCKOO_IMPLEMENT(Name, KeyType, Hasher, Compare)\
+\
+int Name##_insert(Name *self, KeyType key, ValueType value, int *success)\
+{\
+	Name##Slot slot;\
+	CSTL_ASSERT(self && "CuckooMap_insert");\
+	CSTL_ASSERT(self->magic == self && "CuckooMap_insert");\
+	if (success) *success = 0;\
+	if (Name##_lookup(self, &key)) {\
+		return 1;\
+	}\
+	slot.key = key;\
+	slot.value = value;\
+	if (!Name##_insert_slot(self, &slot, Hasher(key))) {\
+		return 0;\
+	}\
+	if (success) *success = 1;\
+	return 1;\
+}\
+\
+ValueType *Name##_find(Name *self, KeyType key)\
+{\
+	Name##Slot *slot;\
+	CSTL_ASSERT(self && "CuckooMap_find");\
+	CSTL_ASSERT(self->magic == self && "CuckooMap_find");\
+	slot = Name##_lookup(self, &key);\
+	return slot ? &slot->value : 0;\
+}\
+\
+ValueType *Name##_at(Name *self, KeyType key)\
+{\
+	Name##Slot *slot;\
+	Name##Slot tmp;\
+	static Name##Slot zero;\
+	CSTL_ASSERT(self && "CuckooMap_at");\
+	CSTL_ASSERT(self->magic == self && "CuckooMap_at");\
+	slot = Name##_lookup(self, &key);\
+	if (slot) {\
+		return &slot->value;\
+	}\
+	tmp.key = key;\
+	/* 新しい要素の値は静的変数からコピーしてゼロ初期化する */\
+	tmp.value = zero.value;\
+	if (!Name##_insert_slot(self, &tmp, Hasher(key))) {\
+		return 0;\
+	}\
+	/* 追い出しで置き場所が変わるので、挿入後に探し直す */\
+	return &Name##_lookup(self, &key)->value;\
+}\
+\
+void Name##_for_each(Name *self, void (*func)(KeyType const *key, ValueType *value, void *arg), void *arg)\
+{\
+	size_t i;\
+	int j;\
+	CSTL_ASSERT(self && "CuckooMap_for_each");\
+	CSTL_ASSERT(self->magic == self && "CuckooMap_for_each");\
+	CSTL_ASSERT(func && "CuckooMap_for_each");\
+	for (i = 0; i < Name##_bucket_count(self); i++) {\
+		for (j = 0; j < CSTL_CUCKOO_SLOTS; j++) {\
+			if (self->buckets[i].u.tags[j]) {\
+				func(&self->buckets[i].u.slots[j].key, &self->buckets[i].u.slots[j].value, arg);\
+			}\
+		}\
+	}\
+}\
+
+
+#endif /* CSTL_CUCKOO_H_INCLUDED */
@@ -36,20 +36,30 @@
 #define CSTL_HASHTABLE_H_INCLUDED
 
 #include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <limits.h>
 #include "common.h"
 #include "vector.h"
 
 
 #define CSTL_EQUAL_TO(x, y)		((x) == (y) ? 0 : 1)
 
+/*
+ * 文字列用ハッシュ関数の定数。
+ * size_tが32bitの場合は下位32bitが使われる(いずれも奇数)。
+ */
+#define CSTL_HASH_BITS		(sizeof(size_t) * CHAR_BIT)
+#define CSTL_HASH_CONST(hi, lo)	((size_t) (((size_t) (hi) << 16 << 16) | (size_t) (lo)))
+#define CSTL_HASH_K1		CSTL_HASH_CONST(0x9E3779B9UL, 0x7F4A7C15UL)
+#define CSTL_HASH_K2		CSTL_HASH_CONST(0xBF58476DUL, 0x1CE4E5B9UL)
+#define CSTL_HASH_K3		CSTL_HASH_CONST(0x94D049BBUL, 0x133111EBUL)
 
-#define CSTL_HASHTABLE_INTERFACE(Name, KeyType, ValueType)	\
-\
-typedef struct Name Name;\
-typedef struct Name##Node *Name##Iterator;\
-typedef struct Name##Node *Name##LocalIterator;\
-size_t Name##_hash_string(register const char *str);\
-size_t Name##_hash_wstring(register const wchar_t *str);\
+/* 
+ * 整数用ハッシュ関数。値をそのまま返す。
+ * バケットの選び方がハッシュ値の偏りを吸収する前提で、各コンテナが展開する。
+ */
+#define CSTL_HASH_INTEGER_INTERFACE(Name)	\
 size_t Name##_hash_char(char n);\
 size_t Name##_hash_schar(signed char n);\
 size_t Name##_hash_uchar(unsigned char n);\
@@ -59,6 +69,92 @@ size_t Name##_hash_int(int n);\
 size_t Name##_hash_uint(unsigned int n);\
 size_t Name##_hash_long(long n);\
 size_t Name##_hash_ulong(unsigned long n);\
+
+
+#define CSTL_HASH_INTEGER_IMPLEMENT(Name)	\
+size_t Name##_hash_char(char n)\
+{\
+    return (size_t) n;\
+}\
+\
+size_t Name##_hash_schar(signed char n)\
+{\
+    return (size_t) n;\
+}\
+\
+size_t Name##_hash_uchar(unsigned char n)\
+{\
+    return (size_t) n;\
+}\
+\
+size_t Name##_hash_short(short n)\
+{\
+    return (size_t) n;\
+}\
+\
+size_t Name##_hash_ushort(unsigned short n)\
+{\
+    return (size_t) n;\
+}\
+\
+size_t Name##_hash_int(int n)\
+{\
+    return (size_t) n;\
+}\
+\
+size_t Name##_hash_uint(unsigned int n)\
+{\
+    return (size_t) n;\
+}\
+\
+size_t Name##_hash_long(long n)\
+{\
+    return (size_t) n;\
+}\
+\
+size_t Name##_hash_ulong(unsigned long n)\
+{\
+    return (size_t) n;\
+}\
+\
+
+
+
+/* 
+ * CSTL_HASHTABLE_THREADマクロが定義されているならば、全要素を1つの双方向リストでつなぎ、
+ * begin()/next()を空のバケットの数によらずO(1)でたどる。end()の要素がリストの番兵となる。
+ */
+#ifdef CSTL_HASHTABLE_THREAD
+#define CSTL_HASHTABLE_LINK(x)		x
+#else
+#define CSTL_HASHTABLE_LINK(x)
+#endif
+
+/* find_batch()で一度に先読みするキーの数 */
+#define CSTL_HASHTABLE_BATCH		16
+
+/* 
+ * ブルームフィルタの1ブロックのワード(size_t)数。
+ * 1つのキーにつきブロック内の各ワードに1ビットずつ立てるので、検査するキャッシュラインは1つで済む。
+ */
+#define CSTL_HASHTABLE_BLOOM_WORDS	8
+#define CSTL_HASHTABLE_BLOOM_BITS	(CSTL_HASHTABLE_BLOOM_WORDS * CSTL_HASH_BITS)
+/* y*saltの上位8bitをワードのビット数で割った余りの位置のビット(256はワードのビット数の倍数) */
+#define CSTL_HASHTABLE_BLOOM_MASK(y, salt)	\
+	((size_t) 1 << ((((y) * (salt)) >> (CSTL_HASH_BITS - 8)) % CSTL_HASH_BITS))
+
+
+#define CSTL_HASHTABLE_INTERFACE(Name, KeyType, ValueType)	\
+\
+typedef struct Name Name;\
+typedef struct Name##Node *Name##Iterator;\
+typedef struct Name##Node *Name##LocalIterator;\
+size_t Name##_hash_string(register const char *str);\
+size_t Name##_hash_wstring(register const wchar_t *str);\
+size_t Name##_hash_chars(const char *chars, size_t chars_len);\
+size_t Name##_hash_wchars(const wchar_t *chars, size_t chars_len);\
+size_t Name##_hash_bytes(const void *data, size_t size);\
+CSTL_HASH_INTEGER_INTERFACE(Name)\
 Name *Name##_new(void);\
 Name *Name##_new_rehash(size_t n);\
 void Name##_delete(Name *self);\
@@ -69,9 +165,15 @@ int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last);\
 Name##Iterator Name##_erase(Name *self, Name##Iterator pos);\
 Name##Iterator Name##_erase_range(Name *self, Name##Iterator first, Name##Iterator last);\
 size_t Name##_erase_key(Name *self, KeyType key);\
+Name##Iterator Name##_extract(Name *self, Name##Iterator pos);\
+void Name##_node_delete(Name##Iterator node);\
 size_t Name##_count(Name *self, KeyType key);\
 Name##Iterator Name##_find(Name *self, KeyType key);\
 void Name##_equal_range(Name *self, KeyType key, Name##Iterator *first, Name##Iterator *last);\
+Name##Iterator Name##_find_ref(Name *self, KeyType const *key);\
+size_t Name##_count_ref(Name *self, KeyType const *key);\
+Name##Iterator Name##_find_with(Name *self, const void *probe, size_t (*hasher)(const void *probe), int (*comp)(const void *probe, KeyType const *key));\
+void Name##_find_batch(Name *self, KeyType const *keys, size_t n, Name##Iterator *iters);\
 Name##Iterator Name##_begin(Name *self);\
 Name##Iterator Name##_end(Name *self);\
 Name##Iterator Name##_next(Name##Iterator pos);\
@@ -86,86 +188,115 @@ float Name##_load_factor(Name *self);\
 float Name##_get_max_load_factor(Name *self);\
 void Name##_set_max_load_factor(Name *self, float z);\
 int Name##_rehash(Name *self, size_t n);\
+int Name##_reserve(Name *self, size_t n);\
+int Name##_shrink_to_fit(Name *self);\
+size_t Name##_get_incremental_rehash(Name *self);\
+void Name##_set_incremental_rehash(Name *self, size_t step);\
+size_t Name##_get_bloom_filter(Name *self);\
+int Name##_set_bloom_filter(Name *self, size_t bits);\
+int Name##_may_contain(Name *self, KeyType key);\
 \
 
 
 #define CSTL_HASHTABLE_IMPLEMENT(Name, KeyType, ValueType, Hasher, Compare)	\
 \
-size_t Name##_hash_string(register const char *str)\
-{\
-	register int c;\
-	register int val = 0;\
-	while ((c = *str++) != '\0') {\
-		val = val * 997 + c;\
-	}\
-	return (size_t) (val + (val >> 5));\
-}\
-\
-size_t Name##_hash_wstring(register const wchar_t *str)\
+size_t Name##_hash_bytes(const void *data, size_t size)\
 {\
-	register int c;\
-	register int val = 0;\
-	while ((c = *str++) != '\0') {\
-		val = val * 997 + c;\
+	register const unsigned char *p = (const unsigned char *) data;\
+	register size_t val = CSTL_HASH_K1 ^ (size * CSTL_HASH_K2);\
+	size_t w;\
+	if (size >= sizeof(size_t)) {\
+		register const unsigned char *last = p + size - sizeof(size_t);\
+		/* size_t単位で読み込んで混ぜる */\
+		while (p < last) {\
+			memcpy(&w, p, sizeof(size_t));\
+			val = (val ^ w) * CSTL_HASH_K2;\
+			val ^= val >> (CSTL_HASH_BITS / 2 - 3);\
+			p += sizeof(size_t);\
+		}\
+		/* 端数は末尾のsize_tを重ねて読む */\
+		memcpy(&w, last, sizeof(size_t));\
+	} else {\
+		w = 0;\
+		while (size) {\
+			size--;\
+			w = (w << CHAR_BIT) | p[size];\
+		}\
 	}\
-	return (size_t) (val + (val >> 5));\
+	val = (val ^ w) * CSTL_HASH_K2;\
+	val ^= val >> (CSTL_HASH_BITS / 2 - 3);\
+	/* 全てのビットを下位ビットに反映させる */\
+	val ^= val >> (CSTL_HASH_BITS / 2 - 2);\
+	val *= CSTL_HASH_K3;\
+	val ^= val >> (CSTL_HASH_BITS / 2 - 5);\
+	val *= CSTL_HASH_K2;\
+	val ^= val >> (CSTL_HASH_BITS / 2 - 1);\
+	return val;\
 }\
 \
-size_t Name##_hash_char(char n)\
+size_t Name##_hash_chars(const char *chars, size_t chars_len)\
 {\
-    return (size_t) n;\
+	return Name##_hash_bytes(chars, chars_len);\
 }\
 \
-size_t Name##_hash_schar(signed char n)\
+size_t Name##_hash_wchars(const wchar_t *chars, size_t chars_len)\
 {\
-    return (size_t) n;\
+	return Name##_hash_bytes(chars, sizeof(wchar_t) * chars_len);\
 }\
 \
-size_t Name##_hash_uchar(unsigned char n)\
-{\
-    return (size_t) n;\
-}\
-\
-size_t Name##_hash_short(short n)\
-{\
-    return (size_t) n;\
-}\
-\
-size_t Name##_hash_ushort(unsigned short n)\
-{\
-    return (size_t) n;\
-}\
-\
-size_t Name##_hash_int(int n)\
+size_t Name##_hash_string(register const char *str)\
 {\
-    return (size_t) n;\
+	return Name##_hash_bytes(str, strlen(str));\
 }\
 \
-size_t Name##_hash_uint(unsigned int n)\
+size_t Name##_hash_wstring(register const wchar_t *str)\
 {\
-    return (size_t) n;\
+	return Name##_hash_bytes(str, sizeof(wchar_t) * wcslen(str));\
 }\
 \
-size_t Name##_hash_long(long n)\
-{\
-    return (size_t) n;\
-}\
-\
-size_t Name##_hash_ulong(unsigned long n)\
-{\
-    return (size_t) n;\
-}\
+CSTL_HASH_INTEGER_IMPLEMENT(Name)\
 \
+/* \
+ * listの先頭にnodeをつなぐ。nodeは元のlistの位置に入るので、pprevはlistのものを引き継ぐ。\
+ * listが空ならば、nodeはバケットの先頭に入るものとする。\
+ */\
 static Name##Node *Name##Node_insert(Name##Node *list, Name##Node *node, Name##Node **bucket)\
 {\
 	node->bucket = bucket;\
 	if (!list) {\
+		node->pprev = bucket;\
 		return node;\
 	}\
 	node->next = list;\
+	node->pprev = list->pprev;\
+	list->pprev = &node->next;\
 	return node;\
 }\
 \
+CSTL_HASHTABLE_LINK(\
+/* リストのposの直前にnodeをつなぐ */\
+static void Name##_link_before(Name##Node *pos, Name##Node *node)\
+{\
+	node->succ = pos;\
+	node->pred = pos->pred;\
+	pos->pred->succ = node;\
+	pos->pred = node;\
+}\
+\
+/* 番兵endのリストをfirstからlastまでの要素にする。firstがold_endならば空にする */\
+static void Name##_set_list(Name##Node *end, Name##Node *first, Name##Node *last, Name##Node *old_end)\
+{\
+	if (first == old_end) {\
+		end->succ = end->pred = end;\
+		return;\
+	}\
+	end->succ = first;\
+	end->pred = last;\
+	first->pred = end;\
+	last->succ = end;\
+}\
+)\
+\
 static Name##Node *Name##Node_erase(Name##Node *list)\
 {\
 	Name##Node *tmp;\
@@ -254,9 +385,188 @@ struct Name {\
 	size_t size;\
 	float max_load_factor;\
 	Name##Node end_node;\
+	Name##Node_Vector *old_buckets; /* インクリメンタル再ハッシュ中の旧バケット配列 */\
+	size_t migrate_idx; /* 次に移す旧バケットのインデックス */\
+	size_t rehash_step; /* 1回の操作で移す旧バケット数。0ならば一括で再ハッシュ */\
+	Name##Node bridge_node; /* 旧バケット配列の終端。走査を新しいバケット配列へつなぐ */\
+	size_t bloom_bits; /* ブルームフィルタの要素あたりのビット数。0ならばブルームフィルタを使わない */\
+	size_t *bloom; /* ブルームフィルタ */\
+	size_t bloom_blocks; /* ブルームフィルタのブロック数 */\
+	size_t *next_bloom; /* 再ハッシュ中に作る新しいバケット配列用のブルームフィルタ */\
+	size_t next_bloom_blocks;\
 	CSTL_MAGIC(Name *magic;)\
 };\
 \
+static const size_t Name##_bloom_salt[CSTL_HASHTABLE_BLOOM_WORDS] = {\
+	CSTL_HASH_CONST(0x47B6137BUL, 0x44974D91UL),\
+	CSTL_HASH_CONST(0x8824AD5BUL, 0xA2B7289DUL),\
+	CSTL_HASH_CONST(0x705495C7UL, 0x2DF1424BUL),\
+	CSTL_HASH_CONST(0x9EFC4947UL, 0x5C6BFB31UL),\
+	CSTL_HASH_CONST(0xD6E8FEB8UL, 0x6659FD93UL),\
+	CSTL_HASH_CONST(0xC2B2AE3DUL, 0x27D4EB4FUL),\
+	CSTL_HASH_CONST(0x165667B1UL, 0x9E3779B1UL),\
+	CSTL_HASH_CONST(0x85EBCA77UL, 0xCC9E2D51UL),\
+};\
+\
+/* バケット数nbucketsで拡張するまでに入る要素数に対して、要素あたりbitsビットのブルームフィルタを確保する */\
+static size_t *Name##_bloom_new(Name *self, size_t bits, size_t nbuckets, size_t *nblocks)\
+{\
+	*nblocks = (size_t) (bits * (nbuckets * self->max_load_factor)) / CSTL_HASHTABLE_BLOOM_BITS + 1;\
+	return (size_t *) calloc(*nblocks * CSTL_HASHTABLE_BLOOM_WORDS, sizeof(size_t));\
+}\
+\
+/* hash_valのブロックを返し、*yにブロック内のビットを選ぶ値を格納する */\
+static size_t *Name##_bloom_block(size_t *bloom, size_t nblocks, size_t hash_val, size_t *y)\
+{\
+	register size_t x = hash_val * CSTL_HASH_K2;\
+	x ^= x >> (CSTL_HASH_BITS / 2);\
+	x *= CSTL_HASH_K3;\
+	*y = x ^ (x >> (CSTL_HASH_BITS / 2));\
+	return bloom + (x % nblocks) * CSTL_HASHTABLE_BLOOM_WORDS;\
+}\
+\
+static void Name##_bloom_set(size_t *bloom, size_t nblocks, size_t hash_val)\
+{\
+	register size_t i;\
+	size_t y;\
+	size_t *block = Name##_bloom_block(bloom, nblocks, hash_val, &y);\
+	for (i = 0; i < CSTL_HASHTABLE_BLOOM_WORDS; i++) {\
+		block[i] |= CSTL_HASHTABLE_BLOOM_MASK(y, Name##_bloom_salt[i]);\
+	}\
+}\
+\
+/* \
+ * hash_valのキーの要素がないことが確実ならば0を返す。\
+ * ブルームフィルタを使わない場合は常に非0を返す。\
+ * 再ハッシュ中は、全ての要素を含む古いブルームフィルタで調べる。\
+ */\
+static int Name##_bloom_test(Name *self, size_t hash_val)\
+{\
+	register size_t i;\
+	size_t y;\
+	size_t *block;\
+	if (!self->bloom) {\
+		return 1;\
+	}\
+	block = Name##_bloom_block(self->bloom, self->bloom_blocks, hash_val, &y);\
+	for (i = 0; i < CSTL_HASHTABLE_BLOOM_WORDS; i++) {\
+		register size_t mask = CSTL_HASHTABLE_BLOOM_MASK(y, Name##_bloom_salt[i]);\
+		if ((block[i] & mask) != mask) {\
+			return 0;\
+		}\
+	}\
+	return 1;\
+}\
+\
+/* 挿入した要素をブルームフィルタに加える。再ハッシュ中は新しいブルームフィルタにも加える */\
+static void Name##_bloom_add(Name *self, size_t hash_val)\
+{\
+	if (!self->bloom) {\
+		return;\
+	}\
+	Name##_bloom_set(self->bloom, self->bloom_blocks, hash_val);\
+	if (self->next_bloom) {\
+		Name##_bloom_set(self->next_bloom, self->next_bloom_blocks, hash_val);\
+	}\
+}\
+\
+/* 再ハッシュで移した要素を新しいブルームフィルタに加える */\
+static void Name##_bloom_migrate(Name *self, size_t hash_val)\
+{\
+	if (self->next_bloom) {\
+		Name##_bloom_set(self->next_bloom, self->next_bloom_blocks, hash_val);\
+	}\
+}\
+\
+/* 再ハッシュ前にnbuckets用の新しいブルームフィルタを用意する */\
+static int Name##_bloom_prepare(Name *self, size_t nbuckets)\
+{\
+	if (!self->bloom) {\
+		return 1;\
+	}\
+	self->next_bloom = Name##_bloom_new(self, self->bloom_bits, nbuckets, &self->next_bloom_blocks);\
+	return self->next_bloom != 0;\
+}\
+\
+/* 再ハッシュが終わったら新しいブルームフィルタに切り替える。削除された要素のビットもここで消える */\
+static void Name##_bloom_commit(Name *self)\
+{\
+	if (!self->next_bloom) {\
+		return;\
+	}\
+	free(self->bloom);\
+	self->bloom = self->next_bloom;\
+	self->bloom_blocks = self->next_bloom_blocks;\
+	self->next_bloom = 0;\
+}\
+\
+static void Name##_migrate_bucket(Name *self, Name##Node **bucket);\
+\
+/* 旧バケット配列の残りを全て移す */\
+static void Name##_rehash_finish(Name *self)\
+{\
+	size_t n;\
+	if (!self->old_buckets) {\
+		return;\
+	}\
+	n = Name##Node_Vector_size(self->old_buckets) - 1;\
+	for (; self->migrate_idx < n; self->migrate_idx++) {\
+		Name##_migrate_bucket(self, Name##Node_Vector_at(self->old_buckets, self->migrate_idx));\
+	}\
+	Name##Node_Vector_delete(self->old_buckets);\
+	self->old_buckets = 0;\
+	Name##_bloom_commit(self);\
+}\
+\
+/* \
+ * 挿入するhash_valのキーが入るバケットのインデックスを返す。\
+ * インクリメンタル再ハッシュ中ならば、そのキーの旧バケットと最大rehash_step個の旧バケットを移す。\
+ * これにより、同じキーの要素が旧バケットと新しいバケットに分かれることはない。\
+ * 検索では要素を移さないので、この関数を使わないこと。\
+ */\
+static size_t Name##_bucket_of(Name *self, size_t hash_val)\
+{\
+	register size_t i;\
+	size_t n;\
+	Name##Node **alias;\
+	if (self->old_buckets) {\
+		n = Name##Node_Vector_size(self->old_buckets) - 1;\
+		alias = Name##Node_Vector_at(self->old_buckets, hash_val % n);\
+		if (*alias) {\
+			Name##_migrate_bucket(self, alias);\
+		}\
+		for (i = 0; i < self->rehash_step && self->migrate_idx < n; i++, self->migrate_idx++) {\
+			alias = Name##Node_Vector_at(self->old_buckets, self->migrate_idx);\
+			if (*alias) {\
+				Name##_migrate_bucket(self, alias);\
+			}\
+		}\
+		if (self->migrate_idx == n) {\
+			Name##Node_Vector_delete(self->old_buckets);\
+			self->old_buckets = 0;\
+			Name##_bloom_commit(self);\
+		}\
+	}\
+	return hash_val % Name##_bucket_count(self);\
+}\
+\
+/* \
+ * bから最初の要素を探す。\
+ * 旧バケット配列の終端(bridge_node)に達したら、新しいバケット配列の先頭から探し続ける。\
+ */\
+static Name##Node *Name##_scan(register Name##Node **b)\
+{\
+	for (;;) {\
+		while (!*b) {\
+			b++;\
+		}\
+		if ((*b)->next != *b) {\
+			return *b;\
+		}\
+		b = (*b)->bucket;\
+	}\
+}\
+\
 static size_t Name##_next_prime(size_t n)\
 {\
 	register size_t i;\
@@ -288,10 +598,19 @@ Name *Name##_new_rehash(size_t n)\
 	Name##Node_Vector_resize(self->buckets, nbuckets + 1, 0);\
 	self->end_node.next = 0;\
 	self->end_node.bucket = 0; /* end()判定に使用 */\
+	CSTL_HASHTABLE_LINK(self->end_node.succ = self->end_node.pred = &self->end_node;)\
 	*Name##Node_Vector_back(self->buckets) = &self->end_node; /* end()の値 */\
 	CSTL_MAGIC(self->end_node.magic = self->buckets);\
 	self->size = 0;\
 	self->max_load_factor = Name##_default_mlf;\
+	self->old_buckets = 0;\
+	self->migrate_idx = 0;\
+	self->rehash_step = 0;\
+	self->bloom_bits = 0;\
+	self->bloom = 0;\
+	self->bloom_blocks = 0;\
+	self->next_bloom = 0;\
+	self->next_bloom_blocks = 0;\
 	CSTL_MAGIC(self->magic = self);\
 	return self;\
 }\
@@ -302,6 +621,7 @@ void Name##_delete(Name *self)\
 	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_delete");\
 	Name##_clear(self);\
 	Name##Node_Vector_delete(self->buckets);\
+	free(self->bloom);\
 	CSTL_MAGIC(self->magic = 0);\
 	free(self);\
 }\
@@ -312,6 +632,21 @@ void Name##_clear(Name *self)\
 	size_t bc;\
 	CSTL_ASSERT(self && "Unordered(Set|Map)_clear");\
 	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_clear");\
+	if (self->old_buckets) {\
+		/* 再ハッシュの途中ならば、まだ移していない旧バケットの要素を移さずに解放する */\
+		bc = Name##Node_Vector_size(self->old_buckets) - 1;\
+		for (i = self->migrate_idx; i < bc; i++) {\
+			Name##Node **alias;\
+			alias = Name##Node_Vector_at(self->old_buckets, i);\
+			*alias = Name##Node_clear(*alias);\
+		}\
+		Name##Node_Vector_delete(self->old_buckets);\
+		self->old_buckets = 0;\
+		Name##_bloom_commit(self);\
+	}\
+	if (self->bloom) {\
+		memset(self->bloom, 0, self->bloom_blocks * CSTL_HASHTABLE_BLOOM_WORDS * sizeof(size_t));\
+	}\
 	if (self->size == 0) {\
 		return;\
 	}\
@@ -321,6 +656,7 @@ void Name##_clear(Name *self)\
 		alias = Name##Node_Vector_at(self->buckets, i);\
 		*alias = Name##Node_clear(*alias);\
 	}\
+	CSTL_HASHTABLE_LINK(self->end_node.succ = self->end_node.pred = &self->end_node;)\
 	self->size = 0;\
 }\
 \
@@ -340,22 +676,13 @@ size_t Name##_size(Name *self)\
 \
 Name##Iterator Name##_begin(Name *self)\
 {\
-	register size_t i;\
 	CSTL_ASSERT(self && "Unordered(Set|Map)_begin");\
 	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_begin");\
+	CSTL_HASHTABLE_LINK(return self->end_node.succ;)\
 	if (self->size == 0) {\
 		return Name##_end(self);\
 	}\
-	for (i = 0;; i++) {\
-		Name##Node **alias;\
-		alias = Name##Node_Vector_at(self->buckets, i);\
-		if (*alias) {\
-			return *alias;\
-		}\
-	}\
-	/* NOTREACHED */\
-	CSTL_ASSERT(0 && "Unordered(Set|Map)_begin");\
-	return 0;\
+	return Name##_scan(Name##Node_Vector_at(self->old_buckets ? self->old_buckets : self->buckets, 0));\
 }\
 \
 Name##Iterator Name##_end(Name *self)\
@@ -367,43 +694,58 @@ Name##Iterator Name##_end(Name *self)\
 \
 Name##Iterator Name##_next(Name##Iterator pos)\
 {\
-	register size_t i;\
 	CSTL_ASSERT(pos && "Unordered(Set|Map)_next");\
 	CSTL_ASSERT(pos->magic && "Unordered(Set|Map)_next");\
 	CSTL_ASSERT(pos->bucket && "Unordered(Set|Map)_next"); /* pos != end() */\
+	CSTL_HASHTABLE_LINK(return pos->succ;)\
 	if (pos->next) {\
 		return pos->next;\
 	}\
-	for (i = 1;; i++) {\
-		if (pos->bucket[i]) {\
-			return pos->bucket[i];\
-		}\
-	}\
-	/* NOTREACHED */\
-	CSTL_ASSERT(0 && "Unordered(Set|Map)_next");\
-	return 0;\
+	return Name##_scan(pos->bucket + 1);\
 }\
 \
-static Name##Iterator Name##_find_node(Name *self, KeyType key, size_t idx)\
+static Name##Iterator Name##_find_node(Name *self, KeyType const *key, size_t idx)\
 {\
 	Name##Node **alias;\
 	register Name##Node *pos;\
 	alias = Name##Node_Vector_at(self->buckets, idx);\
 	for (pos = *alias; pos != 0; pos = pos->next) {\
-		if (Compare(key, pos->key) == 0) {\
+		if (Compare(*key, pos->key) == 0) {\
 			return pos;\
 		}\
 	}\
 	return Name##_end(self);\
 }\
 \
+/* \
+ * hash_valのキーの要素を検索する。要素は移さない。\
+ * インクリメンタル再ハッシュ中は、まだ移していない旧バケットを探してから新しいバケットを探す。\
+ * 要素を移さないので、検索しながらイテレータで全要素を辿ることができる。\
+ */\
+static Name##Iterator Name##_find_hash(Name *self, KeyType const *key, size_t hash_val)\
+{\
+	register Name##Node *pos;\
+	if (self->old_buckets) {\
+		pos = *Name##Node_Vector_at(self->old_buckets, hash_val % (Name##Node_Vector_size(self->old_buckets) - 1));\
+		for (; pos != 0; pos = pos->next) {\
+			if (Compare(*key, pos->key) == 0) {\
+				return pos;\
+			}\
+		}\
+	}\
+	return Name##_find_node(self, key, hash_val % Name##_bucket_count(self));\
+}\
+\
 Name##Iterator Name##_find(Name *self, KeyType key)\
 {\
-	size_t idx;\
+	size_t hash_val;\
 	CSTL_ASSERT(self && "Unordered(Set|Map)_find");\
 	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_find");\
-	idx = Hasher(key) % Name##_bucket_count(self);\
-	return Name##_find_node(self, key, idx);\
+	hash_val = Hasher(key);\
+	if (!Name##_bloom_test(self, hash_val)) {\
+		return Name##_end(self);\
+	}\
+	return Name##_find_hash(self, &key, hash_val);\
 }\
 \
 void Name##_equal_range(Name *self, KeyType key, Name##Iterator *first, Name##Iterator *last)\
@@ -444,15 +786,161 @@ size_t Name##_count(Name *self, KeyType key)\
 	return count;\
 }\
 \
+Name##Iterator Name##_find_ref(Name *self, KeyType const *key)\
+{\
+	size_t hash_val;\
+	CSTL_ASSERT(self && "Unordered(Set|Map)_find_ref");\
+	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_find_ref");\
+	CSTL_ASSERT(key && "Unordered(Set|Map)_find_ref");\
+	hash_val = Hasher(*key);\
+	if (!Name##_bloom_test(self, hash_val)) {\
+		return Name##_end(self);\
+	}\
+	return Name##_find_hash(self, key, hash_val);\
+}\
+\
+size_t Name##_count_ref(Name *self, KeyType const *key)\
+{\
+	register Name##Node *pos;\
+	register size_t count = 0;\
+	Name##Node *end_pos;\
+	CSTL_ASSERT(self && "Unordered(Set|Map)_count_ref");\
+	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_count_ref");\
+	CSTL_ASSERT(key && "Unordered(Set|Map)_count_ref");\
+	end_pos = Name##_end(self);\
+	/* 同じキーの要素は連続している */\
+	for (pos = Name##_find_ref(self, key); pos != end_pos; pos = Name##_next(pos)) {\
+		if (Compare(*key, pos->key) != 0) {\
+			break;\
+		}\
+		count++;\
+	}\
+	return count;\
+}\
+\
+/* hasherはHasherと同じハッシュ値を返し、compは等しいときに0を返すこと */\
+Name##Iterator Name##_find_with(Name *self, const void *probe, size_t (*hasher)(const void *probe), int (*comp)(const void *probe, KeyType const *key))\
+{\
+	register Name##Node *pos;\
+	size_t hash_val;\
+	CSTL_ASSERT(self && "Unordered(Set|Map)_find_with");\
+	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_find_with");\
+	CSTL_ASSERT(hasher && "Unordered(Set|Map)_find_with");\
+	CSTL_ASSERT(comp && "Unordered(Set|Map)_find_with");\
+	hash_val = hasher(probe);\
+	if (!Name##_bloom_test(self, hash_val)) {\
+		return Name##_end(self);\
+	}\
+	if (self->old_buckets) {\
+		pos = *Name##Node_Vector_at(self->old_buckets, hash_val % (Name##Node_Vector_size(self->old_buckets) - 1));\
+		for (; pos != 0; pos = pos->next) {\
+			if (comp(probe, &pos->key) == 0) {\
+				return pos;\
+			}\
+		}\
+	}\
+	pos = *Name##Node_Vector_at(self->buckets, hash_val % Name##_bucket_count(self));\
+	for (; pos != 0; pos = pos->next) {\
+		if (comp(probe, &pos->key) == 0) {\
+			return pos;\
+		}\
+	}\
+	return Name##_end(self);\
+}\
+\
+/* \
+ * keysのキーをCSTL_HASHTABLE_BATCH個ずつ検索する。\
+ * まとめてハッシュ値を計算してバケットを先読みし、次に各バケットの先頭のノードを先読みしてからたどる。\
+ * これにより、キーごとのキャッシュミスの待ち時間が重なる。\
+ */\
+void Name##_find_batch(Name *self, KeyType const *keys, size_t n, Name##Iterator *iters)\
+{\
+	Name##Node **slots[CSTL_HASHTABLE_BATCH];\
+	Name##Node **old_slots[CSTL_HASHTABLE_BATCH];\
+	register Name##Node *pos;\
+	register size_t j;\
+	size_t i, m;\
+	CSTL_ASSERT(self && "Unordered(Set|Map)_find_batch");\
+	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_find_batch");\
+	CSTL_ASSERT((keys || !n) && "Unordered(Set|Map)_find_batch");\
+	CSTL_ASSERT((iters || !n) && "Unordered(Set|Map)_find_batch");\
+	for (i = 0; i < n; i += m) {\
+		m = (n - i < CSTL_HASHTABLE_BATCH) ? n - i : CSTL_HASHTABLE_BATCH;\
+		for (j = 0; j < m; j++) {\
+			size_t hash_val = Hasher(keys[i + j]);\
+			old_slots[j] = 0;\
+			if (!Name##_bloom_test(self, hash_val)) {\
+				slots[j] = 0;\
+				continue;\
+			}\
+			slots[j] = Name##Node_Vector_at(self->buckets, hash_val % Name##_bucket_count(self));\
+			CSTL_PREFETCH(slots[j]);\
+			/* インクリメンタル再ハッシュ中は、まだ移していない旧バケットも探す */\
+			if (self->old_buckets) {\
+				old_slots[j] = Name##Node_Vector_at(self->old_buckets, hash_val % (Name##Node_Vector_size(self->old_buckets) - 1));\
+				CSTL_PREFETCH(old_slots[j]);\
+			}\
+		}\
+		for (j = 0; j < m; j++) {\
+			pos = slots[j] ? *slots[j] : 0;\
+			if (pos) {\
+				CSTL_PREFETCH(pos);\
+			}\
+			iters[i + j] = pos;\
+			if (old_slots[j] && *old_slots[j]) {\
+				CSTL_PREFETCH(*old_slots[j]);\
+			}\
+		}\
+		for (j = 0; j < m; j++) {\
+			pos = 0;\
+			if (old_slots[j]) {\
+				for (pos = *old_slots[j]; pos != 0; pos = pos->next) {\
+					if (Compare(keys[i + j], pos->key) == 0) {\
+						break;\
+					}\
+				}\
+			}\
+			if (!pos) {\
+				for (pos = iters[i + j]; pos != 0; pos = pos->next) {\
+					if (Compare(keys[i + j], pos->key) == 0) {\
+						break;\
+					}\
+				}\
+			}\
+			iters[i + j] = pos ? pos : Name##_end(self);\
+		}\
+	}\
+}\
+\
 void Name##_swap(Name *self, Name *x)\
 {\
 	Name##Node_Vector *tmp_buckets;\
 	size_t tmp_size;\
 	float tmp_max_load_factor;\
+	size_t tmp_rehash_step;\
+	size_t tmp_bloom_bits;\
+	size_t *tmp_bloom;\
+	size_t tmp_bloom_blocks;\
+	CSTL_HASHTABLE_LINK(Name##Node *first;)\
+	CSTL_HASHTABLE_LINK(Name##Node *last;)\
 	CSTL_ASSERT(self && "Unordered(Set|Map)_swap");\
 	CSTL_ASSERT(x && "Unordered(Set|Map)_swap");\
 	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_swap");\
 	CSTL_ASSERT(x->magic == x && "Unordered(Set|Map)_swap");\
+	Name##_rehash_finish(self);\
+	Name##_rehash_finish(x);\
+	tmp_rehash_step = self->rehash_step;\
+	self->rehash_step = x->rehash_step;\
+	x->rehash_step = tmp_rehash_step;\
+	tmp_bloom_bits = self->bloom_bits;\
+	tmp_bloom = self->bloom;\
+	tmp_bloom_blocks = self->bloom_blocks;\
+	self->bloom_bits = x->bloom_bits;\
+	self->bloom = x->bloom;\
+	self->bloom_blocks = x->bloom_blocks;\
+	x->bloom_bits = tmp_bloom_bits;\
+	x->bloom = tmp_bloom;\
+	x->bloom_blocks = tmp_bloom_blocks;\
 	tmp_buckets = self->buckets;\
 	tmp_size = self->size;\
 	tmp_max_load_factor = self->max_load_factor;\
@@ -470,6 +958,12 @@ void Name##_swap(Name *self, Name *x)\
 	CSTL_ASSERT(x->end_node.magic == self->buckets && "Unordered(Set|Map)_swap");\
 	CSTL_MAGIC(self->end_node.magic = self->buckets);\
 	CSTL_MAGIC(x->end_node.magic = x->buckets);\
+	CSTL_HASHTABLE_LINK(\
+		first = self->end_node.succ;\
+		last = self->end_node.pred;\
+		Name##_set_list(&self->end_node, x->end_node.succ, x->end_node.pred, &x->end_node);\
+		Name##_set_list(&x->end_node, first, last, &self->end_node);\
+	)\
 }\
 \
 size_t Name##_bucket_count(Name *self)\
@@ -484,6 +978,7 @@ size_t Name##_bucket_size(Name *self, size_t idx)\
 	CSTL_ASSERT(self && "Unordered(Set|Map)_bucket_size");\
 	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_bucket_size");\
 	CSTL_ASSERT(idx < Name##_bucket_count(self) && "Unordered(Set|Map)_bucket_size");\
+	Name##_rehash_finish(self);\
 	return Name##Node_size(*Name##Node_Vector_at(self->buckets, idx));\
 }\
 \
@@ -499,6 +994,7 @@ Name##LocalIterator Name##_bucket_begin(Name *self, size_t idx)\
 	CSTL_ASSERT(self && "Unordered(Set|Map)_bucket_begin");\
 	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_bucket_begin");\
 	CSTL_ASSERT(idx < Name##_bucket_count(self) && "Unordered(Set|Map)_bucket_begin");\
+	Name##_rehash_finish(self);\
 	return *Name##Node_Vector_at(self->buckets, idx);\
 }\
 \
@@ -541,30 +1037,210 @@ void Name##_set_max_load_factor(Name *self, float z)\
 	self->max_load_factor = (z < Name##_minimum_mlf) ? Name##_minimum_mlf : z;\
 }\
 \
+size_t Name##_get_incremental_rehash(Name *self)\
+{\
+	CSTL_ASSERT(self && "Unordered(Set|Map)_get_incremental_rehash");\
+	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_get_incremental_rehash");\
+	return self->rehash_step;\
+}\
+\
+void Name##_set_incremental_rehash(Name *self, size_t step)\
+{\
+	CSTL_ASSERT(self && "Unordered(Set|Map)_set_incremental_rehash");\
+	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_set_incremental_rehash");\
+	if (!step) {\
+		Name##_rehash_finish(self);\
+	}\
+	self->rehash_step = step;\
+}\
+\
+size_t Name##_get_bloom_filter(Name *self)\
+{\
+	CSTL_ASSERT(self && "Unordered(Set|Map)_get_bloom_filter");\
+	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_get_bloom_filter");\
+	return self->bloom_bits;\
+}\
+\
+/* \
+ * 要素あたりbitsビットのブルームフィルタを作り直し、現在の全要素を加える。\
+ * bitsが0ならばブルームフィルタを使わない。\
+ */\
+int Name##_set_bloom_filter(Name *self, size_t bits)\
+{\
+	register size_t i;\
+	register Name##Node *pos;\
+	size_t bc;\
+	size_t nblocks;\
+	size_t *bloom;\
+	CSTL_ASSERT(self && "Unordered(Set|Map)_set_bloom_filter");\
+	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_set_bloom_filter");\
+	Name##_rehash_finish(self);\
+	bloom = 0;\
+	nblocks = 0;\
+	if (bits) {\
+		bc = Name##_bucket_count(self);\
+		bloom = Name##_bloom_new(self, bits, bc, &nblocks);\
+		if (!bloom) {\
+			return 0;\
+		}\
+		for (i = 0; i < bc; i++) {\
+			for (pos = *Name##Node_Vector_at(self->buckets, i); pos != 0; pos = pos->next) {\
+				Name##_bloom_set(bloom, nblocks, Hasher(pos->key));\
+			}\
+		}\
+	}\
+	free(self->bloom);\
+	self->bloom = bloom;\
+	self->bloom_blocks = nblocks;\
+	self->bloom_bits = bits;\
+	return 1;\
+}\
+\
+int Name##_may_contain(Name *self, KeyType key)\
+{\
+	CSTL_ASSERT(self && "Unordered(Set|Map)_may_contain");\
+	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_may_contain");\
+	return Name##_bloom_test(self, Hasher(key));\
+}\
+\
+/* \
+ * 要素の挿入でロードファクターが上限を超える場合の再ハッシュ。\
+ * インクリメンタル再ハッシュが有効ならば、新しいバケット配列を用意するだけで要素は移さない。\
+ * 要素は以後の挿入ごとに Name##_bucket_of() で少しずつ移す。\
+ */\
+static int Name##_grow(Name *self, size_t n)\
+{\
+	size_t nbuckets;\
+	Name##Node_Vector *old_buckets;\
+	if (!self->rehash_step) {\
+		return Name##_rehash(self, n);\
+	}\
+	Name##_rehash_finish(self);\
+	nbuckets = Name##_next_prime(n);\
+	if (nbuckets <= Name##_bucket_count(self)) {\
+		return 1;\
+	}\
+	old_buckets = Name##Node_Vector_new_reserve(nbuckets + 1);\
+	if (!old_buckets) {\
+		return 0;\
+	}\
+	if (!Name##_bloom_prepare(self, nbuckets)) {\
+		Name##Node_Vector_delete(old_buckets);\
+		return 0;\
+	}\
+	Name##Node_Vector_resize(old_buckets, nbuckets + 1, 0);\
+	/* ノードのmagicが変わらないように、self->bucketsの中身を入れ替える */\
+	Name##Node_Vector_swap(self->buckets, old_buckets);\
+	*Name##Node_Vector_back(self->buckets) = &self->end_node;\
+	/* 旧バケット配列の終端からは新しいバケット配列の先頭へ進む */\
+	*Name##Node_Vector_back(old_buckets) = &self->bridge_node;\
+	self->bridge_node.next = &self->bridge_node;\
+	self->bridge_node.bucket = Name##Node_Vector_at(self->buckets, 0);\
+	self->old_buckets = old_buckets;\
+	self->migrate_idx = 0;\
+	return 1;\
+}\
+\
+/* バケット数をnbucketsにして全要素を再ハッシュする。バケット数を減らすこともできる */\
+static int Name##_rehash_buckets(Name *self, size_t nbuckets)\
+{\
+	register size_t i;\
+	size_t n;\
+	Name##Node_Vector *old_buckets;\
+	old_buckets = Name##Node_Vector_new_reserve(nbuckets + 1);\
+	if (!old_buckets) {\
+		return 0;\
+	}\
+	if (!Name##_bloom_prepare(self, nbuckets)) {\
+		Name##Node_Vector_delete(old_buckets);\
+		return 0;\
+	}\
+	Name##Node_Vector_resize(old_buckets, nbuckets + 1, 0);\
+	/* ノードのmagicが変わらないように、self->bucketsの中身を入れ替える */\
+	Name##Node_Vector_swap(self->buckets, old_buckets);\
+	/* end()を指すポインタ */\
+	*Name##Node_Vector_back(self->buckets) = &self->end_node;\
+	n = Name##Node_Vector_size(old_buckets) - 1;\
+	/* 各バケットのノードに対して再ハッシュ */\
+	for (i = 0; i < n; i++) {\
+		Name##_migrate_bucket(self, Name##Node_Vector_at(old_buckets, i));\
+	}\
+	Name##Node_Vector_delete(old_buckets);\
+	Name##_bloom_commit(self);\
+	return 1;\
+}\
+\
+int Name##_reserve(Name *self, size_t n)\
+{\
+	CSTL_ASSERT(self && "Unordered(Set|Map)_reserve");\
+	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_reserve");\
+	return Name##_rehash(self, (size_t) (n / self->max_load_factor) + 1);\
+}\
+\
+int Name##_shrink_to_fit(Name *self)\
+{\
+	size_t nbuckets;\
+	CSTL_ASSERT(self && "Unordered(Set|Map)_shrink_to_fit");\
+	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_shrink_to_fit");\
+	Name##_rehash_finish(self);\
+	nbuckets = Name##_next_prime((size_t) (self->size / self->max_load_factor) + 1);\
+	if (nbuckets >= Name##_bucket_count(self)) {\
+		return 1;\
+	}\
+	return Name##_rehash_buckets(self, nbuckets);\
+}\
+\
+/* posのノードを解放せずにバケットのリストから外す。pprevを使うのでバケットをたどらない */\
+static void Name##_unlink_node(Name##Node *pos)\
+{\
+	*pos->pprev = pos->next;\
+	if (pos->next) {\
+		pos->next->pprev = pos->pprev;\
+	}\
+	pos->next = 0;\
+	CSTL_HASHTABLE_LINK(pos->pred->succ = pos->succ;)\
+	CSTL_HASHTABLE_LINK(pos->succ->pred = pos->pred;)\
+}\
+\
 Name##Iterator Name##_erase(Name *self, Name##Iterator pos)\
 {\
 	Name##Node *ret;\
-	register Name##Node *i;\
-	register Name##Node *prev;\
 	CSTL_ASSERT(self && "Unordered(Set|Map)_erase");\
 	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_erase");\
 	CSTL_ASSERT(pos && "Unordered(Set|Map)_erase");\
 	CSTL_ASSERT(pos->magic == self->buckets && "Unordered(Set|Map)_erase");\
 	CSTL_ASSERT(pos != Name##_end(self) && "Unordered(Set|Map)_erase");\
 	ret = Name##_next(pos);\
-	for (i = *pos->bucket, prev = 0; i != pos; prev = i, i = i->next) {\
-		;\
-	}\
-	if (prev) {\
-		prev->next = Name##Node_erase(pos);\
-	} else {\
-		Name##Node **tmp = pos->bucket;\
-		*tmp = Name##Node_erase(pos);\
-	}\
+	Name##_unlink_node(pos);\
+	Name##Node_erase(pos);\
 	self->size--;\
 	return ret;\
 }\
 \
+/* \
+ * posのノードを解放せずに取り外し、どのコンテナにも属さないノードとして返す。\
+ * 取り外したノードのmagicはノード自身を指す。\
+ */\
+Name##Iterator Name##_extract(Name *self, Name##Iterator pos)\
+{\
+	CSTL_ASSERT(self && "Unordered(Set|Map)_extract");\
+	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_extract");\
+	CSTL_ASSERT(pos && "Unordered(Set|Map)_extract");\
+	CSTL_ASSERT(pos->magic == self->buckets && "Unordered(Set|Map)_extract");\
+	CSTL_ASSERT(pos != Name##_end(self) && "Unordered(Set|Map)_extract");\
+	Name##_unlink_node(pos);\
+	CSTL_MAGIC(pos->magic = (Name##Node_Vector *) pos);\
+	self->size--;\
+	return pos;\
+}\
+\
+void Name##_node_delete(Name##Iterator node)\
+{\
+	if (!node) return;\
+	CSTL_ASSERT(node->magic == (Name##Node_Vector *) node && "Unordered(Set|Map)_node_delete");\
+	Name##Node_erase(node);\
+}\
+\
 Name##Iterator Name##_erase_range(Name *self, Name##Iterator first, Name##Iterator last)\
 {\
 	register Name##Iterator pos;\
@@ -603,44 +1279,31 @@ size_t Name##_erase_key(Name *self, KeyType key)\
 #define CSTL_HASHTABLE_IMPLEMENT_REHASH(Name, KeyType, ValueType, Hasher, Compare)	\
 int Name##_rehash(Name *self, size_t n)\
 {\
-	register Name##Node *node;\
 	size_t nbuckets;\
-	Name##Node_Vector *new_buckets;\
-	Name##Node *end_pos;\
 	CSTL_ASSERT(self && "Unordered(Set|Map)_rehash");\
 	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_rehash");\
+	Name##_rehash_finish(self);\
 	nbuckets = Name##_next_prime(n);\
 	if (nbuckets <= Name##_bucket_count(self)) {\
 		return 1;\
 	}\
-	new_buckets = Name##Node_Vector_new_reserve(nbuckets + 1);\
-	if (!new_buckets) {\
-		return 0;\
-	}\
-	Name##Node_Vector_resize(new_buckets, nbuckets + 1, 0);\
+	return Name##_rehash_buckets(self, nbuckets);\
+}\
 \
-	end_pos = Name##_end(self);\
-	/* 各ノードに対して再ハッシュ */\
-	for (node = Name##_begin(self); node != end_pos;) {\
-		size_t idx;\
-		Name##Node **alias;\
-		Name##Node *tmp = Name##_next(node);\
-		/* nodeをリストから取り外す */\
-		*node->bucket = node->next;\
+/* 旧バケットの全ノードを新しいバケット配列へ移す */\
+static void Name##_migrate_bucket(Name *self, Name##Node **bucket)\
+{\
+	register Name##Node *node;\
+	Name##Node **alias;\
+	size_t hash_val;\
+	while ((node = *bucket) != 0) {\
+		*bucket = node->next;\
 		node->next = 0;\
-\
-		idx = Hasher(node->key) % nbuckets;\
-		alias = Name##Node_Vector_at(new_buckets, idx);\
+		hash_val = Hasher(node->key);\
+		Name##_bloom_migrate(self, hash_val);\
+		alias = Name##Node_Vector_at(self->buckets, hash_val % Name##_bucket_count(self));\
 		*alias = Name##Node_insert(*alias, node, alias);\
-		node = tmp;\
 	}\
-	/* end()を指すポインタ */\
-	*Name##Node_Vector_back(new_buckets) = &self->end_node;\
-	CSTL_ASSERT(Name##_begin(self) == Name##_end(self) && "Unordered(Set|Map)_rehash");\
-\
-	Name##Node_Vector_swap(self->buckets, new_buckets);\
-	Name##Node_Vector_delete(new_buckets);\
-	return 1;\
 }\
 \
 
@@ -648,59 +1311,135 @@ int Name##_rehash(Name *self, size_t n)\
 #define CSTL_HASHTABLE_IMPLEMENT_REHASH_MULTI(Name, KeyType, ValueType, Hasher, Compare)	\
 int Name##_rehash(Name *self, size_t n)\
 {\
-	register Name##Node *node;\
 	size_t nbuckets;\
-	Name##Node_Vector *new_buckets;\
-	Name##Node *end_pos;\
 	CSTL_ASSERT(self && "UnorderedMulti(Set|Map)_rehash");\
 	CSTL_ASSERT(self->magic == self && "UnorderedMulti(Set|Map)_rehash");\
+	Name##_rehash_finish(self);\
 	nbuckets = Name##_next_prime(n);\
 	if (nbuckets <= Name##_bucket_count(self)) {\
 		return 1;\
 	}\
-	new_buckets = Name##Node_Vector_new_reserve(nbuckets + 1);\
-	if (!new_buckets) {\
-		return 0;\
+	return Name##_rehash_buckets(self, nbuckets);\
+}\
+\
+/* \
+ * 旧バケットの全ノードを新しいバケット配列へ移す。\
+ * 同じキーの要素は1つの旧バケットに連続して並んでおり、移す先のバケットにはまだ存在しない。\
+ * そのため、直前に移した要素と同じキーならばその直後につなげば、元の順序のまま連続して移る。\
+ */\
+static void Name##_migrate_bucket(Name *self, Name##Node **bucket)\
+{\
+	register Name##Node *node;\
+	register Name##Node *last = 0;\
+	Name##Node **alias;\
+	size_t hash_val;\
+	while ((node = *bucket) != 0) {\
+		*bucket = node->next;\
+		if (last && Compare(node->key, last->key) == 0) {\
+			node->bucket = last->bucket;\
+			node->next = last->next;\
+			node->pprev = &last->next;\
+			if (last->next) {\
+				last->next->pprev = &node->next;\
+			}\
+			last->next = node;\
+		} else {\
+			node->next = 0;\
+			hash_val = Hasher(node->key);\
+			Name##_bloom_migrate(self, hash_val);\
+			alias = Name##Node_Vector_at(self->buckets, hash_val % Name##_bucket_count(self));\
+			*alias = Name##Node_insert(*alias, node, alias);\
+		}\
+		last = node;\
 	}\
-	Name##Node_Vector_resize(new_buckets, nbuckets + 1, 0);\
+}\
 \
-	end_pos = Name##_end(self);\
-	/* 各ノードに対して再ハッシュ */\
-	for (node = Name##_begin(self); node != end_pos;) {\
-		register Name##Node *pos;\
-		register Name##Node *prev;\
-		size_t idx;\
-		Name##Node **alias;\
-		Name##Node *tmp = Name##_next(node);\
-		/* nodeをリストから取り外す */\
-		*node->bucket = node->next;\
-		node->next = 0;\
+
+#define CSTL_HASHTABLE_IMPLEMENT_INSERT_NODE(Name, KeyType, ValueType, Hasher, Compare)	\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node, int *success)\
+{\
+	Name##Node **alias;\
+	Name##Node *pos;\
+	size_t hash_val;\
+	size_t idx;\
+	CSTL_ASSERT(self && "Unordered(Set|Map)_insert_node");\
+	CSTL_ASSERT(self->magic == self && "Unordered(Set|Map)_insert_node");\
+	CSTL_ASSERT(node && "Unordered(Set|Map)_insert_node");\
+	CSTL_ASSERT(node->magic == (Name##Node_Vector *) node && "Unordered(Set|Map)_insert_node");\
+	hash_val = Hasher(node->key);\
+	idx = Name##_bucket_of(self, hash_val);\
+	pos = Name##_bloom_test(self, hash_val) ? Name##_find_node(self, &node->key, idx) : Name##_end(self);\
+	if (pos != Name##_end(self)) {\
+		/* nodeの所有権は呼び出し側に残る */\
+		if (success) *success = 0;\
+		return pos;\
+	}\
+	/* rehash */\
+	if (self->size + 1 > self->max_load_factor * Name##_bucket_count(self)) {\
+		size_t s = (size_t) ((self->size + 1) / self->max_load_factor) + 1;\
+		if (!Name##_grow(self, s)) {\
+			if (success) *success = 0;\
+			return 0;\
+		}\
+		idx = Name##_bucket_of(self, hash_val);\
+	}\
+	alias = Name##Node_Vector_at(self->buckets, idx);\
+	*alias = Name##Node_insert(*alias, node, alias);\
+	CSTL_HASHTABLE_LINK(Name##_link_before(&self->end_node, node);)\
+	Name##_bloom_add(self, hash_val);\
+	self->size++;\
+	CSTL_MAGIC(node->magic = self->buckets);\
+	if (success) *success = 1;\
+	return node;\
+}\
 \
-		idx = Hasher(node->key) % nbuckets;\
-		alias = Name##Node_Vector_at(new_buckets, idx);\
-		/* 同じキーを並べるため、バケットの各要素のキーをチェック */\
-		for (pos = *alias, prev = 0; pos != 0; prev = pos, pos = pos->next) {\
-			if (Compare(node->key, pos->key) == 0) {\
-				pos = Name##Node_insert(pos, node, alias);\
-				if (prev) {\
-					prev->next = pos;\
-				} else {\
-					*alias = pos;\
-				}\
-				goto next;\
+
+
+#define CSTL_HASHTABLE_IMPLEMENT_INSERT_NODE_MULTI(Name, KeyType, ValueType, Hasher, Compare)	\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node)\
+{\
+	Name##Node **alias;\
+	register Name##Node *pos;\
+	register Name##Node *prev;\
+	size_t hash_val;\
+	size_t idx;\
+	CSTL_ASSERT(self && "UnorderedMulti(Set|Map)_insert_node");\
+	CSTL_ASSERT(self->magic == self && "UnorderedMulti(Set|Map)_insert_node");\
+	CSTL_ASSERT(node && "UnorderedMulti(Set|Map)_insert_node");\
+	CSTL_ASSERT(node->magic == (Name##Node_Vector *) node && "UnorderedMulti(Set|Map)_insert_node");\
+	hash_val = Hasher(node->key);\
+	idx = Name##_bucket_of(self, hash_val);\
+	/* rehash */\
+	if (self->size + 1 > self->max_load_factor * Name##_bucket_count(self)) {\
+		size_t s = (size_t) ((self->size + 1) / self->max_load_factor) + 1;\
+		if (!Name##_grow(self, s)) {\
+			/* nodeの所有権は呼び出し側に残る */\
+			return 0;\
+		}\
+		idx = Name##_bucket_of(self, hash_val);\
+	}\
+	alias = Name##Node_Vector_at(self->buckets, idx);\
+	/* 同じキーを並べるため、バケットの各要素のキーをチェック */\
+	for (pos = *alias, prev = 0; pos != 0; prev = pos, pos = pos->next) {\
+		if (Compare(node->key, pos->key) == 0) {\
+			pos = Name##Node_insert(pos, node, alias);\
+			if (prev) {\
+				prev->next = pos;\
+			} else {\
+				*alias = pos;\
 			}\
+			CSTL_HASHTABLE_LINK(Name##_link_before(node->next, node);)\
+			self->size++;\
+			CSTL_MAGIC(node->magic = self->buckets);\
+			return node;\
 		}\
-		*alias = Name##Node_insert(*alias, node, alias);\
-next:\
-		node = tmp;\
 	}\
-	/* end()を指すポインタ */\
-	*Name##Node_Vector_back(new_buckets) = &self->end_node;\
-	CSTL_ASSERT(Name##_begin(self) == Name##_end(self) && "UnorderedMulti(Set|Map)_rehash");\
-\
-	Name##Node_Vector_swap(self->buckets, new_buckets);\
-	Name##Node_Vector_delete(new_buckets);\
-	return 1;\
+	*alias = Name##Node_insert(*alias, node, alias);\
+	CSTL_HASHTABLE_LINK(Name##_link_before(&self->end_node, node);)\
+	Name##_bloom_add(self, hash_val);\
+	self->size++;\
+	CSTL_MAGIC(node->magic = self->buckets);\
+	return node;\
 }\
 \
 
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2006-2010, KATO Noriaki
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*!
+ * \file intern.h
+ * \brief 文字列のインターン
+ * \author KATO Noriaki <katono@users.sourceforge.jp>
+ * \date 2026-10-19
+ * $URL$
+ * $Id$
+ */
+#ifndef CSTL_INTERN_H_INCLUDED
+#define CSTL_INTERN_H_INCLUDED
+
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "unordered_set.h"
+#include "string.h"
+
+
+/*!
+ * \brief インターフェイスマクロ
+ *
+ * \param Name コンテナ名
+ * \param Type 文字の型
+ */
+#define CSTL_INTERN_INTERFACE(Name, Type)	\
+typedef struct Name Name;\
+typedef struct Name##Entry *Name##Handle;\
+\
+CSTL_EXTERN_C_BEGIN()\
+Name *Name##_new(void);\
+void Name##_delete(Name *self);\
+size_t Name##_size(Name *self);\
+int Name##_empty(Name *self);\
+Name##Handle Name##_intern(Name *self, const Type *cstr);\
+Name##Handle Name##_intern_len(Name *self, const Type *chars, size_t chars_len);\
+Name##Handle Name##_lookup(Name *self, const Type *cstr);\
+Name##Handle Name##_lookup_len(Name *self, const Type *chars, size_t chars_len);\
+Name##Handle Name##_retain(Name##Handle h);\
+void Name##_release(Name *self, Name##Handle h);\
+const Type *Name##_c_str(Name##Handle h);\
+size_t Name##_length(Name##Handle h);\
+size_t Name##_hash(Name##Handle h);\
+size_t Name##_refcount(Name##Handle h);\
+CSTL_EXTERN_C_END()\
+
+
+/*!
+ * \brief 実装マクロ
+ *
+ * \param Name コンテナ名
+ * \param Type 文字の型
+ */
+#define CSTL_INTERN_IMPLEMENT(Name, Type)	\
+\
+/*! \
+ * \brief インターンされた文字列\
+ * \
+ * 文字列本体は構造体の直後に0で終端して格納する。\
+ */\
+struct Name##Entry {\
+	size_t hash;\
+	size_t refcount;\
+	size_t size;\
+	const Type *str;\
+	CSTL_MAGIC(Name *magic;)\
+};\
+\
+static size_t Name##Entry_hash(Name##Handle e)\
+{\
+	return e->hash;\
+}\
+\
+static int Name##Entry_compare(Name##Handle x, Name##Handle y)\
+{\
+	if (x->hash != y->hash || x->size != y->size) {\
+		return 1;\
+	}\
+	return memcmp(x->str, y->str, sizeof(Type) * x->size);\
+}\
+\
+CSTL_STRING_MYSTRLEN(Name, Type)\
+\
+CSTL_UNORDERED_SET_INTERFACE(Name##_EntrySet, Name##Handle)\
+\
+static size_t Name##_hash_chars(const Type *chars, size_t len)\
+{\
+	return Name##_EntrySet_hash_bytes(chars, sizeof(Type) * len);\
+}\
+\
+CSTL_UNORDERED_SET_IMPLEMENT(Name##_EntrySet, Name##Handle, Name##Entry_hash, Name##Entry_compare)\
+\
+/*! \
+ * \brief intern構造体\
+ */\
+struct Name {\
+	Name##_EntrySet *set;\
+	CSTL_MAGIC(Name *magic;)\
+};\
+\
+Name *Name##_new(void)\
+{\
+	Name *self;\
+	self = (Name *) malloc(sizeof(Name));\
+	if (!self) return 0;\
+	self->set = Name##_EntrySet_new();\
+	if (!self->set) {\
+		free(self);\
+		return 0;\
+	}\
+	CSTL_MAGIC(self->magic = self);\
+	return self;\
+}\
+\
+void Name##_delete(Name *self)\
+{\
+	Name##_EntrySetIterator pos;\
+	if (!self) return;\
+	CSTL_ASSERT(self->magic == self && "Intern_delete");\
+	for (pos = Name##_EntrySet_begin(self->set); pos != Name##_EntrySet_end(self->set);\
+			pos = Name##_EntrySet_next(pos)) {\
+		Name##Handle e = *Name##_EntrySet_data(pos);\
+		CSTL_MAGIC(e->magic = 0);\
+		free(e);\
+	}\
+	Name##_EntrySet_delete(self->set);\
+	CSTL_MAGIC(self->magic = 0);\
+	free(self);\
+}\
+\
+size_t Name##_size(Name *self)\
+{\
+	CSTL_ASSERT(self && "Intern_size");\
+	CSTL_ASSERT(self->magic == self && "Intern_size");\
+	return Name##_EntrySet_size(self->set);\
+}\
+\
+int Name##_empty(Name *self)\
+{\
+	CSTL_ASSERT(self && "Intern_empty");\
+	CSTL_ASSERT(self->magic == self && "Intern_empty");\
+	return Name##_EntrySet_empty(self->set);\
+}\
+\
+static Name##_EntrySetIterator Name##_find_entry(Name *self, const Type *chars, size_t chars_len, size_t hash)\
+{\
+	struct Name##Entry probe;\
+	probe.hash = hash;\
+	probe.size = chars_len;\
+	probe.str = chars;\
+	return Name##_EntrySet_find(self->set, &probe);\
+}\
+\
+Name##Handle Name##_intern(Name *self, const Type *cstr)\
+{\
+	CSTL_ASSERT(self && "Intern_intern");\
+	CSTL_ASSERT(self->magic == self && "Intern_intern");\
+	CSTL_ASSERT(cstr && "Intern_intern");\
+	return Name##_intern_len(self, cstr, CSTL_NPOS);\
+}\
+\
+Name##Handle Name##_intern_len(Name *self, const Type *chars, size_t chars_len)\
+{\
+	Name##_EntrySetIterator pos;\
+	Name##Handle e;\
+	size_t hash;\
+	int success;\
+	CSTL_ASSERT(self && "Intern_intern_len");\
+	CSTL_ASSERT(self->magic == self && "Intern_intern_len");\
+	CSTL_ASSERT(chars && "Intern_intern_len");\
+	if (chars_len == CSTL_NPOS) {\
+		chars_len = Name##_mystrlen(chars);\
+	}\
+	hash = Name##_hash_chars(chars, chars_len);\
+	pos = Name##_find_entry(self, chars, chars_len, hash);\
+	if (pos != Name##_EntrySet_end(self->set)) {\
+		e = *Name##_EntrySet_data(pos);\
+		e->refcount++;\
+		return e;\
+	}\
+	e = (Name##Handle) malloc(sizeof(struct Name##Entry) + sizeof(Type) * (chars_len + 1));\
+	if (!e) return 0;\
+	e->hash = hash;\
+	e->refcount = 1;\
+	e->size = chars_len;\
+	e->str = (const Type *) (e + 1);\
+	memcpy((Type *) (e + 1), chars, sizeof(Type) * chars_len);\
+	((Type *) (e + 1))[chars_len] = '\0';\
+	CSTL_MAGIC(e->magic = self);\
+	if (!Name##_EntrySet_insert(self->set, e, &success)) {\
+		free(e);\
+		return 0;\
+	}\
+	CSTL_ASSERT(success && "Intern_intern_len");\
+	return e;\
+}\
+\
+Name##Handle Name##_lookup(Name *self, const Type *cstr)\
+{\
+	CSTL_ASSERT(self && "Intern_lookup");\
+	CSTL_ASSERT(self->magic == self && "Intern_lookup");\
+	CSTL_ASSERT(cstr && "Intern_lookup");\
+	return Name##_lookup_len(self, cstr, CSTL_NPOS);\
+}\
+\
+Name##Handle Name##_lookup_len(Name *self, const Type *chars, size_t chars_len)\
+{\
+	Name##_EntrySetIterator pos;\
+	CSTL_ASSERT(self && "Intern_lookup_len");\
+	CSTL_ASSERT(self->magic == self && "Intern_lookup_len");\
+	CSTL_ASSERT(chars && "Intern_lookup_len");\
+	if (chars_len == CSTL_NPOS) {\
+		chars_len = Name##_mystrlen(chars);\
+	}\
+	pos = Name##_find_entry(self, chars, chars_len, Name##_hash_chars(chars, chars_len));\
+	if (pos == Name##_EntrySet_end(self->set)) {\
+		return 0;\
+	}\
+	return *Name##_EntrySet_data(pos);\
+}\
+\
+Name##Handle Name##_retain(Name##Handle h)\
+{\
+	CSTL_ASSERT(h && "Intern_retain");\
+	CSTL_ASSERT(h->magic && "Intern_retain");\
+	h->refcount++;\
+	return h;\
+}\
+\
+void Name##_release(Name *self, Name##Handle h)\
+{\
+	Name##_EntrySetIterator pos;\
+	CSTL_ASSERT(self && "Intern_release");\
+	CSTL_ASSERT(self->magic == self && "Intern_release");\
+	CSTL_ASSERT(h && "Intern_release");\
+	CSTL_ASSERT(h->magic == self && "Intern_release");\
+	CSTL_ASSERT(h->refcount > 0 && "Intern_release");\
+	if (--h->refcount > 0) {\
+		return;\
+	}\
+	pos = Name##_EntrySet_find(self->set, h);\
+	CSTL_ASSERT(pos != Name##_EntrySet_end(self->set) && "Intern_release");\
+	Name##_EntrySet_erase(self->set, pos);\
+	CSTL_MAGIC(h->magic = 0);\
+	free(h);\
+}\
+\
+const Type *Name##_c_str(Name##Handle h)\
+{\
+	CSTL_ASSERT(h && "Intern_c_str");\
+	CSTL_ASSERT(h->magic && "Intern_c_str");\
+	return h->str;\
+}\
+\
+size_t Name##_length(Name##Handle h)\
+{\
+	CSTL_ASSERT(h && "Intern_length");\
+	CSTL_ASSERT(h->magic && "Intern_length");\
+	return h->size;\
+}\
+\
+size_t Name##_hash(Name##Handle h)\
+{\
+	CSTL_ASSERT(h && "Intern_hash");\
+	CSTL_ASSERT(h->magic && "Intern_hash");\
+	return h->hash;\
+}\
+\
+size_t Name##_refcount(Name##Handle h)\
+{\
+	CSTL_ASSERT(h && "Intern_refcount");\
+	CSTL_ASSERT(h->magic && "Intern_refcount");\
+	return h->refcount;\
+}\
+\
+
+
+#endif /* CSTL_INTERN_H_INCLUDED */
@@ -47,6 +47,9 @@ struct Name##RBTree {\
 	struct Name##RBTree *left;\
 	struct Name##RBTree *right;\
 	int color;\
+	CSTL_RBTREE_SIZE(size_t size;)\
+	CSTL_RBTREE_LINK(struct Name##RBTree *next;)\
+	CSTL_RBTREE_LINK(struct Name##RBTree *prev;)\
 	KeyType key;\
 	ValueType value;\
 	CSTL_MAGIC(struct Name##RBTree *magic;)\
@@ -84,6 +87,67 @@ ValueType *Name##_value(Name##Iterator pos)\
 	return &pos->value;\
 }\
 \
+KeyType *Name##_node_key(Name##Iterator node)\
+{\
+	CSTL_ASSERT(node && "Map_node_key");\
+	CSTL_ASSERT(node->magic == node && "Map_node_key");\
+	return &node->key;\
+}\
+\
+static int Name##RBTree_insert_range(Name *self, Name##Iterator first, Name##Iterator last, int unique)\
+{\
+	register Name##Iterator pos;\
+	register Name##Iterator tmp;\
+	Name##RBTree head;\
+	register size_t count = 0;\
+	head.right = (Name##RBTree *) &Name##RBTree_nil;\
+	tmp = &head;\
+	/* イテレータの範囲はソート済みなので、コピーをそのまま並べる */\
+	for (pos = first; pos != last; pos = Name##_next(pos)) {\
+		tmp->right = Name##RBTree_new_node(pos->key, &pos->value, Name##_COLOR_RED);\
+		if (!tmp->right) {\
+			for (pos = head.right; pos != 0; pos = tmp) {\
+				tmp = pos->right;\
+				free(pos);\
+			}\
+			return 0;\
+		}\
+		tmp = tmp->right;\
+		count++;\
+	}\
+	self->size += Name##RBTree_insert_sorted(self->tree, self->size, head.right, count, unique);\
+	return 1;\
+}\
+\
+static int Name##RBTree_insert_array(Name *self, KeyType const *keys, ValueType const *values, size_t n, int unique)\
+{\
+	register Name##Iterator pos;\
+	register Name##Iterator tmp;\
+	Name##RBTree head;\
+	register size_t i;\
+	register size_t count = 0;\
+	head.right = (Name##RBTree *) &Name##RBTree_nil;\
+	tmp = &head;\
+	for (i = 0; i < n; i++) {\
+		if (i > 0) {\
+			CSTL_ASSERT(Compare(keys[i - 1], keys[i]) <= 0 && "(Map|MultiMap)_build_from_sorted_array");\
+			if (unique && Compare(keys[i - 1], keys[i]) == 0) continue;\
+		}\
+		tmp->right = Name##RBTree_new_node(keys[i], &values[i], Name##_COLOR_RED);\
+		if (!tmp->right) {\
+			for (pos = head.right; pos != 0; pos = tmp) {\
+				tmp = pos->right;\
+				free(pos);\
+			}\
+			return 0;\
+		}\
+		tmp = tmp->right;\
+		count++;\
+	}\
+	self->size += Name##RBTree_insert_sorted(self->tree, self->size, head.right, count, unique);\
+	return 1;\
+}\
+\
 
 
 /*! 
@@ -98,9 +162,14 @@ CSTL_EXTERN_C_BEGIN()\
 CSTL_RBTREE_WRAPPER_INTERFACE(Name, KeyType, ValueType)\
 Name##Iterator Name##_insert(Name *self, KeyType key, ValueType value, int *success);\
 Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value, int *success);\
+Name##Iterator Name##_insert_hint(Name *self, Name##Iterator hint, KeyType key, ValueType value, int *success);\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node, int *success);\
 KeyType const *Name##_key(Name##Iterator pos);\
+KeyType *Name##_node_key(Name##Iterator node);\
 ValueType *Name##_value(Name##Iterator pos);\
+int Name##_build_from_sorted_array(Name *self, KeyType const *keys, ValueType const *values, size_t n);\
 ValueType *Name##_at(Name *self, KeyType key);\
+ValueType *Name##_at_ref(Name *self, KeyType const *key);\
 CSTL_EXTERN_C_END()\
 
 /*! 
@@ -128,7 +197,7 @@ Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value
 	CSTL_ASSERT(self && "Map_insert_ref");\
 	CSTL_ASSERT(self->magic == self && "Map_insert_ref");\
 	CSTL_ASSERT(value && "Map_insert_ref");\
-	pos = Name##RBTree_find(self->tree, key);\
+	pos = Name##RBTree_find(self->tree, &key);\
 	if (pos == Name##RBTree_end(self->tree)) {\
 		pos = Name##RBTree_new_node(key, value, Name##_COLOR_RED);\
 		if (pos) {\
@@ -144,52 +213,89 @@ Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value
 	return pos;\
 }\
 \
+Name##Iterator Name##_insert_hint(Name *self, Name##Iterator hint, KeyType key, ValueType value, int *success)\
+{\
+	Name##Iterator pos;\
+	Name##RBTree *parent;\
+	int dir;\
+	CSTL_ASSERT(self && "Map_insert_hint");\
+	CSTL_ASSERT(self->magic == self && "Map_insert_hint");\
+	CSTL_ASSERT(hint && "Map_insert_hint");\
+	CSTL_ASSERT(hint->magic && "Map_insert_hint");\
+	parent = Name##RBTree_hint_parent(self->tree, hint, key, 1, &dir);\
+	if (!parent) {\
+		return Name##_insert_ref(self, key, &value, success);\
+	}\
+	if (dir == 0) {\
+		if (success) *success = 0;\
+		return parent;\
+	}\
+	pos = Name##RBTree_new_node(key, &value, Name##_COLOR_RED);\
+	if (pos) {\
+		Name##RBTree_insert_at(self->tree, parent, dir, pos);\
+		if (success) *success = 1;\
+		self->size++;\
+	} else {\
+		if (success) *success = 0;\
+	}\
+	return pos;\
+}\
+\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node, int *success)\
+{\
+	Name##Iterator pos;\
+	CSTL_ASSERT(self && "Map_insert_node");\
+	CSTL_ASSERT(self->magic == self && "Map_insert_node");\
+	CSTL_ASSERT(node && "Map_insert_node");\
+	CSTL_ASSERT(node->magic == node && "Map_insert_node");\
+	pos = Name##RBTree_find(self->tree, &node->key);\
+	if (pos != Name##RBTree_end(self->tree)) {\
+		/* nodeの所有権は呼び出し側に残る */\
+		if (success) *success = 0;\
+		return pos;\
+	}\
+	Name##RBTree_insert(self->tree, node);\
+	self->size++;\
+	if (success) *success = 1;\
+	return node;\
+}\
+\
 int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
 {\
-	register Name##Iterator pos;\
-	register Name##Iterator tmp;\
-	Name##RBTree head;\
-	register size_t count = 0;\
 	CSTL_ASSERT(self && "Map_insert_range");\
 	CSTL_ASSERT(self->magic == self && "Map_insert_range");\
 	CSTL_ASSERT(first && "Map_insert_range");\
 	CSTL_ASSERT(last && "Map_insert_range");\
 	CSTL_ASSERT(first->magic && "Map_insert_range");\
 	CSTL_ASSERT(last->magic && "Map_insert_range");\
-	head.right = (Name##RBTree *) &Name##RBTree_nil;\
-	tmp = &head;\
-	for (pos = first; pos != last; pos = Name##_next(pos)) {\
-		if (Name##RBTree_find(self->tree, pos->key) == Name##RBTree_end(self->tree)) {\
-			tmp->right = Name##RBTree_new_node(pos->key, &pos->value, Name##_COLOR_RED);\
-			if (!tmp->right) {\
-				for (pos = head.right; pos != 0; pos = tmp) {\
-					tmp = pos->right;\
-					free(pos);\
-				}\
-				return 0;\
-			}\
-			tmp = tmp->right;\
-			count++;\
-		}\
-	}\
-	for (pos = head.right; pos != (Name##RBTree *) &Name##RBTree_nil; pos = tmp) {\
-		tmp = pos->right;\
-		pos->right = (Name##RBTree *) &Name##RBTree_nil;\
-		Name##RBTree_insert(self->tree, pos);\
-	}\
-	self->size += count;\
-	return 1;\
+	return Name##RBTree_insert_range(self, first, last, 1);\
+}\
+\
+int Name##_build_from_sorted_array(Name *self, KeyType const *keys, ValueType const *values, size_t n)\
+{\
+	CSTL_ASSERT(self && "Map_build_from_sorted_array");\
+	CSTL_ASSERT(self->magic == self && "Map_build_from_sorted_array");\
+	CSTL_ASSERT(((keys && values) || n == 0) && "Map_build_from_sorted_array");\
+	return Name##RBTree_insert_array(self, keys, values, n, 1);\
 }\
 \
 ValueType *Name##_at(Name *self, KeyType key)\
 {\
-	Name##Iterator pos;\
 	CSTL_ASSERT(self && "Map_at");\
 	CSTL_ASSERT(self->magic == self && "Map_at");\
+	return Name##_at_ref(self, &key);\
+}\
+\
+ValueType *Name##_at_ref(Name *self, KeyType const *key)\
+{\
+	Name##Iterator pos;\
+	CSTL_ASSERT(self && "Map_at_ref");\
+	CSTL_ASSERT(self->magic == self && "Map_at_ref");\
+	CSTL_ASSERT(key && "Map_at_ref");\
 	pos = Name##RBTree_find(self->tree, key);\
 	if (pos == Name##RBTree_end(self->tree)) {\
 		/* 新しい要素の値にはnilの値を使用 */\
-		pos = Name##RBTree_new_node(key, &Name##RBTree_nil.value, Name##_COLOR_RED);\
+		pos = Name##RBTree_new_node(*key, &Name##RBTree_nil.value, Name##_COLOR_RED);\
 		if (pos) {\
 			Name##RBTree_insert(self->tree, pos);\
 			self->size++;\
@@ -215,8 +321,12 @@ CSTL_EXTERN_C_BEGIN()\
 CSTL_RBTREE_WRAPPER_INTERFACE(Name, KeyType, ValueType)\
 Name##Iterator Name##_insert(Name *self, KeyType key, ValueType value);\
 Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value);\
+Name##Iterator Name##_insert_hint(Name *self, Name##Iterator hint, KeyType key, ValueType value);\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node);\
 KeyType const *Name##_key(Name##Iterator pos);\
+KeyType *Name##_node_key(Name##Iterator node);\
 ValueType *Name##_value(Name##Iterator pos);\
+int Name##_build_from_sorted_array(Name *self, KeyType const *keys, ValueType const *values, size_t n);\
 CSTL_EXTERN_C_END()\
 
 /*! 
@@ -252,39 +362,55 @@ Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value
 	return pos;\
 }\
 \
+Name##Iterator Name##_insert_hint(Name *self, Name##Iterator hint, KeyType key, ValueType value)\
+{\
+	Name##Iterator pos;\
+	Name##RBTree *parent;\
+	int dir;\
+	CSTL_ASSERT(self && "MultiMap_insert_hint");\
+	CSTL_ASSERT(self->magic == self && "MultiMap_insert_hint");\
+	CSTL_ASSERT(hint && "MultiMap_insert_hint");\
+	CSTL_ASSERT(hint->magic && "MultiMap_insert_hint");\
+	parent = Name##RBTree_hint_parent(self->tree, hint, key, 0, &dir);\
+	if (!parent) {\
+		return Name##_insert_ref(self, key, &value);\
+	}\
+	pos = Name##RBTree_new_node(key, &value, Name##_COLOR_RED);\
+	if (pos) {\
+		Name##RBTree_insert_at(self->tree, parent, dir, pos);\
+		self->size++;\
+	}\
+	return pos;\
+}\
+\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node)\
+{\
+	CSTL_ASSERT(self && "MultiMap_insert_node");\
+	CSTL_ASSERT(self->magic == self && "MultiMap_insert_node");\
+	CSTL_ASSERT(node && "MultiMap_insert_node");\
+	CSTL_ASSERT(node->magic == node && "MultiMap_insert_node");\
+	Name##RBTree_insert(self->tree, node);\
+	self->size++;\
+	return node;\
+}\
+\
 int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
 {\
-	register Name##Iterator pos;\
-	register Name##Iterator tmp;\
-	Name##RBTree head;\
-	register size_t count = 0;\
 	CSTL_ASSERT(self && "MultiMap_insert_range");\
 	CSTL_ASSERT(self->magic == self && "MultiMap_insert_range");\
 	CSTL_ASSERT(first && "MultiMap_insert_range");\
 	CSTL_ASSERT(last && "MultiMap_insert_range");\
 	CSTL_ASSERT(first->magic && "MultiMap_insert_range");\
 	CSTL_ASSERT(last->magic && "MultiMap_insert_range");\
-	head.right = (Name##RBTree *) &Name##RBTree_nil;\
-	tmp = &head;\
-	for (pos = first; pos != last; pos = Name##_next(pos)) {\
-		tmp->right = Name##RBTree_new_node(pos->key, &pos->value, Name##_COLOR_RED);\
-		if (!tmp->right) {\
-			for (pos = head.right; pos != 0; pos = tmp) {\
-				tmp = pos->right;\
-				free(pos);\
-			}\
-			return 0;\
-		}\
-		tmp = tmp->right;\
-		count++;\
-	}\
-	for (pos = head.right; pos != (Name##RBTree *) &Name##RBTree_nil; pos = tmp) {\
-		tmp = pos->right;\
-		pos->right = (Name##RBTree *) &Name##RBTree_nil;\
-		Name##RBTree_insert(self->tree, pos);\
-	}\
-	self->size += count;\
-	return 1;\
+	return Name##RBTree_insert_range(self, first, last, 0);\
+}\
+\
+int Name##_build_from_sorted_array(Name *self, KeyType const *keys, ValueType const *values, size_t n)\
+{\
+	CSTL_ASSERT(self && "MultiMap_build_from_sorted_array");\
+	CSTL_ASSERT(self->magic == self && "MultiMap_build_from_sorted_array");\
+	CSTL_ASSERT(((keys && values) || n == 0) && "MultiMap_build_from_sorted_array");\
+	return Name##RBTree_insert_array(self, keys, values, n, 0);\
 }\
 \
 
@@ -0,0 +1,484 @@
+/*
+ * Copyright (c) 2006-2010, KATO Noriaki
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*!
+ * \file persistent_map.h
+ * \brief スナップショットをO(1)で作れる永続的なmap
+ * \author KATO Noriaki <katono@users.sourceforge.jp>
+ * \date 2026-10-19
+ * $URL$
+ * $Id$
+ */
+#ifndef CSTL_PERSISTENT_MAP_H_INCLUDED
+#define CSTL_PERSISTENT_MAP_H_INCLUDED
+
+#include <stdlib.h>
+#include "common.h"
+#include "atomic.h"
+
+#ifndef CSTL_LESS
+#define CSTL_LESS(x, y)		((x) == (y) ? 0 : (x) < (y) ? -1 : 1)
+#define CSTL_GREATER(x, y)	((x) == (y) ? 0 : (x) > (y) ? -1 : 1)
+#endif
+
+
+/*!
+ * \brief インターフェイスマクロ
+ *
+ * \param Name コンテナ名
+ * \param KeyType 要素のキーの型
+ * \param ValueType 要素の値の型
+ */
+#define CSTL_PERSISTENT_MAP_INTERFACE(Name, KeyType, ValueType)	\
+typedef struct Name Name;\
+\
+CSTL_EXTERN_C_BEGIN()\
+Name *Name##_new(void);\
+void Name##_delete(Name *self);\
+void Name##_clear(Name *self);\
+int Name##_empty(Name *self);\
+size_t Name##_size(Name *self);\
+Name *Name##_snapshot(Name *self);\
+int Name##_insert(Name *self, KeyType key, ValueType value, int *success);\
+int Name##_assign(Name *self, KeyType key, ValueType value);\
+size_t Name##_erase_key(Name *self, KeyType key);\
+ValueType const *Name##_find(Name *self, KeyType key);\
+size_t Name##_count(Name *self, KeyType key);\
+void Name##_for_each(Name *self, void (*func)(KeyType const *key, ValueType const *value, void *arg), void *arg);\
+void Name##_swap(Name *self, Name *x);\
+CSTL_EXTERN_C_END()\
+
+
+/*!
+ * \brief 実装マクロ
+ *
+ * \param Name コンテナ名
+ * \param KeyType 要素のキーの型
+ * \param ValueType 要素の値の型
+ * \param Compare 要素の比較ルーチン
+ */
+#define CSTL_PERSISTENT_MAP_IMPLEMENT(Name, KeyType, ValueType, Compare)	\
+\
+/*! \
+ * \brief ノード\
+ *\
+ * 親へのポインタを持たないので、複数の版の木で部分木を共有できる。\
+ * refcountはこのノードを指している親ノードと根の数である。\
+ * refcountが1のノードは今の版だけのものなので、その場で書き換えてよい。\
+ */\
+typedef struct Name##Node {\
+	struct Name##Node *left;\
+	struct Name##Node *right;\
+	volatile long refcount;\
+	int height;\
+	KeyType key;\
+	ValueType value;\
+} Name##Node;\
+\
+/*! \
+ * \brief persistent_map構造体\
+ */\
+struct Name {\
+	Name##Node *root;\
+	size_t size;\
+	Name##Node *spare; /* 更新の途中でメモリ不足にならないよう、先に確保しておくノード。leftでつなぐ */\
+	size_t nspare;\
+	CSTL_MAGIC(Name *magic;)\
+};\
+\
+static int Name##_height(Name##Node *t)\
+{\
+	return t ? t->height : 0;\
+}\
+\
+static void Name##_fix_height(Name##Node *t)\
+{\
+	int l = Name##_height(t->left);\
+	int r = Name##_height(t->right);\
+	t->height = (l > r ? l : r) + 1;\
+}\
+\
+static Name##Node *Name##_retain(Name##Node *t)\
+{\
+	if (t) CSTL_ATOMIC_ADD(&t->refcount, 1);\
+	return t;\
+}\
+\
+/* 参照を1つ手放す。他の版からも参照されなくなったノードは解放する */\
+static void Name##_release(Name##Node *t)\
+{\
+	Name##Node *right;\
+	while (t && CSTL_ATOMIC_ADD(&t->refcount, -1) == 1) {\
+		Name##_release(t->left);\
+		right = t->right;\
+		free(t);\
+		t = right;\
+	}\
+}\
+\
+/* \
+ * 1回の挿入・削除で確保するノード数の上限だけ予備を確保する。\
+ * 木の高さをHとすると、経路上のノードの複製がH個、回転のための兄弟の複製が2H個、新しいノードが1個である。\
+ */\
+static int Name##_reserve_nodes(Name *self)\
+{\
+	size_t n = (size_t) Name##_height(self->root) * 3 + 2;\
+	Name##Node *node;\
+	while (self->nspare < n) {\
+		node = (Name##Node *) malloc(sizeof(Name##Node));\
+		if (!node) return 0;\
+		node->left = self->spare;\
+		self->spare = node;\
+		self->nspare++;\
+	}\
+	return 1;\
+}\
+\
+static Name##Node *Name##_node_alloc(Name *self)\
+{\
+	Name##Node *node = self->spare;\
+	CSTL_ASSERT(node && "PersistentMap_node_alloc");\
+	self->spare = node->left;\
+	self->nspare--;\
+	node->refcount = 1;\
+	return node;\
+}\
+\
+/* \
+ * tへの参照を1つ受け取り、同じ内容で書き換え可能なノードを返す。\
+ * 他の版と共有しているならば複製し、子は複製と元のノードで共有する。\
+ */\
+static Name##Node *Name##_own(Name *self, Name##Node *t)\
+{\
+	Name##Node *n;\
+	if (CSTL_ATOMIC_LOAD(&t->refcount) == 1) return t;\
+	n = Name##_node_alloc(self);\
+	n->left = Name##_retain(t->left);\
+	n->right = Name##_retain(t->right);\
+	n->height = t->height;\
+	n->key = t->key;\
+	n->value = t->value;\
+	Name##_release(t);\
+	return n;\
+}\
+\
+/* tとt->leftは書き換え可能であること */\
+static Name##Node *Name##_rotate_right(Name##Node *t)\
+{\
+	Name##Node *l = t->left;\
+	t->left = l->right;\
+	l->right = t;\
+	Name##_fix_height(t);\
+	Name##_fix_height(l);\
+	return l;\
+}\
+\
+/* tとt->rightは書き換え可能であること */\
+static Name##Node *Name##_rotate_left(Name##Node *t)\
+{\
+	Name##Node *r = t->right;\
+	t->right = r->left;\
+	r->left = t;\
+	Name##_fix_height(t);\
+	Name##_fix_height(r);\
+	return r;\
+}\
+\
+/* \
+ * 左右の部分木の高さの差が2以下の書き換え可能なノードtをAVL木の条件を満たすように回転し、\
+ * 新しい部分木の根を返す。回転で動かすノードは書き換え可能にしてから動かす。\
+ */\
+static Name##Node *Name##_balance(Name *self, Name##Node *t)\
+{\
+	int l = Name##_height(t->left);\
+	int r = Name##_height(t->right);\
+	if (l > r + 1) {\
+		t->left = Name##_own(self, t->left);\
+		if (Name##_height(t->left->left) < Name##_height(t->left->right)) {\
+			t->left->right = Name##_own(self, t->left->right);\
+			t->left = Name##_rotate_left(t->left);\
+		}\
+		return Name##_rotate_right(t);\
+	}\
+	if (r > l + 1) {\
+		t->right = Name##_own(self, t->right);\
+		if (Name##_height(t->right->right) < Name##_height(t->right->left)) {\
+			t->right->left = Name##_own(self, t->right->left);\
+			t->right = Name##_rotate_right(t->right);\
+		}\
+		return Name##_rotate_left(t);\
+	}\
+	Name##_fix_height(t);\
+	return t;\
+}\
+\
+/* \
+ * 部分木tにkeyを挿入または値を設定した部分木を返す。tへの参照を1つ受け取る。\
+ * 経路上のノードだけを書き換え可能にする。\
+ */\
+static Name##Node *Name##_insert_node(Name *self, Name##Node *t, KeyType const *key, ValueType const *value)\
+{\
+	int cmp;\
+	if (!t) {\
+		t = Name##_node_alloc(self);\
+		t->left = 0;\
+		t->right = 0;\
+		t->height = 1;\
+		t->key = *key;\
+		t->value = *value;\
+		self->size++;\
+		return t;\
+	}\
+	cmp = Compare(*key, t->key);\
+	t = Name##_own(self, t);\
+	if (cmp < 0) {\
+		t->left = Name##_insert_node(self, t->left, key, value);\
+	} else if (cmp > 0) {\
+		t->right = Name##_insert_node(self, t->right, key, value);\
+	} else {\
+		t->value = *value;\
+		return t;\
+	}\
+	return Name##_balance(self, t);\
+}\
+\
+/* 部分木tから最小のノードを外して*minに格納し、残りの部分木を返す。tへの参照を1つ受け取る */\
+static Name##Node *Name##_erase_min(Name *self, Name##Node *t, Name##Node **min)\
+{\
+	Name##Node *r;\
+	t = Name##_own(self, t);\
+	if (!t->left) {\
+		r = t->right;\
+		t->right = 0;\
+		*min = t;\
+		return r;\
+	}\
+	t->left = Name##_erase_min(self, t->left, min);\
+	return Name##_balance(self, t);\
+}\
+\
+/* 部分木tからkeyのノードを削除した部分木を返す。tへの参照を1つ受け取る。keyが存在すること */\
+static Name##Node *Name##_erase_node(Name *self, Name##Node *t, KeyType const *key)\
+{\
+	Name##Node *min;\
+	Name##Node *child;\
+	int cmp = Compare(*key, t->key);\
+	t = Name##_own(self, t);\
+	if (cmp < 0) {\
+		t->left = Name##_erase_node(self, t->left, key);\
+		return Name##_balance(self, t);\
+	}\
+	if (cmp > 0) {\
+		t->right = Name##_erase_node(self, t->right, key);\
+		return Name##_balance(self, t);\
+	}\
+	self->size--;\
+	if (!t->left || !t->right) {\
+		child = t->left ? t->left : t->right;\
+		t->left = 0;\
+		t->right = 0;\
+		Name##_release(t);\
+		return child;\
+	}\
+	/* 右部分木の最小のノードで置き換える */\
+	t->right = Name##_erase_min(self, t->right, &min);\
+	min->left = t->left;\
+	min->right = t->right;\
+	t->left = 0;\
+	t->right = 0;\
+	Name##_release(t);\
+	return Name##_balance(self, min);\
+}\
+\
+static Name##Node *Name##_find_node(Name *self, KeyType const *key)\
+{\
+	register Name##Node *t = self->root;\
+	register int cmp;\
+	while (t) {\
+		cmp = Compare(*key, t->key);\
+		if (cmp < 0) {\
+			t = t->left;\
+		} else if (cmp > 0) {\
+			t = t->right;\
+		} else {\
+			return t;\
+		}\
+	}\
+	return 0;\
+}\
+\
+static void Name##_for_each_node(Name##Node *t, void (*func)(KeyType const *key, ValueType const *value, void *arg), void *arg)\
+{\
+	while (t) {\
+		Name##_for_each_node(t->left, func, arg);\
+		func(&t->key, &t->value, arg);\
+		t = t->right;\
+	}\
+}\
+\
+Name *Name##_new(void)\
+{\
+	Name *self;\
+	self = (Name *) malloc(sizeof(Name));\
+	if (!self) return 0;\
+	self->root = 0;\
+	self->size = 0;\
+	self->spare = 0;\
+	self->nspare = 0;\
+	CSTL_MAGIC(self->magic = self);\
+	return self;\
+}\
+\
+void Name##_delete(Name *self)\
+{\
+	Name##Node *node;\
+	if (!self) return;\
+	CSTL_ASSERT(self->magic == self && "PersistentMap_delete");\
+	Name##_release(self->root);\
+	while (self->spare) {\
+		node = self->spare;\
+		self->spare = node->left;\
+		free(node);\
+	}\
+	CSTL_MAGIC(self->magic = 0);\
+	free(self);\
+}\
+\
+void Name##_clear(Name *self)\
+{\
+	CSTL_ASSERT(self && "PersistentMap_clear");\
+	CSTL_ASSERT(self->magic == self && "PersistentMap_clear");\
+	Name##_release(self->root);\
+	self->root = 0;\
+	self->size = 0;\
+}\
+\
+int Name##_empty(Name *self)\
+{\
+	CSTL_ASSERT(self && "PersistentMap_empty");\
+	CSTL_ASSERT(self->magic == self && "PersistentMap_empty");\
+	return self->size == 0;\
+}\
+\
+size_t Name##_size(Name *self)\
+{\
+	CSTL_ASSERT(self && "PersistentMap_size");\
+	CSTL_ASSERT(self->magic == self && "PersistentMap_size");\
+	return self->size;\
+}\
+\
+Name *Name##_snapshot(Name *self)\
+{\
+	Name *x;\
+	CSTL_ASSERT(self && "PersistentMap_snapshot");\
+	CSTL_ASSERT(self->magic == self && "PersistentMap_snapshot");\
+	x = Name##_new();\
+	if (!x) return 0;\
+	/* 根を共有するだけ。以後どちらかを変更すると、変更した経路だけが複製される */\
+	x->root = Name##_retain(self->root);\
+	x->size = self->size;\
+	return x;\
+}\
+\
+int Name##_insert(Name *self, KeyType key, ValueType value, int *success)\
+{\
+	CSTL_ASSERT(self && "PersistentMap_insert");\
+	CSTL_ASSERT(self->magic == self && "PersistentMap_insert");\
+	if (success) *success = 0;\
+	if (Name##_find_node(self, &key)) {\
+		return 1;\
+	}\
+	if (!Name##_reserve_nodes(self)) {\
+		return 0;\
+	}\
+	self->root = Name##_insert_node(self, self->root, &key, &value);\
+	if (success) *success = 1;\
+	return 1;\
+}\
+\
+int Name##_assign(Name *self, KeyType key, ValueType value)\
+{\
+	CSTL_ASSERT(self && "PersistentMap_assign");\
+	CSTL_ASSERT(self->magic == self && "PersistentMap_assign");\
+	if (!Name##_reserve_nodes(self)) {\
+		return 0;\
+	}\
+	self->root = Name##_insert_node(self, self->root, &key, &value);\
+	return 1;\
+}\
+\
+size_t Name##_erase_key(Name *self, KeyType key)\
+{\
+	CSTL_ASSERT(self && "PersistentMap_erase_key");\
+	CSTL_ASSERT(self->magic == self && "PersistentMap_erase_key");\
+	if (!Name##_find_node(self, &key)) {\
+		return 0;\
+	}\
+	if (!Name##_reserve_nodes(self)) {\
+		return 0;\
+	}\
+	self->root = Name##_erase_node(self, self->root, &key);\
+	return 1;\
+}\
+\
+ValueType const *Name##_find(Name *self, KeyType key)\
+{\
+	Name##Node *node;\
+	CSTL_ASSERT(self && "PersistentMap_find");\
+	CSTL_ASSERT(self->magic == self && "PersistentMap_find");\
+	node = Name##_find_node(self, &key);\
+	return node ? &node->value : 0;\
+}\
+\
+size_t Name##_count(Name *self, KeyType key)\
+{\
+	CSTL_ASSERT(self && "PersistentMap_count");\
+	CSTL_ASSERT(self->magic == self && "PersistentMap_count");\
+	return Name##_find_node(self, &key) != 0;\
+}\
+\
+void Name##_for_each(Name *self, void (*func)(KeyType const *key, ValueType const *value, void *arg), void *arg)\
+{\
+	CSTL_ASSERT(self && "PersistentMap_for_each");\
+	CSTL_ASSERT(self->magic == self && "PersistentMap_for_each");\
+	CSTL_ASSERT(func && "PersistentMap_for_each");\
+	Name##_for_each_node(self->root, func, arg);\
+}\
+\
+void Name##_swap(Name *self, Name *x)\
+{\
+	Name tmp;\
+	CSTL_ASSERT(self && "PersistentMap_swap");\
+	CSTL_ASSERT(x && "PersistentMap_swap");\
+	CSTL_ASSERT(self->magic == self && "PersistentMap_swap");\
+	CSTL_ASSERT(x->magic == x && "PersistentMap_swap");\
+	tmp = *self;\
+	*self = *x;\
+	*x = tmp;\
+	CSTL_MAGIC(self->magic = self);\
+	CSTL_MAGIC(x->magic = x);\
+}\
+
+
+#endif /* CSTL_PERSISTENT_MAP_H_INCLUDED */
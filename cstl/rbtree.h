@@ -46,6 +46,86 @@
 #define CSTL_RBTREE_IS_HEAD(node, Name)		((node)->color == Name##_COLOR_HEAD)
 #define CSTL_RBTREE_IS_ROOT(node, Name)		CSTL_RBTREE_IS_HEAD((node)->parent, Name)
 #define CSTL_RBTREE_IS_NIL(node, Name)		((node) == (Name##RBTree *) &Name##RBTree_nil)
+#define CSTL_RBTREE_RIGHTMOST(node, Name)	(((Name##RBTreeHead *) (node))->rightmost)
+
+
+/* 
+ * CSTL_RBTREE_RANKマクロが定義されているならば、各ノードに部分木の要素数を持たせ、
+ * nth(), rank(), split()をO(log N)で提供する。
+ */
+#ifdef CSTL_RBTREE_RANK
+#define CSTL_RBTREE_SIZE(x)		x
+#define CSTL_RBTREE_RANK_INTERFACE(Name, KeyType)	\
+Name##Iterator Name##_nth(Name *self, size_t k);\
+size_t Name##_rank(Name *self, KeyType key);\
+void Name##_split(Name *self, KeyType key, Name *out);\
+
+#define CSTL_RBTREE_RANK_IMPLEMENT(Name, KeyType, Compare)	\
+Name##Iterator Name##_nth(Name *self, size_t k)\
+{\
+	register Name##RBTree *t;\
+	CSTL_ASSERT(self && "(Set|Map)_nth");\
+	CSTL_ASSERT(self->magic == self && "(Set|Map)_nth");\
+	t = Name##RBTree_get_root(self->tree);\
+	while (!CSTL_RBTREE_IS_NIL(t, Name)) {\
+		if (k < t->left->size) {\
+			t = t->left;\
+		} else if (k == t->left->size) {\
+			return t;\
+		} else {\
+			k -= t->left->size + 1;\
+			t = t->right;\
+		}\
+	}\
+	return Name##RBTree_end(self->tree);\
+}\
+\
+size_t Name##_rank(Name *self, KeyType key)\
+{\
+	register Name##RBTree *t;\
+	register size_t r = 0;\
+	CSTL_ASSERT(self && "(Set|Map)_rank");\
+	CSTL_ASSERT(self->magic == self && "(Set|Map)_rank");\
+	t = Name##RBTree_get_root(self->tree);\
+	while (!CSTL_RBTREE_IS_NIL(t, Name)) {\
+		if (Compare(key, t->key) <= 0) {\
+			t = t->left;\
+		} else {\
+			r += t->left->size + 1;\
+			t = t->right;\
+		}\
+	}\
+	return r;\
+}\
+\
+void Name##_split(Name *self, KeyType key, Name *out)\
+{\
+	CSTL_ASSERT(self && "(Set|Map)_split");\
+	CSTL_ASSERT(out && "(Set|Map)_split");\
+	CSTL_ASSERT(self->magic == self && "(Set|Map)_split");\
+	CSTL_ASSERT(out->magic == out && "(Set|Map)_split");\
+	CSTL_ASSERT(self != out && "(Set|Map)_split");\
+	CSTL_ASSERT(Name##_empty(out) && "(Set|Map)_split");\
+	Name##RBTree_split(self->tree, key, out->tree);\
+	out->size = Name##RBTree_get_root(out->tree)->size;\
+	self->size -= out->size;\
+}\
+
+#else
+#define CSTL_RBTREE_SIZE(x)
+#define CSTL_RBTREE_RANK_INTERFACE(Name, KeyType)
+#define CSTL_RBTREE_RANK_IMPLEMENT(Name, KeyType, Compare)
+#endif
+
+/* 
+ * CSTL_RBTREE_THREADマクロが定義されているならば、各ノードを昇順の双方向リストでつなぎ、
+ * begin()/next()/prev()をO(1)でたどる。ヘッドがリストの番兵となる。
+ */
+#ifdef CSTL_RBTREE_THREAD
+#define CSTL_RBTREE_LINK(x)		x
+#else
+#define CSTL_RBTREE_LINK(x)
+#endif
 
 
 #define CSTL_RBTREE_IMPLEMENT(Name, KeyType, ValueType, Compare)	\
@@ -59,6 +139,14 @@ enum {\
 	Name##_COLOR_HEAD\
 };\
 \
+/*! \
+ * \brief 赤黒木のヘッダ。最大のノードを保持し、rbegin()と末尾への挿入をO(1)にする\
+ */\
+typedef struct Name##RBTreeHead {\
+	Name##RBTree node;\
+	Name##RBTree *rightmost;\
+} Name##RBTreeHead;\
+\
 static const Name##RBTree Name##RBTree_nil = {\
 	(Name##RBTree *) &Name##RBTree_nil, \
 	(Name##RBTree *) &Name##RBTree_nil, \
@@ -72,22 +160,30 @@ static void Name##RBTree_clear(Name##RBTree *self);\
 static int Name##RBTree_empty(Name##RBTree *self);\
 static void Name##RBTree_insert(Name##RBTree *self, Name##RBTree *node);\
 static void Name##RBTree_erase(Name##RBTree *self, Name##Iterator pos);\
-static size_t Name##RBTree_count(Name##RBTree *self, KeyType key);\
-static Name##Iterator Name##RBTree_find(Name##RBTree *self, KeyType key);\
-static Name##Iterator Name##RBTree_lower_bound(Name##RBTree *self, KeyType key);\
-static Name##Iterator Name##RBTree_upper_bound(Name##RBTree *self, KeyType key);\
+static void Name##RBTree_unlink(Name##RBTree *self, Name##Iterator pos);\
+static size_t Name##RBTree_count(Name##RBTree *self, KeyType const *key);\
+static Name##Iterator Name##RBTree_find(Name##RBTree *self, KeyType const *key);\
+static Name##Iterator Name##RBTree_lower_bound(Name##RBTree *self, KeyType const *key);\
+static Name##Iterator Name##RBTree_upper_bound(Name##RBTree *self, KeyType const *key);\
 static Name##Iterator Name##RBTree_begin(Name##RBTree *self);\
 static Name##Iterator Name##RBTree_end(Name##RBTree *self);\
 static Name##Iterator Name##RBTree_rbegin(Name##RBTree *self);\
 static Name##Iterator Name##RBTree_rend(Name##RBTree *self);\
 static Name##Iterator Name##RBTree_next(Name##Iterator pos);\
 static Name##Iterator Name##RBTree_prev(Name##Iterator pos);\
+static size_t Name##RBTree_insert_sorted(Name##RBTree *self, size_t size, Name##RBTree *list, size_t n, int unique);\
+static Name##RBTree *Name##RBTree_hint_parent(Name##RBTree *self, Name##Iterator hint, KeyType key, int unique, int *dir);\
+static void Name##RBTree_insert_at(Name##RBTree *self, Name##RBTree *parent, int dir, Name##RBTree *node);\
 \
 static void Name##RBTree_set_left(Name##RBTree *node, Name##RBTree *t);\
 static void Name##RBTree_set_right(Name##RBTree *node, Name##RBTree *t);\
+CSTL_RBTREE_SIZE(static void Name##RBTree_fix_size(Name##RBTree *node);)\
+CSTL_RBTREE_SIZE(static void Name##RBTree_inc_size(Name##RBTree *node);)\
+CSTL_RBTREE_SIZE(static void Name##RBTree_dec_size(Name##RBTree *node);)\
+CSTL_RBTREE_LINK(static void Name##RBTree_link_before(Name##RBTree *pos, Name##RBTree *node);)\
 static Name##RBTree *Name##RBTree_get_root(Name##RBTree *self);\
 static void Name##RBTree_set_root(Name##RBTree *self, Name##RBTree *t);\
-static Name##RBTree *Name##RBTree_find_node(Name##RBTree *t, KeyType key);\
+static Name##RBTree *Name##RBTree_find_node(Name##RBTree *t, KeyType const *key);\
 static Name##RBTree *Name##RBTree_replace_subtree(Name##RBTree *node, Name##RBTree *t);\
 static void Name##RBTree_swap_parent_child(Name##RBTree *p, Name##RBTree *c);\
 static void Name##RBTree_swap(Name##RBTree *s, Name##RBTree *t);\
@@ -95,8 +191,13 @@ static void Name##RBTree_rotate_right(Name##RBTree *node);\
 static void Name##RBTree_rotate_left(Name##RBTree *node);\
 static Name##RBTree *Name##RBTree_get_sibling(Name##RBTree *node);\
 static Name##RBTree *Name##RBTree_get_uncle(Name##RBTree *node);\
-static void Name##RBTree_balance_for_insert(Name##RBTree *n);\
+static int Name##RBTree_balance_for_insert(Name##RBTree *n);\
 static void Name##RBTree_balance_for_erase(Name##RBTree *n, Name##RBTree *p_of_n);\
+static Name##RBTree *Name##RBTree_build(Name##RBTree *self, Name##RBTree **list, size_t n, size_t depth, size_t red_depth);\
+CSTL_RBTREE_SIZE(static void Name##RBTree_fix_rightmost(Name##RBTree *self);)\
+static size_t Name##RBTree_black_height(Name##RBTree *t);\
+static size_t Name##RBTree_join_node(Name##RBTree *l, Name##RBTree *node, Name##RBTree *r, size_t hl, size_t hr);\
+CSTL_RBTREE_SIZE(static void Name##RBTree_split(Name##RBTree *self, KeyType key, Name##RBTree *out);)\
 \
 \
 static void Name##RBTree_set_left(Name##RBTree *node, Name##RBTree *t)\
@@ -117,6 +218,42 @@ static void Name##RBTree_set_right(Name##RBTree *node, Name##RBTree *t)\
 	}\
 }\
 \
+CSTL_RBTREE_SIZE(\
+static void Name##RBTree_fix_size(Name##RBTree *node)\
+{\
+	node->size = node->left->size + node->right->size + 1;\
+}\
+\
+/* nodeから根までの部分木の要素数を1増やす */\
+static void Name##RBTree_inc_size(Name##RBTree *node)\
+{\
+	while (!CSTL_RBTREE_IS_HEAD(node, Name)) {\
+		node->size++;\
+		node = node->parent;\
+	}\
+}\
+\
+/* nodeから根までの部分木の要素数を1減らす */\
+static void Name##RBTree_dec_size(Name##RBTree *node)\
+{\
+	while (!CSTL_RBTREE_IS_HEAD(node, Name)) {\
+		node->size--;\
+		node = node->parent;\
+	}\
+}\
+)\
+\
+CSTL_RBTREE_LINK(\
+/* リストのposの直前にnodeをつなぐ */\
+static void Name##RBTree_link_before(Name##RBTree *pos, Name##RBTree *node)\
+{\
+	node->next = pos;\
+	node->prev = pos->prev;\
+	pos->prev->next = node;\
+	pos->prev = node;\
+}\
+)\
+\
 static Name##RBTree *Name##RBTree_get_root(Name##RBTree *self)\
 {\
 	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(self, Name) && "RBTree_get_root");\
@@ -135,12 +272,14 @@ static void Name##RBTree_set_root(Name##RBTree *self, Name##RBTree *t)\
 static Name##RBTree *Name##RBTree_new(void)\
 {\
 	Name##RBTree *self;\
-	self = (Name##RBTree *) malloc(sizeof(Name##RBTree));\
+	self = (Name##RBTree *) malloc(sizeof(Name##RBTreeHead));\
 	if (!self) return 0;\
+	CSTL_RBTREE_RIGHTMOST(self, Name) = self;\
 	self->left = (Name##RBTree *) &Name##RBTree_nil;\
 	self->right = (Name##RBTree *) &Name##RBTree_nil;\
 	self->parent = (Name##RBTree *) &Name##RBTree_nil;\
 	self->color = Name##_COLOR_HEAD;\
+	CSTL_RBTREE_LINK(self->next = self->prev = self;)\
 	CSTL_MAGIC(self->magic = self);\
 	return self;\
 }\
@@ -150,6 +289,8 @@ static void Name##RBTree_clear(Name##RBTree *self)\
 	register Name##RBTree *t;\
 	register Name##RBTree *tmp;\
 	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(self, Name) && "RBTree_clear");\
+	CSTL_RBTREE_RIGHTMOST(self, Name) = self;\
+	CSTL_RBTREE_LINK(self->next = self->prev = self;)\
 	t = Name##RBTree_get_root(self);\
 	if (CSTL_RBTREE_IS_NIL(t, Name)) return;\
 	while (1) {\
@@ -188,11 +329,11 @@ static int Name##RBTree_empty(Name##RBTree *self)\
 	return CSTL_RBTREE_IS_NIL(Name##RBTree_get_root(self), Name);\
 }\
 \
-static Name##RBTree *Name##RBTree_find_node(Name##RBTree *t, KeyType key)\
+static Name##RBTree *Name##RBTree_find_node(Name##RBTree *t, KeyType const *key)\
 {\
 	register int cmp;\
 	while (!CSTL_RBTREE_IS_NIL(t, Name)) {\
-		cmp = Compare(key, t->key);\
+		cmp = Compare(*key, t->key);\
 		if (cmp < 0) {\
 			t = t->left;\
 		} else if (cmp > 0) {\
@@ -204,7 +345,7 @@ static Name##RBTree *Name##RBTree_find_node(Name##RBTree *t, KeyType key)\
 	return t;\
 }\
 \
-static Name##Iterator Name##RBTree_find(Name##RBTree *self, KeyType key)\
+static Name##Iterator Name##RBTree_find(Name##RBTree *self, KeyType const *key)\
 {\
 	Name##RBTree *t;\
 	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(self, Name) && "RBTree_find");\
@@ -212,7 +353,7 @@ static Name##Iterator Name##RBTree_find(Name##RBTree *self, KeyType key)\
 	return CSTL_RBTREE_IS_NIL(t, Name) ? Name##RBTree_end(self) : t;\
 }\
 \
-static size_t Name##RBTree_count(Name##RBTree *self, KeyType key)\
+static size_t Name##RBTree_count(Name##RBTree *self, KeyType const *key)\
 {\
 	register size_t count = 0;\
 	register Name##Iterator pos;\
@@ -227,7 +368,7 @@ static size_t Name##RBTree_count(Name##RBTree *self, KeyType key)\
 	return count;\
 }\
 \
-static Name##Iterator Name##RBTree_lower_bound(Name##RBTree *self, KeyType key)\
+static Name##Iterator Name##RBTree_lower_bound(Name##RBTree *self, KeyType const *key)\
 {\
 	register Name##RBTree *t;\
 	register Name##RBTree *tmp;\
@@ -235,7 +376,7 @@ static Name##Iterator Name##RBTree_lower_bound(Name##RBTree *self, KeyType key)\
 	tmp = Name##RBTree_end(self);\
 	t = Name##RBTree_get_root(self);\
 	while (!CSTL_RBTREE_IS_NIL(t, Name)) {\
-		if (Compare(key, t->key) <= 0) {\
+		if (Compare(*key, t->key) <= 0) {\
 			tmp = t;\
 			t = t->left;\
 		} else {\
@@ -245,7 +386,7 @@ static Name##Iterator Name##RBTree_lower_bound(Name##RBTree *self, KeyType key)\
 	return tmp;\
 }\
 \
-static Name##Iterator Name##RBTree_upper_bound(Name##RBTree *self, KeyType key)\
+static Name##Iterator Name##RBTree_upper_bound(Name##RBTree *self, KeyType const *key)\
 {\
 	register Name##RBTree *t;\
 	register Name##RBTree *tmp;\
@@ -253,7 +394,7 @@ static Name##Iterator Name##RBTree_upper_bound(Name##RBTree *self, KeyType key)\
 	tmp = Name##RBTree_end(self);\
 	t = Name##RBTree_get_root(self);\
 	while (!CSTL_RBTREE_IS_NIL(t, Name)) {\
-		if (Compare(key, t->key) < 0) {\
+		if (Compare(*key, t->key) < 0) {\
 			tmp = t;\
 			t = t->left;\
 		} else {\
@@ -303,6 +444,7 @@ static void Name##RBTree_swap(Name##RBTree *s, Name##RBTree *t)\
 	Name##RBTree *tl;\
 	Name##RBTree *tr;\
 	int c;\
+	CSTL_RBTREE_SIZE(size_t size;)\
 	CSTL_ASSERT(!CSTL_RBTREE_IS_HEAD(s, Name) && "RBTree_swap");\
 	CSTL_ASSERT(!CSTL_RBTREE_IS_HEAD(t, Name) && "RBTree_swap");\
 	CSTL_ASSERT(!CSTL_RBTREE_IS_NIL(s, Name) && "RBTree_swap");\
@@ -333,6 +475,7 @@ static void Name##RBTree_swap(Name##RBTree *s, Name##RBTree *t)\
 	c = s->color;\
 	s->color = t->color;\
 	t->color = c;\
+	CSTL_RBTREE_SIZE(size = s->size; s->size = t->size; t->size = size;)\
 }\
 \
 static void Name##RBTree_rotate_right(Name##RBTree *node)\
@@ -351,6 +494,7 @@ static void Name##RBTree_rotate_right(Name##RBTree *node)\
 	} else {\
 		Name##RBTree_set_right(p, n);\
 	}\
+	CSTL_RBTREE_SIZE(Name##RBTree_fix_size(node); Name##RBTree_fix_size(n);)\
 }\
 \
 static void Name##RBTree_rotate_left(Name##RBTree *node)\
@@ -369,6 +513,7 @@ static void Name##RBTree_rotate_left(Name##RBTree *node)\
 	} else {\
 		Name##RBTree_set_right(p, n);\
 	}\
+	CSTL_RBTREE_SIZE(Name##RBTree_fix_size(node); Name##RBTree_fix_size(n);)\
 }\
 \
 static Name##RBTree *Name##RBTree_get_sibling(Name##RBTree *node)\
@@ -394,7 +539,11 @@ static Name##RBTree *Name##RBTree_get_uncle(Name##RBTree *node)\
 		g->right : g->left;\
 }\
 \
-static void Name##RBTree_balance_for_insert(Name##RBTree *n)\
+/* \
+ * 赤のnを挿入した後の再調整。\
+ * 赤の根を黒にした場合、木の黒の高さが1増えたので非0を返す。\
+ */\
+static int Name##RBTree_balance_for_insert(Name##RBTree *n)\
 {\
 	Name##RBTree *p;\
 	Name##RBTree *g;\
@@ -405,7 +554,7 @@ static void Name##RBTree_balance_for_insert(Name##RBTree *n)\
 		if (CSTL_RBTREE_IS_ROOT(n, Name)) {\
 			/* case 1 nがroot */\
 			n->color = Name##_COLOR_BLACK;\
-			break;\
+			return 1;\
 		}\
 		if (p->color == Name##_COLOR_BLACK) {\
 			/* case 2 pが黒 */\
@@ -452,6 +601,7 @@ static void Name##RBTree_balance_for_insert(Name##RBTree *n)\
 		g->color = Name##_COLOR_RED;\
 		break;\
 	}\
+	return 0;\
 }\
 \
 static void Name##RBTree_insert(Name##RBTree *self, Name##RBTree *node)\
@@ -460,11 +610,14 @@ static void Name##RBTree_insert(Name##RBTree *self, Name##RBTree *node)\
 	register Name##RBTree *tmp;\
 	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(self, Name) && "RBTree_insert");\
 	CSTL_MAGIC(node->magic = self);\
+	CSTL_RBTREE_SIZE(node->size = 1;)\
 	n = Name##RBTree_get_root(self);\
 	if (CSTL_RBTREE_IS_NIL(n, Name)) {\
 		/* rootになる */\
 		node->color = Name##_COLOR_BLACK;\
 		Name##RBTree_set_root(self, node);\
+		CSTL_RBTREE_RIGHTMOST(self, Name) = node;\
+		CSTL_RBTREE_LINK(Name##RBTree_link_before(self, node);)\
 		return;\
 	}\
 	/* 2分探索木の挿入 */\
@@ -479,9 +632,98 @@ static void Name##RBTree_insert(Name##RBTree *self, Name##RBTree *node)\
 	} while (!CSTL_RBTREE_IS_NIL(n, Name));\
 	if (Compare(node->key, tmp->key) < 0) {\
 		Name##RBTree_set_left(tmp, node);\
+		CSTL_RBTREE_LINK(Name##RBTree_link_before(tmp, node);)\
 	} else {\
 		Name##RBTree_set_right(tmp, node);\
+		CSTL_RBTREE_LINK(Name##RBTree_link_before(tmp->next, node);)\
+		if (tmp == CSTL_RBTREE_RIGHTMOST(self, Name)) {\
+			CSTL_RBTREE_RIGHTMOST(self, Name) = node;\
+		}\
 	}\
+	CSTL_RBTREE_SIZE(Name##RBTree_inc_size(tmp);)\
+	Name##RBTree_balance_for_insert(node);\
+}\
+\
+/* \
+ * hintの直前または直後にkeyを挿入できる場合、挿入先の親ノードを返し、*dirに左の子ならば負、右の子ならば正を格納する。\
+ * uniqueが非0で隣接する要素がkeyと等しい場合、その要素を返し、*dirに0を格納する。\
+ * hintが挿入位置に隣接しない場合、0を返す。\
+ */\
+static Name##RBTree *Name##RBTree_hint_parent(Name##RBTree *self, Name##Iterator hint, KeyType key, int unique, int *dir)\
+{\
+	register Name##RBTree *t;\
+	register int cmp;\
+	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(self, Name) && "RBTree_hint_parent");\
+	if (Name##RBTree_empty(self)) return 0;\
+	if (hint == Name##RBTree_end(self)) {\
+		/* 末尾への追加 */\
+		t = Name##RBTree_rbegin(self);\
+		cmp = Compare(key, t->key);\
+		if (cmp < 0) return 0;\
+		*dir = (unique && cmp == 0) ? 0 : 1;\
+		return t;\
+	}\
+	cmp = Compare(key, hint->key);\
+	if (unique && cmp == 0) {\
+		*dir = 0;\
+		return hint;\
+	}\
+	if (cmp < 0 || (!unique && cmp == 0)) {\
+		/* hintの直前 */\
+		t = Name##RBTree_prev(hint);\
+		if (t != Name##RBTree_rend(self)) {\
+			cmp = Compare(key, t->key);\
+			if (cmp < 0) return 0;\
+			if (unique && cmp == 0) {\
+				*dir = 0;\
+				return t;\
+			}\
+		}\
+		if (CSTL_RBTREE_IS_NIL(hint->left, Name)) {\
+			*dir = -1;\
+			return hint;\
+		}\
+		/* hintの左の子が存在するならば、tはその部分木の最大のノードなので右の子を持たない */\
+		*dir = 1;\
+		return t;\
+	}\
+	/* hintの直後 */\
+	t = Name##RBTree_next(hint);\
+	if (t != Name##RBTree_end(self)) {\
+		cmp = Compare(key, t->key);\
+		if (cmp > 0) return 0;\
+		if (unique && cmp == 0) {\
+			*dir = 0;\
+			return t;\
+		}\
+	}\
+	if (CSTL_RBTREE_IS_NIL(hint->right, Name)) {\
+		*dir = 1;\
+		return hint;\
+	}\
+	*dir = -1;\
+	return t;\
+}\
+\
+static void Name##RBTree_insert_at(Name##RBTree *self, Name##RBTree *parent, int dir, Name##RBTree *node)\
+{\
+	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(self, Name) && "RBTree_insert_at");\
+	CSTL_ASSERT(dir != 0 && "RBTree_insert_at");\
+	CSTL_MAGIC(node->magic = self);\
+	CSTL_RBTREE_SIZE(node->size = 1;)\
+	if (dir < 0) {\
+		CSTL_ASSERT(CSTL_RBTREE_IS_NIL(parent->left, Name) && "RBTree_insert_at");\
+		Name##RBTree_set_left(parent, node);\
+		CSTL_RBTREE_LINK(Name##RBTree_link_before(parent, node);)\
+	} else {\
+		CSTL_ASSERT(CSTL_RBTREE_IS_NIL(parent->right, Name) && "RBTree_insert_at");\
+		Name##RBTree_set_right(parent, node);\
+		CSTL_RBTREE_LINK(Name##RBTree_link_before(parent->next, node);)\
+		if (parent == CSTL_RBTREE_RIGHTMOST(self, Name)) {\
+			CSTL_RBTREE_RIGHTMOST(self, Name) = node;\
+		}\
+	}\
+	CSTL_RBTREE_SIZE(Name##RBTree_inc_size(parent);)\
 	Name##RBTree_balance_for_insert(node);\
 }\
 \
@@ -578,17 +820,30 @@ static void Name##RBTree_balance_for_erase(Name##RBTree *n, Name##RBTree *p_of_n
 \
 static void Name##RBTree_erase(Name##RBTree *self, Name##Iterator pos)\
 {\
-	register Name##RBTree *n;\
-	register Name##RBTree *x;\
 	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(self, Name) && "RBTree_erase");\
 	CSTL_ASSERT(!CSTL_RBTREE_IS_HEAD(pos, Name) && "RBTree_erase");\
+	Name##RBTree_unlink(self, pos);\
+	CSTL_MAGIC(pos->magic = 0);\
+	free(pos);\
+}\
+\
+/* posのノードを解放せずに木から外す */\
+static void Name##RBTree_unlink(Name##RBTree *self, Name##Iterator pos)\
+{\
+	register Name##RBTree *n;\
+	register Name##RBTree *x;\
 	n = pos;\
 	CSTL_ASSERT(!CSTL_RBTREE_IS_NIL(n, Name) && "RBTree_erase");\
+	CSTL_RBTREE_LINK(n->prev->next = n->next; n->next->prev = n->prev;)\
+	if (n == CSTL_RBTREE_RIGHTMOST(self, Name)) {\
+		CSTL_RBTREE_RIGHTMOST(self, Name) = Name##RBTree_prev(n);\
+	}\
 	if (CSTL_RBTREE_IS_NIL(n->left, Name) && CSTL_RBTREE_IS_NIL(n->right, Name)) {\
 		if (CSTL_RBTREE_IS_ROOT(n, Name)) {\
 			/* 最後の一つを削除 */\
 			Name##RBTree_set_root(self, (Name##RBTree *) &Name##RBTree_nil);\
 		} else {\
+			CSTL_RBTREE_SIZE(Name##RBTree_dec_size(n->parent);)\
 			n = Name##RBTree_replace_subtree(n, (Name##RBTree *) &Name##RBTree_nil);\
 			if (n->color == Name##_COLOR_BLACK) {\
 				Name##RBTree_balance_for_erase((Name##RBTree *) &Name##RBTree_nil, n->parent);\
@@ -597,6 +852,7 @@ static void Name##RBTree_erase(Name##RBTree *self, Name##Iterator pos)\
 		goto end;\
 	}\
 	if (CSTL_RBTREE_IS_NIL(n->left, Name)) {\
+		CSTL_RBTREE_SIZE(Name##RBTree_dec_size(n->parent);)\
 		n = Name##RBTree_replace_subtree(n, n->right);\
 		if (n->color == Name##_COLOR_BLACK) {\
 			CSTL_ASSERT(!CSTL_RBTREE_IS_NIL(n->right, Name) && "RBTree_erase");\
@@ -605,6 +861,7 @@ static void Name##RBTree_erase(Name##RBTree *self, Name##Iterator pos)\
 		goto end;\
 	}\
 	if (CSTL_RBTREE_IS_NIL(n->right, Name)) {\
+		CSTL_RBTREE_SIZE(Name##RBTree_dec_size(n->parent);)\
 		n = Name##RBTree_replace_subtree(n, n->left);\
 		if (n->color == Name##_COLOR_BLACK) {\
 			CSTL_ASSERT(!CSTL_RBTREE_IS_NIL(n->left, Name) && "RBTree_erase");\
@@ -618,14 +875,15 @@ static void Name##RBTree_erase(Name##RBTree *self, Name##Iterator pos)\
 		x = x->right;\
 	}\
 	Name##RBTree_swap(n, x);\
+	CSTL_RBTREE_SIZE(Name##RBTree_dec_size(n->parent);)\
 	n = Name##RBTree_replace_subtree(n, n->left);\
 	if (n->color == Name##_COLOR_BLACK) {\
 		CSTL_ASSERT(!CSTL_RBTREE_IS_NIL(n, Name) && "RBTree_erase");\
 		Name##RBTree_balance_for_erase(n->left, n->parent);\
 	}\
 end:\
-	CSTL_MAGIC(n->magic = 0);\
-	free(n);\
+	CSTL_ASSERT(n == pos && "RBTree_erase");\
+	return;\
 }\
 \
 static Name##Iterator Name##RBTree_begin(Name##RBTree *self)\
@@ -633,6 +891,7 @@ static Name##Iterator Name##RBTree_begin(Name##RBTree *self)\
 	register Name##RBTree *t;\
 	register Name##RBTree *tmp;\
 	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(self, Name) && "RBTree_begin");\
+	CSTL_RBTREE_LINK(return self->next;)\
 	tmp = Name##RBTree_end(self);\
 	t = Name##RBTree_get_root(self);\
 	while (!CSTL_RBTREE_IS_NIL(t, Name)) {\
@@ -650,16 +909,8 @@ static Name##Iterator Name##RBTree_end(Name##RBTree *self)\
 \
 static Name##Iterator Name##RBTree_rbegin(Name##RBTree *self)\
 {\
-	register Name##RBTree *t;\
-	register Name##RBTree *tmp;\
 	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(self, Name) && "RBTree_rbegin");\
-	tmp = Name##RBTree_rend(self);\
-	t = Name##RBTree_get_root(self);\
-	while (!CSTL_RBTREE_IS_NIL(t, Name)) {\
-		tmp = t;\
-		t = t->right;\
-	}\
-	return tmp;\
+	return CSTL_RBTREE_RIGHTMOST(self, Name);\
 }\
 \
 static Name##Iterator Name##RBTree_rend(Name##RBTree *self)\
@@ -672,6 +923,7 @@ static Name##Iterator Name##RBTree_next(Name##Iterator pos)\
 {\
 	CSTL_ASSERT(!CSTL_RBTREE_IS_HEAD(pos, Name) && "RBTree_next");\
 	CSTL_ASSERT(!CSTL_RBTREE_IS_NIL(pos, Name) && "RBTree_next");\
+	CSTL_RBTREE_LINK(return pos->next;)\
 	/* 下位検索 */\
 	if (!CSTL_RBTREE_IS_NIL(pos->right, Name)) {\
 		pos = pos->right;\
@@ -692,6 +944,7 @@ static Name##Iterator Name##RBTree_prev(Name##Iterator pos)\
 {\
 	CSTL_ASSERT(!CSTL_RBTREE_IS_HEAD(pos, Name) && "RBTree_prev");\
 	CSTL_ASSERT(!CSTL_RBTREE_IS_NIL(pos, Name) && "RBTree_prev");\
+	CSTL_RBTREE_LINK(return pos->prev;)\
 	/* 下位検索 */\
 	if (!CSTL_RBTREE_IS_NIL(pos->left, Name)) {\
 		pos = pos->left;\
@@ -708,6 +961,289 @@ static Name##Iterator Name##RBTree_prev(Name##Iterator pos)\
 	return pos->parent;\
 }\
 \
+static Name##RBTree *Name##RBTree_build(Name##RBTree *self, Name##RBTree **list, size_t n, size_t depth, size_t red_depth)\
+{\
+	Name##RBTree *node;\
+	Name##RBTree *left;\
+	if (n == 0) return (Name##RBTree *) &Name##RBTree_nil;\
+	/* 中央の要素を根とし、左右の部分木を再帰的に構築する */\
+	left = Name##RBTree_build(self, list, (n - 1) / 2, depth + 1, red_depth);\
+	node = *list;\
+	*list = node->right;\
+	CSTL_MAGIC(node->magic = self);\
+	CSTL_RBTREE_LINK(Name##RBTree_link_before(self, node);)\
+	/* 最下段の不完全な段だけを赤にすると、黒の高さはすべての経路で等しくなる */\
+	node->color = (depth == red_depth) ? Name##_COLOR_RED : Name##_COLOR_BLACK;\
+	CSTL_RBTREE_SIZE(node->size = n;)\
+	Name##RBTree_set_left(node, left);\
+	Name##RBTree_set_right(node, Name##RBTree_build(self, list, n - 1 - (n - 1) / 2, depth + 1, red_depth));\
+	return node;\
+}\
+\
+/* split()でのみ使う */\
+CSTL_RBTREE_SIZE(\
+static void Name##RBTree_fix_rightmost(Name##RBTree *self)\
+{\
+	register Name##RBTree *t;\
+	t = Name##RBTree_get_root(self);\
+	if (CSTL_RBTREE_IS_NIL(t, Name)) {\
+		CSTL_RBTREE_RIGHTMOST(self, Name) = self;\
+		return;\
+	}\
+	while (!CSTL_RBTREE_IS_NIL(t->right, Name)) {\
+		t = t->right;\
+	}\
+	CSTL_RBTREE_RIGHTMOST(self, Name) = t;\
+}\
+)\
+\
+/* tから葉までの経路上の黒ノードの数(t自身を含む) */\
+static size_t Name##RBTree_black_height(Name##RBTree *t)\
+{\
+	register size_t h = 0;\
+	for (; !CSTL_RBTREE_IS_NIL(t, Name); t = t->left) {\
+		if (t->color == Name##_COLOR_BLACK) h++;\
+	}\
+	return h;\
+}\
+\
+/* \
+ * lの木、node、rの木を連結してlの木とし、rを空にする。\
+ * lのすべての要素 <= node <= rのすべての要素であること。\
+ * hl, hrはそれぞれlとrの木の根の黒の高さ( Name##RBTree_black_height() の値)であること。\
+ * 連結した木の根の黒の高さを返す。\
+ * 黒の高さが低い方の木を高い方の木の、同じ黒の高さの位置に赤のnodeでつなぐので、\
+ * 計算量は黒の高さの差に比例する。\
+ * lとrはヘッドであればよく、rightmostは更新しない。\
+ */\
+static size_t Name##RBTree_join_node(Name##RBTree *l, Name##RBTree *node, Name##RBTree *r, size_t hl, size_t hr)\
+{\
+	register Name##RBTree *p;\
+	register Name##RBTree *c;\
+	Name##RBTree *tl;\
+	Name##RBTree *tr;\
+	size_t h;\
+	CSTL_RBTREE_SIZE(size_t d;)\
+	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(l, Name) && "RBTree_join_node");\
+	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(r, Name) && "RBTree_join_node");\
+	tl = Name##RBTree_get_root(l);\
+	tr = Name##RBTree_get_root(r);\
+	CSTL_ASSERT(hl == Name##RBTree_black_height(tl) && "RBTree_join_node");\
+	CSTL_ASSERT(hr == Name##RBTree_black_height(tr) && "RBTree_join_node");\
+	/* 部分木を切り出した場合、根が赤のことがあるので黒にする */\
+	if (tl->color == Name##_COLOR_RED) {\
+		tl->color = Name##_COLOR_BLACK;\
+		hl++;\
+	}\
+	if (tr->color == Name##_COLOR_RED) {\
+		tr->color = Name##_COLOR_BLACK;\
+		hr++;\
+	}\
+	h = (hl >= hr) ? hl : hr;\
+	node->color = Name##_COLOR_RED;\
+	if (hl >= hr) {\
+		/* lの右端の経路を、黒の高さがhrの黒ノードまで下る */\
+		p = l;\
+		c = tl;\
+		while (c->color == Name##_COLOR_RED || hl > hr) {\
+			if (c->color == Name##_COLOR_BLACK) hl--;\
+			p = c;\
+			c = c->right;\
+		}\
+		CSTL_RBTREE_SIZE(d = tr->size + 1;)\
+		Name##RBTree_set_left(node, c);\
+		Name##RBTree_set_right(node, tr);\
+		if (p == l) {\
+			Name##RBTree_set_root(l, node);\
+		} else {\
+			Name##RBTree_set_right(p, node);\
+		}\
+	} else {\
+		/* rの左端の経路を、黒の高さがhlの黒ノードまで下る */\
+		p = r;\
+		c = tr;\
+		while (c->color == Name##_COLOR_RED || hr > hl) {\
+			if (c->color == Name##_COLOR_BLACK) hr--;\
+			p = c;\
+			c = c->left;\
+		}\
+		CSTL_RBTREE_SIZE(d = tl->size + 1;)\
+		Name##RBTree_set_left(node, tl);\
+		Name##RBTree_set_right(node, c);\
+		if (p == r) {\
+			Name##RBTree_set_root(r, node);\
+		} else {\
+			Name##RBTree_set_left(p, node);\
+		}\
+		Name##RBTree_set_root(l, Name##RBTree_get_root(r));\
+	}\
+	Name##RBTree_set_root(r, (Name##RBTree *) &Name##RBTree_nil);\
+	CSTL_RBTREE_SIZE(\
+		Name##RBTree_fix_size(node);\
+		for (c = node->parent; !CSTL_RBTREE_IS_HEAD(c, Name); c = c->parent) c->size += d;\
+	)\
+	if (Name##RBTree_balance_for_insert(node)) {\
+		h++;\
+	}\
+	return h;\
+}\
+\
+/* \
+ * selfの木からkey以上の要素を空の木outに移す。\
+ * 根からkeyまでの経路上のノードを下から順に、左右それぞれの木へjoin_nodeでつなぎ直す。\
+ * 経路上の各ノードの黒の高さを下りながら求め、左右の木の黒の高さはjoin_nodeの戻り値で更新するので、\
+ * 黒の高さを数え直すことはない。\
+ * 各joinの計算量は黒の高さの差に比例し、その合計は木の高さで抑えられるので、O(log N)である。\
+ * 要素数を求めるために部分木の要素数を使うので、CSTL_RBTREE_RANKマクロが定義されている場合のみ提供する。\
+ */\
+CSTL_RBTREE_SIZE(\
+static void Name##RBTree_split(Name##RBTree *self, KeyType key, Name##RBTree *out)\
+{\
+	Name##RBTree *path[sizeof(size_t) * 16];\
+	unsigned char dir[sizeof(size_t) * 16];\
+	size_t height[sizeof(size_t) * 16];\
+	Name##RBTree tmp;\
+	register Name##RBTree *t;\
+	register size_t n = 0;\
+	size_t h;\
+	size_t hself = 0;\
+	size_t hout = 0;\
+	CSTL_RBTREE_LINK(Name##RBTree *first = self;)\
+	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(self, Name) && "RBTree_split");\
+	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(out, Name) && "RBTree_split");\
+	CSTL_ASSERT(Name##RBTree_empty(out) && "RBTree_split");\
+	tmp.left = (Name##RBTree *) &Name##RBTree_nil;\
+	tmp.right = (Name##RBTree *) &Name##RBTree_nil;\
+	tmp.parent = (Name##RBTree *) &Name##RBTree_nil;\
+	tmp.color = Name##_COLOR_HEAD;\
+	t = Name##RBTree_get_root(self);\
+	h = Name##RBTree_black_height(t);\
+	while (!CSTL_RBTREE_IS_NIL(t, Name)) {\
+		path[n] = t;\
+		height[n] = h;\
+		if (t->color == Name##_COLOR_BLACK) h--;\
+		dir[n] = (Compare(key, t->key) <= 0);\
+		CSTL_RBTREE_LINK(if (dir[n]) first = t;)\
+		t = dir[n] ? t->left : t->right;\
+		n++;\
+	}\
+	Name##RBTree_set_root(self, (Name##RBTree *) &Name##RBTree_nil);\
+	while (n > 0) {\
+		n--;\
+		t = path[n];\
+		/* tの子の部分木の黒の高さ。tの色はまだ変わっていない */\
+		h = height[n] - (t->color == Name##_COLOR_BLACK);\
+		if (dir[n]) {\
+			/* tとtの右部分木はkey以上 */\
+			Name##RBTree_set_root(&tmp, t->right);\
+			hout = Name##RBTree_join_node(out, t, &tmp, hout, h);\
+		} else {\
+			/* tとtの左部分木はkeyより小さい */\
+			Name##RBTree_set_root(&tmp, t->left);\
+			hself = Name##RBTree_join_node(&tmp, t, self, h, hself);\
+			Name##RBTree_set_root(self, Name##RBTree_get_root(&tmp));\
+			Name##RBTree_set_root(&tmp, (Name##RBTree *) &Name##RBTree_nil);\
+		}\
+	}\
+	CSTL_RBTREE_LINK(\
+		/* リストをfirstの直前で切り、first以降をoutのリストにする */\
+		if (first != self) {\
+			out->prev = self->prev;\
+			out->prev->next = out;\
+			self->prev = first->prev;\
+			self->prev->next = self;\
+			out->next = first;\
+			first->prev = out;\
+		}\
+	)\
+	Name##RBTree_fix_rightmost(self);\
+	Name##RBTree_fix_rightmost(out);\
+	CSTL_MAGIC(for (t = Name##RBTree_begin(out); t != Name##RBTree_end(out); t = Name##RBTree_next(t)) t->magic = out;)\
+}\
+)\
+\
+/* \
+ * rightでつながったソート済みのノードのリストlistを挿入し、挿入した数を返す。\
+ * uniqueが非0ならば、既存の要素と同じキーのノードは解放する。\
+ * 挿入するノードが既存の要素より多い場合、既存のノードとマージして木全体をO(size + n)で再構築する。\
+ */\
+static size_t Name##RBTree_insert_sorted(Name##RBTree *self, size_t size, Name##RBTree *list, size_t n, int unique)\
+{\
+	register Name##RBTree *a;\
+	register Name##RBTree *b;\
+	register Name##RBTree *tmp;\
+	Name##RBTree head;\
+	size_t count = 0;\
+	size_t total;\
+	size_t red_depth;\
+	CSTL_ASSERT(CSTL_RBTREE_IS_HEAD(self, Name) && "RBTree_insert_sorted");\
+	if (n == 0) return 0;\
+	if (size > n) {\
+		/* 少数の挿入は1つずつ行う */\
+		for (b = list; !CSTL_RBTREE_IS_NIL(b, Name); b = tmp) {\
+			tmp = b->right;\
+			b->right = (Name##RBTree *) &Name##RBTree_nil;\
+			if (unique && !CSTL_RBTREE_IS_NIL(Name##RBTree_find_node(Name##RBTree_get_root(self), &b->key), Name)) {\
+				free(b);\
+			} else {\
+				Name##RBTree_insert(self, b);\
+				count++;\
+			}\
+		}\
+		return count;\
+	}\
+	/* 既存のノードを昇順にleftでつなぐ。訪問済みのノードのleftはnext()で参照されない */\
+	a = (Name##RBTree *) &Name##RBTree_nil;\
+	if (size > 0) {\
+		a = Name##RBTree_begin(self);\
+		for (b = a; b != self; b = tmp) {\
+			tmp = Name##RBTree_next(b);\
+			b->left = (tmp == self) ? (Name##RBTree *) &Name##RBTree_nil : tmp;\
+		}\
+	}\
+	/* マージしてrightでつなぐ。同じキーならば既存のノードが先になる */\
+	b = list;\
+	tmp = &head;\
+	while (!CSTL_RBTREE_IS_NIL(a, Name) && !CSTL_RBTREE_IS_NIL(b, Name)) {\
+		register int cmp = Compare(b->key, a->key);\
+		if (cmp < 0) {\
+			tmp->right = b;\
+			tmp = b;\
+			b = b->right;\
+			count++;\
+		} else if (cmp == 0 && unique) {\
+			Name##RBTree *next = b->right;\
+			free(b);\
+			b = next;\
+		} else {\
+			tmp->right = a;\
+			tmp = a;\
+			a = a->left;\
+		}\
+	}\
+	for (; !CSTL_RBTREE_IS_NIL(a, Name); a = a->left) {\
+		tmp->right = a;\
+		tmp = a;\
+	}\
+	for (; !CSTL_RBTREE_IS_NIL(b, Name); b = b->right) {\
+		tmp->right = b;\
+		tmp = b;\
+		count++;\
+	}\
+	tmp->right = (Name##RBTree *) &Name##RBTree_nil;\
+	CSTL_RBTREE_RIGHTMOST(self, Name) = tmp;\
+	/* 完全二分木にならない最下段の深さ */\
+	total = size + count;\
+	red_depth = 0;\
+	while ((total + 1) >> (red_depth + 1)) {\
+		red_depth++;\
+	}\
+	list = head.right;\
+	CSTL_RBTREE_LINK(self->next = self->prev = self;)\
+	Name##RBTree_set_root(self, Name##RBTree_build(self, &list, total, 0, red_depth));\
+	return count;\
+}\
+\
 
 
 
@@ -725,11 +1261,20 @@ int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last);\
 Name##Iterator Name##_erase(Name *self, Name##Iterator pos);\
 Name##Iterator Name##_erase_range(Name *self, Name##Iterator first, Name##Iterator last);\
 size_t Name##_erase_key(Name *self, KeyType key);\
+Name##Iterator Name##_extract(Name *self, Name##Iterator pos);\
+void Name##_node_delete(Name##Iterator node);\
 size_t Name##_count(Name *self, KeyType key);\
 Name##Iterator Name##_find(Name *self, KeyType key);\
 Name##Iterator Name##_lower_bound(Name *self, KeyType key);\
 Name##Iterator Name##_upper_bound(Name *self, KeyType key);\
 void Name##_equal_range(Name *self, KeyType key, Name##Iterator *first, Name##Iterator *last);\
+size_t Name##_count_ref(Name *self, KeyType const *key);\
+Name##Iterator Name##_find_ref(Name *self, KeyType const *key);\
+Name##Iterator Name##_lower_bound_ref(Name *self, KeyType const *key);\
+Name##Iterator Name##_upper_bound_ref(Name *self, KeyType const *key);\
+Name##Iterator Name##_find_with(Name *self, const void *probe, int (*comp)(const void *probe, KeyType const *key));\
+Name##Iterator Name##_lower_bound_with(Name *self, const void *probe, int (*comp)(const void *probe, KeyType const *key));\
+Name##Iterator Name##_upper_bound_with(Name *self, const void *probe, int (*comp)(const void *probe, KeyType const *key));\
 Name##Iterator Name##_begin(Name *self);\
 Name##Iterator Name##_end(Name *self);\
 Name##Iterator Name##_rbegin(Name *self);\
@@ -737,6 +1282,8 @@ Name##Iterator Name##_rend(Name *self);\
 Name##Iterator Name##_next(Name##Iterator pos);\
 Name##Iterator Name##_prev(Name##Iterator pos);\
 void Name##_swap(Name *self, Name *x);\
+void Name##_join(Name *self, Name *other);\
+CSTL_RBTREE_RANK_INTERFACE(Name, KeyType)\
 
 
 #define CSTL_RBTREE_WRAPPER_IMPLEMENT(Name, KeyType, ValueType, Compare)	\
@@ -813,6 +1360,35 @@ Name##Iterator Name##_erase(Name *self, Name##Iterator pos)\
 	return tmp;\
 }\
 \
+/* \
+ * posのノードを解放せずに取り外し、どのコンテナにも属さないノードとして返す。\
+ * 取り外したノードのmagicはノード自身を指す。\
+ */\
+Name##Iterator Name##_extract(Name *self, Name##Iterator pos)\
+{\
+	CSTL_ASSERT(self && "(Set|Map)_extract");\
+	CSTL_ASSERT(self->magic == self && "(Set|Map)_extract");\
+	CSTL_ASSERT(pos && "(Set|Map)_extract");\
+	CSTL_ASSERT(pos != self->tree && "(Set|Map)_extract");\
+	CSTL_ASSERT(pos->magic == self->tree && "(Set|Map)_extract");\
+	Name##RBTree_unlink(self->tree, pos);\
+	pos->left = (Name##RBTree *) &Name##RBTree_nil;\
+	pos->right = (Name##RBTree *) &Name##RBTree_nil;\
+	pos->parent = (Name##RBTree *) &Name##RBTree_nil;\
+	pos->color = Name##_COLOR_RED;\
+	CSTL_MAGIC(pos->magic = pos);\
+	self->size--;\
+	return pos;\
+}\
+\
+void Name##_node_delete(Name##Iterator node)\
+{\
+	if (!node) return;\
+	CSTL_ASSERT(node->magic == node && "(Set|Map)_node_delete");\
+	CSTL_MAGIC(node->magic = 0);\
+	free(node);\
+}\
+\
 Name##Iterator Name##_erase_range(Name *self, Name##Iterator first, Name##Iterator last)\
 {\
 	register Name##Iterator pos;\
@@ -851,28 +1427,28 @@ size_t Name##_count(Name *self, KeyType key)\
 {\
 	CSTL_ASSERT(self && "(Set|Map)_count");\
 	CSTL_ASSERT(self->magic == self && "(Set|Map)_count");\
-	return Name##RBTree_count(self->tree, key);\
+	return Name##RBTree_count(self->tree, &key);\
 }\
 \
 Name##Iterator Name##_find(Name *self, KeyType key)\
 {\
 	CSTL_ASSERT(self && "(Set|Map)_find");\
 	CSTL_ASSERT(self->magic == self && "(Set|Map)_find");\
-	return Name##RBTree_find(self->tree, key);\
+	return Name##RBTree_find(self->tree, &key);\
 }\
 \
 Name##Iterator Name##_lower_bound(Name *self, KeyType key)\
 {\
 	CSTL_ASSERT(self && "(Set|Map)_lower_bound");\
 	CSTL_ASSERT(self->magic == self && "(Set|Map)_lower_bound");\
-	return Name##RBTree_lower_bound(self->tree, key);\
+	return Name##RBTree_lower_bound(self->tree, &key);\
 }\
 \
 Name##Iterator Name##_upper_bound(Name *self, KeyType key)\
 {\
 	CSTL_ASSERT(self && "(Set|Map)_upper_bound");\
 	CSTL_ASSERT(self->magic == self && "(Set|Map)_upper_bound");\
-	return Name##RBTree_upper_bound(self->tree, key);\
+	return Name##RBTree_upper_bound(self->tree, &key);\
 }\
 \
 void Name##_equal_range(Name *self, KeyType key, Name##Iterator *first, Name##Iterator *last)\
@@ -881,8 +1457,102 @@ void Name##_equal_range(Name *self, KeyType key, Name##Iterator *first, Name##It
 	CSTL_ASSERT(self->magic == self && "(Set|Map)_equal_range");\
 	CSTL_ASSERT(first && "(Set|Map)_equal_range");\
 	CSTL_ASSERT(last && "(Set|Map)_equal_range");\
-	*first = Name##RBTree_lower_bound(self->tree, key);\
-	*last = Name##RBTree_upper_bound(self->tree, key);\
+	*first = Name##RBTree_lower_bound(self->tree, &key);\
+	*last = Name##RBTree_upper_bound(self->tree, &key);\
+}\
+\
+size_t Name##_count_ref(Name *self, KeyType const *key)\
+{\
+	CSTL_ASSERT(self && "(Set|Map)_count_ref");\
+	CSTL_ASSERT(self->magic == self && "(Set|Map)_count_ref");\
+	CSTL_ASSERT(key && "(Set|Map)_count_ref");\
+	return Name##RBTree_count(self->tree, key);\
+}\
+\
+Name##Iterator Name##_find_ref(Name *self, KeyType const *key)\
+{\
+	CSTL_ASSERT(self && "(Set|Map)_find_ref");\
+	CSTL_ASSERT(self->magic == self && "(Set|Map)_find_ref");\
+	CSTL_ASSERT(key && "(Set|Map)_find_ref");\
+	return Name##RBTree_find(self->tree, key);\
+}\
+\
+Name##Iterator Name##_lower_bound_ref(Name *self, KeyType const *key)\
+{\
+	CSTL_ASSERT(self && "(Set|Map)_lower_bound_ref");\
+	CSTL_ASSERT(self->magic == self && "(Set|Map)_lower_bound_ref");\
+	CSTL_ASSERT(key && "(Set|Map)_lower_bound_ref");\
+	return Name##RBTree_lower_bound(self->tree, key);\
+}\
+\
+Name##Iterator Name##_upper_bound_ref(Name *self, KeyType const *key)\
+{\
+	CSTL_ASSERT(self && "(Set|Map)_upper_bound_ref");\
+	CSTL_ASSERT(self->magic == self && "(Set|Map)_upper_bound_ref");\
+	CSTL_ASSERT(key && "(Set|Map)_upper_bound_ref");\
+	return Name##RBTree_upper_bound(self->tree, key);\
+}\
+\
+/* compは要素のキーと同じ順序でprobeを比較すること */\
+Name##Iterator Name##_find_with(Name *self, const void *probe, int (*comp)(const void *probe, KeyType const *key))\
+{\
+	register int cmp;\
+	register Name##RBTree *t;\
+	CSTL_ASSERT(self && "(Set|Map)_find_with");\
+	CSTL_ASSERT(self->magic == self && "(Set|Map)_find_with");\
+	CSTL_ASSERT(comp && "(Set|Map)_find_with");\
+	t = Name##RBTree_get_root(self->tree);\
+	while (!CSTL_RBTREE_IS_NIL(t, Name)) {\
+		cmp = comp(probe, &t->key);\
+		if (cmp < 0) {\
+			t = t->left;\
+		} else if (cmp > 0) {\
+			t = t->right;\
+		} else {\
+			return t;\
+		}\
+	}\
+	return Name##RBTree_end(self->tree);\
+}\
+\
+Name##Iterator Name##_lower_bound_with(Name *self, const void *probe, int (*comp)(const void *probe, KeyType const *key))\
+{\
+	register Name##RBTree *t;\
+	register Name##RBTree *tmp;\
+	CSTL_ASSERT(self && "(Set|Map)_lower_bound_with");\
+	CSTL_ASSERT(self->magic == self && "(Set|Map)_lower_bound_with");\
+	CSTL_ASSERT(comp && "(Set|Map)_lower_bound_with");\
+	tmp = Name##RBTree_end(self->tree);\
+	t = Name##RBTree_get_root(self->tree);\
+	while (!CSTL_RBTREE_IS_NIL(t, Name)) {\
+		if (comp(probe, &t->key) <= 0) {\
+			tmp = t;\
+			t = t->left;\
+		} else {\
+			t = t->right;\
+		}\
+	}\
+	return tmp;\
+}\
+\
+Name##Iterator Name##_upper_bound_with(Name *self, const void *probe, int (*comp)(const void *probe, KeyType const *key))\
+{\
+	register Name##RBTree *t;\
+	register Name##RBTree *tmp;\
+	CSTL_ASSERT(self && "(Set|Map)_upper_bound_with");\
+	CSTL_ASSERT(self->magic == self && "(Set|Map)_upper_bound_with");\
+	CSTL_ASSERT(comp && "(Set|Map)_upper_bound_with");\
+	tmp = Name##RBTree_end(self->tree);\
+	t = Name##RBTree_get_root(self->tree);\
+	while (!CSTL_RBTREE_IS_NIL(t, Name)) {\
+		if (comp(probe, &t->key) < 0) {\
+			tmp = t;\
+			t = t->left;\
+		} else {\
+			t = t->right;\
+		}\
+	}\
+	return tmp;\
 }\
 \
 Name##Iterator Name##_begin(Name *self)\
@@ -943,6 +1613,43 @@ void Name##_swap(Name *self, Name *x)\
 	x->size = tmp_size;\
 }\
 \
+void Name##_join(Name *self, Name *other)\
+{\
+	Name##RBTree *node;\
+	CSTL_ASSERT(self && "(Set|Map)_join");\
+	CSTL_ASSERT(other && "(Set|Map)_join");\
+	CSTL_ASSERT(self->magic == self && "(Set|Map)_join");\
+	CSTL_ASSERT(other->magic == other && "(Set|Map)_join");\
+	CSTL_ASSERT(self != other && "(Set|Map)_join");\
+	if (Name##_empty(other)) return;\
+	if (Name##_empty(self)) {\
+		Name##_swap(self, other);\
+		return;\
+	}\
+	CSTL_ASSERT(Compare(Name##RBTree_rbegin(self->tree)->key, Name##RBTree_begin(other->tree)->key) <= 0 && "(Set|Map)_join");\
+	CSTL_MAGIC(for (node = Name##RBTree_begin(other->tree); node != Name##RBTree_end(other->tree); node = Name##RBTree_next(node)) node->magic = self->tree;)\
+	/* selfの最大の要素を外し、2つの木をつなぐノードにする */\
+	node = Name##RBTree_rbegin(self->tree);\
+	Name##RBTree_unlink(self->tree, node);\
+	Name##RBTree_join_node(self->tree, node, other->tree,\
+			Name##RBTree_black_height(Name##RBTree_get_root(self->tree)),\
+			Name##RBTree_black_height(Name##RBTree_get_root(other->tree)));\
+	CSTL_RBTREE_LINK(\
+		/* リストを連結し、外したnodeをotherの先頭の直前に戻す */\
+		self->tree->prev->next = other->tree->next;\
+		other->tree->next->prev = self->tree->prev;\
+		self->tree->prev = other->tree->prev;\
+		self->tree->prev->next = self->tree;\
+		Name##RBTree_link_before(other->tree->next, node);\
+		other->tree->next = other->tree->prev = other->tree;\
+	)\
+	CSTL_RBTREE_RIGHTMOST(self->tree, Name) = CSTL_RBTREE_RIGHTMOST(other->tree, Name);\
+	CSTL_RBTREE_RIGHTMOST(other->tree, Name) = other->tree;\
+	self->size += other->size;\
+	other->size = 0;\
+}\
+\
+CSTL_RBTREE_RANK_IMPLEMENT(Name, KeyType, Compare)\
 
 
 #endif /* CSTL_RBTREE_H_INCLUDED */
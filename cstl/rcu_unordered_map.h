@@ -0,0 +1,561 @@
+/*
+ * Copyright (c) 2006-2010, KATO Noriaki
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*!
+ * \file rcu_unordered_map.h
+ * \brief 読み込み側がロックを取らない読み込み主体のunordered_map
+ * \author KATO Noriaki <katono@users.sourceforge.jp>
+ * \date 2026-10-19
+ * $URL$
+ * $Id$
+ */
+#ifndef CSTL_RCU_UNORDERED_MAP_H_INCLUDED
+#define CSTL_RCU_UNORDERED_MAP_H_INCLUDED
+
+#include <stdlib.h>
+#include "common.h"
+#include "hashtable.h"
+#include "atomic.h"
+
+/*
+ * 書き込み側を直列化するmutexと、読み込み側を待つ間のスレッドの譲渡
+ * CSTL_MUTEX_Tを定義済みならば、利用者の定義を使う。
+ */
+#ifndef CSTL_MUTEX_T
+#ifdef _WIN32
+#include <windows.h>
+#define CSTL_MUTEX_T				CRITICAL_SECTION
+#define CSTL_MUTEX_INIT(l)			(InitializeCriticalSection(l), 1)
+#define CSTL_MUTEX_DESTROY(l)		DeleteCriticalSection(l)
+#define CSTL_MUTEX_LOCK(l)			EnterCriticalSection(l)
+#define CSTL_MUTEX_UNLOCK(l)		LeaveCriticalSection(l)
+#define CSTL_THREAD_YIELD()			SwitchToThread()
+#else
+#include <pthread.h>
+#include <sched.h>
+#define CSTL_MUTEX_T				pthread_mutex_t
+#define CSTL_MUTEX_INIT(l)			(pthread_mutex_init(l, 0) == 0)
+#define CSTL_MUTEX_DESTROY(l)		pthread_mutex_destroy(l)
+#define CSTL_MUTEX_LOCK(l)			pthread_mutex_lock(l)
+#define CSTL_MUTEX_UNLOCK(l)		pthread_mutex_unlock(l)
+#define CSTL_THREAD_YIELD()			sched_yield()
+#endif
+#endif
+
+/* 読み込み中のスレッドを数えるカウンタの数(2を底とする対数) */
+#define CSTL_RCU_READER_BITS		6
+/* カウンタ同士がキャッシュラインを共有しないための大きさ */
+#define CSTL_RCU_CACHE_LINE			64
+/* 削除したノードがこの数だけたまったら、読み込み側を待って解放する */
+#define CSTL_RCU_RECLAIM_THRESHOLD	64
+/* バケット数の最小値の2を底とする対数 */
+#define CSTL_RCU_MIN_BITS			3
+
+
+/*!
+ * \brief インターフェイスマクロ
+ *
+ * \param Name コンテナ名
+ * \param KeyType 要素のキーの型
+ * \param ValueType 要素の値の型
+ */
+#define CSTL_RCU_UNORDERED_MAP_INTERFACE(Name, KeyType, ValueType)	\
+typedef struct Name Name;\
+\
+CSTL_EXTERN_C_BEGIN()\
+CSTL_HASH_INTEGER_INTERFACE(Name)\
+Name *Name##_new(void);\
+void Name##_delete(Name *self);\
+void Name##_clear(Name *self);\
+int Name##_empty(Name *self);\
+size_t Name##_size(Name *self);\
+int Name##_insert(Name *self, KeyType key, ValueType value, int *success);\
+int Name##_assign(Name *self, KeyType key, ValueType value);\
+size_t Name##_erase_key(Name *self, KeyType key);\
+int Name##_find(Name *self, KeyType key, ValueType *value);\
+void Name##_for_each(Name *self, void (*func)(KeyType const *key, ValueType const *value, void *arg), void *arg);\
+size_t Name##_bucket_count(Name *self);\
+void Name##_synchronize(Name *self);\
+CSTL_EXTERN_C_END()\
+
+
+/*!
+ * \brief 実装マクロ
+ *
+ * \param Name コンテナ名
+ * \param KeyType 要素のキーの型
+ * \param ValueType 要素の値の型
+ * \param Hasher ハッシュ関数
+ * \param Compare 要素の比較ルーチン
+ */
+#define CSTL_RCU_UNORDERED_MAP_IMPLEMENT(Name, KeyType, ValueType, Hasher, Compare)	\
+\
+/*! \
+ * \brief ノード\
+ *\
+ * 公開したノードのkeyとvalueは書き換えない。値の更新はノードを置き換えて行う。\
+ */\
+typedef struct Name##Node {\
+	struct Name##Node *volatile next;\
+	struct Name##Node *retired; /* 解放待ちのリスト。読み込み側がたどるnextとは別にする */\
+	KeyType key;\
+	ValueType value;\
+} Name##Node;\
+\
+/*! \
+ * \brief バケット配列\
+ */\
+typedef struct Name##Table {\
+	struct Name##Table *retired;\
+	size_t shift; /* ハッシュ値に定数を掛けて右シフトするビット数 */\
+	Name##Node *volatile buckets[1];\
+} Name##Table;\
+\
+/*! \
+ * \brief 読み込み中のスレッドのカウンタ\
+ *\
+ * 読み込み開始時のエポックの偶奇ごとに数える。\
+ */\
+typedef union Name##Reader {\
+	volatile long count[2];\
+	char pad[CSTL_RCU_CACHE_LINE];\
+} Name##Reader;\
+\
+/*! \
+ * \brief rcu_unordered_map構造体\
+ */\
+struct Name {\
+	Name##Table *volatile table;\
+	volatile size_t size;\
+	volatile long epoch;\
+	void *raw; /* mallocで確保した領域。readersはこれをキャッシュラインの境界に合わせたもの */\
+	Name##Reader *readers;\
+	CSTL_MUTEX_T lock;\
+	Name##Node *retired_nodes;\
+	Name##Table *retired_tables;\
+	size_t retired_count;\
+	CSTL_MAGIC(Name *magic;)\
+};\
+\
+CSTL_HASH_INTEGER_IMPLEMENT(Name)\
+\
+static size_t Name##_index(Name##Table *table, KeyType const *key)\
+{\
+	return (Hasher(*key) * CSTL_HASH_K1) >> table->shift;\
+}\
+\
+static Name##Table *Name##_table_new(size_t bits)\
+{\
+	Name##Table *table;\
+	size_t n = (size_t) 1 << bits;\
+	size_t i;\
+	if (n > (((size_t) -1) - sizeof(Name##Table)) / sizeof(Name##Node *)) {\
+		return 0;\
+	}\
+	table = (Name##Table *) malloc(sizeof(Name##Table) + sizeof(Name##Node *) * (n - 1));\
+	if (!table) return 0;\
+	for (i = 0; i < n; i++) {\
+		table->buckets[i] = 0;\
+	}\
+	table->retired = 0;\
+	table->shift = CSTL_HASH_BITS - bits;\
+	return table;\
+}\
+\
+static size_t Name##_table_size(Name##Table *table)\
+{\
+	return (size_t) 1 << (CSTL_HASH_BITS - table->shift);\
+}\
+\
+/* \
+ * 読み込み開始。\
+ * 読み込み側は自分のカウンタを増やすだけで、書き込み側のmutexは取らない。\
+ * カウンタはスタックのアドレスから選ぶので、スレッドごとにおおむね別のキャッシュラインになる。\
+ * 戻り値はName##_read_unlock()に渡す。\
+ */\
+static size_t Name##_read_lock(Name *self)\
+{\
+	char here;\
+	size_t r = (((size_t) &here >> 12) * CSTL_HASH_K1) >> (CSTL_HASH_BITS - CSTL_RCU_READER_BITS);\
+	long e;\
+	for (;;) {\
+		e = CSTL_ATOMIC_LOAD_SC(&self->epoch);\
+		CSTL_ATOMIC_ADD(&self->readers[r].count[e & 1], 1);\
+		/* \
+		 * カウンタを増やす間に書き込み側がエポックを進めた場合、\
+		 * そのカウンタは既に待ち終わっているかもしれないのでやり直す。\
+		 */\
+		if (CSTL_ATOMIC_LOAD_SC(&self->epoch) == e) break;\
+		CSTL_ATOMIC_ADD(&self->readers[r].count[e & 1], -1);\
+	}\
+	return (r << 1) | (size_t) (e & 1);\
+}\
+\
+static void Name##_read_unlock(Name *self, size_t token)\
+{\
+	CSTL_ATOMIC_ADD(&self->readers[token >> 1].count[token & 1], -1);\
+}\
+\
+/* \
+ * 解放待ちのノードとバケット配列を解放する。書き込み側のmutexを取った状態で呼ぶ。\
+ * エポックを進め、進める前に読み込みを始めたスレッドが全て抜けるまで待つ。\
+ */\
+static void Name##_reclaim(Name *self)\
+{\
+	Name##Node *node;\
+	Name##Table *table;\
+	long e;\
+	size_t i;\
+	if (!self->retired_nodes && !self->retired_tables) return;\
+	e = self->epoch;\
+	CSTL_ATOMIC_STORE_SC(&self->epoch, e + 1);\
+	for (i = 0; i < ((size_t) 1 << CSTL_RCU_READER_BITS); i++) {\
+		while (CSTL_ATOMIC_LOAD_SC(&self->readers[i].count[e & 1])) {\
+			CSTL_THREAD_YIELD();\
+		}\
+	}\
+	while (self->retired_nodes) {\
+		node = self->retired_nodes;\
+		self->retired_nodes = node->retired;\
+		free(node);\
+	}\
+	while (self->retired_tables) {\
+		table = self->retired_tables;\
+		self->retired_tables = table->retired;\
+		free(table);\
+	}\
+	self->retired_count = 0;\
+}\
+\
+static void Name##_retire(Name *self, Name##Node *node)\
+{\
+	node->retired = self->retired_nodes;\
+	self->retired_nodes = node;\
+	self->retired_count++;\
+}\
+\
+static Name##Node *Name##_node_new(KeyType const *key, ValueType const *value, Name##Node *next)\
+{\
+	Name##Node *node = (Name##Node *) malloc(sizeof(Name##Node));\
+	if (!node) return 0;\
+	node->key = *key;\
+	node->value = *value;\
+	node->next = next;\
+	node->retired = 0;\
+	return node;\
+}\
+\
+/* \
+ * バケット数を倍にする。\
+ * 読み込み側が古いバケット配列をたどっている間にnextを付け替えられないので、\
+ * 全ノードを複製して新しい配列につなぎ、古い配列とノードは解放待ちにする。\
+ * メモリ不足の場合は何もしない。\
+ */\
+static void Name##_grow(Name *self)\
+{\
+	Name##Table *old = self->table;\
+	Name##Table *table;\
+	Name##Node *node;\
+	Name##Node *copy;\
+	size_t n = Name##_table_size(old);\
+	size_t i, idx;\
+	table = Name##_table_new(CSTL_HASH_BITS - old->shift + 1);\
+	if (!table) return;\
+	for (i = 0; i < n; i++) {\
+		for (node = old->buckets[i]; node; node = node->next) {\
+			idx = Name##_index(table, &node->key);\
+			copy = Name##_node_new(&node->key, &node->value, table->buckets[idx]);\
+			if (!copy) goto error;\
+			table->buckets[idx] = copy;\
+		}\
+	}\
+	CSTL_ATOMIC_STORE(&self->table, table);\
+	for (i = 0; i < n; i++) {\
+		for (node = old->buckets[i]; node; node = node->next) {\
+			Name##_retire(self, node);\
+		}\
+	}\
+	old->retired = self->retired_tables;\
+	self->retired_tables = old;\
+	return;\
+error:\
+	for (i = 0; i < Name##_table_size(table); i++) {\
+		while (table->buckets[i]) {\
+			node = table->buckets[i];\
+			table->buckets[i] = node->next;\
+			free(node);\
+		}\
+	}\
+	free(table);\
+}\
+\
+/* 書き込み側のmutexを取った状態で、キーkeyのノードを指すリンクを探す。見つからなければ0を返す */\
+static Name##Node *volatile *Name##_find_link(Name *self, KeyType const *key)\
+{\
+	Name##Node *volatile *link = &self->table->buckets[Name##_index(self->table, key)];\
+	for (; *link; link = &(*link)->next) {\
+		if (Compare((*link)->key, *key) == 0) {\
+			return link;\
+		}\
+	}\
+	return 0;\
+}\
+\
+/* 書き込み側のmutexを取った状態で、新しいキーのノードを先頭に挿入する */\
+static int Name##_insert_node(Name *self, KeyType const *key, ValueType const *value)\
+{\
+	Name##Node *volatile *head;\
+	Name##Node *node;\
+	if (self->size >= Name##_table_size(self->table)) {\
+		Name##_grow(self);\
+	}\
+	head = &self->table->buckets[Name##_index(self->table, key)];\
+	node = Name##_node_new(key, value, *head);\
+	if (!node) return 0;\
+	/* key, value, nextを書いてから公開する */\
+	CSTL_ATOMIC_STORE(head, node);\
+	CSTL_ATOMIC_STORE(&self->size, self->size + 1);\
+	return 1;\
+}\
+\
+/* 書き込み側のmutexを取った状態で、たまった解放待ちを必要なら解放する */\
+static void Name##_write_unlock(Name *self)\
+{\
+	if (self->retired_count >= CSTL_RCU_RECLAIM_THRESHOLD || self->retired_tables) {\
+		Name##_reclaim(self);\
+	}\
+	CSTL_MUTEX_UNLOCK(&self->lock);\
+}\
+\
+Name *Name##_new(void)\
+{\
+	Name *self;\
+	size_t i;\
+	self = (Name *) malloc(sizeof(Name));\
+	if (!self) return 0;\
+	self->table = Name##_table_new(CSTL_RCU_MIN_BITS);\
+	if (!self->table) {\
+		free(self);\
+		return 0;\
+	}\
+	self->raw = malloc(sizeof(Name##Reader) * ((size_t) 1 << CSTL_RCU_READER_BITS) + CSTL_RCU_CACHE_LINE);\
+	if (!self->raw) {\
+		free(self->table);\
+		free(self);\
+		return 0;\
+	}\
+	self->readers = (Name##Reader *) (((size_t) self->raw + CSTL_RCU_CACHE_LINE - 1) &\
+			~((size_t) CSTL_RCU_CACHE_LINE - 1));\
+	for (i = 0; i < ((size_t) 1 << CSTL_RCU_READER_BITS); i++) {\
+		self->readers[i].count[0] = 0;\
+		self->readers[i].count[1] = 0;\
+	}\
+	if (!CSTL_MUTEX_INIT(&self->lock)) {\
+		free(self->raw);\
+		free(self->table);\
+		free(self);\
+		return 0;\
+	}\
+	self->size = 0;\
+	self->epoch = 0;\
+	self->retired_nodes = 0;\
+	self->retired_tables = 0;\
+	self->retired_count = 0;\
+	CSTL_MAGIC(self->magic = self);\
+	return self;\
+}\
+\
+void Name##_delete(Name *self)\
+{\
+	Name##Node *node;\
+	size_t i;\
+	if (!self) return;\
+	CSTL_ASSERT(self->magic == self && "RcuUnorderedMap_delete");\
+	CSTL_MUTEX_LOCK(&self->lock);\
+	Name##_reclaim(self);\
+	CSTL_MUTEX_UNLOCK(&self->lock);\
+	for (i = 0; i < Name##_table_size(self->table); i++) {\
+		while (self->table->buckets[i]) {\
+			node = self->table->buckets[i];\
+			self->table->buckets[i] = node->next;\
+			free(node);\
+		}\
+	}\
+	free(self->table);\
+	free(self->raw);\
+	CSTL_MUTEX_DESTROY(&self->lock);\
+	CSTL_MAGIC(self->magic = 0);\
+	free(self);\
+}\
+\
+void Name##_clear(Name *self)\
+{\
+	Name##Node *node;\
+	size_t i;\
+	CSTL_ASSERT(self && "RcuUnorderedMap_clear");\
+	CSTL_ASSERT(self->magic == self && "RcuUnorderedMap_clear");\
+	CSTL_MUTEX_LOCK(&self->lock);\
+	for (i = 0; i < Name##_table_size(self->table); i++) {\
+		node = self->table->buckets[i];\
+		CSTL_ATOMIC_STORE(&self->table->buckets[i], (Name##Node *) 0);\
+		for (; node; node = node->next) {\
+			Name##_retire(self, node);\
+		}\
+	}\
+	CSTL_ATOMIC_STORE(&self->size, (size_t) 0);\
+	Name##_write_unlock(self);\
+}\
+\
+int Name##_empty(Name *self)\
+{\
+	CSTL_ASSERT(self && "RcuUnorderedMap_empty");\
+	CSTL_ASSERT(self->magic == self && "RcuUnorderedMap_empty");\
+	return Name##_size(self) == 0;\
+}\
+\
+size_t Name##_size(Name *self)\
+{\
+	CSTL_ASSERT(self && "RcuUnorderedMap_size");\
+	CSTL_ASSERT(self->magic == self && "RcuUnorderedMap_size");\
+	return CSTL_ATOMIC_LOAD(&self->size);\
+}\
+\
+int Name##_insert(Name *self, KeyType key, ValueType value, int *success)\
+{\
+	int ret = 1;\
+	CSTL_ASSERT(self && "RcuUnorderedMap_insert");\
+	CSTL_ASSERT(self->magic == self && "RcuUnorderedMap_insert");\
+	if (success) *success = 0;\
+	CSTL_MUTEX_LOCK(&self->lock);\
+	if (!Name##_find_link(self, &key)) {\
+		ret = Name##_insert_node(self, &key, &value);\
+		if (ret && success) *success = 1;\
+	}\
+	Name##_write_unlock(self);\
+	return ret;\
+}\
+\
+int Name##_assign(Name *self, KeyType key, ValueType value)\
+{\
+	Name##Node *volatile *link;\
+	Name##Node *node;\
+	int ret = 1;\
+	CSTL_ASSERT(self && "RcuUnorderedMap_assign");\
+	CSTL_ASSERT(self->magic == self && "RcuUnorderedMap_assign");\
+	CSTL_MUTEX_LOCK(&self->lock);\
+	link = Name##_find_link(self, &key);\
+	if (link) {\
+		/* 読み込み側が古い値と新しい値の混ざったものを見ないよう、ノードごと置き換える */\
+		node = Name##_node_new(&key, &value, (*link)->next);\
+		if (node) {\
+			Name##_retire(self, *link);\
+			CSTL_ATOMIC_STORE(link, node);\
+		} else {\
+			ret = 0;\
+		}\
+	} else {\
+		ret = Name##_insert_node(self, &key, &value);\
+	}\
+	Name##_write_unlock(self);\
+	return ret;\
+}\
+\
+size_t Name##_erase_key(Name *self, KeyType key)\
+{\
+	Name##Node *volatile *link;\
+	size_t count = 0;\
+	CSTL_ASSERT(self && "RcuUnorderedMap_erase_key");\
+	CSTL_ASSERT(self->magic == self && "RcuUnorderedMap_erase_key");\
+	CSTL_MUTEX_LOCK(&self->lock);\
+	link = Name##_find_link(self, &key);\
+	if (link) {\
+		/* 削除したノードのnextはそのままにして、読み込み中のスレッドが先へ進めるようにする */\
+		Name##_retire(self, *link);\
+		CSTL_ATOMIC_STORE(link, (*link)->next);\
+		CSTL_ATOMIC_STORE(&self->size, self->size - 1);\
+		count = 1;\
+	}\
+	Name##_write_unlock(self);\
+	return count;\
+}\
+\
+int Name##_find(Name *self, KeyType key, ValueType *value)\
+{\
+	Name##Table *table;\
+	Name##Node *node;\
+	size_t token;\
+	int found = 0;\
+	CSTL_ASSERT(self && "RcuUnorderedMap_find");\
+	CSTL_ASSERT(self->magic == self && "RcuUnorderedMap_find");\
+	token = Name##_read_lock(self);\
+	table = CSTL_ATOMIC_LOAD(&self->table);\
+	for (node = CSTL_ATOMIC_LOAD(&table->buckets[Name##_index(table, &key)]); node;\
+			node = CSTL_ATOMIC_LOAD(&node->next)) {\
+		if (Compare(node->key, key) == 0) {\
+			if (value) *value = node->value;\
+			found = 1;\
+			break;\
+		}\
+	}\
+	Name##_read_unlock(self, token);\
+	return found;\
+}\
+\
+void Name##_for_each(Name *self, void (*func)(KeyType const *key, ValueType const *value, void *arg), void *arg)\
+{\
+	Name##Table *table;\
+	Name##Node *node;\
+	size_t token;\
+	size_t i;\
+	CSTL_ASSERT(self && "RcuUnorderedMap_for_each");\
+	CSTL_ASSERT(self->magic == self && "RcuUnorderedMap_for_each");\
+	CSTL_ASSERT(func && "RcuUnorderedMap_for_each");\
+	token = Name##_read_lock(self);\
+	table = CSTL_ATOMIC_LOAD(&self->table);\
+	for (i = 0; i < Name##_table_size(table); i++) {\
+		for (node = CSTL_ATOMIC_LOAD(&table->buckets[i]); node; node = CSTL_ATOMIC_LOAD(&node->next)) {\
+			func(&node->key, &node->value, arg);\
+		}\
+	}\
+	Name##_read_unlock(self, token);\
+}\
+\
+size_t Name##_bucket_count(Name *self)\
+{\
+	CSTL_ASSERT(self && "RcuUnorderedMap_bucket_count");\
+	CSTL_ASSERT(self->magic == self && "RcuUnorderedMap_bucket_count");\
+	return Name##_table_size(CSTL_ATOMIC_LOAD(&self->table));\
+}\
+\
+void Name##_synchronize(Name *self)\
+{\
+	CSTL_ASSERT(self && "RcuUnorderedMap_synchronize");\
+	CSTL_ASSERT(self->magic == self && "RcuUnorderedMap_synchronize");\
+	CSTL_MUTEX_LOCK(&self->lock);\
+	Name##_reclaim(self);\
+	CSTL_MUTEX_UNLOCK(&self->lock);\
+}\
+
+
+#endif /* CSTL_RCU_UNORDERED_MAP_H_INCLUDED */
@@ -0,0 +1,798 @@
+/*
+ * Copyright (c) 2006-2010, KATO Noriaki
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*!
+ * \file rope.h
+ * \brief rope(大きな文字列の編集用コンテナ)
+ * \author KATO Noriaki <katono@users.sourceforge.jp>
+ * \date 2026-10-19
+ * $URL$
+ * $Id$
+ */
+#ifndef CSTL_ROPE_H_INCLUDED
+#define CSTL_ROPE_H_INCLUDED
+
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "string.h"
+
+
+/*!
+ * \brief インターフェイスマクロ
+ *
+ * \param Name コンテナ名
+ * \param Type 要素の型
+ */
+#define CSTL_ROPE_INTERFACE(Name, Type)	\
+typedef struct Name Name;\
+\
+CSTL_EXTERN_C_BEGIN()\
+Name *Name##_new(void);\
+Name *Name##_new_assign(const Type *cstr);\
+Name *Name##_new_assign_len(const Type *chars, size_t chars_len);\
+void Name##_delete(Name *self);\
+void Name##_clear(Name *self);\
+size_t Name##_size(Name *self);\
+size_t Name##_length(Name *self);\
+int Name##_empty(Name *self);\
+Type *Name##_at(Name *self, size_t idx);\
+size_t Name##_copy(Name *self, Type *buf, size_t idx, size_t len);\
+Name *Name##_erase(Name *self, size_t idx, size_t len);\
+void Name##_swap(Name *self, Name *x);\
+Name *Name##_assign(Name *self, const Type *cstr);\
+Name *Name##_assign_len(Name *self, const Type *chars, size_t chars_len);\
+Name *Name##_append(Name *self, const Type *cstr);\
+Name *Name##_append_len(Name *self, const Type *chars, size_t chars_len);\
+Name *Name##_push_back(Name *self, Type c);\
+Name *Name##_insert(Name *self, size_t idx, const Type *cstr);\
+Name *Name##_insert_len(Name *self, size_t idx, const Type *chars, size_t chars_len);\
+Name *Name##_replace(Name *self, size_t idx, size_t len, const Type *cstr);\
+Name *Name##_replace_len(Name *self, size_t idx, size_t len, const Type *chars, size_t chars_len);\
+size_t Name##_find(Name *self, const Type *cstr, size_t idx);\
+size_t Name##_find_len(Name *self, const Type *chars, size_t idx, size_t chars_len);\
+size_t Name##_find_c(Name *self, Type c, size_t idx);\
+size_t Name##_rfind(Name *self, const Type *cstr, size_t idx);\
+size_t Name##_rfind_len(Name *self, const Type *chars, size_t idx, size_t chars_len);\
+size_t Name##_rfind_c(Name *self, Type c, size_t idx);\
+CSTL_EXTERN_C_END()\
+
+
+/*!
+ * \brief 実装マクロ
+ *
+ * \param Name コンテナ名
+ * \param Type 要素の型
+ */
+#define CSTL_ROPE_IMPLEMENT(Name, Type)	\
+\
+enum {\
+	/* 1つのチャンクに格納する要素数 */\
+	Name##_CHUNK_SIZE = (512 / sizeof(Type) > 16) ? 512 / sizeof(Type) : 16,\
+	/* 再利用のために保持する未使用ノードの最大数 */\
+	Name##_POOL_MAX = 8\
+};\
+\
+typedef struct Name##Node Name##Node;\
+/*! \
+ * \brief ropeノード構造体\
+ * \
+ * 要素のチャンクを持ち、位置をキーとするtreapを構成する。\
+ */\
+struct Name##Node {\
+	Name##Node *left;\
+	Name##Node *right;\
+	size_t size; /* 部分木の要素数 */\
+	size_t len; /* このチャンクの要素数 */\
+	unsigned long prio;\
+	Type buf[Name##_CHUNK_SIZE];\
+};\
+\
+/*! \
+ * \brief rope構造体\
+ */\
+struct Name {\
+	Name##Node *root;\
+	Name##Node *pool; /* 未使用ノードのリスト(rightでつなぐ) */\
+	size_t npool;\
+	unsigned long seed;\
+	CSTL_MAGIC(Name *magic;)\
+};\
+\
+CSTL_STRING_MYSTRLEN(Name, Type)\
+\
+static size_t Name##Node_size(Name##Node *t)\
+{\
+	return t ? t->size : 0;\
+}\
+\
+static void Name##Node_update(Name##Node *t)\
+{\
+	t->size = Name##Node_size(t->left) + t->len + Name##Node_size(t->right);\
+}\
+\
+/* 要素数nの挿入に必要なノード数 */\
+static size_t Name##_nodes_for(size_t n)\
+{\
+	return 1 + (n + Name##_CHUNK_SIZE - 1) / Name##_CHUNK_SIZE;\
+}\
+\
+static int Name##_reserve_node(Name *self, size_t n)\
+{\
+	Name##Node *node;\
+	while (self->npool < n) {\
+		node = (Name##Node *) malloc(sizeof(Name##Node));\
+		if (!node) return 0;\
+		node->right = self->pool;\
+		self->pool = node;\
+		self->npool++;\
+	}\
+	return 1;\
+}\
+\
+static void Name##_trim_pool(Name *self)\
+{\
+	Name##Node *node;\
+	while (self->npool > Name##_POOL_MAX) {\
+		node = self->pool;\
+		self->pool = node->right;\
+		self->npool--;\
+		free(node);\
+	}\
+}\
+\
+static Name##Node *Name##_pop_node(Name *self)\
+{\
+	Name##Node *node;\
+	CSTL_ASSERT(self->pool && "Rope_pop_node");\
+	node = self->pool;\
+	self->pool = node->right;\
+	self->npool--;\
+	node->left = 0;\
+	node->right = 0;\
+	node->size = 0;\
+	node->len = 0;\
+	/* xorshift */\
+	self->seed ^= (self->seed << 13) & 0xffffffffUL;\
+	self->seed ^= self->seed >> 17;\
+	self->seed ^= (self->seed << 5) & 0xffffffffUL;\
+	node->prio = self->seed;\
+	return node;\
+}\
+\
+static void Name##_push_node(Name *self, Name##Node *node)\
+{\
+	if (self->npool < Name##_POOL_MAX) {\
+		node->right = self->pool;\
+		self->pool = node;\
+		self->npool++;\
+	} else {\
+		free(node);\
+	}\
+}\
+\
+static void Name##_free_tree(Name *self, Name##Node *t)\
+{\
+	Name##Node *tmp;\
+	while (t) {\
+		Name##_free_tree(self, t->left);\
+		tmp = t->right;\
+		Name##_push_node(self, t);\
+		t = tmp;\
+	}\
+}\
+\
+static Name##Node *Name##_merge(Name##Node *l, Name##Node *r)\
+{\
+	if (!l) return r;\
+	if (!r) return l;\
+	if (l->prio > r->prio) {\
+		l->right = Name##_merge(l->right, r);\
+		Name##Node_update(l);\
+		return l;\
+	} else {\
+		r->left = Name##_merge(l, r->left);\
+		Name##Node_update(r);\
+		return r;\
+	}\
+}\
+\
+/* \
+ * tを先頭idx個の要素の木lと残りの木rに分割する。\
+ * チャンクの途中で分割する場合は、後半をプールのノードに移して*midに返す。\
+ */\
+static void Name##_split_node(Name *self, Name##Node *t, size_t idx, Name##Node **l, Name##Node **r, Name##Node **mid)\
+{\
+	size_t lsize;\
+	Name##Node *n;\
+	if (!t) {\
+		*l = 0;\
+		*r = 0;\
+		return;\
+	}\
+	lsize = Name##Node_size(t->left);\
+	if (idx <= lsize) {\
+		Name##_split_node(self, t->left, idx, l, &t->left, mid);\
+		Name##Node_update(t);\
+		*r = t;\
+	} else if (idx >= lsize + t->len) {\
+		Name##_split_node(self, t->right, idx - lsize - t->len, &t->right, r, mid);\
+		Name##Node_update(t);\
+		*l = t;\
+	} else {\
+		/* チャンクの途中で分割 */\
+		idx -= lsize;\
+		n = Name##_pop_node(self);\
+		memcpy(n->buf, &t->buf[idx], sizeof(Type) * (t->len - idx));\
+		n->len = t->len - idx;\
+		Name##Node_update(n);\
+		*r = t->right;\
+		t->len = idx;\
+		t->right = 0;\
+		Name##Node_update(t);\
+		*l = t;\
+		*mid = n;\
+	}\
+}\
+\
+/* \
+ * tを先頭idx個の要素の木lと残りの木rに分割する。チャンクを分ける場合はプールのノードを使う。\
+ * 分けたチャンクはpop_nodeで得た優先度のままrの先頭にmergeする。\
+ * tの優先度を引き継ぐと、同じ優先度のノードが連なって木が偏る。\
+ */\
+static void Name##_split(Name *self, Name##Node *t, size_t idx, Name##Node **l, Name##Node **r)\
+{\
+	Name##Node *mid = 0;\
+	Name##_split_node(self, t, idx, l, r, &mid);\
+	if (mid) {\
+		*r = Name##_merge(mid, *r);\
+	}\
+}\
+\
+/* idx番目の要素を含むチャンクを返す。idx < size であること */\
+static Name##Node *Name##_chunk_at(Name##Node *t, size_t idx, size_t *off)\
+{\
+	size_t lsize;\
+	while (1) {\
+		CSTL_ASSERT(t && "Rope_chunk_at");\
+		lsize = Name##Node_size(t->left);\
+		if (idx < lsize) {\
+			t = t->left;\
+		} else if (idx < lsize + t->len) {\
+			*off = idx - lsize;\
+			return t;\
+		} else {\
+			idx -= lsize + t->len;\
+			t = t->right;\
+		}\
+	}\
+}\
+\
+/* idx番目の要素を含むチャンクまでの経路上のノードの要素数を増減する。チャンクのlenを変更する前に呼ぶこと */\
+static void Name##_add_size(Name##Node *t, size_t idx, size_t n, int add)\
+{\
+	size_t lsize;\
+	while (1) {\
+		lsize = Name##Node_size(t->left);\
+		if (add) {\
+			t->size += n;\
+		} else {\
+			t->size -= n;\
+		}\
+		if (idx < lsize) {\
+			t = t->left;\
+		} else if (idx < lsize + t->len) {\
+			return;\
+		} else {\
+			idx -= lsize + t->len;\
+			t = t->right;\
+		}\
+	}\
+}\
+\
+/* 末尾への挿入は最後のチャンクに対して行う */\
+static Name##Node *Name##_insert_chunk(Name *self, size_t idx, size_t *off, size_t *pos)\
+{\
+	Name##Node *t;\
+	*pos = (idx == Name##Node_size(self->root)) ? idx - 1 : idx;\
+	t = Name##_chunk_at(self->root, *pos, off);\
+	if (*pos != idx) {\
+		(*off)++;\
+	}\
+	return t;\
+}\
+\
+static int Name##_insert_in_place(Name *self, size_t idx, const Type *chars, size_t n)\
+{\
+	Name##Node *t;\
+	size_t off;\
+	size_t pos;\
+	if (!self->root) return 0;\
+	t = Name##_insert_chunk(self, idx, &off, &pos);\
+	if (t->len + n > Name##_CHUNK_SIZE) return 0;\
+	memmove(&t->buf[off + n], &t->buf[off], sizeof(Type) * (t->len - off));\
+	Name##_add_size(self->root, pos, n, 1);\
+	memcpy(&t->buf[off], chars, sizeof(Type) * n);\
+	t->len += n;\
+	return 1;\
+}\
+\
+/* 事前にName##_nodes_for(n)個のノードをプールに確保しておくこと */\
+static void Name##_insert_nofail(Name *self, size_t idx, const Type *chars, size_t n)\
+{\
+	Name##Node *l;\
+	Name##Node *r;\
+	Name##Node *m;\
+	Name##Node *node;\
+	size_t k;\
+	if (!n) return;\
+	if (Name##_insert_in_place(self, idx, chars, n)) return;\
+	if (self->root && n <= Name##_CHUNK_SIZE / 2) {\
+		/* 満杯のチャンクを半分に分けて、空いた方に挿入する */\
+		size_t off;\
+		size_t pos;\
+		Name##Node *t = Name##_insert_chunk(self, idx, &off, &pos);\
+		CSTL_UNUSED_PARAM(pos);\
+		Name##_split(self, self->root, idx - off + t->len / 2, &l, &r);\
+		self->root = Name##_merge(l, r);\
+		k = Name##_insert_in_place(self, idx, chars, n);\
+		CSTL_ASSERT(k && "Rope_insert_nofail");\
+		return;\
+	}\
+	Name##_split(self, self->root, idx, &l, &r);\
+	m = 0;\
+	while (n) {\
+		k = (n < Name##_CHUNK_SIZE) ? n : Name##_CHUNK_SIZE;\
+		node = Name##_pop_node(self);\
+		memcpy(node->buf, chars, sizeof(Type) * k);\
+		node->len = k;\
+		Name##Node_update(node);\
+		m = Name##_merge(m, node);\
+		chars += k;\
+		n -= k;\
+	}\
+	self->root = Name##_merge(Name##_merge(l, m), r);\
+}\
+\
+/* 事前に2個のノードをプールに確保しておくこと */\
+static void Name##_erase_nofail(Name *self, size_t idx, size_t len)\
+{\
+	Name##Node *t;\
+	Name##Node *l;\
+	Name##Node *m;\
+	Name##Node *r;\
+	size_t off;\
+	if (!len) return;\
+	t = Name##_chunk_at(self->root, idx, &off);\
+	if (off + len <= t->len && len < t->len) {\
+		/* チャンク内で削除 */\
+		Name##_add_size(self->root, idx, len, 0);\
+		memmove(&t->buf[off], &t->buf[off + len], sizeof(Type) * (t->len - off - len));\
+		t->len -= len;\
+		return;\
+	}\
+	Name##_split(self, self->root, idx, &l, &r);\
+	Name##_split(self, r, len, &m, &r);\
+	Name##_free_tree(self, m);\
+	self->root = Name##_merge(l, r);\
+}\
+\
+/* bufとの間で[idx, idx + len)の要素をコピーする */\
+static void Name##_copy_range(Name##Node *t, Type *buf, size_t idx, size_t len, int to_rope)\
+{\
+	size_t lsize;\
+	size_t k;\
+	while (t && len) {\
+		lsize = Name##Node_size(t->left);\
+		if (idx < lsize) {\
+			k = (lsize - idx < len) ? lsize - idx : len;\
+			Name##_copy_range(t->left, buf, idx, k, to_rope);\
+			buf += k;\
+			idx += k;\
+			len -= k;\
+			if (!len) return;\
+		}\
+		idx -= lsize;\
+		if (idx < t->len) {\
+			k = (t->len - idx < len) ? t->len - idx : len;\
+			if (to_rope) {\
+				memcpy(&t->buf[idx], buf, sizeof(Type) * k);\
+			} else {\
+				memcpy(buf, &t->buf[idx], sizeof(Type) * k);\
+			}\
+			buf += k;\
+			idx += k;\
+			len -= k;\
+		}\
+		idx -= t->len;\
+		t = t->right;\
+	}\
+}\
+\
+Name *Name##_new(void)\
+{\
+	Name *self;\
+	self = (Name *) malloc(sizeof(Name));\
+	if (!self) return 0;\
+	self->root = 0;\
+	self->pool = 0;\
+	self->npool = 0;\
+	self->seed = 2463534242UL;\
+	CSTL_MAGIC(self->magic = self);\
+	return self;\
+}\
+\
+Name *Name##_new_assign(const Type *cstr)\
+{\
+	CSTL_ASSERT(cstr && "Rope_new_assign");\
+	return Name##_new_assign_len(cstr, CSTL_NPOS);\
+}\
+\
+Name *Name##_new_assign_len(const Type *chars, size_t chars_len)\
+{\
+	Name *self;\
+	CSTL_ASSERT(chars && "Rope_new_assign_len");\
+	self = Name##_new();\
+	if (!self) return 0;\
+	if (!Name##_assign_len(self, chars, chars_len)) {\
+		Name##_delete(self);\
+		return 0;\
+	}\
+	return self;\
+}\
+\
+void Name##_delete(Name *self)\
+{\
+	if (!self) return;\
+	CSTL_ASSERT(self->magic == self && "Rope_delete");\
+	Name##_clear(self);\
+	while (self->pool) {\
+		Name##Node *tmp = self->pool->right;\
+		free(self->pool);\
+		self->pool = tmp;\
+	}\
+	CSTL_MAGIC(self->magic = 0);\
+	free(self);\
+}\
+\
+void Name##_clear(Name *self)\
+{\
+	CSTL_ASSERT(self && "Rope_clear");\
+	CSTL_ASSERT(self->magic == self && "Rope_clear");\
+	Name##_free_tree(self, self->root);\
+	self->root = 0;\
+}\
+\
+size_t Name##_size(Name *self)\
+{\
+	CSTL_ASSERT(self && "Rope_size");\
+	CSTL_ASSERT(self->magic == self && "Rope_size");\
+	return Name##Node_size(self->root);\
+}\
+\
+size_t Name##_length(Name *self)\
+{\
+	CSTL_ASSERT(self && "Rope_length");\
+	CSTL_ASSERT(self->magic == self && "Rope_length");\
+	return Name##Node_size(self->root);\
+}\
+\
+int Name##_empty(Name *self)\
+{\
+	CSTL_ASSERT(self && "Rope_empty");\
+	CSTL_ASSERT(self->magic == self && "Rope_empty");\
+	return self->root == 0;\
+}\
+\
+Type *Name##_at(Name *self, size_t idx)\
+{\
+	Name##Node *t;\
+	size_t off;\
+	CSTL_ASSERT(self && "Rope_at");\
+	CSTL_ASSERT(self->magic == self && "Rope_at");\
+	CSTL_ASSERT(Name##_size(self) > idx && "Rope_at");\
+	t = Name##_chunk_at(self->root, idx, &off);\
+	return &t->buf[off];\
+}\
+\
+size_t Name##_copy(Name *self, Type *buf, size_t idx, size_t len)\
+{\
+	size_t size;\
+	CSTL_ASSERT(self && "Rope_copy");\
+	CSTL_ASSERT(self->magic == self && "Rope_copy");\
+	CSTL_ASSERT(buf && "Rope_copy");\
+	size = Name##_size(self);\
+	CSTL_ASSERT(size >= idx && "Rope_copy");\
+	if (len > size - idx) {\
+		len = size - idx;\
+	}\
+	Name##_copy_range(self->root, buf, idx, len, 0);\
+	return len;\
+}\
+\
+Name *Name##_erase(Name *self, size_t idx, size_t len)\
+{\
+	size_t size;\
+	CSTL_ASSERT(self && "Rope_erase");\
+	CSTL_ASSERT(self->magic == self && "Rope_erase");\
+	size = Name##_size(self);\
+	CSTL_ASSERT(size >= idx && "Rope_erase");\
+	if (len > size - idx) {\
+		len = size - idx;\
+	}\
+	if (!Name##_reserve_node(self, 2)) {\
+		return 0;\
+	}\
+	Name##_erase_nofail(self, idx, len);\
+	return self;\
+}\
+\
+void Name##_swap(Name *self, Name *x)\
+{\
+	Name tmp;\
+	CSTL_ASSERT(self && "Rope_swap");\
+	CSTL_ASSERT(x && "Rope_swap");\
+	CSTL_ASSERT(self->magic == self && "Rope_swap");\
+	CSTL_ASSERT(x->magic == x && "Rope_swap");\
+	tmp = *self;\
+	*self = *x;\
+	*x = tmp;\
+	CSTL_MAGIC(self->magic = self);\
+	CSTL_MAGIC(x->magic = x);\
+}\
+\
+Name *Name##_assign(Name *self, const Type *cstr)\
+{\
+	CSTL_ASSERT(self && "Rope_assign");\
+	CSTL_ASSERT(self->magic == self && "Rope_assign");\
+	CSTL_ASSERT(cstr && "Rope_assign");\
+	return Name##_assign_len(self, cstr, CSTL_NPOS);\
+}\
+\
+Name *Name##_assign_len(Name *self, const Type *chars, size_t chars_len)\
+{\
+	CSTL_ASSERT(self && "Rope_assign_len");\
+	CSTL_ASSERT(self->magic == self && "Rope_assign_len");\
+	CSTL_ASSERT(chars && "Rope_assign_len");\
+	if (chars_len == CSTL_NPOS) {\
+		chars_len = Name##_mystrlen(chars);\
+	}\
+	if (!Name##_reserve_node(self, Name##_nodes_for(chars_len))) {\
+		Name##_trim_pool(self);\
+		return 0;\
+	}\
+	Name##_clear(self);\
+	Name##_insert_nofail(self, 0, chars, chars_len);\
+	Name##_trim_pool(self);\
+	return self;\
+}\
+\
+Name *Name##_append(Name *self, const Type *cstr)\
+{\
+	CSTL_ASSERT(self && "Rope_append");\
+	CSTL_ASSERT(self->magic == self && "Rope_append");\
+	CSTL_ASSERT(cstr && "Rope_append");\
+	return Name##_insert_len(self, Name##_size(self), cstr, CSTL_NPOS);\
+}\
+\
+Name *Name##_append_len(Name *self, const Type *chars, size_t chars_len)\
+{\
+	CSTL_ASSERT(self && "Rope_append_len");\
+	CSTL_ASSERT(self->magic == self && "Rope_append_len");\
+	CSTL_ASSERT(chars && "Rope_append_len");\
+	return Name##_insert_len(self, Name##_size(self), chars, chars_len);\
+}\
+\
+Name *Name##_push_back(Name *self, Type c)\
+{\
+	CSTL_ASSERT(self && "Rope_push_back");\
+	CSTL_ASSERT(self->magic == self && "Rope_push_back");\
+	return Name##_insert_len(self, Name##_size(self), &c, 1);\
+}\
+\
+Name *Name##_insert(Name *self, size_t idx, const Type *cstr)\
+{\
+	CSTL_ASSERT(self && "Rope_insert");\
+	CSTL_ASSERT(self->magic == self && "Rope_insert");\
+	CSTL_ASSERT(Name##_size(self) >= idx && "Rope_insert");\
+	CSTL_ASSERT(cstr && "Rope_insert");\
+	return Name##_insert_len(self, idx, cstr, CSTL_NPOS);\
+}\
+\
+Name *Name##_insert_len(Name *self, size_t idx, const Type *chars, size_t chars_len)\
+{\
+	CSTL_ASSERT(self && "Rope_insert_len");\
+	CSTL_ASSERT(self->magic == self && "Rope_insert_len");\
+	CSTL_ASSERT(Name##_size(self) >= idx && "Rope_insert_len");\
+	CSTL_ASSERT(chars && "Rope_insert_len");\
+	if (chars_len == CSTL_NPOS) {\
+		chars_len = Name##_mystrlen(chars);\
+	}\
+	if (!Name##_reserve_node(self, Name##_nodes_for(chars_len))) {\
+		Name##_trim_pool(self);\
+		return 0;\
+	}\
+	Name##_insert_nofail(self, idx, chars, chars_len);\
+	Name##_trim_pool(self);\
+	return self;\
+}\
+\
+Name *Name##_replace(Name *self, size_t idx, size_t len, const Type *cstr)\
+{\
+	CSTL_ASSERT(self && "Rope_replace");\
+	CSTL_ASSERT(self->magic == self && "Rope_replace");\
+	CSTL_ASSERT(Name##_size(self) >= idx && "Rope_replace");\
+	CSTL_ASSERT(cstr && "Rope_replace");\
+	return Name##_replace_len(self, idx, len, cstr, CSTL_NPOS);\
+}\
+\
+Name *Name##_replace_len(Name *self, size_t idx, size_t len, const Type *chars, size_t chars_len)\
+{\
+	size_t size;\
+	CSTL_ASSERT(self && "Rope_replace_len");\
+	CSTL_ASSERT(self->magic == self && "Rope_replace_len");\
+	CSTL_ASSERT(chars && "Rope_replace_len");\
+	size = Name##_size(self);\
+	CSTL_ASSERT(size >= idx && "Rope_replace_len");\
+	if (len > size - idx) {\
+		len = size - idx;\
+	}\
+	if (chars_len == CSTL_NPOS) {\
+		chars_len = Name##_mystrlen(chars);\
+	}\
+	if (chars_len == len) {\
+		/* 同じ長さなら上書きのみ */\
+		Name##_copy_range(self->root, (Type *) chars, idx, len, 1);\
+		return self;\
+	}\
+	if (!Name##_reserve_node(self, 2 + Name##_nodes_for(chars_len))) {\
+		Name##_trim_pool(self);\
+		return 0;\
+	}\
+	Name##_erase_nofail(self, idx, len);\
+	Name##_insert_nofail(self, idx, chars, chars_len);\
+	Name##_trim_pool(self);\
+	return self;\
+}\
+\
+/* tのoff番目から始まる要素の並びがcharsと一致するか */\
+static int Name##_match(Name *self, Name##Node *t, size_t off, size_t pos, const Type *chars, size_t chars_len)\
+{\
+	size_t k;\
+	while (chars_len) {\
+		if (off == t->len) {\
+			t = Name##_chunk_at(self->root, pos, &off);\
+		}\
+		for (k = off; k < t->len && chars_len; k++) {\
+			if (t->buf[k] != *chars) {\
+				return 0;\
+			}\
+			chars++;\
+			chars_len--;\
+		}\
+		pos += k - off;\
+		off = k;\
+	}\
+	return 1;\
+}\
+\
+size_t Name##_find(Name *self, const Type *cstr, size_t idx)\
+{\
+	CSTL_ASSERT(self && "Rope_find");\
+	CSTL_ASSERT(self->magic == self && "Rope_find");\
+	CSTL_ASSERT(cstr && "Rope_find");\
+	return Name##_find_len(self, cstr, idx, CSTL_NPOS);\
+}\
+\
+size_t Name##_find_len(Name *self, const Type *chars, size_t idx, size_t chars_len)\
+{\
+	Name##Node *t;\
+	size_t off;\
+	size_t last;\
+	register size_t i;\
+	CSTL_ASSERT(self && "Rope_find_len");\
+	CSTL_ASSERT(self->magic == self && "Rope_find_len");\
+	CSTL_ASSERT(chars && "Rope_find_len");\
+	if (chars_len == CSTL_NPOS) {\
+		chars_len = Name##_mystrlen(chars);\
+	}\
+	if (chars_len == 0) {\
+		return idx;\
+	}\
+	if (Name##_size(self) <= idx || Name##_size(self) - idx < chars_len) {\
+		return CSTL_NPOS;\
+	}\
+	last = Name##_size(self) - chars_len;\
+	while (idx <= last) {\
+		t = Name##_chunk_at(self->root, idx, &off);\
+		for (i = off; i < t->len && idx <= last; i++, idx++) {\
+			if (t->buf[i] == chars[0] && Name##_match(self, t, i, idx, chars, chars_len)) {\
+				return idx;\
+			}\
+		}\
+	}\
+	return CSTL_NPOS;\
+}\
+\
+size_t Name##_find_c(Name *self, Type c, size_t idx)\
+{\
+	CSTL_ASSERT(self && "Rope_find_c");\
+	CSTL_ASSERT(self->magic == self && "Rope_find_c");\
+	return Name##_find_len(self, &c, idx, 1);\
+}\
+\
+size_t Name##_rfind(Name *self, const Type *cstr, size_t idx)\
+{\
+	CSTL_ASSERT(self && "Rope_rfind");\
+	CSTL_ASSERT(self->magic == self && "Rope_rfind");\
+	CSTL_ASSERT(cstr && "Rope_rfind");\
+	return Name##_rfind_len(self, cstr, idx, CSTL_NPOS);\
+}\
+\
+size_t Name##_rfind_len(Name *self, const Type *chars, size_t idx, size_t chars_len)\
+{\
+	Name##Node *t;\
+	size_t off;\
+	size_t size;\
+	register size_t i;\
+	CSTL_ASSERT(self && "Rope_rfind_len");\
+	CSTL_ASSERT(self->magic == self && "Rope_rfind_len");\
+	CSTL_ASSERT(chars && "Rope_rfind_len");\
+	if (chars_len == CSTL_NPOS) {\
+		chars_len = Name##_mystrlen(chars);\
+	}\
+	size = Name##_size(self);\
+	if (size < chars_len) {\
+		return CSTL_NPOS;\
+	}\
+	if (size - chars_len < idx) {\
+		idx = size - chars_len;\
+	}\
+	if (chars_len == 0) {\
+		return idx;\
+	}\
+	while (1) {\
+		t = Name##_chunk_at(self->root, idx, &off);\
+		for (i = off + 1; i > 0; i--) {\
+			if (t->buf[i - 1] == chars[0] && Name##_match(self, t, i - 1, idx, chars, chars_len)) {\
+				return idx;\
+			}\
+			if (idx == 0) {\
+				return CSTL_NPOS;\
+			}\
+			idx--;\
+		}\
+	}\
+}\
+\
+size_t Name##_rfind_c(Name *self, Type c, size_t idx)\
+{\
+	CSTL_ASSERT(self && "Rope_rfind_c");\
+	CSTL_ASSERT(self->magic == self && "Rope_rfind_c");\
+	return Name##_rfind_len(self, &c, idx, 1);\
+}\
+\
+
+
+#endif /* CSTL_ROPE_H_INCLUDED */
@@ -47,6 +47,9 @@ struct Name##RBTree {\
 	struct Name##RBTree *left;\
 	struct Name##RBTree *right;\
 	int color;\
+	CSTL_RBTREE_SIZE(size_t size;)\
+	CSTL_RBTREE_LINK(struct Name##RBTree *next;)\
+	CSTL_RBTREE_LINK(struct Name##RBTree *prev;)\
 	Type key;\
 	CSTL_MAGIC(struct Name##RBTree *magic;)\
 };\
@@ -74,6 +77,153 @@ Type const *Name##_data(Name##Iterator pos)\
 	return &pos->key;\
 }\
 \
+Type *Name##_node_data(Name##Iterator node)\
+{\
+	CSTL_ASSERT(node && "Set_node_data");\
+	CSTL_ASSERT(node->magic == node && "Set_node_data");\
+	return &node->key;\
+}\
+\
+static int Name##RBTree_insert_range(Name *self, Name##Iterator first, Name##Iterator last, int unique)\
+{\
+	register Name##Iterator pos;\
+	register Name##Iterator tmp;\
+	Name##RBTree head;\
+	register size_t count = 0;\
+	head.right = (Name##RBTree *) &Name##RBTree_nil;\
+	tmp = &head;\
+	/* イテレータの範囲はソート済みなので、コピーをそのまま並べる */\
+	for (pos = first; pos != last; pos = Name##_next(pos)) {\
+		tmp->right = Name##RBTree_new_node(pos->key, Name##_COLOR_RED);\
+		if (!tmp->right) {\
+			for (pos = head.right; pos != 0; pos = tmp) {\
+				tmp = pos->right;\
+				free(pos);\
+			}\
+			return 0;\
+		}\
+		tmp = tmp->right;\
+		count++;\
+	}\
+	self->size += Name##RBTree_insert_sorted(self->tree, self->size, head.right, count, unique);\
+	return 1;\
+}\
+\
+static int Name##RBTree_insert_array(Name *self, Type const *data, size_t n, int unique)\
+{\
+	register Name##Iterator pos;\
+	register Name##Iterator tmp;\
+	Name##RBTree head;\
+	register size_t i;\
+	register size_t count = 0;\
+	head.right = (Name##RBTree *) &Name##RBTree_nil;\
+	tmp = &head;\
+	for (i = 0; i < n; i++) {\
+		if (i > 0) {\
+			CSTL_ASSERT(Compare(data[i - 1], data[i]) <= 0 && "(Set|MultiSet)_build_from_sorted_array");\
+			if (unique && Compare(data[i - 1], data[i]) == 0) continue;\
+		}\
+		tmp->right = Name##RBTree_new_node(data[i], Name##_COLOR_RED);\
+		if (!tmp->right) {\
+			for (pos = head.right; pos != 0; pos = tmp) {\
+				tmp = pos->right;\
+				free(pos);\
+			}\
+			return 0;\
+		}\
+		tmp = tmp->right;\
+		count++;\
+	}\
+	self->size += Name##RBTree_insert_sorted(self->tree, self->size, head.right, count, unique);\
+	return 1;\
+}\
+\
+/*! \
+ * \brief 集合演算で出力する要素の種類\
+ */\
+enum {\
+	Name##_SETOP_ONLY_X = 1,\
+	Name##_SETOP_ONLY_Y = 2,\
+	Name##_SETOP_BOTH = 4\
+};\
+\
+/* sizeの要素を持つ木を1回探索する回数の目安(log2(size) + 1) */\
+static size_t Name##RBTree_search_cost(size_t size)\
+{\
+	register size_t cost = 1;\
+	while (size >>= 1) cost++;\
+	return cost;\
+}\
+\
+/* \
+ * xとyを順にマージしながら、opで指定した種類の要素のコピーをselfに挿入する。\
+ * 出力しない側の要素を読み飛ばす場合、相手より十分に小さければ\
+ * lower_boundで読み飛ばすので、O(m log(n/m))に近い回数の比較で済む。\
+ */\
+static int Name##RBTree_set_operation(Name *self, Name *x, Name *y, int op, int unique)\
+{\
+	register Name##Iterator a;\
+	register Name##Iterator b;\
+	register Name##Iterator tmp;\
+	Name##RBTree head;\
+	register size_t count = 0;\
+	register int c;\
+	int skip_x;\
+	int skip_y;\
+	/* 出力しない側が十分大きい場合はlower_boundで読み飛ばす */\
+	skip_x = !(op & Name##_SETOP_ONLY_X) && y->size * Name##RBTree_search_cost(x->size) < x->size;\
+	skip_y = !(op & Name##_SETOP_ONLY_Y) && x->size * Name##RBTree_search_cost(y->size) < y->size;\
+	head.right = (Name##RBTree *) &Name##RBTree_nil;\
+	tmp = &head;\
+	a = Name##RBTree_begin(x->tree);\
+	b = Name##RBTree_begin(y->tree);\
+	for (;;) {\
+		if (a == Name##RBTree_end(x->tree)) {\
+			if (!(op & Name##_SETOP_ONLY_Y) || b == Name##RBTree_end(y->tree)) break;\
+			c = 1;\
+		} else if (b == Name##RBTree_end(y->tree)) {\
+			if (!(op & Name##_SETOP_ONLY_X)) break;\
+			c = -1;\
+		} else {\
+			c = Compare(a->key, b->key);\
+		}\
+		if (c < 0) {\
+			if (op & Name##_SETOP_ONLY_X) {\
+				tmp->right = Name##RBTree_new_node(a->key, Name##_COLOR_RED);\
+				if (!tmp->right) goto error;\
+				tmp = tmp->right;\
+				count++;\
+			}\
+			a = skip_x ? Name##RBTree_lower_bound(x->tree, &b->key) : Name##RBTree_next(a);\
+		} else if (c > 0) {\
+			if (op & Name##_SETOP_ONLY_Y) {\
+				tmp->right = Name##RBTree_new_node(b->key, Name##_COLOR_RED);\
+				if (!tmp->right) goto error;\
+				tmp = tmp->right;\
+				count++;\
+			}\
+			b = skip_y ? Name##RBTree_lower_bound(y->tree, &a->key) : Name##RBTree_next(b);\
+		} else {\
+			if (op & Name##_SETOP_BOTH) {\
+				tmp->right = Name##RBTree_new_node(a->key, Name##_COLOR_RED);\
+				if (!tmp->right) goto error;\
+				tmp = tmp->right;\
+				count++;\
+			}\
+			a = Name##RBTree_next(a);\
+			b = Name##RBTree_next(b);\
+		}\
+	}\
+	self->size += Name##RBTree_insert_sorted(self->tree, self->size, head.right, count, unique);\
+	return 1;\
+error:\
+	for (a = head.right; a != 0; a = tmp) {\
+		tmp = a->right;\
+		free(a);\
+	}\
+	return 0;\
+}\
+\
 
 
 /*! 
@@ -87,7 +237,15 @@ Type const *Name##_data(Name##Iterator pos)\
 CSTL_EXTERN_C_BEGIN()\
 CSTL_RBTREE_WRAPPER_INTERFACE(Name, Type, Type)\
 Name##Iterator Name##_insert(Name *self, Type data, int *success);\
+Name##Iterator Name##_insert_hint(Name *self, Name##Iterator hint, Type data, int *success);\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node, int *success);\
 Type const *Name##_data(Name##Iterator pos);\
+Type *Name##_node_data(Name##Iterator node);\
+int Name##_build_from_sorted_array(Name *self, Type const *data, size_t n);\
+int Name##_set_union(Name *self, Name *x, Name *y);\
+int Name##_set_intersection(Name *self, Name *x, Name *y);\
+int Name##_set_difference(Name *self, Name *x, Name *y);\
+int Name##_set_symmetric_difference(Name *self, Name *x, Name *y);\
 CSTL_EXTERN_C_END()\
 
 /*! 
@@ -105,7 +263,7 @@ Name##Iterator Name##_insert(Name *self, Type data, int *success)\
 	Name##Iterator pos;\
 	CSTL_ASSERT(self && "Set_insert");\
 	CSTL_ASSERT(self->magic == self && "Set_insert");\
-	pos = Name##RBTree_find(self->tree, data);\
+	pos = Name##RBTree_find(self->tree, &data);\
 	if (pos == Name##RBTree_end(self->tree)) {\
 		pos = Name##RBTree_new_node(data, Name##_COLOR_RED);\
 		if (pos) {\
@@ -121,41 +279,118 @@ Name##Iterator Name##_insert(Name *self, Type data, int *success)\
 	return pos;\
 }\
 \
+Name##Iterator Name##_insert_hint(Name *self, Name##Iterator hint, Type data, int *success)\
+{\
+	Name##Iterator pos;\
+	Name##RBTree *parent;\
+	int dir;\
+	CSTL_ASSERT(self && "Set_insert_hint");\
+	CSTL_ASSERT(self->magic == self && "Set_insert_hint");\
+	CSTL_ASSERT(hint && "Set_insert_hint");\
+	CSTL_ASSERT(hint->magic && "Set_insert_hint");\
+	parent = Name##RBTree_hint_parent(self->tree, hint, data, 1, &dir);\
+	if (!parent) {\
+		return Name##_insert(self, data, success);\
+	}\
+	if (dir == 0) {\
+		if (success) *success = 0;\
+		return parent;\
+	}\
+	pos = Name##RBTree_new_node(data, Name##_COLOR_RED);\
+	if (pos) {\
+		Name##RBTree_insert_at(self->tree, parent, dir, pos);\
+		if (success) *success = 1;\
+		self->size++;\
+	} else {\
+		if (success) *success = 0;\
+	}\
+	return pos;\
+}\
+\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node, int *success)\
+{\
+	Name##Iterator pos;\
+	CSTL_ASSERT(self && "Set_insert_node");\
+	CSTL_ASSERT(self->magic == self && "Set_insert_node");\
+	CSTL_ASSERT(node && "Set_insert_node");\
+	CSTL_ASSERT(node->magic == node && "Set_insert_node");\
+	pos = Name##RBTree_find(self->tree, &node->key);\
+	if (pos != Name##RBTree_end(self->tree)) {\
+		/* nodeの所有権は呼び出し側に残る */\
+		if (success) *success = 0;\
+		return pos;\
+	}\
+	Name##RBTree_insert(self->tree, node);\
+	self->size++;\
+	if (success) *success = 1;\
+	return node;\
+}\
+\
 int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
 {\
-	register Name##Iterator pos;\
-	register Name##Iterator tmp;\
-	Name##RBTree head;\
-	register size_t count = 0;\
 	CSTL_ASSERT(self && "Set_insert_range");\
 	CSTL_ASSERT(self->magic == self && "Set_insert_range");\
 	CSTL_ASSERT(first && "Set_insert_range");\
 	CSTL_ASSERT(last && "Set_insert_range");\
 	CSTL_ASSERT(first->magic && "Set_insert_range");\
 	CSTL_ASSERT(last->magic && "Set_insert_range");\
-	head.right = (Name##RBTree *) &Name##RBTree_nil;\
-	tmp = &head;\
-	for (pos = first; pos != last; pos = Name##_next(pos)) {\
-		if (Name##RBTree_find(self->tree, pos->key) == Name##RBTree_end(self->tree)) {\
-			tmp->right = Name##RBTree_new_node(pos->key, Name##_COLOR_RED);\
-			if (!tmp->right) {\
-				for (pos = head.right; pos != 0; pos = tmp) {\
-					tmp = pos->right;\
-					free(pos);\
-				}\
-				return 0;\
-			}\
-			tmp = tmp->right;\
-			count++;\
-		}\
-	}\
-	for (pos = head.right; pos != (Name##RBTree *) &Name##RBTree_nil; pos = tmp) {\
-		tmp = pos->right;\
-		pos->right = (Name##RBTree *) &Name##RBTree_nil;\
-		Name##RBTree_insert(self->tree, pos);\
-	}\
-	self->size += count;\
-	return 1;\
+	return Name##RBTree_insert_range(self, first, last, 1);\
+}\
+\
+int Name##_build_from_sorted_array(Name *self, Type const *data, size_t n)\
+{\
+	CSTL_ASSERT(self && "Set_build_from_sorted_array");\
+	CSTL_ASSERT(self->magic == self && "Set_build_from_sorted_array");\
+	CSTL_ASSERT((data || n == 0) && "Set_build_from_sorted_array");\
+	return Name##RBTree_insert_array(self, data, n, 1);\
+}\
+\
+int Name##_set_union(Name *self, Name *x, Name *y)\
+{\
+	CSTL_ASSERT(self && "Set_set_union");\
+	CSTL_ASSERT(self->magic == self && "Set_set_union");\
+	CSTL_ASSERT(x && "Set_set_union");\
+	CSTL_ASSERT(x->magic == x && "Set_set_union");\
+	CSTL_ASSERT(y && "Set_set_union");\
+	CSTL_ASSERT(y->magic == y && "Set_set_union");\
+	CSTL_ASSERT(self != x && self != y && "Set_set_union");\
+	return Name##RBTree_set_operation(self, x, y, Name##_SETOP_ONLY_X | Name##_SETOP_ONLY_Y | Name##_SETOP_BOTH, 1);\
+}\
+\
+int Name##_set_intersection(Name *self, Name *x, Name *y)\
+{\
+	CSTL_ASSERT(self && "Set_set_intersection");\
+	CSTL_ASSERT(self->magic == self && "Set_set_intersection");\
+	CSTL_ASSERT(x && "Set_set_intersection");\
+	CSTL_ASSERT(x->magic == x && "Set_set_intersection");\
+	CSTL_ASSERT(y && "Set_set_intersection");\
+	CSTL_ASSERT(y->magic == y && "Set_set_intersection");\
+	CSTL_ASSERT(self != x && self != y && "Set_set_intersection");\
+	return Name##RBTree_set_operation(self, x, y, Name##_SETOP_BOTH, 1);\
+}\
+\
+int Name##_set_difference(Name *self, Name *x, Name *y)\
+{\
+	CSTL_ASSERT(self && "Set_set_difference");\
+	CSTL_ASSERT(self->magic == self && "Set_set_difference");\
+	CSTL_ASSERT(x && "Set_set_difference");\
+	CSTL_ASSERT(x->magic == x && "Set_set_difference");\
+	CSTL_ASSERT(y && "Set_set_difference");\
+	CSTL_ASSERT(y->magic == y && "Set_set_difference");\
+	CSTL_ASSERT(self != x && self != y && "Set_set_difference");\
+	return Name##RBTree_set_operation(self, x, y, Name##_SETOP_ONLY_X, 1);\
+}\
+\
+int Name##_set_symmetric_difference(Name *self, Name *x, Name *y)\
+{\
+	CSTL_ASSERT(self && "Set_set_symmetric_difference");\
+	CSTL_ASSERT(self->magic == self && "Set_set_symmetric_difference");\
+	CSTL_ASSERT(x && "Set_set_symmetric_difference");\
+	CSTL_ASSERT(x->magic == x && "Set_set_symmetric_difference");\
+	CSTL_ASSERT(y && "Set_set_symmetric_difference");\
+	CSTL_ASSERT(y->magic == y && "Set_set_symmetric_difference");\
+	CSTL_ASSERT(self != x && self != y && "Set_set_symmetric_difference");\
+	return Name##RBTree_set_operation(self, x, y, Name##_SETOP_ONLY_X | Name##_SETOP_ONLY_Y, 1);\
 }\
 \
 
@@ -171,7 +406,15 @@ int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
 CSTL_EXTERN_C_BEGIN()\
 CSTL_RBTREE_WRAPPER_INTERFACE(Name, Type, Type)\
 Name##Iterator Name##_insert(Name *self, Type data);\
+Name##Iterator Name##_insert_hint(Name *self, Name##Iterator hint, Type data);\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node);\
 Type const *Name##_data(Name##Iterator pos);\
+Type *Name##_node_data(Name##Iterator node);\
+int Name##_build_from_sorted_array(Name *self, Type const *data, size_t n);\
+int Name##_set_union(Name *self, Name *x, Name *y);\
+int Name##_set_intersection(Name *self, Name *x, Name *y);\
+int Name##_set_difference(Name *self, Name *x, Name *y);\
+int Name##_set_symmetric_difference(Name *self, Name *x, Name *y);\
 CSTL_EXTERN_C_END()\
 
 /*! 
@@ -197,39 +440,103 @@ Name##Iterator Name##_insert(Name *self, Type data)\
 	return pos;\
 }\
 \
+Name##Iterator Name##_insert_hint(Name *self, Name##Iterator hint, Type data)\
+{\
+	Name##Iterator pos;\
+	Name##RBTree *parent;\
+	int dir;\
+	CSTL_ASSERT(self && "MultiSet_insert_hint");\
+	CSTL_ASSERT(self->magic == self && "MultiSet_insert_hint");\
+	CSTL_ASSERT(hint && "MultiSet_insert_hint");\
+	CSTL_ASSERT(hint->magic && "MultiSet_insert_hint");\
+	parent = Name##RBTree_hint_parent(self->tree, hint, data, 0, &dir);\
+	if (!parent) {\
+		return Name##_insert(self, data);\
+	}\
+	pos = Name##RBTree_new_node(data, Name##_COLOR_RED);\
+	if (pos) {\
+		Name##RBTree_insert_at(self->tree, parent, dir, pos);\
+		self->size++;\
+	}\
+	return pos;\
+}\
+\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node)\
+{\
+	CSTL_ASSERT(self && "MultiSet_insert_node");\
+	CSTL_ASSERT(self->magic == self && "MultiSet_insert_node");\
+	CSTL_ASSERT(node && "MultiSet_insert_node");\
+	CSTL_ASSERT(node->magic == node && "MultiSet_insert_node");\
+	Name##RBTree_insert(self->tree, node);\
+	self->size++;\
+	return node;\
+}\
+\
 int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
 {\
-	register Name##Iterator pos;\
-	register Name##Iterator tmp;\
-	Name##RBTree head;\
-	register size_t count = 0;\
 	CSTL_ASSERT(self && "MultiSet_insert_range");\
 	CSTL_ASSERT(self->magic == self && "MultiSet_insert_range");\
 	CSTL_ASSERT(first && "MultiSet_insert_range");\
 	CSTL_ASSERT(last && "MultiSet_insert_range");\
 	CSTL_ASSERT(first->magic && "MultiSet_insert_range");\
 	CSTL_ASSERT(last->magic && "MultiSet_insert_range");\
-	head.right = (Name##RBTree *) &Name##RBTree_nil;\
-	tmp = &head;\
-	for (pos = first; pos != last; pos = Name##_next(pos)) {\
-		tmp->right = Name##RBTree_new_node(pos->key, Name##_COLOR_RED);\
-		if (!tmp->right) {\
-			for (pos = head.right; pos != 0; pos = tmp) {\
-				tmp = pos->right;\
-				free(pos);\
-			}\
-			return 0;\
-		}\
-		tmp = tmp->right;\
-		count++;\
-	}\
-	for (pos = head.right; pos != (Name##RBTree *) &Name##RBTree_nil; pos = tmp) {\
-		tmp = pos->right;\
-		pos->right = (Name##RBTree *) &Name##RBTree_nil;\
-		Name##RBTree_insert(self->tree, pos);\
-	}\
-	self->size += count;\
-	return 1;\
+	return Name##RBTree_insert_range(self, first, last, 0);\
+}\
+\
+int Name##_build_from_sorted_array(Name *self, Type const *data, size_t n)\
+{\
+	CSTL_ASSERT(self && "MultiSet_build_from_sorted_array");\
+	CSTL_ASSERT(self->magic == self && "MultiSet_build_from_sorted_array");\
+	CSTL_ASSERT((data || n == 0) && "MultiSet_build_from_sorted_array");\
+	return Name##RBTree_insert_array(self, data, n, 0);\
+}\
+\
+int Name##_set_union(Name *self, Name *x, Name *y)\
+{\
+	CSTL_ASSERT(self && "MultiSet_set_union");\
+	CSTL_ASSERT(self->magic == self && "MultiSet_set_union");\
+	CSTL_ASSERT(x && "MultiSet_set_union");\
+	CSTL_ASSERT(x->magic == x && "MultiSet_set_union");\
+	CSTL_ASSERT(y && "MultiSet_set_union");\
+	CSTL_ASSERT(y->magic == y && "MultiSet_set_union");\
+	CSTL_ASSERT(self != x && self != y && "MultiSet_set_union");\
+	return Name##RBTree_set_operation(self, x, y, Name##_SETOP_ONLY_X | Name##_SETOP_ONLY_Y | Name##_SETOP_BOTH, 0);\
+}\
+\
+int Name##_set_intersection(Name *self, Name *x, Name *y)\
+{\
+	CSTL_ASSERT(self && "MultiSet_set_intersection");\
+	CSTL_ASSERT(self->magic == self && "MultiSet_set_intersection");\
+	CSTL_ASSERT(x && "MultiSet_set_intersection");\
+	CSTL_ASSERT(x->magic == x && "MultiSet_set_intersection");\
+	CSTL_ASSERT(y && "MultiSet_set_intersection");\
+	CSTL_ASSERT(y->magic == y && "MultiSet_set_intersection");\
+	CSTL_ASSERT(self != x && self != y && "MultiSet_set_intersection");\
+	return Name##RBTree_set_operation(self, x, y, Name##_SETOP_BOTH, 0);\
+}\
+\
+int Name##_set_difference(Name *self, Name *x, Name *y)\
+{\
+	CSTL_ASSERT(self && "MultiSet_set_difference");\
+	CSTL_ASSERT(self->magic == self && "MultiSet_set_difference");\
+	CSTL_ASSERT(x && "MultiSet_set_difference");\
+	CSTL_ASSERT(x->magic == x && "MultiSet_set_difference");\
+	CSTL_ASSERT(y && "MultiSet_set_difference");\
+	CSTL_ASSERT(y->magic == y && "MultiSet_set_difference");\
+	CSTL_ASSERT(self != x && self != y && "MultiSet_set_difference");\
+	return Name##RBTree_set_operation(self, x, y, Name##_SETOP_ONLY_X, 0);\
+}\
+\
+int Name##_set_symmetric_difference(Name *self, Name *x, Name *y)\
+{\
+	CSTL_ASSERT(self && "MultiSet_set_symmetric_difference");\
+	CSTL_ASSERT(self->magic == self && "MultiSet_set_symmetric_difference");\
+	CSTL_ASSERT(x && "MultiSet_set_symmetric_difference");\
+	CSTL_ASSERT(x->magic == x && "MultiSet_set_symmetric_difference");\
+	CSTL_ASSERT(y && "MultiSet_set_symmetric_difference");\
+	CSTL_ASSERT(y->magic == y && "MultiSet_set_symmetric_difference");\
+	CSTL_ASSERT(self != x && self != y && "MultiSet_set_symmetric_difference");\
+	return Name##RBTree_set_operation(self, x, y, Name##_SETOP_ONLY_X | Name##_SETOP_ONLY_Y, 0);\
 }\
 \
 
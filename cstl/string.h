@@ -35,6 +35,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <wchar.h>
 #include "common.h"
 #include "vector.h"
 
@@ -54,6 +55,40 @@
 #define CSTL_NPOS	((size_t)-1)
 
 
+/* 
+ * 要素の型の判別用。
+ * 整数型でchar/wchar_tと同じサイズ・符号ならば、標準ライブラリの関数で処理する。
+ */
+#define CSTL_STRING_IS_INTEGER(Type)	((Type) 1 / 2 == 0)
+#define CSTL_STRING_IS_SIGNED(Type)		((Type) -1 < 0)
+#define CSTL_STRING_IS_CHAR(Type)		(CSTL_STRING_IS_INTEGER(Type) && sizeof(Type) == sizeof(char))
+#define CSTL_STRING_IS_WCHAR(Type)		(CSTL_STRING_IS_INTEGER(Type) && sizeof(Type) == sizeof(wchar_t) &&\
+											CSTL_STRING_IS_SIGNED(Type) == CSTL_STRING_IS_SIGNED(wchar_t))
+#define CSTL_STRING_COMPARE_BLOCK		64
+
+
+/* 
+ * Type型の終端文字までの長さを返す静的関数Name##_mystrlenを定義する。
+ * rope.h, intern.hなどC文字列を受け取る他のコンテナでも使う。
+ */
+#define CSTL_STRING_MYSTRLEN(Name, Type)	\
+static size_t Name##_mystrlen(const Type *cstr)\
+{\
+	register size_t i = 0;\
+	if (CSTL_STRING_IS_CHAR(Type)) {\
+		return strlen((const char *) cstr);\
+	} else if (CSTL_STRING_IS_INTEGER(Type) && sizeof(Type) == sizeof(wchar_t)) {\
+		/* 終端の判定だけなので符号は問わない */\
+		return wcslen((const wchar_t *) cstr);\
+	}\
+	while (*cstr != '\0') {\
+		cstr++;\
+		i++;\
+	}\
+	return i;\
+}
+
+
 /*! 
  * \brief インターフェイスマクロ
  * 
@@ -62,6 +97,17 @@
  */
 #define CSTL_STRING_INTERFACE(Name, Type)	\
 typedef struct Name Name;\
+typedef struct Name##View Name##View;\
+\
+/*! \
+ * \brief stringビュー構造体\
+ * \
+ * 文字の配列を所有せずに参照する。\
+ */\
+struct Name##View {\
+	const Type *data;\
+	size_t size;\
+};\
 \
 CSTL_EXTERN_C_BEGIN()\
 Name *Name##_new(void);\
@@ -116,6 +162,38 @@ size_t Name##_find_first_not_of_c(Name *self, Type c, size_t idx);\
 size_t Name##_find_last_not_of(Name *self, const Type *cstr, size_t idx);\
 size_t Name##_find_last_not_of_len(Name *self, const Type *chars, size_t idx, size_t chars_len);\
 size_t Name##_find_last_not_of_c(Name *self, Type c, size_t idx);\
+Name##View Name##_view(Name *self);\
+Name##View Name##_substr_view(Name *self, size_t idx, size_t len);\
+Name *Name##_new_assign_view(Name##View view);\
+int Name##_compare_view(Name *self, Name##View view);\
+Name *Name##_assign_view(Name *self, Name##View view);\
+Name *Name##_append_view(Name *self, Name##View view);\
+Name *Name##_insert_view(Name *self, size_t idx, Name##View view);\
+Name *Name##_replace_view(Name *self, size_t idx, size_t len, Name##View view);\
+size_t Name##_find_view(Name *self, Name##View view, size_t idx);\
+size_t Name##_rfind_view(Name *self, Name##View view, size_t idx);\
+Name##View Name##View_make(const Type *chars, size_t chars_len);\
+size_t Name##View_size(Name##View self);\
+size_t Name##View_length(Name##View self);\
+int Name##View_empty(Name##View self);\
+const Type *Name##View_data(Name##View self);\
+const Type *Name##View_at(Name##View self, size_t idx);\
+Name##View Name##View_substr(Name##View self, size_t idx, size_t len);\
+void Name##View_remove_prefix(Name##View *self, size_t n);\
+void Name##View_remove_suffix(Name##View *self, size_t n);\
+int Name##View_compare(Name##View self, Name##View x);\
+size_t Name##View_find(Name##View self, Name##View x, size_t idx);\
+size_t Name##View_find_c(Name##View self, Type c, size_t idx);\
+size_t Name##View_rfind(Name##View self, Name##View x, size_t idx);\
+size_t Name##View_rfind_c(Name##View self, Type c, size_t idx);\
+size_t Name##View_find_first_of(Name##View self, Name##View x, size_t idx);\
+size_t Name##View_find_first_of_c(Name##View self, Type c, size_t idx);\
+size_t Name##View_find_last_of(Name##View self, Name##View x, size_t idx);\
+size_t Name##View_find_last_of_c(Name##View self, Type c, size_t idx);\
+size_t Name##View_find_first_not_of(Name##View self, Name##View x, size_t idx);\
+size_t Name##View_find_first_not_of_c(Name##View self, Type c, size_t idx);\
+size_t Name##View_find_last_not_of(Name##View self, Name##View x, size_t idx);\
+size_t Name##View_find_last_not_of_c(Name##View self, Type c, size_t idx);\
 CSTL_ALGORITHM_INTERFACE(Name, Type)\
 CSTL_EXTERN_C_END()\
 
@@ -130,10 +208,23 @@ CSTL_EXTERN_C_END()\
 \
 static int Name##_mymemcmp(const Type *x, const Type *y, size_t size)\
 {\
+	if (CSTL_STRING_IS_CHAR(Type)) {\
+		if (!CSTL_STRING_IS_SIGNED(Type)) {\
+			return memcmp(x, y, size);\
+		}\
+		/* memcmpはunsigned charとして比較するので、不一致のブロックだけを以下で比較し直す */\
+		while (size > CSTL_STRING_COMPARE_BLOCK && !memcmp(x, y, CSTL_STRING_COMPARE_BLOCK)) {\
+			x += CSTL_STRING_COMPARE_BLOCK;\
+			y += CSTL_STRING_COMPARE_BLOCK;\
+			size -= CSTL_STRING_COMPARE_BLOCK;\
+		}\
+	} else if (CSTL_STRING_IS_WCHAR(Type)) {\
+		return wmemcmp((const wchar_t *) x, (const wchar_t *) y, size);\
+	}\
 	if (size) {\
 		do {\
 			if (*x != *y) {\
-				return *x - *y;\
+				return (*x < *y) ? -1 : 1;\
 			}\
 			x++;\
 			y++;\
@@ -143,16 +234,23 @@ static int Name##_mymemcmp(const Type *x, const Type *y, size_t size)\
 	return 0;\
 }\
 \
-static size_t Name##_mystrlen(const Type *cstr)\
+static int Name##_compare_chars(const Type *x, size_t xlen, const Type *y, size_t ylen)\
 {\
-	register size_t i = 0;\
-	while (*cstr != '\0') {\
-		cstr++;\
-		i++;\
+	int ret;\
+	ret = (xlen && ylen) ? Name##_mymemcmp(x, y, (xlen > ylen) ? ylen : xlen) : 0;\
+	if (ret) {\
+		return ret;\
+	} else if (xlen == ylen) {\
+		return 0;\
+	} else if (xlen > ylen) {\
+		return 1;\
+	} else {\
+		return -1;\
 	}\
-	return i;\
 }\
 \
+CSTL_STRING_MYSTRLEN(Name, Type)\
+\
 CSTL_VECTOR_INTERFACE(Name##_CharVector, Type)\
 CSTL_VECTOR_IMPLEMENT_BASE(Name##_CharVector, Type)\
 CSTL_VECTOR_IMPLEMENT_RESERVE(Name##_CharVector, Type)\
@@ -286,24 +384,11 @@ int Name##_empty(Name *self)\
 \
 int Name##_compare(Name *self, Name *x)\
 {\
-	size_t len, xlen;\
-	int ret;\
 	CSTL_ASSERT(self && "String_compare");\
 	CSTL_ASSERT(x && "String_compare");\
 	CSTL_ASSERT(self->magic == self && "String_compare");\
 	CSTL_ASSERT(x->magic == x && "String_compare");\
-	len = Name##_size(self);\
-	xlen = Name##_size(x);\
-	ret = Name##_mymemcmp(Name##_c_str(self), Name##_c_str(x), (len > xlen) ? xlen : len);\
-	if (ret) {\
-		return ret;\
-	} else if (len == xlen) {\
-		return 0;\
-	} else if (len > xlen) {\
-		return 1;\
-	} else {\
-		return -1;\
-	}\
+	return Name##_compare_chars(Name##_c_str(self), Name##_size(self), Name##_c_str(x), Name##_size(x));\
 }\
 \
 Type *Name##_at(Name *self, size_t idx)\
@@ -666,6 +751,105 @@ static size_t Name##_brute_force_search_r(const Type *str, size_t str_len, const
 	return (j == 0) ? i : CSTL_NPOS;\
 }\
 \
+static size_t Name##_find_chars(const Type *p, size_t size, const Type *chars, size_t idx, size_t chars_len)\
+{\
+	size_t i;\
+	if (chars_len == 0) {\
+		return idx;\
+	}\
+	if (size <= idx) return CSTL_NPOS;\
+	i = Name##_brute_force_search(&p[idx], size - idx, chars, chars_len);\
+	if (i == CSTL_NPOS) return i;\
+	return i + idx;\
+}\
+\
+static size_t Name##_rfind_chars(const Type *p, size_t size, const Type *chars, size_t idx, size_t chars_len)\
+{\
+	if (size < chars_len) {\
+		return CSTL_NPOS;\
+	}\
+	if (size - chars_len < idx) {\
+		idx = size - chars_len;\
+	}\
+	return Name##_brute_force_search_r(p, idx + chars_len, chars, chars_len);\
+}\
+\
+static size_t Name##_find_first_of_chars(const Type *p, size_t size, const Type *chars, size_t idx, size_t chars_len)\
+{\
+	register size_t i, j;\
+	if (size <= idx) return CSTL_NPOS;\
+	for (i = idx; i < size; i++) {\
+		for (j = 0; j < chars_len; j++) {\
+			if (p[i] == chars[j]) {\
+				return i;\
+			}\
+		}\
+	}\
+	return CSTL_NPOS;\
+}\
+\
+static size_t Name##_find_last_of_chars(const Type *p, size_t size, const Type *chars, size_t idx, size_t chars_len)\
+{\
+	register size_t i, j;\
+	if (!size) {\
+		return CSTL_NPOS;\
+	}\
+	if (size <= idx) {\
+		idx = size - 1;\
+	}\
+	for (i = idx + 1; i > 0; i--) {\
+		for (j = 0; j < chars_len; j++) {\
+			if (p[i - 1] == chars[j]) {\
+				return i - 1;\
+			}\
+		}\
+	}\
+	return CSTL_NPOS;\
+}\
+\
+static size_t Name##_find_first_not_of_chars(const Type *p, size_t size, const Type *chars, size_t idx, size_t chars_len)\
+{\
+	register size_t i, j;\
+	if (size <= idx) return CSTL_NPOS;\
+	if (chars_len == 0) {\
+		return idx;\
+	}\
+	for (i = idx; i < size; i++) {\
+		for (j = 0; j < chars_len; j++) {\
+			if (p[i] != chars[j]) {\
+				if (j == chars_len - 1) return i;\
+			} else {\
+				break;\
+			}\
+		}\
+	}\
+	return CSTL_NPOS;\
+}\
+\
+static size_t Name##_find_last_not_of_chars(const Type *p, size_t size, const Type *chars, size_t idx, size_t chars_len)\
+{\
+	register size_t i, j;\
+	if (!size) {\
+		return CSTL_NPOS;\
+	}\
+	if (size <= idx) {\
+		idx = size - 1;\
+	}\
+	if (chars_len == 0) {\
+		return idx;\
+	}\
+	for (i = idx + 1; i > 0; i--) {\
+		for (j = 0; j < chars_len; j++) {\
+			if (p[i - 1] != chars[j]) {\
+				if (j == chars_len - 1) return i - 1;\
+			} else {\
+				break;\
+			}\
+		}\
+	}\
+	return CSTL_NPOS;\
+}\
+\
 size_t Name##_find(Name *self, const Type *cstr, size_t idx)\
 {\
 	CSTL_ASSERT(self && "String_find");\
@@ -676,22 +860,13 @@ size_t Name##_find(Name *self, const Type *cstr, size_t idx)\
 \
 size_t Name##_find_len(Name *self, const Type *chars, size_t idx, size_t chars_len)\
 {\
-	size_t i;\
-	size_t size;\
 	CSTL_ASSERT(self && "String_find_len");\
 	CSTL_ASSERT(self->magic == self && "String_find_len");\
 	CSTL_ASSERT(chars && "String_find_len");\
 	if (chars_len == CSTL_NPOS) {\
 		chars_len = Name##_mystrlen(chars);\
 	}\
-	if (chars_len == 0) {\
-		return idx;\
-	}\
-	size = Name##_size(self);\
-	if (size <= idx) return CSTL_NPOS;\
-	i = Name##_brute_force_search(&Name##_c_str(self)[idx], size - idx, chars, chars_len);\
-	if (i == CSTL_NPOS) return i;\
-	return i + idx;\
+	return Name##_find_chars(Name##_c_str(self), Name##_size(self), chars, idx, chars_len);\
 }\
 \
 size_t Name##_find_c(Name *self, Type c, size_t idx)\
@@ -711,21 +886,13 @@ size_t Name##_rfind(Name *self, const Type *cstr, size_t idx)\
 \
 size_t Name##_rfind_len(Name *self, const Type *chars, size_t idx, size_t chars_len)\
 {\
-	size_t size;\
 	CSTL_ASSERT(self && "String_rfind_len");\
 	CSTL_ASSERT(self->magic == self && "String_rfind_len");\
 	CSTL_ASSERT(chars && "String_rfind_len");\
 	if (chars_len == CSTL_NPOS) {\
 		chars_len = Name##_mystrlen(chars);\
 	}\
-	size = Name##_size(self);\
-	if (size < chars_len) {\
-		return CSTL_NPOS;\
-	}\
-	if (size - chars_len < idx) {\
-		idx = size - chars_len;\
-	}\
-	return Name##_brute_force_search_r(Name##_c_str(self), idx + chars_len, chars, chars_len);\
+	return Name##_rfind_chars(Name##_c_str(self), Name##_size(self), chars, idx, chars_len);\
 }\
 \
 size_t Name##_rfind_c(Name *self, Type c, size_t idx)\
@@ -745,26 +912,13 @@ size_t Name##_find_first_of(Name *self, const Type *cstr, size_t idx)\
 \
 size_t Name##_find_first_of_len(Name *self, const Type *chars, size_t idx, size_t chars_len)\
 {\
-	register size_t i, j;\
-	size_t size;\
-	const Type *p;\
 	CSTL_ASSERT(self && "String_find_first_of_len");\
 	CSTL_ASSERT(self->magic == self && "String_find_first_of_len");\
 	CSTL_ASSERT(chars && "String_find_first_of_len");\
-	size = Name##_size(self);\
-	if (size <= idx) return CSTL_NPOS;\
 	if (chars_len == CSTL_NPOS) {\
 		chars_len = Name##_mystrlen(chars);\
 	}\
-	p = Name##_c_str(self);\
-	for (i = idx; i < size; i++) {\
-		for (j = 0; j < chars_len; j++) {\
-			if (p[i] == chars[j]) {\
-				return i;\
-			}\
-		}\
-	}\
-	return CSTL_NPOS;\
+	return Name##_find_first_of_chars(Name##_c_str(self), Name##_size(self), chars, idx, chars_len);\
 }\
 \
 size_t Name##_find_first_of_c(Name *self, Type c, size_t idx)\
@@ -784,31 +938,13 @@ size_t Name##_find_last_of(Name *self, const Type *cstr, size_t idx)\
 \
 size_t Name##_find_last_of_len(Name *self, const Type *chars, size_t idx, size_t chars_len)\
 {\
-	register size_t i, j;\
-	size_t size;\
-	const Type *p;\
 	CSTL_ASSERT(self && "String_find_last_of_len");\
 	CSTL_ASSERT(self->magic == self && "String_find_last_of_len");\
 	CSTL_ASSERT(chars && "String_find_last_of_len");\
-	size = Name##_size(self);\
-	if (!size) {\
-		return CSTL_NPOS;\
-	}\
-	if (size <= idx) {\
-		idx = size - 1;\
-	}\
 	if (chars_len == CSTL_NPOS) {\
 		chars_len = Name##_mystrlen(chars);\
 	}\
-	p = Name##_c_str(self);\
-	for (i = idx + 1; i > 0; i--) {\
-		for (j = 0; j < chars_len; j++) {\
-			if (p[i - 1] == chars[j]) {\
-				return i - 1;\
-			}\
-		}\
-	}\
-	return CSTL_NPOS;\
+	return Name##_find_last_of_chars(Name##_c_str(self), Name##_size(self), chars, idx, chars_len);\
 }\
 \
 size_t Name##_find_last_of_c(Name *self, Type c, size_t idx)\
@@ -828,31 +964,13 @@ size_t Name##_find_first_not_of(Name *self, const Type *cstr, size_t idx)\
 \
 size_t Name##_find_first_not_of_len(Name *self, const Type *chars, size_t idx, size_t chars_len)\
 {\
-	register size_t i, j;\
-	size_t size;\
-	const Type *p;\
 	CSTL_ASSERT(self && "String_find_first_not_of_len");\
 	CSTL_ASSERT(self->magic == self && "String_find_first_not_of_len");\
 	CSTL_ASSERT(chars && "String_find_first_not_of_len");\
-	size = Name##_size(self);\
-	if (size <= idx) return CSTL_NPOS;\
 	if (chars_len == CSTL_NPOS) {\
 		chars_len = Name##_mystrlen(chars);\
 	}\
-	if (chars_len == 0) {\
-		return idx;\
-	}\
-	p = Name##_c_str(self);\
-	for (i = idx; i < size; i++) {\
-		for (j = 0; j < chars_len; j++) {\
-			if (p[i] != chars[j]) {\
-				if (j == chars_len - 1) return i;\
-			} else {\
-				break;\
-			}\
-		}\
-	}\
-	return CSTL_NPOS;\
+	return Name##_find_first_not_of_chars(Name##_c_str(self), Name##_size(self), chars, idx, chars_len);\
 }\
 \
 size_t Name##_find_first_not_of_c(Name *self, Type c, size_t idx)\
@@ -872,36 +990,13 @@ size_t Name##_find_last_not_of(Name *self, const Type *cstr, size_t idx)\
 \
 size_t Name##_find_last_not_of_len(Name *self, const Type *chars, size_t idx, size_t chars_len)\
 {\
-	register size_t i, j;\
-	size_t size;\
-	const Type *p;\
 	CSTL_ASSERT(self && "String_find_last_not_of_len");\
 	CSTL_ASSERT(self->magic == self && "String_find_last_not_of_len");\
 	CSTL_ASSERT(chars && "String_find_last_not_of_len");\
-	size = Name##_size(self);\
-	if (!size) {\
-		return CSTL_NPOS;\
-	}\
-	if (size <= idx) {\
-		idx = size - 1;\
-	}\
 	if (chars_len == CSTL_NPOS) {\
 		chars_len = Name##_mystrlen(chars);\
 	}\
-	if (chars_len == 0) {\
-		return idx;\
-	}\
-	p = Name##_c_str(self);\
-	for (i = idx + 1; i > 0; i--) {\
-		for (j = 0; j < chars_len; j++) {\
-			if (p[i - 1] != chars[j]) {\
-				if (j == chars_len - 1) return i - 1;\
-			} else {\
-				break;\
-			}\
-		}\
-	}\
-	return CSTL_NPOS;\
+	return Name##_find_last_not_of_chars(Name##_c_str(self), Name##_size(self), chars, idx, chars_len);\
 }\
 \
 size_t Name##_find_last_not_of_c(Name *self, Type c, size_t idx)\
@@ -911,6 +1006,213 @@ size_t Name##_find_last_not_of_c(Name *self, Type c, size_t idx)\
 	return Name##_find_last_not_of_len(self, &c, idx, 1);\
 }\
 \
+Name##View Name##_view(Name *self)\
+{\
+	CSTL_ASSERT(self && "String_view");\
+	CSTL_ASSERT(self->magic == self && "String_view");\
+	return Name##View_make(Name##_c_str(self), Name##_size(self));\
+}\
+\
+Name##View Name##_substr_view(Name *self, size_t idx, size_t len)\
+{\
+	CSTL_ASSERT(self && "String_substr_view");\
+	CSTL_ASSERT(self->magic == self && "String_substr_view");\
+	CSTL_ASSERT(Name##_size(self) >= idx && "String_substr_view");\
+	return Name##View_substr(Name##_view(self), idx, len);\
+}\
+\
+/* 空のビューはdataがNULLのことがあるので、*_len関数に渡す前に空の文字列に置き換える */\
+static const Type *Name##View_chars(Name##View view)\
+{\
+	static const Type empty[1] = {0};\
+	return view.size ? view.data : empty;\
+}\
+\
+Name *Name##_new_assign_view(Name##View view)\
+{\
+	return Name##_new_assign_len(Name##View_chars(view), view.size);\
+}\
+\
+int Name##_compare_view(Name *self, Name##View view)\
+{\
+	CSTL_ASSERT(self && "String_compare_view");\
+	CSTL_ASSERT(self->magic == self && "String_compare_view");\
+	return Name##_compare_chars(Name##_c_str(self), Name##_size(self), Name##View_chars(view), view.size);\
+}\
+\
+Name *Name##_assign_view(Name *self, Name##View view)\
+{\
+	CSTL_ASSERT(self && "String_assign_view");\
+	CSTL_ASSERT(self->magic == self && "String_assign_view");\
+	return Name##_assign_len(self, Name##View_chars(view), view.size);\
+}\
+\
+Name *Name##_append_view(Name *self, Name##View view)\
+{\
+	CSTL_ASSERT(self && "String_append_view");\
+	CSTL_ASSERT(self->magic == self && "String_append_view");\
+	return Name##_insert_len(self, Name##_size(self), Name##View_chars(view), view.size);\
+}\
+\
+Name *Name##_insert_view(Name *self, size_t idx, Name##View view)\
+{\
+	CSTL_ASSERT(self && "String_insert_view");\
+	CSTL_ASSERT(self->magic == self && "String_insert_view");\
+	CSTL_ASSERT(Name##_size(self) >= idx && "String_insert_view");\
+	return Name##_insert_len(self, idx, Name##View_chars(view), view.size);\
+}\
+\
+Name *Name##_replace_view(Name *self, size_t idx, size_t len, Name##View view)\
+{\
+	CSTL_ASSERT(self && "String_replace_view");\
+	CSTL_ASSERT(self->magic == self && "String_replace_view");\
+	CSTL_ASSERT(Name##_size(self) >= idx && "String_replace_view");\
+	return Name##_replace_len(self, idx, len, Name##View_chars(view), view.size);\
+}\
+\
+size_t Name##_find_view(Name *self, Name##View view, size_t idx)\
+{\
+	CSTL_ASSERT(self && "String_find_view");\
+	CSTL_ASSERT(self->magic == self && "String_find_view");\
+	return Name##_find_chars(Name##_c_str(self), Name##_size(self), Name##View_chars(view), idx, view.size);\
+}\
+\
+size_t Name##_rfind_view(Name *self, Name##View view, size_t idx)\
+{\
+	CSTL_ASSERT(self && "String_rfind_view");\
+	CSTL_ASSERT(self->magic == self && "String_rfind_view");\
+	return Name##_rfind_chars(Name##_c_str(self), Name##_size(self), Name##View_chars(view), idx, view.size);\
+}\
+\
+Name##View Name##View_make(const Type *chars, size_t chars_len)\
+{\
+	Name##View view;\
+	CSTL_ASSERT((chars || !chars_len) && "StringView_make");\
+	if (chars_len == CSTL_NPOS) {\
+		chars_len = Name##_mystrlen(chars);\
+	}\
+	view.data = chars;\
+	view.size = chars_len;\
+	return view;\
+}\
+\
+size_t Name##View_size(Name##View self)\
+{\
+	return self.size;\
+}\
+\
+size_t Name##View_length(Name##View self)\
+{\
+	return self.size;\
+}\
+\
+int Name##View_empty(Name##View self)\
+{\
+	return self.size == 0;\
+}\
+\
+const Type *Name##View_data(Name##View self)\
+{\
+	return self.data;\
+}\
+\
+const Type *Name##View_at(Name##View self, size_t idx)\
+{\
+	CSTL_ASSERT(self.size > idx && "StringView_at");\
+	return &self.data[idx];\
+}\
+\
+Name##View Name##View_substr(Name##View self, size_t idx, size_t len)\
+{\
+	CSTL_ASSERT(self.size >= idx && "StringView_substr");\
+	if (len > self.size - idx) {\
+		len = self.size - idx;\
+	}\
+	self.data += idx;\
+	self.size = len;\
+	return self;\
+}\
+\
+void Name##View_remove_prefix(Name##View *self, size_t n)\
+{\
+	CSTL_ASSERT(self && "StringView_remove_prefix");\
+	CSTL_ASSERT(self->size >= n && "StringView_remove_prefix");\
+	self->data += n;\
+	self->size -= n;\
+}\
+\
+void Name##View_remove_suffix(Name##View *self, size_t n)\
+{\
+	CSTL_ASSERT(self && "StringView_remove_suffix");\
+	CSTL_ASSERT(self->size >= n && "StringView_remove_suffix");\
+	self->size -= n;\
+}\
+\
+int Name##View_compare(Name##View self, Name##View x)\
+{\
+	return Name##_compare_chars(self.data, self.size, x.data, x.size);\
+}\
+\
+size_t Name##View_find(Name##View self, Name##View x, size_t idx)\
+{\
+	return Name##_find_chars(self.data, self.size, x.data, idx, x.size);\
+}\
+\
+size_t Name##View_find_c(Name##View self, Type c, size_t idx)\
+{\
+	return Name##_find_chars(self.data, self.size, &c, idx, 1);\
+}\
+\
+size_t Name##View_rfind(Name##View self, Name##View x, size_t idx)\
+{\
+	return Name##_rfind_chars(self.data, self.size, x.data, idx, x.size);\
+}\
+\
+size_t Name##View_rfind_c(Name##View self, Type c, size_t idx)\
+{\
+	return Name##_rfind_chars(self.data, self.size, &c, idx, 1);\
+}\
+\
+size_t Name##View_find_first_of(Name##View self, Name##View x, size_t idx)\
+{\
+	return Name##_find_first_of_chars(self.data, self.size, x.data, idx, x.size);\
+}\
+\
+size_t Name##View_find_first_of_c(Name##View self, Type c, size_t idx)\
+{\
+	return Name##_find_first_of_chars(self.data, self.size, &c, idx, 1);\
+}\
+\
+size_t Name##View_find_last_of(Name##View self, Name##View x, size_t idx)\
+{\
+	return Name##_find_last_of_chars(self.data, self.size, x.data, idx, x.size);\
+}\
+\
+size_t Name##View_find_last_of_c(Name##View self, Type c, size_t idx)\
+{\
+	return Name##_find_last_of_chars(self.data, self.size, &c, idx, 1);\
+}\
+\
+size_t Name##View_find_first_not_of(Name##View self, Name##View x, size_t idx)\
+{\
+	return Name##_find_first_not_of_chars(self.data, self.size, x.data, idx, x.size);\
+}\
+\
+size_t Name##View_find_first_not_of_c(Name##View self, Type c, size_t idx)\
+{\
+	return Name##_find_first_not_of_chars(self.data, self.size, &c, idx, 1);\
+}\
+\
+size_t Name##View_find_last_not_of(Name##View self, Name##View x, size_t idx)\
+{\
+	return Name##_find_last_not_of_chars(self.data, self.size, x.data, idx, x.size);\
+}\
+\
+size_t Name##View_find_last_not_of_c(Name##View self, Type c, size_t idx)\
+{\
+	return Name##_find_last_not_of_chars(self.data, self.size, &c, idx, 1);\
+}\
+\
 CSTL_ALGORITHM_IMPLEMENT(Name, Type, CSTL_VECTOR_AT)\
 
 
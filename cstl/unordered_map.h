@@ -47,6 +47,9 @@ typedef struct Name##Node Name##Node;\
 struct Name##Node {\
 	struct Name##Node *next;\
 	struct Name##Node **bucket;\
+	struct Name##Node **pprev; /* このノードを指すポインタ(直前のノードのnextかバケット)のアドレス */\
+	CSTL_HASHTABLE_LINK(struct Name##Node *succ;)\
+	CSTL_HASHTABLE_LINK(struct Name##Node *pred;)\
 	KeyType key;\
 	ValueType value;\
 	CSTL_MAGIC(struct Name##Node_Vector *magic;)\
@@ -81,6 +84,13 @@ ValueType *Name##_value(Name##Iterator pos)\
 	return &pos->value;\
 }\
 \
+KeyType *Name##_node_key(Name##Iterator node)\
+{\
+	CSTL_ASSERT(node && "UnorderedMap_node_key");\
+	CSTL_ASSERT(node->magic == (Name##Node_Vector *) node && "UnorderedMap_node_key");\
+	return &node->key;\
+}\
+\
 
 
 /*! 
@@ -95,9 +105,12 @@ CSTL_EXTERN_C_BEGIN()\
 CSTL_HASHTABLE_INTERFACE(Name, KeyType, ValueType)\
 Name##Iterator Name##_insert(Name *self, KeyType key, ValueType value, int *success);\
 Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value, int *success);\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node, int *success);\
 KeyType const *Name##_key(Name##Iterator pos);\
+KeyType *Name##_node_key(Name##Iterator node);\
 ValueType *Name##_value(Name##Iterator pos);\
 ValueType *Name##_at(Name *self, KeyType key);\
+ValueType *Name##_at_ref(Name *self, KeyType const *key);\
 CSTL_EXTERN_C_END()\
 
 /*! 
@@ -112,6 +125,7 @@ CSTL_EXTERN_C_END()\
 #define CSTL_UNORDERED_MAP_IMPLEMENT(Name, KeyType, ValueType, Hasher, Compare)	\
 CSTL_COMMON_UNORDERED_MAP_IMPLEMENT(Name, KeyType, ValueType, Hasher, Compare)\
 CSTL_HASHTABLE_IMPLEMENT_REHASH(Name, KeyType, ValueType, Hasher, Compare)\
+CSTL_HASHTABLE_IMPLEMENT_INSERT_NODE(Name, KeyType, ValueType, Hasher, Compare)\
 \
 Name##Iterator Name##_insert(Name *self, KeyType key, ValueType value, int *success)\
 {\
@@ -131,8 +145,8 @@ Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value
 	CSTL_ASSERT(self->magic == self && "UnorderedMap_insert_ref");\
 	CSTL_ASSERT(value && "UnorderedMap_insert_ref");\
 	hash_val = Hasher(key);\
-	idx = hash_val % Name##_bucket_count(self);\
-	pos = Name##_find_node(self, key, idx);\
+	idx = Name##_bucket_of(self, hash_val);\
+	pos = Name##_bloom_test(self, hash_val) ? Name##_find_node(self, &key, idx) : Name##_end(self);\
 	if (pos != Name##_end(self)) {\
 		if (success) *success = 0;\
 		return pos;\
@@ -145,15 +159,17 @@ Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value
 	/* rehash */\
 	if (self->size + 1 > self->max_load_factor * Name##_bucket_count(self)) {\
 		size_t s = (size_t) ((self->size + 1) / self->max_load_factor) + 1;\
-		if (!Name##_rehash(self, s)) {\
+		if (!Name##_grow(self, s)) {\
 			Name##Node_erase(node);\
 			if (success) *success = 0;\
 			return 0;\
 		}\
-		idx = hash_val % Name##_bucket_count(self);\
+		idx = Name##_bucket_of(self, hash_val);\
 	}\
 	alias = Name##Node_Vector_at(self->buckets, idx);\
 	*alias = Name##Node_insert(*alias, node, alias);\
+	CSTL_HASHTABLE_LINK(Name##_link_before(&self->end_node, node);)\
+	Name##_bloom_add(self, hash_val);\
 	self->size++;\
 	CSTL_MAGIC(node->magic = self->buckets);\
 	if (success) *success = 1;\
@@ -193,15 +209,19 @@ int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
 		CSTL_ASSERT(self->size + count <= self->max_load_factor * Name##_bucket_count(self) && "UnorderedMap_insert_range");\
 	}\
 	for (pos = list; pos != 0; pos = list) {\
+		size_t hash_val;\
 		size_t idx;\
 		Name##Node **alias;\
 		/* posをリストから取り外す */\
 		list = pos->next;\
 		pos->next = 0;\
 \
-		idx = Hasher(pos->key) % Name##_bucket_count(self);\
+		hash_val = Hasher(pos->key);\
+		idx = Name##_bucket_of(self, hash_val);\
 		alias = Name##Node_Vector_at(self->buckets, idx);\
 		*alias = Name##Node_insert(*alias, pos, alias);\
+		CSTL_HASHTABLE_LINK(Name##_link_before(&self->end_node, pos);)\
+		Name##_bloom_add(self, hash_val);\
 		CSTL_MAGIC(pos->magic = self->buckets);\
 	}\
 	self->size += count;\
@@ -209,32 +229,42 @@ int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
 }\
 \
 ValueType *Name##_at(Name *self, KeyType key)\
+{\
+	CSTL_ASSERT(self && "UnorderedMap_at");\
+	CSTL_ASSERT(self->magic == self && "UnorderedMap_at");\
+	return Name##_at_ref(self, &key);\
+}\
+\
+ValueType *Name##_at_ref(Name *self, KeyType const *key)\
 {\
 	Name##Iterator pos;\
 	size_t hash_val;\
 	size_t idx;\
-	CSTL_ASSERT(self && "UnorderedMap_at");\
-	CSTL_ASSERT(self->magic == self && "UnorderedMap_at");\
-	hash_val = Hasher(key);\
-	idx = hash_val % Name##_bucket_count(self);\
-	pos = Name##_find_node(self, key, idx);\
+	CSTL_ASSERT(self && "UnorderedMap_at_ref");\
+	CSTL_ASSERT(self->magic == self && "UnorderedMap_at_ref");\
+	CSTL_ASSERT(key && "UnorderedMap_at_ref");\
+	hash_val = Hasher(*key);\
+	idx = Name##_bucket_of(self, hash_val);\
+	pos = Name##_bloom_test(self, hash_val) ? Name##_find_node(self, key, idx) : Name##_end(self);\
 	if (pos == Name##_end(self)) {\
 		/* 新しい要素の値にはend_nodeの値を使用 */\
-		pos = Name##Node_new(key, &self->end_node.value);\
+		pos = Name##Node_new(*key, &self->end_node.value);\
 		if (pos) {\
 			Name##Node **alias;\
 			/* rehash */\
 			if (self->size + 1 > self->max_load_factor * Name##_bucket_count(self)) {\
 				size_t s = (size_t) ((self->size + 1) / self->max_load_factor) + 1;\
-				if (!Name##_rehash(self, s)) {\
+				if (!Name##_grow(self, s)) {\
 					Name##Node_erase(pos);\
 					/* メモリ不足 */\
 					return 0;\
 				}\
-				idx = hash_val % Name##_bucket_count(self);\
+				idx = Name##_bucket_of(self, hash_val);\
 			}\
 			alias = Name##Node_Vector_at(self->buckets, idx);\
 			*alias = Name##Node_insert(*alias, pos, alias);\
+			CSTL_HASHTABLE_LINK(Name##_link_before(&self->end_node, pos);)\
+			Name##_bloom_add(self, hash_val);\
 			self->size++;\
 			CSTL_MAGIC(pos->magic = self->buckets);\
 		} else {\
@@ -259,7 +289,9 @@ CSTL_EXTERN_C_BEGIN()\
 CSTL_HASHTABLE_INTERFACE(Name, KeyType, ValueType)\
 Name##Iterator Name##_insert(Name *self, KeyType key, ValueType value);\
 Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value);\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node);\
 KeyType const *Name##_key(Name##Iterator pos);\
+KeyType *Name##_node_key(Name##Iterator node);\
 ValueType *Name##_value(Name##Iterator pos);\
 CSTL_EXTERN_C_END()\
 
@@ -275,6 +307,7 @@ CSTL_EXTERN_C_END()\
 #define CSTL_UNORDERED_MULTIMAP_IMPLEMENT(Name, KeyType, ValueType, Hasher, Compare)	\
 CSTL_COMMON_UNORDERED_MAP_IMPLEMENT(Name, KeyType, ValueType, Hasher, Compare)\
 CSTL_HASHTABLE_IMPLEMENT_REHASH_MULTI(Name, KeyType, ValueType, Hasher, Compare)\
+CSTL_HASHTABLE_IMPLEMENT_INSERT_NODE_MULTI(Name, KeyType, ValueType, Hasher, Compare)\
 \
 Name##Iterator Name##_insert(Name *self, KeyType key, ValueType value)\
 {\
@@ -295,7 +328,7 @@ Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value
 	CSTL_ASSERT(self->magic == self && "UnorderedMultiMap_insert_ref");\
 	CSTL_ASSERT(value && "UnorderedMultiMap_insert_ref");\
 	hash_val = Hasher(key);\
-	idx = hash_val % Name##_bucket_count(self);\
+	idx = Name##_bucket_of(self, hash_val);\
 	node = Name##Node_new(key, value);\
 	if (!node) {\
 		return node;\
@@ -303,11 +336,11 @@ Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value
 	/* rehash */\
 	if (self->size + 1 > self->max_load_factor * Name##_bucket_count(self)) {\
 		size_t s = (size_t) ((self->size + 1) / self->max_load_factor) + 1;\
-		if (!Name##_rehash(self, s)) {\
+		if (!Name##_grow(self, s)) {\
 			Name##Node_erase(node);\
 			return 0;\
 		}\
-		idx = hash_val % Name##_bucket_count(self);\
+		idx = Name##_bucket_of(self, hash_val);\
 	}\
 	alias = Name##Node_Vector_at(self->buckets, idx);\
 	/* 同じキーを並べるため、バケットの各要素のキーをチェック */\
@@ -319,12 +352,15 @@ Name##Iterator Name##_insert_ref(Name *self, KeyType key, ValueType const *value
 			} else {\
 				*alias = pos;\
 			}\
+			CSTL_HASHTABLE_LINK(Name##_link_before(node->next, node);)\
 			self->size++;\
 			CSTL_MAGIC(node->magic = self->buckets);\
 			return node;\
 		}\
 	}\
 	*alias = Name##Node_insert(*alias, node, alias);\
+	CSTL_HASHTABLE_LINK(Name##_link_before(&self->end_node, node);)\
+	Name##_bloom_add(self, hash_val);\
 	self->size++;\
 	CSTL_MAGIC(node->magic = self->buckets);\
 	return node;\
@@ -363,13 +399,15 @@ int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
 	for (pos = list; pos != 0; pos = list) {\
 		register Name##Node *i;\
 		register Name##Node *prev;\
+		size_t hash_val;\
 		size_t idx;\
 		Name##Node **alias;\
 		/* posをリストから取り外す */\
 		list = pos->next;\
 		pos->next = 0;\
 \
-		idx = Hasher(pos->key) % Name##_bucket_count(self);\
+		hash_val = Hasher(pos->key);\
+		idx = Name##_bucket_of(self, hash_val);\
 		alias = Name##Node_Vector_at(self->buckets, idx);\
 		/* 同じキーを並べるため、バケットの各要素のキーをチェック */\
 		for (i = *alias, prev = 0; i != 0; prev = i, i = i->next) {\
@@ -380,11 +418,14 @@ int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
 				} else {\
 					*alias = i;\
 				}\
+				CSTL_HASHTABLE_LINK(Name##_link_before(pos->next, pos);)\
 				CSTL_MAGIC(pos->magic = self->buckets);\
 				goto next;\
 			}\
 		}\
 		*alias = Name##Node_insert(*alias, pos, alias);\
+		CSTL_HASHTABLE_LINK(Name##_link_before(&self->end_node, pos);)\
+		Name##_bloom_add(self, hash_val);\
 		CSTL_MAGIC(pos->magic = self->buckets);\
 next:\
 		;\
@@ -47,6 +47,9 @@ typedef struct Name##Node Name##Node;\
 struct Name##Node {\
 	struct Name##Node *next;\
 	struct Name##Node **bucket;\
+	struct Name##Node **pprev; /* このノードを指すポインタ(直前のノードのnextかバケット)のアドレス */\
+	CSTL_HASHTABLE_LINK(struct Name##Node *succ;)\
+	CSTL_HASHTABLE_LINK(struct Name##Node *pred;)\
 	Type key;\
 	CSTL_MAGIC(struct Name##Node_Vector *magic;)\
 };\
@@ -71,6 +74,13 @@ Type const *Name##_data(Name##Iterator pos)\
 	return &pos->key;\
 }\
 \
+Type *Name##_node_data(Name##Iterator node)\
+{\
+	CSTL_ASSERT(node && "UnorderedSet_node_data");\
+	CSTL_ASSERT(node->magic == (Name##Node_Vector *) node && "UnorderedSet_node_data");\
+	return &node->key;\
+}\
+\
 
 
 /*! 
@@ -83,7 +93,9 @@ Type const *Name##_data(Name##Iterator pos)\
 CSTL_EXTERN_C_BEGIN()\
 CSTL_HASHTABLE_INTERFACE(Name, Type, Type)\
 Name##Iterator Name##_insert(Name *self, Type data, int *success);\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node, int *success);\
 Type const *Name##_data(Name##Iterator pos);\
+Type *Name##_node_data(Name##Iterator node);\
 CSTL_EXTERN_C_END()\
 
 /*! 
@@ -97,6 +109,7 @@ CSTL_EXTERN_C_END()\
 #define CSTL_UNORDERED_SET_IMPLEMENT(Name, Type, Hasher, Compare)	\
 CSTL_COMMON_UNORDERED_SET_IMPLEMENT(Name, Type, Hasher, Compare)\
 CSTL_HASHTABLE_IMPLEMENT_REHASH(Name, Type, Type, Hasher, Compare)\
+CSTL_HASHTABLE_IMPLEMENT_INSERT_NODE(Name, Type, Type, Hasher, Compare)\
 \
 Name##Iterator Name##_insert(Name *self, Type data, int *success)\
 {\
@@ -108,8 +121,8 @@ Name##Iterator Name##_insert(Name *self, Type data, int *success)\
 	CSTL_ASSERT(self && "UnorderedSet_insert");\
 	CSTL_ASSERT(self->magic == self && "UnorderedSet_insert");\
 	hash_val = Hasher(data);\
-	idx = hash_val % Name##_bucket_count(self);\
-	pos = Name##_find_node(self, data, idx);\
+	idx = Name##_bucket_of(self, hash_val);\
+	pos = Name##_bloom_test(self, hash_val) ? Name##_find_node(self, &data, idx) : Name##_end(self);\
 	if (pos != Name##_end(self)) {\
 		if (success) *success = 0;\
 		return pos;\
@@ -122,15 +135,17 @@ Name##Iterator Name##_insert(Name *self, Type data, int *success)\
 	/* rehash */\
 	if (self->size + 1 > self->max_load_factor * Name##_bucket_count(self)) {\
 		size_t s = (size_t) ((self->size + 1) / self->max_load_factor) + 1;\
-		if (!Name##_rehash(self, s)) {\
+		if (!Name##_grow(self, s)) {\
 			Name##Node_erase(node);\
 			if (success) *success = 0;\
 			return 0;\
 		}\
-		idx = hash_val % Name##_bucket_count(self);\
+		idx = Name##_bucket_of(self, hash_val);\
 	}\
 	alias = Name##Node_Vector_at(self->buckets, idx);\
 	*alias = Name##Node_insert(*alias, node, alias);\
+	CSTL_HASHTABLE_LINK(Name##_link_before(&self->end_node, node);)\
+	Name##_bloom_add(self, hash_val);\
 	self->size++;\
 	CSTL_MAGIC(node->magic = self->buckets);\
 	if (success) *success = 1;\
@@ -170,15 +185,19 @@ int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
 		CSTL_ASSERT(self->size + count <= self->max_load_factor * Name##_bucket_count(self) && "UnorderedSet_insert_range");\
 	}\
 	for (pos = list; pos != 0; pos = list) {\
+		size_t hash_val;\
 		size_t idx;\
 		Name##Node **alias;\
 		/* posをリストから取り外す */\
 		list = pos->next;\
 		pos->next = 0;\
 \
-		idx = Hasher(pos->key) % Name##_bucket_count(self);\
+		hash_val = Hasher(pos->key);\
+		idx = Name##_bucket_of(self, hash_val);\
 		alias = Name##Node_Vector_at(self->buckets, idx);\
 		*alias = Name##Node_insert(*alias, pos, alias);\
+		CSTL_HASHTABLE_LINK(Name##_link_before(&self->end_node, pos);)\
+		Name##_bloom_add(self, hash_val);\
 		CSTL_MAGIC(pos->magic = self->buckets);\
 	}\
 	self->size += count;\
@@ -197,7 +216,9 @@ int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
 CSTL_EXTERN_C_BEGIN()\
 CSTL_HASHTABLE_INTERFACE(Name, Type, Type)\
 Name##Iterator Name##_insert(Name *self, Type data);\
+Name##Iterator Name##_insert_node(Name *self, Name##Iterator node);\
 Type const *Name##_data(Name##Iterator pos);\
+Type *Name##_node_data(Name##Iterator node);\
 CSTL_EXTERN_C_END()\
 
 /*! 
@@ -211,6 +232,7 @@ CSTL_EXTERN_C_END()\
 #define CSTL_UNORDERED_MULTISET_IMPLEMENT(Name, Type, Hasher, Compare)	\
 CSTL_COMMON_UNORDERED_SET_IMPLEMENT(Name, Type, Hasher, Compare)\
 CSTL_HASHTABLE_IMPLEMENT_REHASH_MULTI(Name, Type, Type, Hasher, Compare)\
+CSTL_HASHTABLE_IMPLEMENT_INSERT_NODE_MULTI(Name, Type, Type, Hasher, Compare)\
 \
 Name##Iterator Name##_insert(Name *self, Type data)\
 {\
@@ -223,7 +245,7 @@ Name##Iterator Name##_insert(Name *self, Type data)\
 	CSTL_ASSERT(self && "UnorderedMultiSet_insert");\
 	CSTL_ASSERT(self->magic == self && "UnorderedMultiSet_insert");\
 	hash_val = Hasher(data);\
-	idx = hash_val % Name##_bucket_count(self);\
+	idx = Name##_bucket_of(self, hash_val);\
 	node = Name##Node_new(data);\
 	if (!node) {\
 		return node;\
@@ -231,11 +253,11 @@ Name##Iterator Name##_insert(Name *self, Type data)\
 	/* rehash */\
 	if (self->size + 1 > self->max_load_factor * Name##_bucket_count(self)) {\
 		size_t s = (size_t) ((self->size + 1) / self->max_load_factor) + 1;\
-		if (!Name##_rehash(self, s)) {\
+		if (!Name##_grow(self, s)) {\
 			Name##Node_erase(node);\
 			return 0;\
 		}\
-		idx = hash_val % Name##_bucket_count(self);\
+		idx = Name##_bucket_of(self, hash_val);\
 	}\
 	alias = Name##Node_Vector_at(self->buckets, idx);\
 	/* 同じキーを並べるため、バケットの各要素のキーをチェック */\
@@ -247,12 +269,15 @@ Name##Iterator Name##_insert(Name *self, Type data)\
 			} else {\
 				*alias = pos;\
 			}\
+			CSTL_HASHTABLE_LINK(Name##_link_before(node->next, node);)\
 			self->size++;\
 			CSTL_MAGIC(node->magic = self->buckets);\
 			return node;\
 		}\
 	}\
 	*alias = Name##Node_insert(*alias, node, alias);\
+	CSTL_HASHTABLE_LINK(Name##_link_before(&self->end_node, node);)\
+	Name##_bloom_add(self, hash_val);\
 	self->size++;\
 	CSTL_MAGIC(node->magic = self->buckets);\
 	return node;\
@@ -291,13 +316,15 @@ int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
 	for (pos = list; pos != 0; pos = list) {\
 		register Name##Node *i;\
 		register Name##Node *prev;\
+		size_t hash_val;\
 		size_t idx;\
 		Name##Node **alias;\
 		/* posをリストから取り外す */\
 		list = pos->next;\
 		pos->next = 0;\
 \
-		idx = Hasher(pos->key) % Name##_bucket_count(self);\
+		hash_val = Hasher(pos->key);\
+		idx = Name##_bucket_of(self, hash_val);\
 		alias = Name##Node_Vector_at(self->buckets, idx);\
 		/* 同じキーを並べるため、バケットの各要素のキーをチェック */\
 		for (i = *alias, prev = 0; i != 0; prev = i, i = i->next) {\
@@ -308,11 +335,14 @@ int Name##_insert_range(Name *self, Name##Iterator first, Name##Iterator last)\
 				} else {\
 					*alias = i;\
 				}\
+				CSTL_HASHTABLE_LINK(Name##_link_before(pos->next, pos);)\
 				CSTL_MAGIC(pos->magic = self->buckets);\
 				goto next;\
 			}\
 		}\
 		*alias = Name##Node_insert(*alias, pos, alias);\
+		CSTL_HASHTABLE_LINK(Name##_link_before(&self->end_node, pos);)\
+		Name##_bloom_add(self, hash_val);\
 		CSTL_MAGIC(pos->magic = self->buckets);\
 next:\
 		;\
@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <string.h>
+#include <cstl/btree.h>
+
+/* btree_setのインターフェイスと実装を展開 */
+CSTL_BTREE_SET_INTERFACE(IntBSet, int)
+CSTL_BTREE_SET_IMPLEMENT(IntBSet, int, CSTL_LESS)
+
+/* btree_mapのインターフェイスと実装を展開 */
+CSTL_BTREE_MAP_INTERFACE(StrIntBMap, const char *, int)
+CSTL_BTREE_MAP_IMPLEMENT(StrIntBMap, const char *, int, strcmp)
+
+int main(void)
+{
+	{ /* btree_set */
+		int i;
+		/* イテレータ */
+		IntBSetIterator pos;
+		/* 要素の型がintのbtree_setを生成。
+		 * 型名・関数のプレフィックスはIntBSetとなる。 */
+		IntBSet *set = IntBSet_new();
+
+		/* 要素を挿入 */
+		for (i = 0; i < 100; i++) {
+			IntBSet_insert(set, (i * 37) % 100, NULL);
+		}
+		/* 要素を削除 */
+		for (pos = IntBSet_begin(set); pos != IntBSet_end(set);) {
+			if (*IntBSet_data(pos) % 10 != 0) {
+				/* 削除するとイテレータは無効になるので、戻り値を使う */
+				pos = IntBSet_erase(set, pos);
+			} else {
+				pos = IntBSet_next(pos);
+			}
+		}
+		/* 要素数 */
+		printf("size: %d\n", (int) IntBSet_size(set));
+		for (pos = IntBSet_begin(set); pos != IntBSet_end(set); 
+				pos = IntBSet_next(pos)) {
+			/* イテレータによる要素の読み出し */
+			printf("%d\n", *IntBSet_data(pos));
+		}
+
+		/* 使い終わったら破棄 */
+		IntBSet_delete(set);
+	}
+	{ /* btree_map */
+		/* イテレータ */
+		StrIntBMapIterator pos;
+		/* キーが文字列、値がintのbtree_mapを生成。
+		 * 型名・関数のプレフィックスはStrIntBMapとなる。 */
+		StrIntBMap *map = StrIntBMap_new();
+
+		/* 要素を挿入 */
+		StrIntBMap_insert(map, "aaa", 1, NULL);
+		StrIntBMap_insert(map, "bbb", 2, NULL);
+		/* キーによる値の読み書き */
+		printf("%d\n", *StrIntBMap_at(map, "aaa"));
+		*StrIntBMap_at(map, "bbb") = 3;
+		*StrIntBMap_at(map, "ccc") = 4; /* 存在しないキーの要素は自動的に挿入 */
+		/* 要素数 */
+		printf("size: %d\n", (int) StrIntBMap_size(map));
+		for (pos = StrIntBMap_begin(map); pos != StrIntBMap_end(map); 
+				pos = StrIntBMap_next(pos)) {
+			/* イテレータによる要素の読み書き */
+			printf("%s: %d,", *StrIntBMap_key(pos), *StrIntBMap_value(pos));
+			*StrIntBMap_value(pos) += 1;
+			printf("%d\n", *StrIntBMap_value(pos));
+		}
+
+		/* 使い終わったら破棄 */
+		StrIntBMap_delete(map);
+	}
+	return 0;
+}
@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <cstl/compact_unordered_set.h>
+
+/* compact_unordered_setのインターフェイスと実装を展開 */
+CSTL_COMPACT_UNORDERED_SET_INTERFACE(IntCUSet, int)
+CSTL_COMPACT_UNORDERED_SET_IMPLEMENT(IntCUSet, int, IntCUSet_hash_int, CSTL_EQUAL_TO)
+
+int main(void)
+{
+	int i;
+	IntCUSetIterator pos;
+	/* int型の要素を持つcompact_unordered_setを生成。
+	 * 型名・関数のプレフィックスはIntCUSetとなる。 */
+	IntCUSet *set = IntCUSet_new();
+
+	/* 挿入する要素数が分かっていれば予約しておく */
+	IntCUSet_reserve(set, 100);
+	for (i = 0; i < 100; i++) {
+		IntCUSet_insert(set, i * i, NULL);
+	}
+	/* サイズ */
+	printf("size: %d\n", (int) IntCUSet_size(set));
+	/* 検索 */
+	if (IntCUSet_find(set, 49) != IntCUSet_end(set)) {
+		printf("found 49\n");
+	}
+	/* 偶数の要素を削除。削除した位置には末尾の要素が移ってくるので、posを進めない */
+	for (pos = IntCUSet_begin(set); pos != IntCUSet_end(set); ) {
+		if (*IntCUSet_data(pos) % 2 == 0) {
+			pos = IntCUSet_erase(set, pos);
+		} else {
+			pos = IntCUSet_next(pos);
+		}
+	}
+	/* 全要素の表示 */
+	for (pos = IntCUSet_begin(set); pos != IntCUSet_end(set); pos = IntCUSet_next(pos)) {
+		printf("%d\n", *IntCUSet_data(pos));
+	}
+
+	/* 使い終わったら破棄 */
+	IntCUSet_delete(set);
+	return 0;
+}
@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <pthread.h>
+#include <cstl/concurrent_unordered_map.h>
+
+/* concurrent_unordered_mapのインターフェイスと実装を展開 */
+CSTL_CONCURRENT_UNORDERED_MAP_INTERFACE(IntIntCMap, int, int)
+CSTL_CONCURRENT_UNORDERED_MAP_IMPLEMENT(IntIntCMap, int, int, IntIntCMap_ShardMap_hash_int, CSTL_EQUAL_TO)
+
+static IntIntCMap *map;
+
+/* 値を1増やす。新しい要素の値は不定なので初期化する */
+static void increment(int *value, int inserted, void *arg)
+{
+	if (inserted) {
+		*value = 0;
+	}
+	(*value)++;
+}
+
+static void print(int const *key, int *value, void *arg)
+{
+	printf("%d: %d\n", *key, *value);
+}
+
+static void *worker(void *arg)
+{
+	int i;
+	for (i = 0; i < 1000; i++) {
+		/* 複数のスレッドから同時に呼び出せる */
+		IntIntCMap_at(map, i % 4, increment, NULL);
+	}
+	return NULL;
+}
+
+int main(void)
+{
+	int i;
+	int value;
+	pthread_t th[4];
+	/* concurrent_unordered_mapを16個のシャードで生成。
+	 * 型名・関数のプレフィックスはIntIntCMapとなる。 */
+	map = IntIntCMap_new(16);
+
+	for (i = 0; i < 4; i++) {
+		pthread_create(&th[i], NULL, worker, NULL);
+	}
+	for (i = 0; i < 4; i++) {
+		pthread_join(th[i], NULL);
+	}
+
+	/* 値はコピーして取り出す */
+	if (IntIntCMap_find(map, 0, &value)) {
+		printf("%d\n", value);
+	}
+	/* 全要素の表示 */
+	IntIntCMap_for_each(map, print, NULL);
+
+	/* 使い終わったら破棄 */
+	IntIntCMap_delete(map);
+	return 0;
+}
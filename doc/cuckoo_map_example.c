@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <cstl/cuckoo.h>
+
+/* cuckoo_mapのインターフェイスと実装を展開 */
+CSTL_CUCKOO_MAP_INTERFACE(IntIntCkMap, int, int)
+CSTL_CUCKOO_MAP_IMPLEMENT(IntIntCkMap, int, int, IntIntCkMap_hash_int, CSTL_EQUAL_TO)
+
+static void print_pair(int const *key, int *value, void *arg)
+{
+	printf("%d: %d\n", *key, *value);
+}
+
+int main(void)
+{
+	int i;
+	int *value;
+	/* キーがint型、値がint型のcuckoo_mapを生成。
+	 * 型名・関数のプレフィックスはIntIntCkMapとなる。 */
+	IntIntCkMap *map = IntIntCkMap_new();
+
+	/* 挿入 */
+	for (i = 0; i < 10; i++) {
+		IntIntCkMap_insert(map, i, i * i, NULL);
+	}
+	/* atで値を書き換える。キーがなければ挿入される */
+	*IntIntCkMap_at(map, 3) = -9;
+	*IntIntCkMap_at(map, 100) = 10000;
+	/* サイズ */
+	printf("size: %d\n", (int) IntIntCkMap_size(map));
+	/* 検索 */
+	value = IntIntCkMap_find(map, 3);
+	if (value) {
+		printf("3: %d\n", *value);
+	}
+	/* 削除 */
+	IntIntCkMap_erase_key(map, 0);
+	/* 全要素の表示(順序は不定) */
+	IntIntCkMap_for_each(map, print_pair, NULL);
+
+	/* 使い終わったら破棄 */
+	IntIntCkMap_delete(map);
+	return 0;
+}
@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <cstl/cuckoo.h>
+
+/* cuckoo_setのインターフェイスと実装を展開 */
+CSTL_CUCKOO_SET_INTERFACE(IntCkSet, int)
+CSTL_CUCKOO_SET_IMPLEMENT(IntCkSet, int, IntCkSet_hash_int, CSTL_EQUAL_TO)
+
+static void print_data(int const *data, void *arg)
+{
+	printf("%d\n", *data);
+}
+
+int main(void)
+{
+	int i;
+	/* int型の要素を持つcuckoo_setを生成。
+	 * 型名・関数のプレフィックスはIntCkSetとなる。 */
+	IntCkSet *set = IntCkSet_new();
+
+	/* 挿入する要素数が分かっていれば予約しておく */
+	IntCkSet_reserve(set, 100);
+	for (i = 0; i < 100; i++) {
+		IntCkSet_insert(set, i * i, NULL);
+	}
+	/* サイズ */
+	printf("size: %d\n", (int) IntCkSet_size(set));
+	/* 検索。調べるのは2つのバケットだけ */
+	if (IntCkSet_find(set, 49)) {
+		printf("found 49\n");
+	}
+	/* 偶数の要素を削除 */
+	for (i = 0; i < 100; i += 2) {
+		IntCkSet_erase_key(set, i * i);
+	}
+	/* 全要素の表示(順序は不定) */
+	IntCkSet_for_each(set, print_data, NULL);
+
+	/* 使い終わったら破棄 */
+	IntCkSet_delete(set);
+	return 0;
+}
@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include <cstl/intern.h>
+#include <cstl/unordered_map.h>
+
+/* internのインターフェイスと実装を展開 */
+CSTL_INTERN_INTERFACE(Intern, char)
+CSTL_INTERN_IMPLEMENT(Intern, char)
+
+/* InternHandleをキーとするunordered_mapのインターフェイスと実装を展開 */
+CSTL_UNORDERED_MAP_INTERFACE(HandleIntMap, InternHandle, int)
+CSTL_UNORDERED_MAP_IMPLEMENT(HandleIntMap, InternHandle, int, Intern_hash, CSTL_EQUAL_TO)
+
+int main(void)
+{
+	InternHandle a, b, c;
+	HandleIntMap *map;
+	/* internを生成。
+	 * 型名・関数のプレフィックスはInternとなる。 */
+	Intern *pool = Intern_new();
+
+	/* 文字列をインターンする */
+	a = Intern_intern(pool, "service");
+	b = Intern_intern(pool, "service");
+	c = Intern_intern(pool, "tag");
+	/* 同じ文字列は同じハンドルになるので、ポインタの比較で等価判定ができる */
+	printf("%d, %d\n", a == b, a == c);
+	printf("%s: %d\n", Intern_c_str(a), (int) Intern_refcount(a));
+
+	/* ハンドルをキーとして使う。ハッシュ値は計算済み */
+	map = HandleIntMap_new();
+	*HandleIntMap_at(map, a) = 1;
+	*HandleIntMap_at(map, c) = 2;
+	printf("%d\n", *HandleIntMap_at(map, Intern_lookup(pool, "tag")));
+	HandleIntMap_delete(map);
+
+	/* 使い終わったハンドルを解放 */
+	Intern_release(pool, a);
+	Intern_release(pool, b);
+	Intern_release(pool, c);
+	printf("%d\n", (int) Intern_size(pool));
+
+	/* 使い終わったら破棄 */
+	Intern_delete(pool);
+	return 0;
+}
@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <pthread.h>
+#include <cstl/persistent_map.h>
+
+/* persistent_mapのインターフェイスと実装を展開 */
+CSTL_PERSISTENT_MAP_INTERFACE(IntIntPMap, int, int)
+CSTL_PERSISTENT_MAP_IMPLEMENT(IntIntPMap, int, int, CSTL_LESS)
+
+static void print(int const *key, int const *value, void *arg)
+{
+	printf("%d: %d\n", *key, *value);
+}
+
+/* スナップショットを別のスレッドで書き出して破棄する */
+static void *exporter(void *arg)
+{
+	IntIntPMap *snap = (IntIntPMap *) arg;
+	IntIntPMap_for_each(snap, print, NULL);
+	IntIntPMap_delete(snap);
+	return NULL;
+}
+
+int main(void)
+{
+	int i;
+	pthread_t th;
+	/* キーがint型、値がint型のpersistent_mapを生成。
+	 * 型名・関数のプレフィックスはIntIntPMapとなる。 */
+	IntIntPMap *map = IntIntPMap_new();
+	for (i = 0; i < 5; i++) {
+		IntIntPMap_insert(map, i, i * i, NULL);
+	}
+
+	/* O(1)でスナップショットを作る */
+	pthread_create(&th, NULL, exporter, IntIntPMap_snapshot(map));
+	/* 書き出しの間も変更できる。スナップショットには影響しない */
+	IntIntPMap_assign(map, 0, 100);
+	IntIntPMap_erase_key(map, 1);
+	pthread_join(th, NULL);
+
+	/* 値の検索 */
+	printf("0: %d\n", *IntIntPMap_find(map, 0));
+	printf("size: %d\n", (int) IntIntPMap_size(map));
+
+	/* 使い終わったら破棄 */
+	IntIntPMap_delete(map);
+	return 0;
+}
@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include <pthread.h>
+#include <cstl/rcu_unordered_map.h>
+
+/* rcu_unordered_mapのインターフェイスと実装を展開 */
+CSTL_RCU_UNORDERED_MAP_INTERFACE(IntIntRMap, int, int)
+CSTL_RCU_UNORDERED_MAP_IMPLEMENT(IntIntRMap, int, int, IntIntRMap_hash_int, CSTL_EQUAL_TO)
+
+static IntIntRMap *map;
+
+static void print(int const *key, int const *value, void *arg)
+{
+	printf("%d: %d\n", *key, *value);
+}
+
+static void *reader(void *arg)
+{
+	int i;
+	long sum = 0;
+	int value;
+	for (i = 0; i < 100000; i++) {
+		/* 複数のスレッドからロックなしで検索できる。値はコピーして取り出す */
+		if (IntIntRMap_find(map, i % 10, &value)) {
+			sum += value;
+		}
+	}
+	return (void *) sum;
+}
+
+int main(void)
+{
+	int i;
+	pthread_t th[4];
+	/* rcu_unordered_mapを生成。
+	 * 型名・関数のプレフィックスはIntIntRMapとなる。 */
+	map = IntIntRMap_new();
+	for (i = 0; i < 10; i++) {
+		IntIntRMap_insert(map, i, i, NULL);
+	}
+
+	for (i = 0; i < 4; i++) {
+		pthread_create(&th[i], NULL, reader, NULL);
+	}
+	/* 検索中でも更新できる。検索側は古い値か新しい値のどちらかを得る */
+	for (i = 0; i < 10; i++) {
+		IntIntRMap_assign(map, i, i * 100);
+	}
+	IntIntRMap_erase_key(map, 0);
+	for (i = 0; i < 4; i++) {
+		pthread_join(th[i], NULL);
+	}
+
+	/* 全要素の表示 */
+	IntIntRMap_for_each(map, print, NULL);
+
+	/* 使い終わったら破棄 */
+	IntIntRMap_delete(map);
+	return 0;
+}
@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <string.h>
+#include <cstl/rope.h>
+
+/* ropeのインターフェイスと実装を展開 */
+CSTL_ROPE_INTERFACE(Rope, char)
+CSTL_ROPE_IMPLEMENT(Rope, char)
+
+int main(void)
+{
+	size_t pos;
+	char buf[64];
+	/* ropeを生成。
+	 * 型名・関数のプレフィックスはRopeとなる。 */
+	Rope *rope = Rope_new();
+
+	/* 代入 */
+	Rope_assign(rope, "rope example");
+	/* 末尾に追加 */
+	Rope_append(rope, " text");
+	/* 途中に挿入 */
+	Rope_insert(rope, 5, "editing ");
+
+	/* 検索して置換 */
+	pos = Rope_find(rope, "example", 0);
+	if (pos != CSTL_NPOS) {
+		Rope_replace(rope, pos, strlen("example"), "sample");
+	}
+
+	/* 文字の配列に取り出して出力 */
+	buf[Rope_copy(rope, buf, 0, sizeof buf - 1)] = '\0';
+	printf("%s\n", buf);
+
+	/* インデックスによる文字の読み書き */
+	*Rope_at(rope, 0) = 'R';
+	printf("%c\n", *Rope_at(rope, 0));
+
+	/* 使い終わったら破棄 */
+	Rope_delete(rope);
+	return 0;
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include <cstl/unordered_set.h>
+
+
+CSTL_UNORDERED_SET_INTERFACE(IntUSet, int)
+CSTL_UNORDERED_SET_IMPLEMENT(IntUSet, int, IntUSet_hash_int, CSTL_EQUAL_TO)
+
+
+double get_msec(void)
+{
+#ifdef _WIN32
+	return (double) GetTickCount();
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+#define COUNT		(4 * 1024 * 1024)
+#define PROBE_COUNT	(8 * 1024 * 1024)
+
+static int buf[COUNT];
+static int probe[PROBE_COUNT];
+
+static int rand_int(void)
+{
+	return (int) ((unsigned long) rand() * ((unsigned long) RAND_MAX + 1) + rand());
+}
+
+/*
+ * 要素あたりbitsビットのブルームフィルタを付けたunordered_setを作り、
+ * 要素のキーがhit_percent%のキー列で検索する。
+ */
+static void bm_find(size_t bits, int hit_percent)
+{
+	int i;
+	long found = 0;
+	long fp = 0;
+	long miss = 0;
+	double t_insert, t_find;
+	IntUSet *uset;
+	for (i = 0; i < PROBE_COUNT; i++) {
+		if ((unsigned int) rand_int() % 100 < (unsigned int) hit_percent) {
+			probe[i] = buf[(unsigned int) rand_int() % COUNT];
+		} else {
+			/* 要素は偶数なので奇数は必ず外れる */
+			probe[i] = rand_int() | 1;
+			miss++;
+		}
+	}
+	uset = IntUSet_new();
+	IntUSet_set_bloom_filter(uset, bits);
+	t_insert = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntUSet_insert(uset, buf[i], NULL);
+	}
+	t_insert = get_msec() - t_insert;
+
+	t_find = get_msec();
+	for (i = 0; i < PROBE_COUNT; i++) {
+		found += IntUSet_find(uset, probe[i]) != IntUSet_end(uset);
+	}
+	t_find = get_msec() - t_find;
+
+	if (bits) {
+		for (i = 0; i < PROBE_COUNT; i++) {
+			if (probe[i] & 1) {
+				fp += IntUSet_may_contain(uset, probe[i]);
+			}
+		}
+		printf("bloom[%2d bits]", (int) bits);
+	} else {
+		printf("no bloom      ");
+	}
+	printf(": hit %3d%%: insert %8g ms, find %8g ms, found %ld", hit_percent, t_insert, t_find, found);
+	if (bits) {
+		printf(", false positive rate %.4f", (double) fp / miss);
+	}
+	printf("\n");
+	IntUSet_delete(uset);
+}
+
+int main(void)
+{
+	int i;
+	int hit[] = {1, 10, 50};
+	size_t bits[] = {0, 8, 10, 16};
+	size_t j, k;
+	srand(0);
+	for (i = 0; i < COUNT; i++) {
+		buf[i] = rand_int() & ~1;
+	}
+	printf("*** benchmark unordered_set<int> find with bloom filter (%d elements, %d lookups) ***\n", COUNT, PROBE_COUNT);
+	for (k = 0; k < sizeof hit / sizeof hit[0]; k++) {
+		for (j = 0; j < sizeof bits / sizeof bits[0]; j++) {
+			srand(k + 1);
+			bm_find(bits[j], hit[k]);
+		}
+	}
+	return 0;
+}
+
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include <cstl/unordered_set.h>
+#include <cstl/compact_unordered_set.h>
+
+
+/*
+ * 確保中のメモリを数えるため、コンテナのmalloc/realloc/freeを置き換える。
+ * 要求サイズだけを数えるので、malloc自体のブロックごとの管理領域は含まない。
+ */
+#define HEADER_SIZE	16
+static size_t mem_bytes;
+static size_t mem_blocks;
+
+static void *count_malloc(size_t s)
+{
+	char *p = (char *) malloc(HEADER_SIZE + s);
+	if (!p) return 0;
+	*(size_t *) p = s;
+	mem_bytes += s;
+	mem_blocks++;
+	return p + HEADER_SIZE;
+}
+
+static void count_free(void *ptr)
+{
+	char *p;
+	if (!ptr) return;
+	p = (char *) ptr - HEADER_SIZE;
+	mem_bytes -= *(size_t *) p;
+	mem_blocks--;
+	free(p);
+}
+
+static void *count_realloc(void *ptr, size_t s)
+{
+	char *p;
+	size_t old;
+	if (!ptr) return count_malloc(s);
+	p = (char *) ptr - HEADER_SIZE;
+	old = *(size_t *) p;
+	p = (char *) realloc(p, HEADER_SIZE + s);
+	if (!p) return 0;
+	*(size_t *) p = s;
+	mem_bytes += s - old;
+	return p + HEADER_SIZE;
+}
+
+#define malloc(s)		count_malloc(s)
+#define realloc(p, s)	count_realloc(p, s)
+#define free(p)			count_free(p)
+
+
+CSTL_UNORDERED_SET_INTERFACE(IntUSet, int)
+CSTL_UNORDERED_SET_IMPLEMENT(IntUSet, int, IntUSet_hash_int, CSTL_EQUAL_TO)
+
+CSTL_COMPACT_UNORDERED_SET_INTERFACE(IntCUSet, int)
+CSTL_COMPACT_UNORDERED_SET_IMPLEMENT(IntCUSet, int, IntCUSet_hash_int, CSTL_EQUAL_TO)
+
+
+double get_msec(void)
+{
+#ifdef _WIN32
+	return (double) GetTickCount();
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+#define COUNT		(3000000)
+
+static int buf[COUNT];
+
+static void init_buf(void)
+{
+	int i;
+	srand(0);
+	for (i = 0; i < COUNT; i++) {
+		buf[i] = (int) ((unsigned long) rand() * ((unsigned long) RAND_MAX + 1) + rand());
+	}
+}
+
+static void report(const char *label, size_t size, size_t bytes, size_t blocks, double t_insert, double t_find, double t_iter, long sum)
+{
+	printf("%-31s: %6.2f bytes/elem, %6.3f blocks/elem, insert %8g ms, find %8g ms, iterate %8g ms (sum %ld)\n",
+			label, (double) bytes / size, (double) blocks / size, t_insert, t_find, t_iter, sum);
+}
+
+static void bm_uset(void)
+{
+	int i;
+	long found = 0;
+	long sum = 0;
+	double t_insert, t_find, t_iter;
+	size_t base = mem_bytes;
+	size_t base_blocks = mem_blocks;
+	IntUSet *uset;
+	IntUSetIterator pos;
+	uset = IntUSet_new();
+	t_insert = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntUSet_insert(uset, buf[i], NULL);
+	}
+	t_insert = get_msec() - t_insert;
+	t_find = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		found += IntUSet_find(uset, buf[i]) != IntUSet_end(uset);
+	}
+	t_find = get_msec() - t_find;
+	t_iter = get_msec();
+	for (pos = IntUSet_begin(uset); pos != IntUSet_end(uset); pos = IntUSet_next(pos)) {
+		sum += *IntUSet_data(pos);
+	}
+	t_iter = get_msec() - t_iter;
+	if (found != COUNT) {
+		printf("!!!NG!!!\n");
+	}
+	report("unordered_set",
+			IntUSet_size(uset), mem_bytes - base, mem_blocks - base_blocks, t_insert, t_find, t_iter, sum);
+	IntUSet_delete(uset);
+}
+
+static void bm_cuset(int reserve)
+{
+	int i;
+	long found = 0;
+	long sum = 0;
+	double t_insert, t_find, t_iter;
+	size_t base = mem_bytes;
+	size_t base_blocks = mem_blocks;
+	IntCUSet *cuset;
+	IntCUSetIterator pos;
+	cuset = IntCUSet_new();
+	if (reserve) {
+		IntCUSet_reserve(cuset, COUNT);
+	}
+	t_insert = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntCUSet_insert(cuset, buf[i], NULL);
+	}
+	t_insert = get_msec() - t_insert;
+	if (reserve) {
+		/* 重複したキーの分を返す */
+		IntCUSet_shrink_to_fit(cuset);
+	}
+	t_find = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		found += IntCUSet_find(cuset, buf[i]) != IntCUSet_end(cuset);
+	}
+	t_find = get_msec() - t_find;
+	t_iter = get_msec();
+	for (pos = IntCUSet_begin(cuset); pos != IntCUSet_end(cuset); pos = IntCUSet_next(pos)) {
+		sum += *IntCUSet_data(pos);
+	}
+	t_iter = get_msec() - t_iter;
+	if (found != COUNT) {
+		printf("!!!NG!!!\n");
+	}
+	report(reserve ? "compact_unordered_set (reserve)" : "compact_unordered_set",
+			IntCUSet_size(cuset), mem_bytes - base, mem_blocks - base_blocks, t_insert, t_find, t_iter, sum);
+	IntCUSet_delete(cuset);
+}
+
+int main(void)
+{
+	init_buf();
+	printf("*** benchmark unordered_set<int> vs compact_unordered_set<int> memory (%d elements) ***\n", COUNT);
+	printf("(bytes/elem does not include malloc's own overhead per block)\n");
+	bm_uset();
+	bm_cuset(0);
+	bm_cuset(1);
+	return 0;
+}
+
@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <cstl/unordered_map.h>
+#include <cstl/concurrent_unordered_map.h>
+
+CSTL_UNORDERED_MAP_INTERFACE(IntIntUMap, int, int)
+CSTL_UNORDERED_MAP_IMPLEMENT(IntIntUMap, int, int, IntIntUMap_hash_int, CSTL_EQUAL_TO)
+
+CSTL_CONCURRENT_UNORDERED_MAP_INTERFACE(IntIntCMap, int, int)
+CSTL_CONCURRENT_UNORDERED_MAP_IMPLEMENT(IntIntCMap, int, int, IntIntCMap_ShardMap_hash_int, CSTL_EQUAL_TO)
+
+
+double get_msec(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+#define KEY_COUNT		(1000000)
+#define OP_COUNT		(4000000)
+#define MAX_THREADS		(32)
+#define SHARD_COUNT		(64)
+
+/* 操作の割合: find 90%, insert 5%, erase 5% */
+enum { OP_FIND = 90, OP_INSERT = 95 };
+
+static IntIntUMap *umap;
+static pthread_mutex_t umap_mutex = PTHREAD_MUTEX_INITIALIZER;
+static IntIntCMap *cmap;
+static int thread_count;
+
+static unsigned int xorshift(unsigned int *s)
+{
+	*s ^= *s << 13;
+	*s ^= *s >> 17;
+	*s ^= *s << 5;
+	return *s;
+}
+
+/* 単一のunordered_mapをグローバルなmutexで保護する */
+static void *locked_worker(void *arg)
+{
+	unsigned int seed = (unsigned int) (size_t) arg + 1;
+	long hit = 0;
+	int i;
+	for (i = 0; i < OP_COUNT / thread_count; i++) {
+		int key = (int) (xorshift(&seed) % KEY_COUNT);
+		unsigned int op = xorshift(&seed) % 100;
+		pthread_mutex_lock(&umap_mutex);
+		if (op < OP_FIND) {
+			hit += IntIntUMap_find(umap, key) != IntIntUMap_end(umap);
+		} else if (op < OP_INSERT) {
+			IntIntUMap_insert(umap, key, key, NULL);
+		} else {
+			IntIntUMap_erase_key(umap, key);
+		}
+		pthread_mutex_unlock(&umap_mutex);
+	}
+	return (void *) hit;
+}
+
+static void *sharded_worker(void *arg)
+{
+	unsigned int seed = (unsigned int) (size_t) arg + 1;
+	long hit = 0;
+	int i;
+	for (i = 0; i < OP_COUNT / thread_count; i++) {
+		int key = (int) (xorshift(&seed) % KEY_COUNT);
+		unsigned int op = xorshift(&seed) % 100;
+		if (op < OP_FIND) {
+			hit += IntIntCMap_find(cmap, key, NULL);
+		} else if (op < OP_INSERT) {
+			IntIntCMap_insert(cmap, key, key, NULL);
+		} else {
+			IntIntCMap_erase_key(cmap, key);
+		}
+	}
+	return (void *) hit;
+}
+
+static double run(void *(*worker)(void *))
+{
+	pthread_t th[MAX_THREADS];
+	double t;
+	size_t i;
+	t = get_msec();
+	for (i = 0; i < (size_t) thread_count; i++) {
+		pthread_create(&th[i], NULL, worker, (void *) i);
+	}
+	for (i = 0; i < (size_t) thread_count; i++) {
+		pthread_join(th[i], NULL);
+	}
+	return get_msec() - t;
+}
+
+int main(void)
+{
+	int i;
+	double t;
+
+	umap = IntIntUMap_new();
+	cmap = IntIntCMap_new(SHARD_COUNT);
+	for (i = 0; i < KEY_COUNT; i += 2) {
+		IntIntUMap_insert(umap, i, i, NULL);
+		IntIntCMap_insert(cmap, i, i, NULL);
+	}
+
+	printf("*** benchmark concurrent_unordered_map<int, int> (find 90%%, insert 5%%, erase 5%%) ***\n");
+	for (thread_count = 1; thread_count <= MAX_THREADS; thread_count *= 2) {
+		t = run(locked_worker);
+		printf("mutex  : threads[%2d]: %g ms, %g Mops/s\n", thread_count, t, OP_COUNT / t / 1000.0);
+		t = run(sharded_worker);
+		printf("sharded: threads[%2d]: %g ms, %g Mops/s\n", thread_count, t, OP_COUNT / t / 1000.0);
+	}
+	if (IntIntUMap_size(umap) == 0 || IntIntCMap_size(cmap) == 0) {
+		printf("!!!NG!!!\n");
+	}
+
+	IntIntUMap_delete(umap);
+	IntIntCMap_delete(cmap);
+
+	return 0;
+}
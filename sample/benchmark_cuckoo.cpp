@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include <cstl/unordered_set.h>
+#include <cstl/cuckoo.h>
+#include <vector>
+#include <algorithm>
+
+
+CSTL_UNORDERED_SET_INTERFACE(IntUSet, int)
+CSTL_UNORDERED_SET_IMPLEMENT(IntUSet, int, IntUSet_hash_int, CSTL_EQUAL_TO)
+
+CSTL_CUCKOO_SET_INTERFACE(IntCkSet, int)
+CSTL_CUCKOO_SET_IMPLEMENT(IntCkSet, int, IntCkSet_hash_int, CSTL_EQUAL_TO)
+
+
+using namespace std;
+
+
+/* 1回の操作の時間を計るため、マイクロ秒より細かい時刻を使う */
+double get_usec(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return count.QuadPart * 1000000.0 / freq.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000.0 + tv.tv_usec;
+#endif
+}
+
+#define COUNT		(2000000)
+#define PROBE_COUNT	(4000000)
+
+static int buf[COUNT];
+static int probe[PROBE_COUNT];
+static vector<double> latency(PROBE_COUNT);
+
+static int rand_int(void)
+{
+	return (int) ((unsigned long) rand() * ((unsigned long) RAND_MAX + 1) + rand());
+}
+
+static double percentile(double p)
+{
+	size_t i = (size_t) (p * (PROBE_COUNT - 1));
+	return latency[i] * 1000.0;
+}
+
+static void print_latency(const char *label, double total, long found)
+{
+	sort(latency.begin(), latency.end());
+	printf("%-14s: find total %8.1f ms (found %ld), p50 %5.0f ns, p99 %5.0f ns, p999 %6.0f ns, p9999 %6.0f ns, max %8.0f ns\n",
+			label, total / 1000.0, found, percentile(0.5), percentile(0.99), percentile(0.999), percentile(0.9999),
+			latency[PROBE_COUNT - 1] * 1000.0);
+}
+
+/*
+ * 1回ごとの検索時間を計り、パーセンタイルを表示する。
+ * 時刻の取得にかかる時間も含まれるので、比較にだけ使うこと。
+ */
+static void bm_uset(void)
+{
+	int i;
+	long found = 0;
+	double t, total;
+	size_t max_chain = 0;
+	IntUSet *uset = IntUSet_new();
+	for (i = 0; i < COUNT; i++) {
+		IntUSet_insert(uset, buf[i], NULL);
+	}
+	for (i = 0; i < (int) IntUSet_bucket_count(uset); i++) {
+		if (IntUSet_bucket_size(uset, i) > max_chain) {
+			max_chain = IntUSet_bucket_size(uset, i);
+		}
+	}
+	total = get_usec();
+	for (i = 0; i < PROBE_COUNT; i++) {
+		t = get_usec();
+		found += IntUSet_find(uset, probe[i]) != IntUSet_end(uset);
+		latency[i] = get_usec() - t;
+	}
+	total = get_usec() - total;
+	print_latency("unordered_set", total, found);
+	printf("%-14s  load factor %.2f, longest chain %d nodes\n", "",
+			IntUSet_load_factor(uset), (int) max_chain);
+	IntUSet_delete(uset);
+}
+
+static void bm_cuckoo(void)
+{
+	int i;
+	long found = 0;
+	double t, total;
+	IntCkSet *ckset = IntCkSet_new();
+	for (i = 0; i < COUNT; i++) {
+		IntCkSet_insert(ckset, buf[i], NULL);
+	}
+	total = get_usec();
+	for (i = 0; i < PROBE_COUNT; i++) {
+		t = get_usec();
+		found += IntCkSet_count(ckset, probe[i]);
+		latency[i] = get_usec() - t;
+	}
+	total = get_usec() - total;
+	print_latency("cuckoo_set", total, found);
+	printf("%-14s  load factor %.2f, at most 2 buckets (%d slots) per lookup\n", "",
+			IntCkSet_load_factor(ckset), 2 * CSTL_CUCKOO_SLOTS);
+	IntCkSet_delete(ckset);
+}
+
+int main(void)
+{
+	int i;
+	srand(0);
+	for (i = 0; i < COUNT; i++) {
+		buf[i] = rand_int();
+	}
+	for (i = 0; i < PROBE_COUNT; i++) {
+		probe[i] = (i & 1) ? buf[(unsigned int) rand_int() % COUNT] : rand_int();
+	}
+	printf("*** benchmark unordered_set<int> vs cuckoo_set<int> find latency (%d elements, %d lookups) ***\n",
+			COUNT, PROBE_COUNT);
+	bm_uset();
+	bm_cuckoo();
+	return 0;
+}
@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include <cstl/unordered_map.h>
+
+
+CSTL_UNORDERED_MAP_INTERFACE(IntIntUMap, int, int)
+CSTL_UNORDERED_MAP_IMPLEMENT(IntIntUMap, int, int, IntIntUMap_hash_int, CSTL_EQUAL_TO)
+
+
+double get_msec(void)
+{
+#ifdef _WIN32
+	return (double) GetTickCount();
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+#define MAX_COUNT	(8 * 1024 * 1024)
+#define PROBE_COUNT	(8 * 1024 * 1024)
+#define CHUNK		(1024)
+
+static int buf[MAX_COUNT];
+static int probe[PROBE_COUNT];
+static IntIntUMapIterator iters[CHUNK];
+
+static int rand_int(void)
+{
+	return (int) ((unsigned long) rand() * ((unsigned long) RAND_MAX + 1) + rand());
+}
+
+/*
+ * count個の要素を持つunordered_mapをPROBE_COUNT個のキーで検索する。
+ * キーの半分は要素のキー、残りはランダムな値。
+ * find_batchはハッシュ結合の探索側のように、CHUNK個ずつ呼び出す。
+ */
+static void bm_find(int count)
+{
+	int i, j;
+	long hit1 = 0, hit2 = 0;
+	double t1, t2;
+	IntIntUMap *umap;
+	IntIntUMapIterator end;
+	umap = IntIntUMap_new();
+	for (i = 0; i < count; i++) {
+		buf[i] = rand_int();
+		IntIntUMap_insert(umap, buf[i], i, NULL);
+	}
+	for (i = 0; i < PROBE_COUNT; i++) {
+		probe[i] = (i & 1) ? buf[(unsigned int) rand_int() % count] : rand_int();
+	}
+	end = IntIntUMap_end(umap);
+
+	t1 = get_msec();
+	for (i = 0; i < PROBE_COUNT; i++) {
+		IntIntUMapIterator pos = IntIntUMap_find(umap, probe[i]);
+		if (pos != end) {
+			hit1 += *IntIntUMap_value(pos);
+		}
+	}
+	t1 = get_msec() - t1;
+
+	t2 = get_msec();
+	for (i = 0; i < PROBE_COUNT; i += CHUNK) {
+		IntIntUMap_find_batch(umap, &probe[i], CHUNK, iters);
+		for (j = 0; j < CHUNK; j++) {
+			if (iters[j] != end) {
+				hit2 += *IntIntUMap_value(iters[j]);
+			}
+		}
+	}
+	t2 = get_msec() - t2;
+
+	if (hit1 != hit2) {
+		printf("!!!NG!!!\n");
+	}
+	printf("size[%8d]: find %8g ms, find_batch %8g ms (%4.2fx)\n",
+			count, t1, t2, t1 / t2);
+	IntIntUMap_delete(umap);
+}
+
+int main(void)
+{
+	srand(0);
+	printf("*** benchmark unordered_map<int, int> find vs find_batch (%d lookups) ***\n", PROBE_COUNT);
+	bm_find(64 * 1024);
+	bm_find(1024 * 1024);
+	bm_find(MAX_COUNT);
+	return 0;
+}
+
@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include <cstl/unordered_set.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+
+/* 以前のハッシュ関数 */
+static size_t old_hash_string(const char *str)
+{
+	int c;
+	unsigned int val = 0;
+	while ((c = *str++) != '\0') {
+		val = val * 997 + c;
+	}
+	return (size_t) ((int) val + ((int) val >> 5));
+}
+
+CSTL_UNORDERED_SET_INTERFACE(OldStrSet, const char *)
+CSTL_UNORDERED_SET_IMPLEMENT(OldStrSet, const char *, old_hash_string, strcmp)
+
+CSTL_UNORDERED_SET_INTERFACE(StrSet, const char *)
+CSTL_UNORDERED_SET_IMPLEMENT(StrSet, const char *, StrSet_hash_string, strcmp)
+
+
+using namespace std;
+
+
+double get_msec(void)
+{
+#ifdef _WIN32
+	return (double) GetTickCount();
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+#define LOOP	(10)
+
+struct KeySet {
+	const char *name;
+	vector<string> keys;
+};
+
+static size_t hash_old(const string &s)
+{
+	return old_hash_string(s.c_str());
+}
+
+static size_t hash_string(const string &s)
+{
+	return StrSet_hash_string(s.c_str());
+}
+
+static size_t hash_chars(const string &s)
+{
+	return StrSet_hash_chars(s.data(), s.size());
+}
+
+static size_t hash_stl(const string &s)
+{
+	return std::hash<string>()(s);
+}
+
+struct Hasher {
+	const char *name;
+	size_t (*func)(const string &);
+};
+
+static const Hasher hashers[] = {
+	{"old hash_string", hash_old},
+	{"hash_string", hash_string},
+	{"hash_chars", hash_chars},
+	{"std::hash", hash_stl},
+};
+
+/* バケット数mにn個のキーを格納した時の分布の評価値。ランダムなハッシュ関数なら1に近くなる */
+static double distribution(const vector<size_t> &hashes, size_t m, int pow2, size_t *max_bucket)
+{
+	vector<size_t> buckets(m, 0);
+	double sum = 0;
+	double n = (double) hashes.size();
+	size_t i;
+	*max_bucket = 0;
+	for (i = 0; i < hashes.size(); i++) {
+		size_t idx = pow2 ? (hashes[i] & (m - 1)) : (hashes[i] % m);
+		buckets[idx]++;
+	}
+	for (i = 0; i < m; i++) {
+		sum += (double) buckets[i] * (buckets[i] + 1) / 2;
+		if (buckets[i] > *max_bucket) *max_bucket = buckets[i];
+	}
+	return sum / ((n / (2 * m)) * (n + 2 * m - 1));
+}
+
+static size_t next_prime(size_t n)
+{
+	size_t i;
+	for (n |= 1;; n += 2) {
+		for (i = 3; i * i <= n; i += 2) {
+			if (n % i == 0) break;
+		}
+		if (i * i > n) return n;
+	}
+}
+
+static void measure(const KeySet &ks)
+{
+	size_t i, j, k;
+	size_t bytes = 0;
+	for (i = 0; i < ks.keys.size(); i++) {
+		bytes += ks.keys[i].size();
+	}
+	printf("--- %s: %d keys, average length %.1f ---\n", ks.name, (int) ks.keys.size(),
+			(double) bytes / ks.keys.size());
+	for (k = 0; k < sizeof hashers / sizeof hashers[0]; k++) {
+		vector<size_t> hashes(ks.keys.size());
+		size_t collisions = 0;
+		size_t max_prime, max_pow2;
+		size_t pow2 = 1;
+		size_t sum = 0;
+		double t, q_prime, q_pow2;
+		for (i = 0; i < ks.keys.size(); i++) {
+			hashes[i] = hashers[k].func(ks.keys[i]);
+		}
+		while (pow2 < ks.keys.size()) pow2 <<= 1;
+		q_prime = distribution(hashes, next_prime(ks.keys.size()), 0, &max_prime);
+		q_pow2 = distribution(hashes, pow2, 1, &max_pow2);
+		sort(hashes.begin(), hashes.end());
+		for (i = 1; i < hashes.size(); i++) {
+			if (hashes[i] == hashes[i - 1]) collisions++;
+		}
+		t = get_msec();
+		for (j = 0; j < LOOP; j++) {
+			for (i = 0; i < ks.keys.size(); i++) {
+				sum += hashers[k].func(ks.keys[i]);
+			}
+		}
+		t = get_msec() - t;
+		printf("%-16s: collisions %6d, prime %.3f (max %2d), pow2 %.3f (max %4d), %7.2f ms, %7.1f MB/s%s\n",
+				hashers[k].name, (int) collisions, q_prime, (int) max_prime, q_pow2, (int) max_pow2,
+				t, (double) bytes * LOOP / (t * 1000.0), sum ? "" : " ");
+	}
+}
+
+static void measure_set(const KeySet &ks)
+{
+	size_t i;
+	double t;
+	OldStrSet *x = OldStrSet_new();
+	StrSet *y = StrSet_new();
+	size_t n1 = 0, n2 = 0;
+
+	t = get_msec();
+	for (i = 0; i < ks.keys.size(); i++) {
+		OldStrSet_insert(x, ks.keys[i].c_str(), 0);
+	}
+	for (i = 0; i < ks.keys.size(); i++) {
+		n1 += OldStrSet_find(x, ks.keys[i].c_str()) != OldStrSet_end(x);
+	}
+	printf("cstl: old hash_string insert/find[%d]: %g ms\n", (int) ks.keys.size(), get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < ks.keys.size(); i++) {
+		StrSet_insert(y, ks.keys[i].c_str(), 0);
+	}
+	for (i = 0; i < ks.keys.size(); i++) {
+		n2 += StrSet_find(y, ks.keys[i].c_str()) != StrSet_end(y);
+	}
+	printf("cstl: hash_string insert/find[%d]: %g ms\n", (int) ks.keys.size(), get_msec() - t);
+	if (n1 != n2 || OldStrSet_size(x) != StrSet_size(y)) {
+		printf("!!!NG!!!\n");
+	}
+	OldStrSet_delete(x);
+	StrSet_delete(y);
+}
+
+/* ファイルから識別子を取り出す */
+static void load_identifiers(KeySet &ks, const char *path)
+{
+	FILE *fp = fopen(path, "r");
+	string tok;
+	int c;
+	if (!fp) return;
+	while ((c = fgetc(fp)) != EOF) {
+		if (isalnum(c) || c == '_') {
+			tok += (char) c;
+		} else if (!tok.empty()) {
+			ks.keys.push_back(tok);
+			tok.clear();
+		}
+	}
+	fclose(fp);
+}
+
+int main(int argc, char *argv[])
+{
+	int i;
+	char buf[256];
+	KeySet seq, ids, paths, words;
+
+	printf("*** benchmark hash ***\n");
+
+	seq.name = "sequential";
+	for (i = 0; i < 1000000; i++) {
+		sprintf(buf, "key%d", i);
+		seq.keys.push_back(buf);
+	}
+
+	srand(0);
+	ids.name = "random id";
+	for (i = 0; i < 1000000; i++) {
+		sprintf(buf, "user_%04x%04x", rand() & 0xffff, rand() & 0xffff);
+		ids.keys.push_back(buf);
+	}
+
+	paths.name = "path";
+	for (i = 0; i < 200000; i++) {
+		sprintf(buf, "/usr/share/app/data/module%03d/resources/image_%05d.png", i % 1000, i / 1000);
+		paths.keys.push_back(buf);
+	}
+
+	/* 実際の識別子の集合としてヘッダファイルを使う */
+	words.name = "identifiers";
+	if (argc > 1) {
+		for (i = 1; i < argc; i++) {
+			load_identifiers(words, argv[i]);
+		}
+	} else {
+		const char *files[] = {
+			"../cstl/vector.h", "../cstl/ring.h", "../cstl/deque.h", "../cstl/list.h",
+			"../cstl/rbtree.h", "../cstl/set.h", "../cstl/map.h", "../cstl/hashtable.h",
+			"../cstl/unordered_set.h", "../cstl/unordered_map.h", "../cstl/string.h",
+			"../cstl/algorithm.h",
+		};
+		for (i = 0; i < (int) (sizeof files / sizeof files[0]); i++) {
+			load_identifiers(words, files[i]);
+		}
+	}
+	sort(words.keys.begin(), words.keys.end());
+	words.keys.erase(unique(words.keys.begin(), words.keys.end()), words.keys.end());
+
+	measure(seq);
+	measure_set(seq);
+	measure(ids);
+	measure_set(ids);
+	measure(paths);
+	measure_set(paths);
+	if (!words.keys.empty()) {
+		measure(words);
+		measure_set(words);
+	}
+
+	return 0;
+}
@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include <cstl/string.h>
+#include <cstl/intern.h>
+#include <cstl/unordered_map.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+
+/* cstlが確保したメモリ量を数える */
+static size_t mem_usage;
+
+static void *count_malloc(size_t size)
+{
+	size_t *p = (size_t *) malloc(sizeof(double) * 2 + size);
+	if (!p) return 0;
+	*p = size;
+	mem_usage += size;
+	return (double *) p + 2;
+}
+
+static void count_free(void *ptr)
+{
+	size_t *p;
+	if (!ptr) return;
+	p = (size_t *) ((double *) ptr - 2);
+	mem_usage -= *p;
+	free(p);
+}
+
+static void *count_realloc(void *ptr, size_t size)
+{
+	size_t *p;
+	if (!ptr) return count_malloc(size);
+	p = (size_t *) ((double *) ptr - 2);
+	mem_usage -= *p;
+	p = (size_t *) realloc(p, sizeof(double) * 2 + size);
+	if (!p) return 0;
+	*p = size;
+	mem_usage += size;
+	return (double *) p + 2;
+}
+
+#define malloc(s)		count_malloc(s)
+#define realloc(p, s)	count_realloc(p, s)
+#define free(p)			count_free(p)
+
+CSTL_STRING_INTERFACE(String, char)
+CSTL_STRING_IMPLEMENT(String, char)
+
+CSTL_INTERN_INTERFACE(Intern, char)
+CSTL_INTERN_IMPLEMENT(Intern, char)
+
+#define STRING_HASH(x)		StrIntMap_hash_chars(String_c_str(x), String_size(x))
+#define STRING_COMP(x, y)	String_compare(x, y)
+
+CSTL_UNORDERED_MAP_INTERFACE(StrIntMap, String *, int)
+CSTL_UNORDERED_MAP_IMPLEMENT(StrIntMap, String *, int, STRING_HASH, STRING_COMP)
+
+CSTL_UNORDERED_MAP_INTERFACE(HandleIntMap, InternHandle, int)
+CSTL_UNORDERED_MAP_IMPLEMENT(HandleIntMap, InternHandle, int, Intern_hash, CSTL_EQUAL_TO)
+
+#undef malloc
+#undef realloc
+#undef free
+
+
+using namespace std;
+
+
+double get_msec(void)
+{
+#ifdef _WIN32
+	return (double) GetTickCount();
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+#define COUNT		(1000000)
+#define DISTINCT	(1000)
+
+
+int main(void)
+{
+	int i;
+	double t;
+	size_t m;
+	size_t r1, r2, r3;
+	char buf[64];
+	String **strs;
+	InternHandle *handles;
+	Intern *pool;
+	StrIntMap *smap;
+	HandleIntMap *hmap;
+	vector<string> stds;
+	unordered_map<string, int> ymap;
+
+	strs = (String **) malloc(sizeof(String *) * COUNT);
+	handles = (InternHandle *) malloc(sizeof(InternHandle) * COUNT);
+
+	printf("*** benchmark intern ***\n");
+
+	// 重複の多いキーの生成
+	m = mem_usage;
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		sprintf(buf, "service.frontend.request.latency.%d", i % DISTINCT);
+		strs[i] = String_new_assign(buf);
+	}
+	printf("cstl: string new[%d]: %g ms, %lu bytes\n", COUNT, get_msec() - t,
+			(unsigned long) (mem_usage - m + sizeof(String *) * COUNT));
+
+	m = mem_usage;
+	t = get_msec();
+	pool = Intern_new();
+	for (i = 0; i < COUNT; i++) {
+		sprintf(buf, "service.frontend.request.latency.%d", i % DISTINCT);
+		handles[i] = Intern_intern(pool, buf);
+	}
+	printf("cstl: intern[%d]: %g ms, %lu bytes\n", COUNT, get_msec() - t,
+			(unsigned long) (mem_usage - m + sizeof(InternHandle) * COUNT));
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		sprintf(buf, "service.frontend.request.latency.%d", i % DISTINCT);
+		stds.push_back(buf);
+	}
+	printf("stl : string[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (Intern_size(pool) != DISTINCT) {
+		printf("!!!NG!!!\n");
+	}
+
+	// 比較
+	r1 = r2 = r3 = 0;
+	t = get_msec();
+	for (i = DISTINCT; i < COUNT; i++) {
+		r1 += String_compare(strs[i], strs[i - DISTINCT + (i % 3 == 0)]) == 0;
+	}
+	printf("cstl: string compare[%d]: %g ms\n", COUNT - DISTINCT, get_msec() - t);
+
+	t = get_msec();
+	for (i = DISTINCT; i < COUNT; i++) {
+		r2 += handles[i] == handles[i - DISTINCT + (i % 3 == 0)];
+	}
+	printf("cstl: handle compare[%d]: %g ms\n", COUNT - DISTINCT, get_msec() - t);
+
+	t = get_msec();
+	for (i = DISTINCT; i < COUNT; i++) {
+		r3 += stds[i] == stds[i - DISTINCT + (i % 3 == 0)];
+	}
+	printf("stl : string compare[%d]: %g ms\n", COUNT - DISTINCT, get_msec() - t);
+	if (r1 != r2 || r1 != r3) {
+		printf("!!!NG!!!\n");
+	}
+
+	// 検索
+	smap = StrIntMap_new();
+	hmap = HandleIntMap_new();
+	for (i = 0; i < DISTINCT; i++) {
+		StrIntMap_insert(smap, strs[i], i, 0);
+		HandleIntMap_insert(hmap, handles[i], i, 0);
+		ymap[stds[i]] = i;
+	}
+
+	r1 = r2 = r3 = 0;
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		r1 += *StrIntMap_value(StrIntMap_find(smap, strs[i]));
+	}
+	printf("cstl: string find[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		r2 += *HandleIntMap_value(HandleIntMap_find(hmap, handles[i]));
+	}
+	printf("cstl: handle find[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		r3 += ymap.find(stds[i])->second;
+	}
+	printf("stl : string find[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (r1 != r2 || r1 != r3) {
+		printf("!!!NG!!!\n");
+	}
+
+	StrIntMap_delete(smap);
+	HandleIntMap_delete(hmap);
+	for (i = 0; i < COUNT; i++) {
+		String_delete(strs[i]);
+		Intern_release(pool, handles[i]);
+	}
+	if (!Intern_empty(pool)) {
+		printf("!!!NG!!!\n");
+	}
+	Intern_delete(pool);
+	free(strs);
+	free(handles);
+
+	return 0;
+}
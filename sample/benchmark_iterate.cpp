@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include <cstl/unordered_map.h>
+
+
+CSTL_UNORDERED_MAP_INTERFACE(IntIntUMap, int, int)
+CSTL_UNORDERED_MAP_IMPLEMENT(IntIntUMap, int, int, IntIntUMap_hash_int, CSTL_EQUAL_TO)
+
+
+double get_msec(void)
+{
+#ifdef _WIN32
+	return (double) GetTickCount();
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+#define COUNT		(1000000)
+#define REPEAT		(10)
+
+static int buf[COUNT];
+
+static void init_buf(void)
+{
+	int i;
+	srand(0);
+	for (i = 0; i < COUNT; i++) {
+		buf[i] = (int) ((unsigned long) rand() * ((unsigned long) RAND_MAX + 1) + rand());
+	}
+}
+
+/* 全要素をREPEAT回たどる */
+static void bm_traverse(IntIntUMap *umap, const char *label)
+{
+	int i;
+	long sum = 0;
+	size_t count = 0;
+	double t;
+	IntIntUMapIterator pos;
+	t = get_msec();
+	for (i = 0; i < REPEAT; i++) {
+		for (pos = IntIntUMap_begin(umap); pos != IntIntUMap_end(umap); pos = IntIntUMap_next(pos)) {
+			sum += *IntIntUMap_value(pos);
+			count++;
+		}
+	}
+	t = get_msec() - t;
+	if (count != IntIntUMap_size(umap) * REPEAT) {
+		printf("!!!NG!!!\n");
+	}
+	printf("%-28s: size[%7d], bucket_count[%7d]: %8g ms (sum %ld)\n", label,
+			(int) IntIntUMap_size(umap), (int) IntIntUMap_bucket_count(umap), t, sum);
+}
+
+static IntIntUMapIterator iters[COUNT * 2];
+
+/* 
+ * ロードファクターの上限をmlfにして、イテレータで全要素を削除する。
+ * 先頭からの場合は常にバケットの先頭の要素を削除し、
+ * 末尾からの場合はバケットごとに末尾の要素から削除する。
+ */
+static void bm_erase_all(float mlf)
+{
+	int i, j, k;
+	int n;
+	double t1, t2;
+	IntIntUMap *umap;
+	IntIntUMapIterator pos;
+	umap = IntIntUMap_new();
+	IntIntUMap_set_max_load_factor(umap, mlf);
+	for (i = 0; i < COUNT; i++) {
+		IntIntUMap_insert(umap, buf[i], i, NULL);
+	}
+	t1 = get_msec();
+	for (pos = IntIntUMap_begin(umap); pos != IntIntUMap_end(umap); ) {
+		pos = IntIntUMap_erase(umap, pos);
+	}
+	t1 = get_msec() - t1;
+	if (!IntIntUMap_empty(umap)) {
+		printf("!!!NG!!!\n");
+	}
+	for (i = 0; i < COUNT; i++) {
+		IntIntUMap_insert(umap, buf[i], i, NULL);
+	}
+	n = 0;
+	for (i = 0; i < (int) IntIntUMap_bucket_count(umap); i++) {
+		for (pos = IntIntUMap_bucket_begin(umap, i); pos != IntIntUMap_bucket_end(umap, i); pos = IntIntUMap_bucket_next(pos)) {
+			iters[n++] = pos;
+		}
+		iters[n++] = 0; /* バケットの区切り */
+	}
+	t2 = get_msec();
+	for (i = 0; i < n; i = j + 1) {
+		for (j = i; iters[j]; j++) ;
+		for (k = j; k > i; k--) {
+			IntIntUMap_erase(umap, iters[k - 1]);
+		}
+	}
+	t2 = get_msec() - t2;
+	if (!IntIntUMap_empty(umap)) {
+		printf("!!!NG!!!\n");
+	}
+	printf("erase all by iterator       : load_factor[%6.3f]: head first %8g ms, tail first %8g ms\n",
+			(float) COUNT / IntIntUMap_bucket_count(umap), t1, t2);
+	IntIntUMap_delete(umap);
+}
+
+int main(void)
+{
+	int i;
+	double t;
+	IntIntUMap *umap;
+	init_buf();
+#ifdef CSTL_HASHTABLE_THREAD
+	printf("*** benchmark unordered_map<int, int> iteration (CSTL_HASHTABLE_THREAD) ***\n");
+#else
+	printf("*** benchmark unordered_map<int, int> iteration ***\n");
+#endif
+
+	umap = IntIntUMap_new();
+	for (i = 0; i < COUNT; i++) {
+		IntIntUMap_insert(umap, buf[i], i, NULL);
+	}
+	bm_traverse(umap, "dense");
+
+	/* 99%の要素を削除した疎なハッシュテーブル */
+	for (i = 0; i < COUNT; i++) {
+		if (i % 100 != 0) {
+			IntIntUMap_erase_key(umap, buf[i]);
+		}
+	}
+	bm_traverse(umap, "sparse (after erase)");
+	IntIntUMap_shrink_to_fit(umap);
+	bm_traverse(umap, "sparse (after shrink_to_fit)");
+	IntIntUMap_delete(umap);
+
+	/* ロードファクターの上限が小さい */
+	umap = IntIntUMap_new();
+	IntIntUMap_set_max_load_factor(umap, 0.1f);
+	for (i = 0; i < COUNT / 10; i++) {
+		IntIntUMap_insert(umap, buf[i], i, NULL);
+	}
+	bm_traverse(umap, "max_load_factor 0.1");
+	IntIntUMap_delete(umap);
+
+	/* 先頭の要素を次々に削除する */
+	umap = IntIntUMap_new();
+	for (i = 0; i < COUNT / 10; i++) {
+		IntIntUMap_insert(umap, buf[i], i, NULL);
+	}
+	t = get_msec();
+	while (!IntIntUMap_empty(umap)) {
+		IntIntUMap_erase(umap, IntIntUMap_begin(umap));
+	}
+	printf("%-28s: size[%7d]: %8g ms\n", "erase(begin()) until empty", COUNT / 10, get_msec() - t);
+	IntIntUMap_delete(umap);
+
+	bm_erase_all(1.0f);
+	bm_erase_all(4.0f);
+	bm_erase_all(16.0f);
+
+	return 0;
+}
+
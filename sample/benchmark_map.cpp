@@ -7,13 +7,26 @@
 #else
 #include <sys/time.h>
 #endif
-#include <cstl/map.h>
-#include <cstl/unordered_map.h>
 #include <map>
 
 //#define malloc(s) ::operator new(s)
 //#define free(p) ::operator delete(p)
 
+/* cstlが確保したメモリ量を数える(解放は数えないので構築直後に参照する) */
+static size_t mem_usage;
+
+static void *count_malloc(size_t size)
+{
+	mem_usage += size;
+	return malloc(size);
+}
+
+#define malloc(s)		count_malloc(s)
+
+#include <cstl/map.h>
+#include <cstl/btree.h>
+#include <cstl/unordered_map.h>
+
 #ifndef UNORDERED
 CSTL_MAP_INTERFACE(IntIntMap, int, int)
 CSTL_MAP_IMPLEMENT(IntIntMap, int, int, CSTL_LESS)
@@ -22,6 +35,35 @@ CSTL_UNORDERED_MAP_INTERFACE(IntIntMap, int, int)
 CSTL_UNORDERED_MAP_IMPLEMENT(IntIntMap, int, int, IntIntMap_hash_int, CSTL_EQUAL_TO)
 #endif
 
+CSTL_BTREE_MAP_INTERFACE(IntIntBMap, int, int)
+CSTL_BTREE_MAP_IMPLEMENT(IntIntBMap, int, int, CSTL_LESS)
+
+/* 大きな構造体をキーとする(検索時のキーのコピーを測る) */
+struct BigKey {
+	int k;
+	int pad[31];
+};
+#define BIGKEY_COMP(x, y)	CSTL_LESS((x).k, (y).k)
+
+#ifndef UNORDERED
+CSTL_MAP_INTERFACE(BigKeyMap, BigKey, int)
+CSTL_MAP_IMPLEMENT(BigKeyMap, BigKey, int, BIGKEY_COMP)
+#else
+#define BIGKEY_HASH(x)		IntIntMap_hash_int((x).k)
+CSTL_UNORDERED_MAP_INTERFACE(BigKeyMap, BigKey, int)
+CSTL_UNORDERED_MAP_IMPLEMENT(BigKeyMap, BigKey, int, BIGKEY_HASH, BIGKEY_COMP)
+
+static size_t bigkey_hash_int(const void *probe)
+{
+	return IntIntMap_hash_int(*(const int *) probe);
+}
+#endif
+
+static int bigkey_comp_int(const void *probe, BigKey const *key)
+{
+	return CSTL_LESS(*(const int *) probe, key->k);
+}
+
 using namespace std;
 
 
@@ -40,6 +82,8 @@ double get_msec(void)
 #define INSERT_COUNT	(10000)
 #define SORT_COUNT		(1000000)
 
+static int keys[COUNT];
+
 
 int main(void)
 {
@@ -49,17 +93,49 @@ int main(void)
 	map<int, int> y;
 	IntIntMapIterator xpos;
 	map<int, int>::iterator ypos;
+#ifndef UNORDERED
+	size_t ret;
+	IntIntBMap *z;
+	IntIntBMapIterator zpos;
+#endif
+
+	/* ランダムな順序のキー */
+	srand(0);
+	for (i = 0; i < COUNT; i++) {
+		keys[i] = i;
+	}
+	for (i = COUNT - 1; i > 0; i--) {
+		int j = (int) (((unsigned long) rand() * ((unsigned long) RAND_MAX + 1) + rand()) % (i + 1));
+		int tmp = keys[i];
+		keys[i] = keys[j];
+		keys[j] = tmp;
+	}
 
 	x = IntIntMap_new();
+#ifndef UNORDERED
+	z = IntIntBMap_new();
+#endif
 
 	printf("*** benchmark map<int, int> ***\n");
 
 	// at
+	mem_usage = 0;
 	t = get_msec();
 	for (i = 0; i < COUNT; i++) {
 		*IntIntMap_at(x, i) = COUNT - i;
 	}
 	printf("cstl: at[%d]: %g ms\n", COUNT, get_msec() - t);
+	printf("cstl: memory: %g bytes/element\n", (double) mem_usage / COUNT);
+
+#ifndef UNORDERED
+	mem_usage = 0;
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		*IntIntBMap_at(z, i) = COUNT - i;
+	}
+	printf("btree: at[%d]: %g ms\n", COUNT, get_msec() - t);
+	printf("btree: memory: %g bytes/element\n", (double) mem_usage / COUNT);
+#endif
 
 	t = get_msec();
 	for (i = 0; i < COUNT; i++) {
@@ -74,6 +150,39 @@ int main(void)
 			printf("!!!NG!!!\n");
 		}
 	}
+#ifndef UNORDERED
+	for (zpos = IntIntBMap_begin(z), ypos = y.begin(); ypos != y.end(); zpos = IntIntBMap_next(zpos), ++ypos) {
+		if (ypos->first != *IntIntBMap_key(zpos)) {
+			printf("!!!NG!!!\n");
+		}
+		if (ypos->second != *IntIntBMap_value(zpos)) {
+			printf("!!!NG!!!\n");
+		}
+	}
+
+	// find
+	ret = 0;
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		ret += *IntIntMap_value(IntIntMap_find(x, keys[i]));
+	}
+	printf("cstl: find random[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		ret -= *IntIntBMap_value(IntIntBMap_find(z, keys[i]));
+	}
+	printf("btree: find random[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		ret += y.find(keys[i])->second;
+	}
+	printf("stl : find random[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (ret != (size_t) COUNT / 2 * (COUNT + 1)) {
+		printf("!!!NG!!!\n");
+	}
+#endif
 
 	// erase
 	t = get_msec();
@@ -82,6 +191,17 @@ int main(void)
 	}
 	printf("cstl: erase[%d]: %g ms\n", COUNT, get_msec() - t);
 
+#ifndef UNORDERED
+	t = get_msec();
+	for (zpos = IntIntBMap_begin(z); zpos != IntIntBMap_end(z);) {
+		zpos = IntIntBMap_erase(z, zpos);
+	}
+	printf("btree: erase[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (!IntIntBMap_empty(z)) {
+		printf("!!!NG!!!\n");
+	}
+#endif
+
 	t = get_msec();
 	for (ypos = y.begin(); ypos != y.end();) {
 		y.erase(ypos++);
@@ -98,6 +218,14 @@ int main(void)
 	}
 	printf("cstl: insert[%d]: %g ms\n", COUNT, get_msec() - t);
 
+#ifndef UNORDERED
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntIntBMap_insert(z, i, COUNT - i, NULL);
+	}
+	printf("btree: insert[%d]: %g ms\n", COUNT, get_msec() - t);
+#endif
+
 	t = get_msec();
 	for (i = 0; i < COUNT; i++) {
 		y.insert(make_pair(i, COUNT - i));
@@ -114,6 +242,34 @@ int main(void)
 			printf("!!!NG!!!\n");
 		}
 	}
+#ifndef UNORDERED
+	if (y.size() != IntIntBMap_size(z)) {
+		printf("!!!NG!!!\n");
+	}
+#endif
+
+	// move all elements to another map
+	{
+		IntIntMap *w = IntIntMap_new();
+		t = get_msec();
+		for (xpos = IntIntMap_begin(x); xpos != IntIntMap_end(x);) {
+			IntIntMap_insert(w, *IntIntMap_key(xpos), *IntIntMap_value(xpos), NULL);
+			xpos = IntIntMap_erase(x, xpos);
+		}
+		printf("cstl: move by insert/erase[%d]: %g ms\n", COUNT, get_msec() - t);
+
+		t = get_msec();
+		for (xpos = IntIntMap_begin(w); xpos != IntIntMap_end(w);) {
+			IntIntMapIterator node = xpos;
+			xpos = IntIntMap_next(xpos);
+			IntIntMap_insert_node(x, IntIntMap_extract(w, node), NULL);
+		}
+		printf("cstl: move by extract/insert_node[%d]: %g ms\n", COUNT, get_msec() - t);
+		if (IntIntMap_size(x) != (size_t) COUNT) {
+			printf("!!!NG!!!\n");
+		}
+		IntIntMap_delete(w);
+	}
 
 	// erase key
 	t = get_msec();
@@ -122,6 +278,17 @@ int main(void)
 	}
 	printf("cstl: erase key[%d]: %g ms\n", COUNT, get_msec() - t);
 
+#ifndef UNORDERED
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntIntBMap_erase_key(z, i);
+	}
+	printf("btree: erase key[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (!IntIntBMap_empty(z)) {
+		printf("!!!NG!!!\n");
+	}
+#endif
+
 	t = get_msec();
 	for (i = 0; i < COUNT; i++) {
 		y.erase(i);
@@ -131,9 +298,189 @@ int main(void)
 		printf("!!!NG!!!\n");
 	}
 
+#ifndef UNORDERED
+	// insert hint
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntIntMap_insert_hint(x, IntIntMap_end(x), i, COUNT - i, NULL);
+	}
+	printf("cstl: insert hint end[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		y.insert(y.end(), make_pair(i, COUNT - i));
+	}
+	printf("stl : insert hint end[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (y.size() != IntIntMap_size(x)) {
+		printf("!!!NG!!!\n");
+	}
+	for (xpos = IntIntMap_begin(x), ypos = y.begin(); ypos != y.end(); xpos = IntIntMap_next(xpos), ++ypos) {
+		if (ypos->first != *IntIntMap_key(xpos) || ypos->second != *IntIntMap_value(xpos)) {
+			printf("!!!NG!!!\n");
+		}
+	}
+	IntIntMap_clear(x);
+	y.clear();
+
+	// insert random
+	mem_usage = 0;
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntIntMap_insert(x, keys[i], i, NULL);
+	}
+	printf("cstl: insert random[%d]: %g ms\n", COUNT, get_msec() - t);
+	printf("cstl: memory: %g bytes/element\n", (double) mem_usage / COUNT);
+
+	IntIntBMap_clear(z);
+	mem_usage = 0;
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntIntBMap_insert(z, keys[i], i, NULL);
+	}
+	printf("btree: insert random[%d]: %g ms\n", COUNT, get_msec() - t);
+	printf("btree: memory: %g bytes/element\n", (double) mem_usage / COUNT);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		y.insert(make_pair(keys[i], i));
+	}
+	printf("stl : insert random[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (y.size() != IntIntMap_size(x) || y.size() != IntIntBMap_size(z)) {
+		printf("!!!NG!!!\n");
+	}
+	IntIntBMap_delete(z);
+
+	// build from sorted array
+	IntIntMap_clear(x);
+	y.clear();
+	{
+		int *values = (int *) malloc(sizeof(int) * COUNT);
+		for (i = 0; i < COUNT; i++) {
+			keys[i] = i;
+			values[i] = COUNT - i;
+		}
+		t = get_msec();
+		IntIntMap_build_from_sorted_array(x, keys, values, COUNT);
+		printf("cstl: build from sorted array[%d]: %g ms\n", COUNT, get_msec() - t);
+
+		t = get_msec();
+		for (i = 0; i < COUNT; i++) {
+			y.insert(y.end(), make_pair(keys[i], values[i]));
+		}
+		printf("stl : insert sorted with hint[%d]: %g ms\n", COUNT, get_msec() - t);
+		free(values);
+	}
+	if (y.size() != IntIntMap_size(x)) {
+		printf("!!!NG!!!\n");
+	}
+	for (xpos = IntIntMap_begin(x), ypos = y.begin(); ypos != y.end(); xpos = IntIntMap_next(xpos), ++ypos) {
+		if (ypos->first != *IntIntMap_key(xpos) || ypos->second != *IntIntMap_value(xpos)) {
+			printf("!!!NG!!!\n");
+		}
+	}
+
+	// split / join
+	{
+		IntIntMap *w = IntIntMap_new();
+		map<int, int> v;
+		t = get_msec();
+		IntIntMap_insert_range(w, IntIntMap_lower_bound(x, COUNT / 2), IntIntMap_end(x));
+		IntIntMap_erase_range(x, IntIntMap_lower_bound(x, COUNT / 2), IntIntMap_end(x));
+		printf("cstl: move half by insert_range/erase_range[%d]: %g ms\n", COUNT, get_msec() - t);
+		t = get_msec();
+		IntIntMap_join(x, w);
+		printf("cstl: join[%d]: %g ms\n", COUNT, get_msec() - t);
+		if (IntIntMap_size(x) != (size_t) COUNT || !IntIntMap_empty(w)) {
+			printf("!!!NG!!!\n");
+		}
+
+#ifdef CSTL_RBTREE_RANK
+		// split()はCSTL_RBTREE_RANK定義時のみ
+		t = get_msec();
+		IntIntMap_split(x, COUNT / 2, w);
+		printf("cstl: split half[%d]: %g ms\n", COUNT, get_msec() - t);
+		if (IntIntMap_size(w) != (size_t) COUNT / 2 || IntIntMap_size(x) != (size_t) COUNT / 2) {
+			printf("!!!NG!!!\n");
+		}
+		IntIntMap_join(x, w);
+#endif
+
+		t = get_msec();
+		v.insert(y.lower_bound(COUNT / 2), y.end());
+		y.erase(y.lower_bound(COUNT / 2), y.end());
+		printf("stl : move half by insert/erase range[%d]: %g ms\n", COUNT, get_msec() - t);
+		IntIntMap_delete(w);
+	}
+
+	// full scan (CSTL_RBTREE_THREAD定義時はnext/prevがリンクを辿るだけになる)
+	{
+		long sum = 0;
+		long ysum = 0;
+		t = get_msec();
+		for (xpos = IntIntMap_begin(x); xpos != IntIntMap_end(x); xpos = IntIntMap_next(xpos)) {
+			sum += *IntIntMap_value(xpos);
+		}
+		printf("cstl: scan forward[%d]: %g ms\n", COUNT, get_msec() - t);
+		t = get_msec();
+		for (xpos = IntIntMap_rbegin(x); xpos != IntIntMap_rend(x); xpos = IntIntMap_prev(xpos)) {
+			sum -= *IntIntMap_value(xpos);
+		}
+		printf("cstl: scan reverse[%d]: %g ms\n", COUNT, get_msec() - t);
+		t = get_msec();
+		for (ypos = y.begin(); ypos != y.end(); ++ypos) {
+			ysum += ypos->second;
+		}
+		printf("stl : scan forward[%d]: %g ms\n", y.size(), get_msec() - t);
+		t = get_msec();
+		for (i = 0; i < COUNT; i++) {
+			ret = IntIntMap_empty(x) ? 0 : *IntIntMap_key(IntIntMap_begin(x));
+		}
+		printf("cstl: begin[%d]: %g ms\n", COUNT, get_msec() - t);
+		if (sum != 0 || ysum == 0 || ret != 0) {
+			printf("!!!NG!!!\n");
+		}
+	}
+#endif
+
+	// find by reference / transparent find
+	{
+		BigKeyMap *b = BigKeyMap_new();
+		BigKey key;
+		long sum[3] = {0, 0, 0};
+		memset(&key, 0, sizeof key);
+		for (i = 0; i < COUNT; i++) {
+			key.k = i;
+			*BigKeyMap_at_ref(b, &key) = i;
+		}
+		t = get_msec();
+		for (i = 0; i < COUNT; i++) {
+			key.k = keys[i];
+			sum[0] += *BigKeyMap_value(BigKeyMap_find(b, key));
+		}
+		printf("cstl: find random, %d bytes key[%d]: %g ms\n", (int) sizeof key, COUNT, get_msec() - t);
+		t = get_msec();
+		for (i = 0; i < COUNT; i++) {
+			key.k = keys[i];
+			sum[1] += *BigKeyMap_value(BigKeyMap_find_ref(b, &key));
+		}
+		printf("cstl: find_ref random, %d bytes key[%d]: %g ms\n", (int) sizeof key, COUNT, get_msec() - t);
+		t = get_msec();
+		for (i = 0; i < COUNT; i++) {
+#ifndef UNORDERED
+			sum[2] += *BigKeyMap_value(BigKeyMap_find_with(b, &keys[i], bigkey_comp_int));
+#else
+			sum[2] += *BigKeyMap_value(BigKeyMap_find_with(b, &keys[i], bigkey_hash_int, bigkey_comp_int));
+#endif
+		}
+		printf("cstl: find_with int probe random[%d]: %g ms\n", COUNT, get_msec() - t);
+		if (sum[0] != sum[1] || sum[1] != sum[2]) {
+			printf("!!!NG!!!\n");
+		}
+		BigKeyMap_delete(b);
+	}
+
 	IntIntMap_delete(x);
 
 	return 0;
 }
 
-
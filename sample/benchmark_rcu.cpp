@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <cstl/unordered_map.h>
+#include <cstl/concurrent_unordered_map.h>
+#include <cstl/rcu_unordered_map.h>
+
+CSTL_UNORDERED_MAP_INTERFACE(IntIntUMap, int, int)
+CSTL_UNORDERED_MAP_IMPLEMENT(IntIntUMap, int, int, IntIntUMap_hash_int, CSTL_EQUAL_TO)
+
+CSTL_CONCURRENT_UNORDERED_MAP_INTERFACE(IntIntCMap, int, int)
+CSTL_CONCURRENT_UNORDERED_MAP_IMPLEMENT(IntIntCMap, int, int, IntIntCMap_ShardMap_hash_int, CSTL_EQUAL_TO)
+
+CSTL_RCU_UNORDERED_MAP_INTERFACE(IntIntRMap, int, int)
+CSTL_RCU_UNORDERED_MAP_IMPLEMENT(IntIntRMap, int, int, IntIntRMap_hash_int, CSTL_EQUAL_TO)
+
+
+double get_msec(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+#define KEY_COUNT		(10000)
+#define OP_COUNT		(8000000)
+#define MAX_THREADS		(32)
+#define SHARD_COUNT		(64)
+/* 書き込み側は1スレッドで、この間隔(マイクロ秒)ごとに1つのキーの値を更新する */
+#define WRITE_INTERVAL	(1000)
+
+enum { MUTEX, RWLOCK, SHARDED, RCU };
+
+static IntIntUMap *umap;
+static pthread_mutex_t umap_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_rwlock_t umap_rwlock = PTHREAD_RWLOCK_INITIALIZER;
+static IntIntCMap *cmap;
+static IntIntRMap *rmap;
+static int thread_count;
+static int kind;
+static volatile int readers_done;
+static long write_count;
+
+static unsigned int xorshift(unsigned int *s)
+{
+	*s ^= *s << 13;
+	*s ^= *s >> 17;
+	*s ^= *s << 5;
+	return *s;
+}
+
+static int find(int key, int *value)
+{
+	IntIntUMapIterator pos;
+	int found;
+	switch (kind) {
+	case MUTEX:
+		pthread_mutex_lock(&umap_mutex);
+		pos = IntIntUMap_find(umap, key);
+		found = (pos != IntIntUMap_end(umap));
+		if (found) *value = *IntIntUMap_value(pos);
+		pthread_mutex_unlock(&umap_mutex);
+		return found;
+	case RWLOCK:
+		pthread_rwlock_rdlock(&umap_rwlock);
+		pos = IntIntUMap_find(umap, key);
+		found = (pos != IntIntUMap_end(umap));
+		if (found) *value = *IntIntUMap_value(pos);
+		pthread_rwlock_unlock(&umap_rwlock);
+		return found;
+	case SHARDED:
+		return IntIntCMap_find(cmap, key, value);
+	default:
+		return IntIntRMap_find(rmap, key, value);
+	}
+}
+
+static void set_value(int *value, int inserted, void *arg)
+{
+	(void) inserted;
+	*value = *(int *) arg;
+}
+
+static void update(int key, int value)
+{
+	switch (kind) {
+	case MUTEX:
+		pthread_mutex_lock(&umap_mutex);
+		*IntIntUMap_at(umap, key) = value;
+		pthread_mutex_unlock(&umap_mutex);
+		break;
+	case RWLOCK:
+		pthread_rwlock_wrlock(&umap_rwlock);
+		*IntIntUMap_at(umap, key) = value;
+		pthread_rwlock_unlock(&umap_rwlock);
+		break;
+	case SHARDED:
+		IntIntCMap_at(cmap, key, set_value, &value);
+		break;
+	default:
+		IntIntRMap_assign(rmap, key, value);
+		break;
+	}
+}
+
+static void *reader(void *arg)
+{
+	unsigned int seed = (unsigned int) (size_t) arg + 1;
+	long hit = 0;
+	int value;
+	int i;
+	for (i = 0; i < OP_COUNT / thread_count; i++) {
+		hit += find((int) (xorshift(&seed) % KEY_COUNT), &value);
+	}
+	return (void *) hit;
+}
+
+static void *writer(void *arg)
+{
+	unsigned int seed = 12345;
+	int key;
+	(void) arg;
+	while (!__atomic_load_n(&readers_done, __ATOMIC_ACQUIRE)) {
+		key = (int) (xorshift(&seed) % KEY_COUNT);
+		update(key, key);
+		write_count++;
+		usleep(WRITE_INTERVAL);
+	}
+	return 0;
+}
+
+/* thread_count個の読み込みスレッドと1個の書き込みスレッドを動かし、読み込みが全て終わるまでの時間を計る */
+static double run(void)
+{
+	pthread_t th[MAX_THREADS];
+	pthread_t wr;
+	double t;
+	long hit = 0;
+	void *ret;
+	size_t i;
+	readers_done = 0;
+	pthread_create(&wr, NULL, writer, NULL);
+	t = get_msec();
+	for (i = 0; i < (size_t) thread_count; i++) {
+		pthread_create(&th[i], NULL, reader, (void *) i);
+	}
+	for (i = 0; i < (size_t) thread_count; i++) {
+		pthread_join(th[i], &ret);
+		hit += (long) ret;
+	}
+	t = get_msec() - t;
+	__atomic_store_n(&readers_done, 1, __ATOMIC_RELEASE);
+	pthread_join(wr, NULL);
+	if (hit != OP_COUNT / thread_count * thread_count) {
+		printf("!!!NG!!!\n");
+	}
+	return t;
+}
+
+int main(void)
+{
+	static const char *label[] = {"mutex  ", "rwlock ", "sharded", "rcu    "};
+	int i;
+	double t;
+
+	umap = IntIntUMap_new();
+	cmap = IntIntCMap_new(SHARD_COUNT);
+	rmap = IntIntRMap_new();
+	for (i = 0; i < KEY_COUNT; i++) {
+		IntIntUMap_insert(umap, i, i, NULL);
+		IntIntCMap_insert(cmap, i, i, NULL);
+		IntIntRMap_insert(rmap, i, i, NULL);
+	}
+
+	printf("*** benchmark read-mostly map<int, int> (%d keys, readers find only, 1 writer updates every %d us) ***\n",
+			KEY_COUNT, WRITE_INTERVAL);
+	for (thread_count = 1; thread_count <= MAX_THREADS; thread_count *= 2) {
+		for (kind = MUTEX; kind <= RCU; kind++) {
+			write_count = 0;
+			t = run();
+			printf("%s: readers[%2d]: %8g ms, %8g Mfinds/s, %ld writes\n",
+					label[kind], thread_count, t, OP_COUNT / t / 1000.0, write_count);
+		}
+	}
+
+	IntIntUMap_delete(umap);
+	IntIntCMap_delete(cmap);
+	IntIntRMap_delete(rmap);
+
+	return 0;
+}
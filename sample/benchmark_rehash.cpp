@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include <cstl/unordered_map.h>
+#include <vector>
+#include <algorithm>
+
+
+CSTL_UNORDERED_MAP_INTERFACE(IntIntUMap, int, int)
+CSTL_UNORDERED_MAP_IMPLEMENT(IntIntUMap, int, int, IntIntUMap_hash_int, CSTL_EQUAL_TO)
+
+
+using namespace std;
+
+
+/* 1回の操作の時間を計るため、マイクロ秒より細かい時刻を使う */
+double get_usec(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return count.QuadPart * 1000000.0 / freq.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000.0 + tv.tv_usec;
+#endif
+}
+
+#define COUNT		(2000000)
+
+static int buf[COUNT];
+static vector<double> latency(COUNT);
+
+static void init_buf(void)
+{
+	int i;
+	srand(0);
+	for (i = 0; i < COUNT; i++) {
+		buf[i] = (int) ((unsigned long) rand() * ((unsigned long) RAND_MAX + 1) + rand());
+	}
+}
+
+static double percentile(double p)
+{
+	size_t i = (size_t) (p * (COUNT - 1));
+	return latency[i];
+}
+
+/* 
+ * 挿入1回ごとの時間を計り、パーセンタイルを表示する。
+ * 前の計測で解放したメモリの後始末が計測に混ざらないよう、mapは最後にまとめて破棄する。
+ */
+static IntIntUMap *bm_insert(size_t step)
+{
+	int i;
+	double t, total;
+	IntIntUMap *umap = IntIntUMap_new();
+	IntIntUMap_set_incremental_rehash(umap, step);
+	total = get_usec();
+	for (i = 0; i < COUNT; i++) {
+		t = get_usec();
+		IntIntUMap_insert(umap, buf[i], i, NULL);
+		latency[i] = get_usec() - t;
+	}
+	total = get_usec() - total;
+	for (i = 0; i < COUNT; i++) {
+		if (IntIntUMap_find(umap, buf[i]) == IntIntUMap_end(umap)) {
+			printf("!!!NG!!!\n");
+			break;
+		}
+	}
+	sort(latency.begin(), latency.end());
+	if (step) {
+		printf("incremental[%2d]", (int) step);
+	} else {
+		printf("full           ");
+	}
+	printf(": total %8.1f ms, p50 %6.3f us, p99 %6.3f us, p999 %8.3f us, max %10.1f us\n",
+			total / 1000.0, percentile(0.5), percentile(0.99), percentile(0.999), latency[COUNT - 1]);
+	return umap;
+}
+
+int main(void)
+{
+	size_t step;
+	size_t i;
+	IntIntUMap *umap[4];
+	init_buf();
+	printf("*** benchmark unordered_map<int, int> insert latency (%d elements) ***\n", COUNT);
+	umap[0] = bm_insert(0);
+	for (step = 1, i = 1; step <= 16; step *= 4, i++) {
+		umap[i] = bm_insert(step);
+	}
+	for (i = 0; i < 4; i++) {
+		IntIntUMap_delete(umap[i]);
+	}
+	return 0;
+}
+
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include <cstl/rope.h>
+#include <string>
+
+
+CSTL_STRING_INTERFACE(String, char)
+CSTL_STRING_IMPLEMENT(String, char)
+
+CSTL_ROPE_INTERFACE(Rope, char)
+CSTL_ROPE_IMPLEMENT(Rope, char)
+
+
+using namespace std;
+
+
+double get_msec(void)
+{
+#ifdef _WIN32
+	return (double) GetTickCount();
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+#define DOC_SIZE		(4 * 1024 * 1024)
+#define EDIT_COUNT		(1000000)
+#define FLAT_COUNT		(10000)
+#define MAX_EDIT_LEN	(16)
+
+/* エディタの編集操作を模した乱数列 */
+struct Edit {
+	unsigned int jump;
+	unsigned int pos;
+	unsigned int op;
+	unsigned int len;
+};
+
+static Edit *edits;
+static char text[MAX_EDIT_LEN];
+
+static size_t next_pos(const Edit *e, size_t cursor, size_t size)
+{
+	/* 大抵はカーソル付近を編集し、ときどき離れた位置へ移動する */
+	if (e->jump % 10 == 0 || cursor > size) {
+		return e->pos % (size + 1);
+	}
+	return cursor;
+}
+
+static size_t edit_rope(Rope *x, int count)
+{
+	size_t cursor = 0;
+	size_t size;
+	int i;
+	for (i = 0; i < count; i++) {
+		const Edit *e = &edits[i];
+		size = Rope_size(x);
+		cursor = next_pos(e, cursor, size);
+		if (e->op % 3 || cursor == size) {
+			Rope_insert_len(x, cursor, text, e->len);
+			cursor += e->len;
+		} else {
+			Rope_erase(x, cursor, e->len);
+		}
+	}
+	return Rope_size(x);
+}
+
+static size_t edit_string(String *x, int count)
+{
+	size_t cursor = 0;
+	size_t size;
+	int i;
+	for (i = 0; i < count; i++) {
+		const Edit *e = &edits[i];
+		size = String_size(x);
+		cursor = next_pos(e, cursor, size);
+		if (e->op % 3 || cursor == size) {
+			String_insert_len(x, cursor, text, e->len);
+			cursor += e->len;
+		} else {
+			String_erase(x, cursor, e->len);
+		}
+	}
+	return String_size(x);
+}
+
+static size_t edit_stl(string &x, int count)
+{
+	size_t cursor = 0;
+	size_t size;
+	int i;
+	for (i = 0; i < count; i++) {
+		const Edit *e = &edits[i];
+		size = x.size();
+		cursor = next_pos(e, cursor, size);
+		if (e->op % 3 || cursor == size) {
+			x.insert(cursor, text, e->len);
+			cursor += e->len;
+		} else {
+			x.erase(cursor, e->len);
+		}
+	}
+	return x.size();
+}
+
+int main(void)
+{
+	int i;
+	double t;
+	char *doc;
+	char *tmp;
+	Rope *x;
+	String *y;
+	string z;
+
+	doc = (char *) malloc(DOC_SIZE + 1);
+	tmp = (char *) malloc(DOC_SIZE * 2);
+	edits = (Edit *) malloc(sizeof(Edit) * EDIT_COUNT);
+	for (i = 0; i < DOC_SIZE; i++) {
+		doc[i] = (i % 64 == 63) ? '\n' : 'a' + i % 26;
+	}
+	doc[DOC_SIZE] = '\0';
+	for (i = 0; i < MAX_EDIT_LEN; i++) {
+		text[i] = 'A' + i;
+	}
+	srand(0);
+	for (i = 0; i < EDIT_COUNT; i++) {
+		edits[i].jump = rand();
+		edits[i].pos = ((unsigned int) rand() << 16) ^ rand();
+		edits[i].op = rand();
+		edits[i].len = 1 + rand() % MAX_EDIT_LEN;
+	}
+
+	printf("*** benchmark rope ***\n");
+
+	// 少ない回数の編集でstringと比較
+	x = Rope_new_assign_len(doc, DOC_SIZE);
+	t = get_msec();
+	edit_rope(x, FLAT_COUNT);
+	printf("cstl: rope edit[%d]: %g ms\n", FLAT_COUNT, get_msec() - t);
+
+	y = String_new_assign_len(doc, DOC_SIZE);
+	t = get_msec();
+	edit_string(y, FLAT_COUNT);
+	printf("cstl: string edit[%d]: %g ms\n", FLAT_COUNT, get_msec() - t);
+
+	z.assign(doc, DOC_SIZE);
+	t = get_msec();
+	edit_stl(z, FLAT_COUNT);
+	printf("stl : string edit[%d]: %g ms\n", FLAT_COUNT, get_msec() - t);
+
+	if (Rope_size(x) != z.size() || String_size(y) != z.size() ||
+			Rope_copy(x, tmp, 0, Rope_size(x)) != z.size() ||
+			memcmp(tmp, z.data(), z.size()) != 0 ||
+			memcmp(String_c_str(y), z.data(), z.size()) != 0) {
+		printf("!!!NG!!!\n");
+	}
+	String_delete(y);
+	Rope_delete(x);
+
+	// 全ての編集をropeで行う
+	x = Rope_new_assign_len(doc, DOC_SIZE);
+	t = get_msec();
+	edit_rope(x, EDIT_COUNT);
+	printf("cstl: rope edit[%d]: %g ms\n", EDIT_COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < EDIT_COUNT; i++) {
+		if (*Rope_at(x, edits[i].pos % Rope_size(x)) == '\0') {
+			printf("!!!NG!!!\n");
+		}
+	}
+	printf("cstl: rope at[%d]: %g ms\n", EDIT_COUNT, get_msec() - t);
+
+	t = get_msec();
+	Rope_copy(x, tmp, 0, Rope_size(x));
+	printf("cstl: rope copy[%d]: %g ms\n", (int) Rope_size(x), get_msec() - t);
+	Rope_delete(x);
+
+	free(edits);
+	free(tmp);
+	free(doc);
+
+	return 0;
+}
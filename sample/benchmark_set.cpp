@@ -7,13 +7,28 @@
 #else
 #include <sys/time.h>
 #endif
-#include <cstl/set.h>
-#include <cstl/unordered_set.h>
 #include <set>
+#include <algorithm>
+#include <iterator>
 
 //#define malloc(s) ::operator new(s)
 //#define free(p) ::operator delete(p)
 
+/* cstlが確保したメモリ量を数える(解放は数えないので構築直後に参照する) */
+static size_t mem_usage;
+
+static void *count_malloc(size_t size)
+{
+	mem_usage += size;
+	return malloc(size);
+}
+
+#define malloc(s)		count_malloc(s)
+
+#include <cstl/set.h>
+#include <cstl/btree.h>
+#include <cstl/unordered_set.h>
+
 #ifndef UNORDERED
 CSTL_SET_INTERFACE(IntSet, int)
 CSTL_SET_IMPLEMENT(IntSet, int, CSTL_LESS)
@@ -22,6 +37,9 @@ CSTL_UNORDERED_SET_INTERFACE(IntSet, int)
 CSTL_UNORDERED_SET_IMPLEMENT(IntSet, int, IntSet_hash_int, CSTL_EQUAL_TO)
 #endif
 
+CSTL_BTREE_SET_INTERFACE(IntBSet, int)
+CSTL_BTREE_SET_IMPLEMENT(IntBSet, int, CSTL_LESS)
+
 using namespace std;
 
 
@@ -40,26 +58,58 @@ double get_msec(void)
 #define INSERT_COUNT	(10000)
 #define SORT_COUNT		(1000000)
 
+static int keys[COUNT];
+
 
 int main(void)
 {
 	int i;
 	double t;
 	IntSet *x;
+	IntBSet *z;
 	set<int> y;
 	IntSetIterator xpos;
 	set<int>::iterator ypos;
+#ifndef UNORDERED
+	size_t ret;
+	IntBSetIterator zpos;
+#endif
+
+	/* ランダムな順序のキー */
+	srand(0);
+	for (i = 0; i < COUNT; i++) {
+		keys[i] = i;
+	}
+	for (i = COUNT - 1; i > 0; i--) {
+		int j = (int) (((unsigned long) rand() * ((unsigned long) RAND_MAX + 1) + rand()) % (i + 1));
+		int tmp = keys[i];
+		keys[i] = keys[j];
+		keys[j] = tmp;
+	}
 
 	x = IntSet_new();
+	z = IntBSet_new();
 
 	printf("*** benchmark set<int> ***\n");
 
 	// insert
+	mem_usage = 0;
 	t = get_msec();
 	for (i = 0; i < COUNT; i++) {
 		IntSet_insert(x, i, NULL);
 	}
 	printf("cstl: insert[%d]: %g ms\n", COUNT, get_msec() - t);
+	printf("cstl: memory: %g bytes/element\n", (double) mem_usage / COUNT);
+
+#ifndef UNORDERED
+	mem_usage = 0;
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntBSet_insert(z, i, NULL);
+	}
+	printf("btree: insert[%d]: %g ms\n", COUNT, get_msec() - t);
+	printf("btree: memory: %g bytes/element\n", (double) mem_usage / COUNT);
+#endif
 
 	t = get_msec();
 	for (i = 0; i < COUNT; i++) {
@@ -75,6 +125,63 @@ int main(void)
 		}
 	}
 
+#ifndef UNORDERED
+	if (y.size() != IntBSet_size(z)) {
+		printf("!!!NG!!!\n");
+	}
+	for (zpos = IntBSet_begin(z), ypos = y.begin(); ypos != y.end(); zpos = IntBSet_next(zpos), ++ypos) {
+		if (*ypos != *IntBSet_data(zpos)) {
+			printf("!!!NG!!!\n");
+		}
+	}
+
+	// find
+	ret = 0;
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		ret += IntSet_find(x, keys[i]) != IntSet_end(x);
+	}
+	printf("cstl: find random[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		ret += IntBSet_find(z, keys[i]) != IntBSet_end(z);
+	}
+	printf("btree: find random[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		ret += y.find(keys[i]) != y.end();
+	}
+	printf("stl : find random[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (ret != (size_t) COUNT * 3) {
+		printf("!!!NG!!!\n");
+	}
+
+	// iterate
+	ret = 0;
+	t = get_msec();
+	for (xpos = IntSet_begin(x); xpos != IntSet_end(x); xpos = IntSet_next(xpos)) {
+		ret += *IntSet_data(xpos);
+	}
+	printf("cstl: iterate[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (zpos = IntBSet_begin(z); zpos != IntBSet_end(z); zpos = IntBSet_next(zpos)) {
+		ret -= *IntBSet_data(zpos);
+	}
+	printf("btree: iterate[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (ypos = y.begin(); ypos != y.end(); ++ypos) {
+		ret += *ypos;
+	}
+	printf("stl : iterate[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (ret != (size_t) COUNT / 2 * (COUNT - 1)) {
+		printf("!!!NG!!!\n");
+	}
+#endif
+
 	// erase
 	t = get_msec();
 	for (i = 0; i < COUNT; i++) {
@@ -82,6 +189,17 @@ int main(void)
 	}
 	printf("cstl: erase key[%d]: %g ms\n", COUNT, get_msec() - t);
 
+#ifndef UNORDERED
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntBSet_erase_key(z, i);
+	}
+	printf("btree: erase key[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (!IntBSet_empty(z)) {
+		printf("!!!NG!!!\n");
+	}
+#endif
+
 	t = get_msec();
 	for (i = 0; i < COUNT; i++) {
 		y.erase(i);
@@ -91,7 +209,147 @@ int main(void)
 		printf("!!!NG!!!\n");
 	}
 
+#ifndef UNORDERED
+	// insert random
+	IntSet_clear(x);
+	IntBSet_clear(z);
+	mem_usage = 0;
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntSet_insert(x, keys[i], NULL);
+	}
+	printf("cstl: insert random[%d]: %g ms\n", COUNT, get_msec() - t);
+	printf("cstl: memory: %g bytes/element\n", (double) mem_usage / COUNT);
+
+	mem_usage = 0;
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntBSet_insert(z, keys[i], NULL);
+	}
+	printf("btree: insert random[%d]: %g ms\n", COUNT, get_msec() - t);
+	printf("btree: memory: %g bytes/element\n", (double) mem_usage / COUNT);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		y.insert(keys[i]);
+	}
+	printf("stl : insert random[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (y.size() != IntSet_size(x) || y.size() != IntBSet_size(z)) {
+		printf("!!!NG!!!\n");
+	}
+
+	// erase random
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntSet_erase_key(x, keys[i]);
+	}
+	printf("cstl: erase key random[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		IntBSet_erase_key(z, keys[i]);
+	}
+	printf("btree: erase key random[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		y.erase(keys[i]);
+	}
+	printf("stl : erase key random[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (!y.empty() || !IntSet_empty(x) || !IntBSet_empty(z)) {
+		printf("!!!NG!!!\n");
+	}
+
+	// build from sorted array
+	for (i = 0; i < COUNT; i++) {
+		keys[i] = i;
+	}
+	t = get_msec();
+	IntSet_build_from_sorted_array(x, keys, COUNT);
+	printf("cstl: build from sorted array[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	y.insert(keys, keys + COUNT);
+	printf("stl : insert sorted range[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (y.size() != IntSet_size(x)) {
+		printf("!!!NG!!!\n");
+	}
+	for (xpos = IntSet_begin(x), ypos = y.begin(); ypos != y.end(); xpos = IntSet_next(xpos), ++ypos) {
+		if (*ypos != *IntSet_data(xpos)) {
+			printf("!!!NG!!!\n");
+		}
+	}
+
+	// set intersection
+	{
+		IntSet *a = IntSet_new();
+		IntSet *b = IntSet_new();
+		set<int> ya;
+		set<int> yb;
+		IntSet_clear(x);
+		y.clear();
+		for (i = 0; i < COUNT; i += 2) {
+			IntSet_insert(a, i, NULL);
+			ya.insert(i);
+		}
+		for (i = 0; i < COUNT; i += 3) {
+			IntSet_insert(b, i, NULL);
+			yb.insert(i);
+		}
+
+		t = get_msec();
+		for (xpos = IntSet_begin(a); xpos != IntSet_end(a); xpos = IntSet_next(xpos)) {
+			if (IntSet_find(b, *IntSet_data(xpos)) != IntSet_end(b)) {
+				IntSet_insert(x, *IntSet_data(xpos), NULL);
+			}
+		}
+		printf("cstl: intersection by find[%d]: %g ms\n", COUNT, get_msec() - t);
+
+		IntSet_clear(x);
+		t = get_msec();
+		IntSet_set_intersection(x, a, b);
+		printf("cstl: set_intersection[%d]: %g ms\n", COUNT, get_msec() - t);
+
+		t = get_msec();
+		set_intersection(ya.begin(), ya.end(), yb.begin(), yb.end(), inserter(y, y.end()));
+		printf("stl : set_intersection[%d]: %g ms\n", COUNT, get_msec() - t);
+		if (y.size() != IntSet_size(x)) {
+			printf("!!!NG!!!\n");
+		}
+
+		IntSet_clear(x);
+		t = get_msec();
+		IntSet_set_union(x, a, b);
+		printf("cstl: set_union[%d]: %g ms\n", COUNT, get_msec() - t);
+
+		y.clear();
+		t = get_msec();
+		set_union(ya.begin(), ya.end(), yb.begin(), yb.end(), inserter(y, y.end()));
+		printf("stl : set_union[%d]: %g ms\n", COUNT, get_msec() - t);
+		if (y.size() != IntSet_size(x)) {
+			printf("!!!NG!!!\n");
+		}
+
+		/* 要素数が大きく異なる場合 */
+		IntSet_clear(b);
+		for (i = 0; i < 1000; i++) {
+			IntSet_insert(b, keys[i] * 2, NULL);
+		}
+		IntSet_clear(x);
+		t = get_msec();
+		IntSet_set_intersection(x, a, b);
+		printf("cstl: set_intersection[%d, 1000]: %g ms\n", COUNT / 2, get_msec() - t);
+		if (IntSet_size(x) != 1000) {
+			printf("!!!NG!!!\n");
+		}
+
+		IntSet_delete(a);
+		IntSet_delete(b);
+	}
+#endif
+
 	IntSet_delete(x);
+	IntBSet_delete(z);
 
 	return 0;
 }
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <cstl/map.h>
+#include <cstl/persistent_map.h>
+#include <vector>
+
+CSTL_MAP_INTERFACE(IntIntMap, int, int)
+CSTL_MAP_IMPLEMENT(IntIntMap, int, int, CSTL_LESS)
+
+CSTL_PERSISTENT_MAP_INTERFACE(IntIntPMap, int, int)
+CSTL_PERSISTENT_MAP_IMPLEMENT(IntIntPMap, int, int, CSTL_LESS)
+
+
+using namespace std;
+
+
+double get_msec(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+#define COUNT		(1000000)
+#define OP_COUNT	(1000000)
+/* スナップショットを取る間隔(更新回数) */
+#define SNAP_INTERVAL	(10000)
+
+static int buf[COUNT];
+static int ops[OP_COUNT];
+
+typedef pair<int, int> Pair;
+
+static void push_pair(int const *key, int const *value, void *arg)
+{
+	((vector<Pair> *) arg)->push_back(Pair(*key, *value));
+}
+
+/*
+ * 一貫した全要素のコピーを取り出す。
+ * mapは走査の間ずっと書き込みを止める必要がある。
+ * persistent_mapは書き込みを止めるのはスナップショットを取る間だけで、走査は後で行える。
+ */
+static void bm_export(IntIntMap *map, IntIntPMap *pmap)
+{
+	double t, locked, walk;
+	vector<Pair> out;
+	IntIntMapIterator pos;
+	IntIntPMap *snap;
+
+	out.reserve(COUNT);
+	t = get_msec();
+	for (pos = IntIntMap_begin(map); pos != IntIntMap_end(map); pos = IntIntMap_next(pos)) {
+		out.push_back(Pair(*IntIntMap_key(pos), *IntIntMap_value(pos)));
+	}
+	locked = get_msec() - t;
+	printf("map           : export %d elements: writers blocked %8.3f ms\n", (int) out.size(), locked);
+
+	out.clear();
+	t = get_msec();
+	snap = IntIntPMap_snapshot(pmap);
+	locked = get_msec() - t;
+	t = get_msec();
+	IntIntPMap_for_each(snap, push_pair, &out);
+	walk = get_msec() - t;
+	IntIntPMap_delete(snap);
+	printf("persistent_map: export %d elements: writers blocked %8.3f ms (walk %g ms, concurrent with writers)\n",
+			(int) out.size(), locked, walk);
+}
+
+/* 更新(挿入と削除を交互)の速さ。persistent_mapはスナップショットが生きている間、経路を複製する */
+static void bm_update(IntIntMap *map, IntIntPMap *pmap, IntIntPMap *pmap2)
+{
+	double t;
+	int i;
+	IntIntPMap *snap = 0;
+
+	t = get_msec();
+	for (i = 0; i < OP_COUNT; i++) {
+		if (i & 1) {
+			IntIntMap_erase_key(map, ops[i]);
+		} else {
+			IntIntMap_insert(map, ops[i], i, NULL);
+		}
+	}
+	printf("map           : update %d times: %8.3f ms\n", OP_COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < OP_COUNT; i++) {
+		if (i & 1) {
+			IntIntPMap_erase_key(pmap, ops[i]);
+		} else {
+			IntIntPMap_insert(pmap, ops[i], i, NULL);
+		}
+	}
+	printf("persistent_map: update %d times: %8.3f ms (no snapshot)\n", OP_COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < OP_COUNT; i++) {
+		if (i % SNAP_INTERVAL == 0) {
+			IntIntPMap_delete(snap);
+			snap = IntIntPMap_snapshot(pmap2);
+		}
+		if (i & 1) {
+			IntIntPMap_erase_key(pmap2, ops[i]);
+		} else {
+			IntIntPMap_insert(pmap2, ops[i], i, NULL);
+		}
+	}
+	IntIntPMap_delete(snap);
+	printf("persistent_map: update %d times: %8.3f ms (snapshot every %d updates)\n",
+			OP_COUNT, get_msec() - t, SNAP_INTERVAL);
+}
+
+int main(void)
+{
+	int i;
+	IntIntMap *map;
+	IntIntPMap *pmap;
+	IntIntPMap *pmap2;
+	srand(0);
+	for (i = 0; i < COUNT; i++) {
+		buf[i] = rand();
+	}
+	for (i = 0; i < OP_COUNT; i++) {
+		ops[i] = (i & 1) ? buf[rand() % COUNT] : rand();
+	}
+
+	map = IntIntMap_new();
+	pmap = IntIntPMap_new();
+	/* スナップショットを取りながら更新する方は、同じ内容の別のmapで計る */
+	pmap2 = IntIntPMap_new();
+	for (i = 0; i < COUNT; i++) {
+		IntIntMap_insert(map, buf[i], i, NULL);
+		IntIntPMap_insert(pmap, buf[i], i, NULL);
+		IntIntPMap_insert(pmap2, buf[i], i, NULL);
+	}
+
+	printf("*** benchmark map<int, int> vs persistent_map<int, int> snapshot ***\n");
+	bm_export(map, pmap);
+	bm_update(map, pmap, pmap2);
+	if (IntIntMap_size(map) != IntIntPMap_size(pmap) || IntIntMap_size(map) != IntIntPMap_size(pmap2)) {
+		printf("!!!NG!!!\n");
+	}
+
+	IntIntMap_delete(map);
+	IntIntPMap_delete(pmap);
+	IntIntPMap_delete(pmap2);
+	return 0;
+}
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include <cstl/string.h>
+#include <string>
+
+
+CSTL_STRING_INTERFACE(String, char)
+CSTL_STRING_IMPLEMENT(String, char)
+
+CSTL_STRING_INTERFACE(WString, wchar_t)
+CSTL_STRING_IMPLEMENT(WString, wchar_t)
+
+
+using namespace std;
+
+
+double get_msec(void)
+{
+#ifdef _WIN32
+	return (double) GetTickCount();
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+#define COUNT			(1000000)
+#define COMPARE_COUNT	(100000)
+#define LENGTH			(1000)
+#define TOKEN_COUNT		(1000000)
+
+
+int main(void)
+{
+	int i;
+	int ret = 0;
+	double t;
+	char cstr[LENGTH + 1];
+	wchar_t wcstr[LENGTH + 1];
+	String *x1, *x2;
+	WString *wx1, *wx2;
+	string y1, y2;
+	wstring wy1, wy2;
+
+	for (i = 0; i < LENGTH; i++) {
+		cstr[i] = 'a' + i % 26;
+		wcstr[i] = L'a' + i % 26;
+	}
+	cstr[LENGTH] = '\0';
+	wcstr[LENGTH] = L'\0';
+
+	printf("*** benchmark string ***\n");
+
+	// compare
+	x1 = String_new_assign(cstr);
+	x2 = String_new_assign(cstr);
+	y1 = cstr;
+	y2 = cstr;
+	t = get_msec();
+	for (i = 0; i < COMPARE_COUNT; i++) {
+		*String_at(x2, LENGTH - 1) = cstr[LENGTH - 1] + (i & 1);
+		ret += String_compare(x1, x2) == 0;
+	}
+	printf("cstl: compare[%d x %d]: %g ms\n", COMPARE_COUNT, LENGTH, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COMPARE_COUNT; i++) {
+		y2[LENGTH - 1] = cstr[LENGTH - 1] + (i & 1);
+		ret += y1.compare(y2) == 0;
+	}
+	printf("stl : compare[%d x %d]: %g ms\n", COMPARE_COUNT, LENGTH, get_msec() - t);
+
+	wx1 = WString_new_assign(wcstr);
+	wx2 = WString_new_assign(wcstr);
+	wy1 = wcstr;
+	wy2 = wcstr;
+	t = get_msec();
+	for (i = 0; i < COMPARE_COUNT; i++) {
+		*WString_at(wx2, LENGTH - 1) = wcstr[LENGTH - 1] + (i & 1);
+		ret += WString_compare(wx1, wx2) == 0;
+	}
+	printf("cstl: wcompare[%d x %d]: %g ms\n", COMPARE_COUNT, LENGTH, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COMPARE_COUNT; i++) {
+		wy2[LENGTH - 1] = wcstr[LENGTH - 1] + (i & 1);
+		ret += wy1.compare(wy2) == 0;
+	}
+	printf("stl : wcompare[%d x %d]: %g ms\n", COMPARE_COUNT, LENGTH, get_msec() - t);
+	if (ret != COMPARE_COUNT / 2 * 4) {
+		printf("!!!NG!!!\n");
+	}
+
+	// append
+	String_clear(x1);
+	y1.clear();
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		String_append(x1, &cstr[LENGTH - 16]);
+	}
+	printf("cstl: append[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		y1.append(&cstr[LENGTH - 16]);
+	}
+	printf("stl : append[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (y1.size() != String_size(x1) || strcmp(y1.c_str(), String_c_str(x1)) != 0) {
+		printf("!!!NG!!!\n");
+	}
+
+	WString_clear(wx1);
+	wy1.clear();
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		WString_append(wx1, &wcstr[LENGTH - 16]);
+	}
+	printf("cstl: wappend[%d]: %g ms\n", COUNT, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		wy1.append(&wcstr[LENGTH - 16]);
+	}
+	printf("stl : wappend[%d]: %g ms\n", COUNT, get_msec() - t);
+	if (wy1.size() != WString_size(wx1)) {
+		printf("!!!NG!!!\n");
+	}
+
+	// assign
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		String_assign(x2, cstr);
+	}
+	printf("cstl: assign[%d x %d]: %g ms\n", COUNT, LENGTH, get_msec() - t);
+
+	t = get_msec();
+	for (i = 0; i < COUNT; i++) {
+		y2.assign(cstr);
+	}
+	printf("stl : assign[%d x %d]: %g ms\n", COUNT, LENGTH, get_msec() - t);
+
+	// tokenize
+	String_clear(x1);
+	y1.clear();
+	for (i = 0; i < TOKEN_COUNT; i++) {
+		String_append_len(x1, cstr, i % 16 + 1);
+		String_push_back(x1, ',');
+	}
+	y1 = String_c_str(x1);
+	{
+		size_t pos, next;
+		size_t total1 = 0, total2 = 0, total3 = 0;
+		t = get_msec();
+		for (pos = 0; (next = String_find_c(x1, ',', pos)) != CSTL_NPOS; pos = next + 1) {
+			String *tok = String_new_assign_len(String_c_str(x1) + pos, next - pos);
+			total1 += String_size(tok);
+			String_delete(tok);
+		}
+		printf("cstl: tokenize(new_assign_len)[%d]: %g ms\n", TOKEN_COUNT, get_msec() - t);
+
+		t = get_msec();
+		{
+			StringView v = String_view(x1);
+			while ((next = StringView_find_c(v, ',', 0)) != CSTL_NPOS) {
+				StringView tok = StringView_substr(v, 0, next);
+				total2 += StringView_size(tok);
+				StringView_remove_prefix(&v, next + 1);
+			}
+		}
+		printf("cstl: tokenize(view)[%d]: %g ms\n", TOKEN_COUNT, get_msec() - t);
+
+		t = get_msec();
+		for (pos = 0; (next = y1.find(',', pos)) != string::npos; pos = next + 1) {
+			string tok = y1.substr(pos, next - pos);
+			total3 += tok.size();
+		}
+		printf("stl : tokenize(substr)[%d]: %g ms\n", TOKEN_COUNT, get_msec() - t);
+		if (total1 != total2 || total1 != total3) {
+			printf("!!!NG!!!\n");
+		}
+	}
+
+	String_delete(x1);
+	String_delete(x2);
+	WString_delete(wx1);
+	WString_delete(wx2);
+
+	return 0;
+}
+
@@ -0,0 +1,153 @@
+/* 
+ * Copyright (c) 2006, KATO Noriaki
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*!
+ * \file btree_debug.h
+ * \brief B木のset/mapデバッグ用
+ * \author KATO Noriaki <katono@users.sourceforge.jp>
+ * \date 2026-10-19
+ * $URL$
+ * $Id$
+ *
+ * B木の表示とベリファイ
+ */
+#ifndef CSTL_BTREE_DEBUG_H_INCLUDED
+#define CSTL_BTREE_DEBUG_H_INCLUDED
+
+#include <stdio.h>
+
+
+#define CSTL_BTREE_DEBUG_INTERFACE(Name)	\
+int Name##_verify(Name *self);\
+void Name##_print(Name *self);\
+
+
+#define CSTL_BTREE_DEBUG_IMPLEMENT(Name, KeyType, Compare, format)	\
+static int Name##BTree_verify_node(Name *self, void *node, size_t height,\
+		KeyType *lo, KeyType *hi, Name##BTreeLeaf **prev, size_t *count)\
+{\
+	size_t i;\
+	if (height == 0) {\
+		Name##BTreeLeaf *leaf = (Name##BTreeLeaf *) node;\
+		if (leaf->prev != *prev || (*prev)->next != leaf) {\
+			return 0;\
+		}\
+		if (leaf->size == 0 || leaf->size > Name##_LEAF_CAP) {\
+			return 0;\
+		}\
+		CSTL_MAGIC(if (leaf->magic != self->head) return 0;)\
+		for (i = 0; i < leaf->size; i++) {\
+			if (Name##BTree_leaf_of(&leaf->elems[i]) != leaf) {\
+				return 0;\
+			}\
+			if (i > 0 && Compare(leaf->elems[i - 1].key, leaf->elems[i].key) >= 0) {\
+				return 0;\
+			}\
+		}\
+		if (lo && Compare(leaf->elems[0].key, *lo) < 0) {\
+			return 0;\
+		}\
+		if (hi && Compare(leaf->elems[leaf->size - 1].key, *hi) >= 0) {\
+			return 0;\
+		}\
+		*prev = leaf;\
+		*count += leaf->size;\
+		return 1;\
+	} else {\
+		Name##BTreeInner *inner = (Name##BTreeInner *) node;\
+		if (inner->size == 0 || inner->size > Name##_INNER_CAP) {\
+			return 0;\
+		}\
+		if (node != self->root && inner->size < Name##_INNER_MIN) {\
+			return 0;\
+		}\
+		for (i = 0; i < inner->size; i++) {\
+			if (i > 0 && Compare(inner->keys[i - 1], inner->keys[i]) >= 0) {\
+				return 0;\
+			}\
+			if ((lo && Compare(inner->keys[i], *lo) < 0) || (hi && Compare(inner->keys[i], *hi) >= 0)) {\
+				return 0;\
+			}\
+		}\
+		for (i = 0; i <= inner->size; i++) {\
+			if (!Name##BTree_verify_node(self, inner->children[i], height - 1,\
+						i > 0 ? &inner->keys[i - 1] : lo, i < inner->size ? &inner->keys[i] : hi, prev, count)) {\
+				return 0;\
+			}\
+		}\
+		return 1;\
+	}\
+}\
+\
+int Name##_verify(Name *self)\
+{\
+	Name##BTreeLeaf *prev = self->head;\
+	size_t count = 0;\
+	if (!self->root) {\
+		return self->size == 0 && self->height == 0 &&\
+			self->head->next == self->head && self->head->prev == self->head;\
+	}\
+	if (!Name##BTree_verify_node(self, self->root, self->height, 0, 0, &prev, &count)) {\
+		return 0;\
+	}\
+	return prev->next == self->head && self->head->prev == prev && count == self->size;\
+}\
+\
+static void Name##BTree_print_node(void *node, size_t height, size_t depth)\
+{\
+	size_t i;\
+	for (i = 0; i < depth; i++) {\
+		printf("  ");\
+	}\
+	if (height == 0) {\
+		Name##BTreeLeaf *leaf = (Name##BTreeLeaf *) node;\
+		printf("leaf[%p], size[%d]:", (void *) leaf, (int) leaf->size);\
+		for (i = 0; i < leaf->size; i++) {\
+			printf(" "#format, leaf->elems[i].key);\
+		}\
+		printf("\n");\
+	} else {\
+		Name##BTreeInner *inner = (Name##BTreeInner *) node;\
+		printf("inner[%p], size[%d]:", (void *) inner, (int) inner->size);\
+		for (i = 0; i < inner->size; i++) {\
+			printf(" "#format, inner->keys[i]);\
+		}\
+		printf("\n");\
+		for (i = 0; i <= inner->size; i++) {\
+			Name##BTree_print_node(inner->children[i], height - 1, depth + 1);\
+		}\
+	}\
+}\
+\
+void Name##_print(Name *self)\
+{\
+	if (self->root) {\
+		Name##BTree_print_node(self->root, self->height, 0);\
+	}\
+	printf("size[%d], height[%d], leaf cap[%d], inner cap[%d]\n", (int) self->size, (int) self->height,\
+			(int) Name##_LEAF_CAP, (int) Name##_INNER_CAP);\
+}\
+
+
+#endif /* CSTL_BTREE_DEBUG_H_INCLUDED */
@@ -0,0 +1,431 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../cstl/btree.h"
+#include "btree_debug.h"
+#include "Pool.h"
+#ifdef MY_MALLOC
+double buf[1024*1024/sizeof(double)];
+Pool pool;
+#define malloc(s)		Pool_malloc(&pool, s)
+#define realloc(p, s)	Pool_realloc(&pool, p, s)
+#define free(p)			Pool_free(&pool, p)
+#endif
+
+
+typedef struct Big {
+	int key;
+	char data[200];
+} Big;
+
+#define BIG_COMP(x, y)	CSTL_LESS((x).key, (y).key)
+
+
+CSTL_BTREE_SET_INTERFACE(IntBSet, int)
+CSTL_BTREE_SET_IMPLEMENT(IntBSet, int, CSTL_LESS)
+CSTL_BTREE_DEBUG_INTERFACE(IntBSet)
+CSTL_BTREE_DEBUG_IMPLEMENT(IntBSet, int, CSTL_LESS, %d)
+
+CSTL_BTREE_SET_INTERFACE(IntBSetD, int)
+CSTL_BTREE_SET_IMPLEMENT(IntBSetD, int, CSTL_GREATER)
+CSTL_BTREE_DEBUG_INTERFACE(IntBSetD)
+CSTL_BTREE_DEBUG_IMPLEMENT(IntBSetD, int, CSTL_GREATER, %d)
+
+CSTL_BTREE_MAP_INTERFACE(IntIntBMap, int, int)
+CSTL_BTREE_MAP_IMPLEMENT(IntIntBMap, int, int, CSTL_LESS)
+CSTL_BTREE_DEBUG_INTERFACE(IntIntBMap)
+CSTL_BTREE_DEBUG_IMPLEMENT(IntIntBMap, int, CSTL_LESS, %d)
+
+CSTL_BTREE_MAP_INTERFACE(StrIntBMap, const char *, int)
+CSTL_BTREE_MAP_IMPLEMENT(StrIntBMap, const char *, int, strcmp)
+CSTL_BTREE_DEBUG_INTERFACE(StrIntBMap)
+CSTL_BTREE_DEBUG_IMPLEMENT(StrIntBMap, const char *, strcmp, %s)
+
+CSTL_BTREE_SET_INTERFACE(BigBSet, Big)
+CSTL_BTREE_SET_IMPLEMENT(BigBSet, Big, BIG_COMP)
+
+#define SIZE	2000
+#define KEYS	5000
+#define BIG_SIZE	500
+
+
+static int present[KEYS];
+
+static int rand_key(void)
+{
+	return rand() % KEYS;
+}
+
+static void check_set(IntBSet *x)
+{
+	IntBSetIterator pos;
+	size_t count = 0;
+	int i;
+	assert(IntBSet_verify(x));
+	pos = IntBSet_begin(x);
+	for (i = 0; i < KEYS; i++) {
+		if (present[i]) {
+			assert(pos != IntBSet_end(x));
+			assert(*IntBSet_data(pos) == i);
+			pos = IntBSet_next(pos);
+			count++;
+		}
+	}
+	assert(pos == IntBSet_end(x));
+	assert(count == IntBSet_size(x));
+	pos = IntBSet_rbegin(x);
+	for (i = KEYS - 1; i >= 0; i--) {
+		if (present[i]) {
+			assert(pos != IntBSet_rend(x));
+			assert(*IntBSet_data(pos) == i);
+			pos = IntBSet_prev(pos);
+		}
+	}
+	assert(pos == IntBSet_rend(x));
+}
+
+void BTreeTest_test_1_1(void)
+{
+	IntBSet *x;
+	IntBSetIterator pos;
+	IntBSetIterator first;
+	IntBSetIterator last;
+	int i;
+	int success;
+	printf("***** test_1_1 *****\n");
+	x = IntBSet_new();
+	assert(x);
+	assert(IntBSet_empty(x));
+	assert(IntBSet_size(x) == 0);
+	assert(IntBSet_begin(x) == IntBSet_end(x));
+	assert(IntBSet_rbegin(x) == IntBSet_rend(x));
+	assert(IntBSet_find(x, 1) == IntBSet_end(x));
+	assert(IntBSet_lower_bound(x, 1) == IntBSet_end(x));
+	assert(IntBSet_verify(x));
+	/* insert */
+	for (i = 0; i < SIZE; i++) {
+		pos = IntBSet_insert(x, i * 2, &success);
+		assert(pos);
+		assert(success);
+		assert(*IntBSet_data(pos) == i * 2);
+	}
+	assert(IntBSet_verify(x));
+	assert(IntBSet_size(x) == SIZE);
+	pos = IntBSet_insert(x, 10, &success);
+	assert(!success);
+	assert(*IntBSet_data(pos) == 10);
+	assert(IntBSet_size(x) == SIZE);
+	/* find, count, lower_bound, upper_bound, equal_range */
+	for (i = 0; i < SIZE * 2; i++) {
+		pos = IntBSet_find(x, i);
+		if (i % 2 == 0) {
+			assert(pos != IntBSet_end(x));
+			assert(*IntBSet_data(pos) == i);
+			assert(IntBSet_count(x, i) == 1);
+			assert(IntBSet_lower_bound(x, i) == pos);
+			IntBSet_equal_range(x, i, &first, &last);
+			assert(first == pos);
+			assert(last == IntBSet_next(pos));
+		} else {
+			assert(pos == IntBSet_end(x));
+			assert(IntBSet_count(x, i) == 0);
+			IntBSet_equal_range(x, i, &first, &last);
+			assert(first == last);
+			if (i < SIZE * 2 - 1) {
+				assert(*IntBSet_data(IntBSet_lower_bound(x, i)) == i + 1);
+			}
+		}
+		pos = IntBSet_upper_bound(x, i);
+		if (i < SIZE * 2 - 2) {
+			assert(*IntBSet_data(pos) == i + 2 - i % 2);
+		} else {
+			assert(pos == IntBSet_end(x));
+		}
+	}
+	assert(*IntBSet_data(IntBSet_lower_bound(x, -1)) == 0);
+	assert(*IntBSet_data(IntBSet_begin(x)) == 0);
+	assert(*IntBSet_data(IntBSet_rbegin(x)) == SIZE * 2 - 2);
+	/* next, prev */
+	for (pos = IntBSet_begin(x), i = 0; pos != IntBSet_end(x); pos = IntBSet_next(pos), i += 2) {
+		assert(*IntBSet_data(pos) == i);
+	}
+	assert(i == SIZE * 2);
+	for (pos = IntBSet_rbegin(x), i = SIZE * 2 - 2; pos != IntBSet_rend(x); pos = IntBSet_prev(pos), i -= 2) {
+		assert(*IntBSet_data(pos) == i);
+	}
+	assert(i == -2);
+	/* erase */
+	pos = IntBSet_find(x, 100);
+	pos = IntBSet_erase(x, pos);
+	assert(*IntBSet_data(pos) == 102);
+	assert(IntBSet_size(x) == SIZE - 1);
+	pos = IntBSet_erase(x, IntBSet_rbegin(x));
+	assert(pos == IntBSet_end(x));
+	assert(IntBSet_verify(x));
+	/* erase_range */
+	first = IntBSet_find(x, 200);
+	last = IntBSet_find(x, 1000);
+	pos = IntBSet_erase_range(x, first, last);
+	assert(*IntBSet_data(pos) == 1000);
+	assert(*IntBSet_data(IntBSet_prev(pos)) == 198);
+	assert(IntBSet_size(x) == SIZE - 2 - 400);
+	assert(IntBSet_verify(x));
+	/* erase_key */
+	assert(IntBSet_erase_key(x, 0) == 1);
+	assert(IntBSet_erase_key(x, 0) == 0);
+	assert(IntBSet_erase_key(x, 1) == 0);
+	assert(IntBSet_size(x) == SIZE - 3 - 400);
+	/* 全削除 */
+	for (pos = IntBSet_begin(x); pos != IntBSet_end(x); ) {
+		pos = IntBSet_erase(x, pos);
+	}
+	assert(IntBSet_empty(x));
+	assert(IntBSet_verify(x));
+	/* clear */
+	for (i = 0; i < SIZE; i++) {
+		assert(IntBSet_insert(x, SIZE - i, NULL));
+	}
+	assert(IntBSet_verify(x));
+	IntBSet_clear(x);
+	assert(IntBSet_empty(x));
+	assert(IntBSet_begin(x) == IntBSet_end(x));
+	assert(IntBSet_verify(x));
+	assert(IntBSet_insert(x, 1, NULL));
+	assert(IntBSet_size(x) == 1);
+	IntBSet_delete(x);
+}
+
+void BTreeTest_test_1_2(void)
+{
+	IntBSet *x;
+	IntBSet *y;
+	IntBSetIterator pos;
+	int i, j;
+	int success;
+	printf("***** test_1_2 *****\n");
+	x = IntBSet_new();
+	srand(0);
+	memset(present, 0, sizeof present);
+	/* ランダムな挿入と削除 */
+	for (j = 0; j < 20; j++) {
+		for (i = 0; i < SIZE; i++) {
+			int k = rand_key();
+			if (rand() % 3 == 0) {
+				assert(IntBSet_erase_key(x, k) == (size_t) present[k]);
+				present[k] = 0;
+			} else {
+				pos = IntBSet_insert(x, k, &success);
+				assert(pos);
+				assert(success == !present[k]);
+				assert(*IntBSet_data(pos) == k);
+				present[k] = 1;
+			}
+		}
+		check_set(x);
+		/* 範囲の削除 */
+		{
+			int lo = rand_key();
+			int hi = lo + rand() % 500;
+			IntBSetIterator first = IntBSet_lower_bound(x, lo);
+			IntBSetIterator last = IntBSet_lower_bound(x, hi);
+			pos = IntBSet_erase_range(x, first, last);
+			assert(pos == IntBSet_lower_bound(x, hi));
+			for (i = lo; i < hi && i < KEYS; i++) {
+				present[i] = 0;
+			}
+			check_set(x);
+		}
+		/* 繰り返し位置で削除 */
+		for (pos = IntBSet_begin(x); pos != IntBSet_end(x); ) {
+			int k = *IntBSet_data(pos);
+			if (rand() % 4 == 0) {
+				IntBSetIterator next = IntBSet_erase(x, pos);
+				present[k] = 0;
+				assert(next == IntBSet_upper_bound(x, k));
+				pos = next;
+			} else {
+				pos = IntBSet_next(pos);
+			}
+		}
+		check_set(x);
+	}
+	/* insert_range, swap */
+	y = IntBSet_new();
+	assert(IntBSet_insert(y, -1, NULL));
+	assert(IntBSet_insert(y, KEYS + 1, NULL));
+	assert(IntBSet_insert_range(y, IntBSet_begin(x), IntBSet_end(x)));
+	assert(IntBSet_size(y) == IntBSet_size(x) + 2);
+	assert(IntBSet_verify(y));
+	assert(IntBSet_insert_range(y, IntBSet_begin(x), IntBSet_end(x)));
+	assert(IntBSet_size(y) == IntBSet_size(x) + 2);
+	assert(IntBSet_insert_range(x, IntBSet_begin(x), IntBSet_end(x)));
+	check_set(x);
+	IntBSet_swap(x, y);
+	assert(*IntBSet_data(IntBSet_begin(x)) == -1);
+	assert(IntBSet_erase_key(x, -1) == 1);
+	assert(IntBSet_erase_key(x, KEYS + 1) == 1);
+	check_set(x);
+	check_set(y);
+	IntBSet_delete(x);
+	IntBSet_delete(y);
+}
+
+void BTreeTest_test_1_3(void)
+{
+	IntBSetD *x;
+	IntBSetDIterator pos;
+	int i;
+	printf("***** test_1_3 *****\n");
+	x = IntBSetD_new();
+	/* 降順 */
+	for (i = 0; i < SIZE; i++) {
+		assert(IntBSetD_insert(x, i, NULL));
+	}
+	assert(IntBSetD_verify(x));
+	for (pos = IntBSetD_begin(x), i = SIZE - 1; pos != IntBSetD_end(x); pos = IntBSetD_next(pos), i--) {
+		assert(*IntBSetD_data(pos) == i);
+	}
+	assert(i == -1);
+	assert(*IntBSetD_data(IntBSetD_lower_bound(x, SIZE / 2)) == SIZE / 2);
+	assert(*IntBSetD_data(IntBSetD_upper_bound(x, SIZE / 2)) == SIZE / 2 - 1);
+	for (i = 0; i < SIZE; i += 2) {
+		assert(IntBSetD_erase_key(x, i) == 1);
+	}
+	assert(IntBSetD_verify(x));
+	assert(IntBSetD_size(x) == SIZE / 2);
+	IntBSetD_delete(x);
+}
+
+void BTreeTest_test_2_1(void)
+{
+	IntIntBMap *x;
+	IntIntBMapIterator pos;
+	int i;
+	int success;
+	int value = 5;
+	printf("***** test_2_1 *****\n");
+	x = IntIntBMap_new();
+	/* at */
+	for (i = 0; i < SIZE; i++) {
+		int *p = IntIntBMap_at(x, SIZE - i);
+		assert(p);
+		assert(*p == 0);
+		*p = i;
+	}
+	assert(IntIntBMap_verify(x));
+	assert(IntIntBMap_size(x) == SIZE);
+	for (i = 0; i < SIZE; i++) {
+		assert(*IntIntBMap_at(x, SIZE - i) == i);
+	}
+	assert(IntIntBMap_size(x) == SIZE);
+	for (pos = IntIntBMap_begin(x), i = 1; pos != IntIntBMap_end(x); pos = IntIntBMap_next(pos), i++) {
+		assert(*IntIntBMap_key(pos) == i);
+		assert(*IntIntBMap_value(pos) == SIZE - i);
+	}
+	/* insert, insert_ref */
+	pos = IntIntBMap_insert(x, 1, 100, &success);
+	assert(!success);
+	assert(*IntIntBMap_value(pos) == SIZE - 1);
+	pos = IntIntBMap_insert(x, 0, 100, &success);
+	assert(success);
+	assert(*IntIntBMap_value(pos) == 100);
+	pos = IntIntBMap_insert_ref(x, -1, &value, &success);
+	assert(success);
+	assert(*IntIntBMap_value(pos) == 5);
+	assert(IntIntBMap_begin(x) == pos);
+	assert(IntIntBMap_verify(x));
+	/* 値は要素の移動に伴って移動する */
+	for (i = 1; i <= SIZE; i += 3) {
+		assert(IntIntBMap_erase_key(x, i) == 1);
+	}
+	assert(IntIntBMap_verify(x));
+	for (pos = IntIntBMap_find(x, 2); pos != IntIntBMap_end(x); pos = IntIntBMap_next(pos)) {
+		assert(*IntIntBMap_value(pos) == SIZE - *IntIntBMap_key(pos));
+	}
+	IntIntBMap_delete(x);
+}
+
+void BTreeTest_test_2_2(void)
+{
+	StrIntBMap *x;
+	StrIntBMapIterator pos;
+	static const char *words[] = {
+		"pear", "apple", "orange", "banana", "cherry", "grape", "melon", "kiwi", "lemon", "peach",
+	};
+	size_t i;
+	printf("***** test_2_2 *****\n");
+	x = StrIntBMap_new();
+	for (i = 0; i < sizeof words / sizeof words[0]; i++) {
+		assert(StrIntBMap_insert(x, words[i], (int) i, NULL));
+	}
+	assert(StrIntBMap_verify(x));
+	assert(strcmp(*StrIntBMap_key(StrIntBMap_begin(x)), "apple") == 0);
+	assert(strcmp(*StrIntBMap_key(StrIntBMap_rbegin(x)), "pear") == 0);
+	assert(*StrIntBMap_value(StrIntBMap_find(x, "melon")) == 6);
+	assert(strcmp(*StrIntBMap_key(StrIntBMap_lower_bound(x, "c")), "cherry") == 0);
+	assert(StrIntBMap_find(x, "fig") == StrIntBMap_end(x));
+	for (pos = StrIntBMap_begin(x); StrIntBMap_next(pos) != StrIntBMap_end(x); pos = StrIntBMap_next(pos)) {
+		assert(strcmp(*StrIntBMap_key(pos), *StrIntBMap_key(StrIntBMap_next(pos))) < 0);
+	}
+	StrIntBMap_print(x);
+	StrIntBMap_delete(x);
+}
+
+void BTreeTest_test_3_1(void)
+{
+	BigBSet *x;
+	BigBSetIterator pos;
+	Big b;
+	int i;
+	printf("***** test_3_1 *****\n");
+	x = BigBSet_new();
+	memset(&b, 0, sizeof b);
+	/* 大きな要素 */
+	for (i = 0; i < BIG_SIZE; i++) {
+		b.key = (i * 7) % BIG_SIZE;
+		b.data[0] = (char) b.key;
+		assert(BigBSet_insert(x, b, NULL));
+	}
+	assert(BigBSet_size(x) == BIG_SIZE);
+	for (pos = BigBSet_begin(x), i = 0; pos != BigBSet_end(x); pos = BigBSet_next(pos), i++) {
+		assert(BigBSet_data(pos)->key == i);
+		assert(BigBSet_data(pos)->data[0] == (char) i);
+	}
+	for (i = 0; i < BIG_SIZE; i += 2) {
+		b.key = i;
+		assert(BigBSet_erase_key(x, b) == 1);
+	}
+	assert(BigBSet_size(x) == BIG_SIZE / 2);
+	for (pos = BigBSet_rbegin(x), i = BIG_SIZE - 1; pos != BigBSet_rend(x); pos = BigBSet_prev(pos), i -= 2) {
+		assert(BigBSet_data(pos)->key == i);
+	}
+	BigBSet_delete(x);
+}
+
+
+
+
+void BTreeTest_run(void)
+{
+	printf("\n===== btree test =====\n");
+	BTreeTest_test_1_1();
+	BTreeTest_test_1_2();
+	BTreeTest_test_1_3();
+	BTreeTest_test_2_1();
+	BTreeTest_test_2_2();
+	BTreeTest_test_3_1();
+}
+
+
+int main(void)
+{
+#ifdef MY_MALLOC
+	Pool_init(&pool, buf, sizeof buf, sizeof buf[0]);
+#endif
+	BTreeTest_run();
+#ifdef MY_MALLOC
+	POOL_DUMP_LEAK(&pool, 0);
+#endif
+	return 0;
+}
@@ -0,0 +1,300 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "../cstl/compact_unordered_set.h"
+#include "Pool.h"
+#ifdef MY_MALLOC
+double buf[1024*1024/sizeof(double)];
+Pool pool;
+#define malloc(s)		Pool_malloc(&pool, s)
+#define realloc(p, s)	Pool_realloc(&pool, p, s)
+#define free(p)			Pool_free(&pool, p)
+#endif
+
+
+CSTL_COMPACT_UNORDERED_SET_INTERFACE(IntCUSet, int)
+CSTL_COMPACT_UNORDERED_SET_IMPLEMENT(IntCUSet, int, IntCUSet_hash_int, CSTL_EQUAL_TO)
+
+static size_t hash_string(const char *str)
+{
+	size_t val = 0;
+	while (*str) {
+		val = val * 31 + (unsigned char) *str++;
+	}
+	return val;
+}
+
+CSTL_COMPACT_UNORDERED_SET_INTERFACE(StrCUSet, const char *)
+CSTL_COMPACT_UNORDERED_SET_IMPLEMENT(StrCUSet, const char *, hash_string, strcmp)
+
+#define SIZE	1000
+
+static IntCUSet *ia;
+static StrCUSet *sa;
+static char str[SIZE][16];
+
+
+/* 全ノードがちょうど1回ずつ、自分のキーのバケットからたどれること */
+static int IntCUSet_verify(IntCUSet *self)
+{
+	size_t i;
+	size_t n = 0;
+	unsigned int j;
+	for (i = 0; i < IntCUSet_bucket_count(self); i++) {
+		for (j = self->buckets[i]; j; j = CSTL_VECTOR_AT(self->nodes, j - 1).next) {
+			if (j > CSTL_VECTOR_SIZE(self->nodes)) return 0;
+			if (IntCUSet_bucket_index(self, &CSTL_VECTOR_AT(self->nodes, j - 1).key) != i) return 0;
+			n++;
+			if (n > CSTL_VECTOR_SIZE(self->nodes)) return 0;
+		}
+	}
+	if (n != CSTL_VECTOR_SIZE(self->nodes)) return 0;
+	if ((double) n > (double) IntCUSet_bucket_count(self) * self->max_load_factor) return 0;
+	return 1;
+}
+
+void CUSetTest_test_1_1(void)
+{
+	int i;
+	int success;
+	size_t count;
+	long sum;
+	IntCUSetIterator pos;
+	printf("***** test_1_1 *****\n");
+	ia = IntCUSet_new();
+	assert(ia);
+	assert(IntCUSet_empty(ia));
+	assert(IntCUSet_size(ia) == 0);
+	assert(IntCUSet_begin(ia) == IntCUSet_end(ia));
+	assert(IntCUSet_bucket_count(ia) == 1 << CSTL_COMPACT_UNORDERED_SET_MIN_BITS);
+	assert(IntCUSet_get_max_load_factor(ia) == 1.0f);
+	/* insert */
+	for (i = 0; i < SIZE; i++) {
+		pos = IntCUSet_insert(ia, i * 3, &success);
+		assert(pos && success);
+		assert(*IntCUSet_data(pos) == i * 3);
+		assert(IntCUSet_size(ia) == (size_t) i + 1);
+	}
+	assert(IntCUSet_verify(ia));
+	assert(!IntCUSet_empty(ia));
+	assert(IntCUSet_load_factor(ia) <= 1.0f);
+	/* 同じキー */
+	for (i = 0; i < SIZE; i++) {
+		pos = IntCUSet_insert(ia, i * 3, &success);
+		assert(pos && !success);
+		assert(*IntCUSet_data(pos) == i * 3);
+	}
+	assert(IntCUSet_insert(ia, 0, NULL));
+	assert(IntCUSet_size(ia) == SIZE);
+	/* find, count */
+	for (i = 0; i < SIZE * 3; i++) {
+		pos = IntCUSet_find(ia, i);
+		if (i % 3 == 0) {
+			assert(pos != IntCUSet_end(ia));
+			assert(*IntCUSet_data(pos) == i);
+			assert(IntCUSet_count(ia, i) == 1);
+		} else {
+			assert(pos == IntCUSet_end(ia));
+			assert(IntCUSet_count(ia, i) == 0);
+		}
+	}
+	/* 走査 */
+	count = 0;
+	sum = 0;
+	for (pos = IntCUSet_begin(ia); pos != IntCUSet_end(ia); pos = IntCUSet_next(pos)) {
+		sum += *IntCUSet_data(pos);
+		count++;
+	}
+	assert(count == SIZE);
+	assert(sum == 3L * SIZE * (SIZE - 1) / 2);
+	/* erase_key */
+	for (i = 0; i < SIZE; i += 2) {
+		assert(IntCUSet_erase_key(ia, i * 3) == 1);
+		assert(IntCUSet_erase_key(ia, i * 3) == 0);
+		assert(IntCUSet_verify(ia));
+	}
+	assert(IntCUSet_size(ia) == SIZE / 2);
+	for (i = 0; i < SIZE; i++) {
+		assert(IntCUSet_count(ia, i * 3) == (size_t) (i % 2));
+	}
+	/* clear */
+	IntCUSet_clear(ia);
+	assert(IntCUSet_empty(ia));
+	assert(IntCUSet_begin(ia) == IntCUSet_end(ia));
+	assert(IntCUSet_find(ia, 3) == IntCUSet_end(ia));
+	assert(IntCUSet_verify(ia));
+	assert(IntCUSet_insert(ia, 3, &success) && success);
+	assert(IntCUSet_size(ia) == 1);
+	POOL_DUMP_OVERFLOW(&pool);
+	IntCUSet_delete(ia);
+	IntCUSet_delete(NULL);
+}
+
+void CUSetTest_test_1_2(void)
+{
+	int i;
+	size_t count;
+	IntCUSetIterator pos;
+	printf("***** test_1_2 *****\n");
+	ia = IntCUSet_new();
+	for (i = 0; i < SIZE; i++) {
+		assert(IntCUSet_insert(ia, i, NULL));
+	}
+	/* 奇数をイテレータで削除。eraseは同じ位置に末尾の要素を移して返す */
+	count = 0;
+	for (pos = IntCUSet_begin(ia); pos != IntCUSet_end(ia); ) {
+		count++;
+		if (*IntCUSet_data(pos) & 1) {
+			pos = IntCUSet_erase(ia, pos);
+			assert(IntCUSet_verify(ia));
+		} else {
+			pos = IntCUSet_next(pos);
+		}
+	}
+	assert(count == SIZE);
+	assert(IntCUSet_size(ia) == SIZE / 2);
+	for (i = 0; i < SIZE; i++) {
+		assert(IntCUSet_count(ia, i) == (size_t) !(i & 1));
+	}
+	/* 末尾の要素の削除はend()を返す */
+	pos = IntCUSet_begin(ia);
+	for (i = 1; i < (int) IntCUSet_size(ia); i++) {
+		pos = IntCUSet_next(pos);
+	}
+	assert(IntCUSet_erase(ia, pos) == IntCUSet_end(ia));
+	assert(IntCUSet_verify(ia));
+	/* 先頭の要素を次々に削除 */
+	while (!IntCUSet_empty(ia)) {
+		IntCUSet_erase(ia, IntCUSet_begin(ia));
+		assert(IntCUSet_verify(ia));
+	}
+	assert(IntCUSet_begin(ia) == IntCUSet_end(ia));
+	POOL_DUMP_OVERFLOW(&pool);
+	IntCUSet_delete(ia);
+}
+
+void CUSetTest_test_1_3(void)
+{
+	int i;
+	size_t n;
+	IntCUSet *x;
+	printf("***** test_1_3 *****\n");
+	ia = IntCUSet_new();
+	/* reserve */
+	assert(IntCUSet_reserve(ia, SIZE));
+	n = IntCUSet_bucket_count(ia);
+	assert(n >= SIZE);
+	assert((n & (n - 1)) == 0);
+	assert(CSTL_VECTOR_CAPACITY(ia->nodes) >= SIZE);
+	for (i = 0; i < SIZE; i++) {
+		assert(IntCUSet_insert(ia, -i, NULL));
+	}
+	assert(IntCUSet_bucket_count(ia) == n);
+	assert(IntCUSet_verify(ia));
+	/* rehash */
+	assert(IntCUSet_rehash(ia, n * 4 - 1));
+	assert(IntCUSet_bucket_count(ia) == n * 4);
+	assert(IntCUSet_verify(ia));
+	assert(IntCUSet_rehash(ia, 1));
+	assert(IntCUSet_bucket_count(ia) == n * 4);
+	for (i = 0; i < SIZE; i++) {
+		assert(IntCUSet_count(ia, -i) == 1);
+	}
+	/* shrink_to_fit */
+	for (i = 10; i < SIZE; i++) {
+		assert(IntCUSet_erase_key(ia, -i) == 1);
+	}
+	assert(IntCUSet_shrink_to_fit(ia));
+	assert(IntCUSet_bucket_count(ia) == 16);
+	assert(CSTL_VECTOR_CAPACITY(ia->nodes) == 10);
+	assert(IntCUSet_verify(ia));
+	for (i = 0; i < SIZE; i++) {
+		assert(IntCUSet_count(ia, -i) == (size_t) (i < 10));
+	}
+	/* max_load_factor */
+	IntCUSet_set_max_load_factor(ia, 4.0f);
+	assert(IntCUSet_get_max_load_factor(ia) == 4.0f);
+	for (i = 10; i < SIZE; i++) {
+		assert(IntCUSet_insert(ia, -i, NULL));
+	}
+	assert(IntCUSet_verify(ia));
+	assert(IntCUSet_load_factor(ia) > 1.0f);
+	assert(IntCUSet_load_factor(ia) <= 4.0f);
+	IntCUSet_set_max_load_factor(ia, 0.0f);
+	assert(IntCUSet_get_max_load_factor(ia) > 0.0f);
+	IntCUSet_set_max_load_factor(ia, 0.5f);
+	assert(IntCUSet_insert(ia, 1, NULL));
+	assert(IntCUSet_verify(ia));
+	/* swap */
+	x = IntCUSet_new();
+	assert(IntCUSet_insert(x, 12345, NULL));
+	n = IntCUSet_bucket_count(ia);
+	IntCUSet_swap(ia, x);
+	assert(IntCUSet_size(ia) == 1);
+	assert(IntCUSet_count(ia, 12345) == 1);
+	assert(IntCUSet_get_max_load_factor(ia) == 1.0f);
+	assert(IntCUSet_size(x) == SIZE + 1);
+	assert(IntCUSet_bucket_count(x) == n);
+	assert(IntCUSet_get_max_load_factor(x) == 0.5f);
+	assert(IntCUSet_verify(ia));
+	assert(IntCUSet_verify(x));
+	/* 空にしてからshrink_to_fit */
+	IntCUSet_clear(x);
+	assert(IntCUSet_shrink_to_fit(x));
+	assert(IntCUSet_bucket_count(x) == 1 << CSTL_COMPACT_UNORDERED_SET_MIN_BITS);
+	assert(IntCUSet_begin(x) == IntCUSet_end(x));
+	assert(IntCUSet_insert(x, 1, NULL));
+	assert(IntCUSet_verify(x));
+	POOL_DUMP_OVERFLOW(&pool);
+	IntCUSet_delete(x);
+	IntCUSet_delete(ia);
+}
+
+void CUSetTest_test_2_1(void)
+{
+	int i;
+	int success;
+	StrCUSetIterator pos;
+	printf("***** test_2_1 *****\n");
+	for (i = 0; i < SIZE; i++) {
+		sprintf(str[i], "%05d", i);
+	}
+	sa = StrCUSet_new();
+	for (i = 0; i < SIZE; i++) {
+		assert(StrCUSet_insert(sa, str[i], &success) && success);
+	}
+	assert(StrCUSet_insert(sa, "00001", &success) && !success);
+	assert(StrCUSet_size(sa) == SIZE);
+	pos = StrCUSet_find(sa, "00123");
+	assert(pos != StrCUSet_end(sa));
+	assert(*StrCUSet_data(pos) == str[123]);
+	assert(StrCUSet_find(sa, "abc") == StrCUSet_end(sa));
+	assert(StrCUSet_erase_key(sa, "00123") == 1);
+	assert(StrCUSet_count(sa, "00123") == 0);
+	assert(StrCUSet_size(sa) == SIZE - 1);
+	POOL_DUMP_OVERFLOW(&pool);
+	StrCUSet_delete(sa);
+}
+
+
+void CUSetTest_run(void)
+{
+	printf("\n===== compact_unordered_set test =====\n");
+	CUSetTest_test_1_1();
+	CUSetTest_test_1_2();
+	CUSetTest_test_1_3();
+	CUSetTest_test_2_1();
+}
+
+
+int main(void)
+{
+#ifdef MY_MALLOC
+	Pool_init(&pool, buf, sizeof buf, sizeof buf[0]);
+#endif
+	CUSetTest_run();
+#ifdef MY_MALLOC
+	POOL_DUMP_LEAK(&pool, 0);
+#endif
+	return 0;
+}
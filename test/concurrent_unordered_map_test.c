@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "Pool.h"
+#ifdef MY_MALLOC
+double buf[1024*1024/sizeof(double)];
+Pool pool;
+/* Poolはスレッドセーフではないので排他する */
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static void *test_malloc(size_t s)
+{
+	void *p;
+	pthread_mutex_lock(&pool_mutex);
+	p = Pool_malloc(&pool, s);
+	pthread_mutex_unlock(&pool_mutex);
+	return p;
+}
+static void *test_realloc(void *ptr, size_t s)
+{
+	void *p;
+	pthread_mutex_lock(&pool_mutex);
+	p = Pool_realloc(&pool, ptr, s);
+	pthread_mutex_unlock(&pool_mutex);
+	return p;
+}
+static void test_free(void *p)
+{
+	pthread_mutex_lock(&pool_mutex);
+	Pool_free(&pool, p);
+	pthread_mutex_unlock(&pool_mutex);
+}
+#define malloc(s)		test_malloc(s)
+#define realloc(p, s)	test_realloc(p, s)
+#define free(p)			test_free(p)
+#endif
+#include "../cstl/concurrent_unordered_map.h"
+
+
+CSTL_CONCURRENT_UNORDERED_MAP_INTERFACE(IntIntCMap, int, int)
+CSTL_CONCURRENT_UNORDERED_MAP_IMPLEMENT(IntIntCMap, int, int, IntIntCMap_ShardMap_hash_int, CSTL_EQUAL_TO)
+
+#define THREAD_COUNT	8
+#define SIZE			1000
+
+static IntIntCMap *ia;
+
+
+static void add_arg(int *value, int inserted, void *arg)
+{
+	if (inserted) {
+		*value = 0;
+	}
+	*value += *(int *) arg;
+}
+
+static void sum_value(int const *key, int *value, void *arg)
+{
+	assert(*value == -*key);
+	*(long *) arg += *value;
+}
+
+void CMapTest_test_1_1(void)
+{
+	int i;
+	int v;
+	int success;
+	long sum;
+	size_t n;
+	printf("***** test_1_1 *****\n");
+	ia = IntIntCMap_new(5);
+	assert(ia);
+	assert(IntIntCMap_shard_count(ia) == 8);
+	assert(IntIntCMap_empty(ia));
+	for (i = 0; i < SIZE; i++) {
+		assert(IntIntCMap_insert(ia, i, -i, &success) && success);
+		assert(IntIntCMap_shard(ia, i) < 8);
+	}
+	assert(IntIntCMap_insert(ia, 0, 100, &success) && !success);
+	assert(IntIntCMap_size(ia) == SIZE);
+	for (i = 0; i < SIZE; i++) {
+		assert(IntIntCMap_find(ia, i, &v) && v == -i);
+	}
+	assert(!IntIntCMap_find(ia, SIZE, &v));
+	assert(!IntIntCMap_find(ia, -1, NULL));
+	/* シャードごとの走査 */
+	sum = 0;
+	for (n = 0; n < IntIntCMap_shard_count(ia); n++) {
+		IntIntCMap_for_each_shard(ia, n, sum_value, &sum);
+	}
+	assert(sum == -(long) SIZE * (SIZE - 1) / 2);
+	/* at */
+	v = 3;
+	assert(IntIntCMap_at(ia, SIZE, add_arg, &v));
+	assert(IntIntCMap_at(ia, SIZE, add_arg, &v));
+	assert(IntIntCMap_find(ia, SIZE, &v) && v == 6);
+	assert(IntIntCMap_erase_key(ia, SIZE) == 1);
+	assert(IntIntCMap_erase_key(ia, SIZE) == 0);
+	for (i = 0; i < SIZE; i += 2) {
+		assert(IntIntCMap_erase_key(ia, i) == 1);
+	}
+	assert(IntIntCMap_size(ia) == SIZE / 2);
+	IntIntCMap_clear(ia);
+	assert(IntIntCMap_empty(ia));
+	IntIntCMap_delete(ia);
+
+	/* シャード数の省略値 */
+	ia = IntIntCMap_new(0);
+	assert(IntIntCMap_shard_count(ia) == CSTL_CONCURRENT_SHARD_COUNT);
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntCMap_delete(ia);
+}
+
+static void *CMapTest_worker(void *arg)
+{
+	int id = *(int *) arg;
+	int one = 1;
+	int i;
+	int v;
+	for (i = id; i < SIZE * THREAD_COUNT; i += THREAD_COUNT) {
+		assert(IntIntCMap_insert(ia, i, -i, NULL));
+		/* 全スレッドが同じキーを更新する */
+		assert(IntIntCMap_at(ia, -1 - i % 16, add_arg, &one));
+	}
+	for (i = id; i < SIZE * THREAD_COUNT; i += THREAD_COUNT) {
+		assert(IntIntCMap_find(ia, i, &v) && v == -i);
+		if (i % 3 == 0) {
+			assert(IntIntCMap_erase_key(ia, i) == 1);
+		}
+	}
+	return 0;
+}
+
+void CMapTest_test_2_1(void)
+{
+	int i;
+	int v;
+	int ids[THREAD_COUNT];
+	pthread_t th[THREAD_COUNT];
+	size_t n = 0;
+	printf("***** test_2_1 *****\n");
+	ia = IntIntCMap_new(4);
+	for (i = 0; i < THREAD_COUNT; i++) {
+		ids[i] = i;
+		assert(pthread_create(&th[i], 0, CMapTest_worker, &ids[i]) == 0);
+	}
+	for (i = 0; i < THREAD_COUNT; i++) {
+		pthread_join(th[i], 0);
+	}
+	for (i = 0; i < SIZE * THREAD_COUNT; i++) {
+		if (i % 3 == 0) {
+			assert(!IntIntCMap_find(ia, i, NULL));
+		} else {
+			assert(IntIntCMap_find(ia, i, &v) && v == -i);
+			n++;
+		}
+	}
+	for (i = 0; i < 16; i++) {
+		assert(IntIntCMap_find(ia, -1 - i, &v) && v == SIZE * THREAD_COUNT / 16);
+	}
+	assert(IntIntCMap_size(ia) == n + 16);
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntCMap_delete(ia);
+}
+
+
+void CMapTest_run(void)
+{
+	printf("\n===== concurrent_unordered_map test =====\n");
+	CMapTest_test_1_1();
+	CMapTest_test_2_1();
+}
+
+
+int main(void)
+{
+#ifdef MY_MALLOC
+	Pool_init(&pool, buf, sizeof buf, sizeof buf[0]);
+#endif
+	CMapTest_run();
+#ifdef MY_MALLOC
+	POOL_DUMP_LEAK(&pool, 0);
+#endif
+	return 0;
+}
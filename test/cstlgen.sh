@@ -274,7 +274,7 @@ ${hashtable_debug}
 "
 
 tmp=`grep -h '#define CSTL_' ../cstl/*.h | \
-	grep -v 'CSTL_.*\(INCLUDED\|EXTERN_C\|INTERFACE\|IMPLEMENT.*\|LESS\|GREATER\|EQUAL_TO\)' | \
+	grep -v 'CSTL_.*\(INCLUDED\|EXTERN_C\|INTERFACE\|IMPLEMENT.*\|LESS\|GREATER\|EQUAL_TO\|RBTREE_SIZE\|RBTREE_LINK\)' | \
 	sort | sed -e "s/#define \(CSTL_[^ \t(]*\).*/\1/" | uniq`
 for i in ${tmp}; do
 	src=${src}"#undef ${i}
@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "../cstl/cuckoo.h"
+#include "Pool.h"
+#ifdef MY_MALLOC
+double buf[1024*1024/sizeof(double)];
+Pool pool;
+#define malloc(s)		Pool_malloc(&pool, s)
+#define realloc(p, s)	Pool_realloc(&pool, p, s)
+#define free(p)			Pool_free(&pool, p)
+#endif
+
+
+CSTL_CUCKOO_SET_INTERFACE(IntCkSet, int)
+CSTL_CUCKOO_SET_IMPLEMENT(IntCkSet, int, IntCkSet_hash_int, CSTL_EQUAL_TO)
+
+CSTL_CUCKOO_MAP_INTERFACE(IntIntCkMap, int, int)
+CSTL_CUCKOO_MAP_IMPLEMENT(IntIntCkMap, int, int, IntIntCkMap_hash_int, CSTL_EQUAL_TO)
+
+/* 全てのキーが同じバケットの候補を持つハッシュ関数 */
+#define BAD_HASH(x)		((size_t) 0)
+
+CSTL_CUCKOO_SET_INTERFACE(BadCkSet, int)
+CSTL_CUCKOO_SET_IMPLEMENT(BadCkSet, int, BAD_HASH, CSTL_EQUAL_TO)
+
+#define SIZE	1000
+
+static IntCkSet *ia;
+static IntIntCkMap *im;
+
+
+/* 各要素が自分のキーの2つのバケットのどちらかにあり、タグが一致し、要素数が合っていること */
+static int IntCkSet_verify(IntCkSet *self)
+{
+	size_t i, n = 0;
+	size_t hash_val;
+	int j;
+	if ((size_t) self->buckets % CSTL_CUCKOO_CACHE_LINE) return 0;
+	for (i = 0; i < IntCkSet_bucket_count(self); i++) {
+		for (j = 0; j < CSTL_CUCKOO_SLOTS; j++) {
+			if (!self->buckets[i].u.tags[j]) continue;
+			hash_val = IntCkSet_hash_int(self->buckets[i].u.slots[j].key);
+			if (IntCkSet_bucket1(self, hash_val) != i && IntCkSet_bucket2(self, hash_val) != i) return 0;
+			if (IntCkSet_tag(hash_val) != self->buckets[i].u.tags[j]) return 0;
+			n++;
+		}
+	}
+	return n == self->size;
+}
+
+static void sum_data(int const *data, void *arg)
+{
+	*(long *) arg += *data;
+}
+
+static void sum_value(int const *key, int *value, void *arg)
+{
+	assert(*value == -*key);
+	*(long *) arg += *value;
+}
+
+void CuckooTest_test_1_1(void)
+{
+	int i;
+	int success;
+	long sum;
+	printf("***** test_1_1 *****\n");
+	assert(sizeof(IntCkSetBucket) == CSTL_CUCKOO_CACHE_LINE);
+	ia = IntCkSet_new();
+	assert(ia);
+	assert(IntCkSet_empty(ia));
+	assert(IntCkSet_size(ia) == 0);
+	assert(IntCkSet_capacity(ia) == IntCkSet_bucket_count(ia) * CSTL_CUCKOO_SLOTS);
+	assert(IntCkSet_verify(ia));
+	/* insert */
+	for (i = 0; i < SIZE; i++) {
+		assert(IntCkSet_insert(ia, i, &success) && success);
+		assert(IntCkSet_size(ia) == (size_t) i + 1);
+	}
+	assert(IntCkSet_verify(ia));
+	assert(IntCkSet_load_factor(ia) <= 0.9f);
+	assert(IntCkSet_load_factor(ia) > 0.2f);
+	for (i = 0; i < SIZE; i++) {
+		assert(IntCkSet_insert(ia, i, &success) && !success);
+	}
+	assert(IntCkSet_insert(ia, 0, NULL));
+	assert(IntCkSet_size(ia) == SIZE);
+	/* find, count */
+	for (i = -SIZE; i < SIZE * 2; i++) {
+		if (0 <= i && i < SIZE) {
+			assert(IntCkSet_find(ia, i) && *IntCkSet_find(ia, i) == i);
+			assert(IntCkSet_count(ia, i) == 1);
+		} else {
+			assert(!IntCkSet_find(ia, i));
+			assert(IntCkSet_count(ia, i) == 0);
+		}
+	}
+	/* for_each */
+	sum = 0;
+	IntCkSet_for_each(ia, sum_data, &sum);
+	assert(sum == (long) SIZE * (SIZE - 1) / 2);
+	/* erase_key */
+	for (i = 0; i < SIZE; i += 2) {
+		assert(IntCkSet_erase_key(ia, i) == 1);
+		assert(IntCkSet_erase_key(ia, i) == 0);
+	}
+	assert(IntCkSet_size(ia) == SIZE / 2);
+	assert(IntCkSet_verify(ia));
+	for (i = 0; i < SIZE; i++) {
+		assert(IntCkSet_count(ia, i) == (size_t) (i & 1));
+	}
+	/* 削除した後に再び挿入 */
+	for (i = 0; i < SIZE; i += 2) {
+		assert(IntCkSet_insert(ia, i, &success) && success);
+	}
+	assert(IntCkSet_size(ia) == SIZE);
+	assert(IntCkSet_verify(ia));
+	/* clear */
+	IntCkSet_clear(ia);
+	assert(IntCkSet_empty(ia));
+	assert(IntCkSet_count(ia, 1) == 0);
+	assert(IntCkSet_verify(ia));
+	POOL_DUMP_OVERFLOW(&pool);
+	IntCkSet_delete(ia);
+	IntCkSet_delete(NULL);
+}
+
+void CuckooTest_test_1_2(void)
+{
+	int i;
+	size_t n;
+	IntCkSet *x;
+	printf("***** test_1_2 *****\n");
+	ia = IntCkSet_new();
+	/* reserve */
+	assert(IntCkSet_reserve(ia, SIZE));
+	n = IntCkSet_bucket_count(ia);
+	assert(n * CSTL_CUCKOO_SLOTS * 9 / 10 >= SIZE);
+	assert(n * CSTL_CUCKOO_SLOTS * 9 / 10 / 2 < SIZE);
+	for (i = 0; i < SIZE; i++) {
+		assert(IntCkSet_insert(ia, i * 7919, NULL));
+	}
+	assert(IntCkSet_bucket_count(ia) == n);
+	assert(IntCkSet_verify(ia));
+	assert(IntCkSet_reserve(ia, 1));
+	assert(IntCkSet_bucket_count(ia) == n);
+	/* 大きくするとき全要素が置き直される */
+	assert(IntCkSet_reserve(ia, SIZE * 4));
+	assert(IntCkSet_bucket_count(ia) > n);
+	assert(IntCkSet_verify(ia));
+	for (i = 0; i < SIZE; i++) {
+		assert(IntCkSet_count(ia, i * 7919) == 1);
+	}
+	/* swap */
+	x = IntCkSet_new();
+	assert(IntCkSet_insert(x, -1, NULL));
+	IntCkSet_swap(ia, x);
+	assert(IntCkSet_size(ia) == 1);
+	assert(IntCkSet_count(ia, -1) == 1);
+	assert(IntCkSet_size(x) == SIZE);
+	assert(IntCkSet_count(x, 7919) == 1);
+	assert(IntCkSet_verify(ia));
+	assert(IntCkSet_verify(x));
+	POOL_DUMP_OVERFLOW(&pool);
+	IntCkSet_delete(x);
+	IntCkSet_delete(ia);
+}
+
+void CuckooTest_test_1_3(void)
+{
+	int i;
+	int success;
+	BadCkSet *bs;
+	printf("***** test_1_3 *****\n");
+	/* 2つのバケットに入りきらない要素は挿入できない */
+	bs = BadCkSet_new();
+	for (i = 0; i < CSTL_CUCKOO_SLOTS * 2; i++) {
+		assert(BadCkSet_insert(bs, i, &success) && success);
+	}
+	assert(BadCkSet_size(bs) == CSTL_CUCKOO_SLOTS * 2);
+	/* 何も変更せずに失敗する */
+	assert(!BadCkSet_insert(bs, -1, &success) && !success);
+	assert(BadCkSet_size(bs) == CSTL_CUCKOO_SLOTS * 2);
+	for (i = 0; i < CSTL_CUCKOO_SLOTS * 2; i++) {
+		assert(BadCkSet_count(bs, i) == 1);
+	}
+	assert(BadCkSet_count(bs, -1) == 0);
+	assert(BadCkSet_erase_key(bs, 0) == 1);
+	assert(BadCkSet_insert(bs, -1, &success) && success);
+	assert(BadCkSet_count(bs, -1) == 1);
+	POOL_DUMP_OVERFLOW(&pool);
+	BadCkSet_delete(bs);
+}
+
+void CuckooTest_test_2_1(void)
+{
+	int i;
+	int success;
+	int *v;
+	long sum;
+	printf("***** test_2_1 *****\n");
+	im = IntIntCkMap_new();
+	assert(im);
+	for (i = 0; i < SIZE; i++) {
+		assert(IntIntCkMap_insert(im, i, -i, &success) && success);
+	}
+	assert(IntIntCkMap_insert(im, 0, 100, &success) && !success);
+	assert(*IntIntCkMap_find(im, 0) == 0);
+	assert(IntIntCkMap_size(im) == SIZE);
+	for (i = 0; i < SIZE; i++) {
+		v = IntIntCkMap_find(im, i);
+		assert(v && *v == -i);
+	}
+	assert(!IntIntCkMap_find(im, SIZE));
+	sum = 0;
+	IntIntCkMap_for_each(im, sum_value, &sum);
+	assert(sum == -(long) SIZE * (SIZE - 1) / 2);
+	/* at */
+	v = IntIntCkMap_at(im, SIZE);
+	assert(v && *v == 0);
+	*v = 5;
+	assert(IntIntCkMap_size(im) == SIZE + 1);
+	v = IntIntCkMap_at(im, SIZE);
+	assert(v && *v == 5);
+	*v = -SIZE;
+	assert(IntIntCkMap_size(im) == SIZE + 1);
+	for (i = SIZE + 1; i < SIZE * 3; i++) {
+		v = IntIntCkMap_at(im, i);
+		assert(v && *v == 0);
+		*v = -i;
+	}
+	for (i = 0; i < SIZE * 3; i++) {
+		v = IntIntCkMap_find(im, i);
+		assert(v && *v == -i);
+	}
+	assert(IntIntCkMap_erase_key(im, SIZE) == 1);
+	assert(!IntIntCkMap_find(im, SIZE));
+	assert(IntIntCkMap_count(im, SIZE) == 0);
+	IntIntCkMap_clear(im);
+	assert(IntIntCkMap_empty(im));
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntCkMap_delete(im);
+}
+
+
+void CuckooTest_run(void)
+{
+	printf("\n===== cuckoo test =====\n");
+	CuckooTest_test_1_1();
+	CuckooTest_test_1_2();
+	CuckooTest_test_1_3();
+	CuckooTest_test_2_1();
+}
+
+
+int main(void)
+{
+#ifdef MY_MALLOC
+	Pool_init(&pool, buf, sizeof buf, sizeof buf[0]);
+#endif
+	CuckooTest_run();
+#ifdef MY_MALLOC
+	POOL_DUMP_LEAK(&pool, 0);
+#endif
+	return 0;
+}
@@ -65,6 +65,18 @@ void Name##_print(Name *self)\
 	figure = (int) log10(bc) + 1;\
 	printf("size[%d], bucket_count[%d], load_factor[%g], max_load_factor[%g]\n", \
 			Name##_size(self), bc, Name##_load_factor(self), Name##_get_max_load_factor(self));\
+	if (self->old_buckets) {\
+		size_t oc = Name##Node_Vector_size(self->old_buckets) - 1;\
+		printf("old_bucket_count[%d], migrate_idx[%d]\n", oc, self->migrate_idx);\
+		for (i = 0; i < oc; i++) {\
+			Name##Node **alias;\
+			alias = Name##Node_Vector_at(self->old_buckets, i);\
+			if (*alias) {\
+				printf("old[%*d]: ", figure, i);\
+				Name##Node_print(*alias);\
+			}\
+		}\
+	}\
 	for (i = 0; i < bc; i++) {\
 		Name##Node **alias;\
 		alias = Name##Node_Vector_at(self->buckets, i);\
@@ -75,25 +87,27 @@ void Name##_print(Name *self)\
 	}\
 }\
 \
-int Name##_verify(Name *self)\
+static int Name##_verify_buckets(Name##Node_Vector *buckets, Name##Node_Vector *v)\
 {\
-	int ret = 0;\
 	register size_t i;\
-	size_t bc = Name##_bucket_count(self);\
-	Name##Node_Vector *v = Name##Node_Vector_new_reserve(1024);\
-	CSTL_ASSERT(v && "Unordered(Set|Map)_verify");\
+	size_t bc = Name##Node_Vector_size(buckets) - 1;\
 	for (i = 0; i < bc; i++) {\
 		Name##Node **alias;\
+		Name##Node **prev;\
 		register Name##Iterator pos;\
 		register size_t j, k;\
 		size_t v_size;\
-		alias = Name##Node_Vector_at(self->buckets, i);\
-		for (pos = *alias; pos != 0; pos = pos->next) {\
+		alias = Name##Node_Vector_at(buckets, i);\
+		for (pos = *alias, prev = alias; pos != 0; prev = &pos->next, pos = pos->next) {\
 			int ret;\
 			size_t idx;\
 			idx = Hasher(pos->key) % bc;\
-			if (i != idx) {\
-				goto end;\
+			if (i != idx || pos->bucket != alias) {\
+				return 0;\
+			}\
+			/* pprevは直前のノードのnextかバケットを指す */\
+			if (pos->pprev != prev) {\
+				return 0;\
 			}\
 			ret = Name##Node_Vector_push_back(v, pos);\
 			CSTL_ASSERT(ret && "Unordered(Set|Map)_verify");\
@@ -107,13 +121,118 @@ int Name##_verify(Name *self)\
 						break;\
 					} else {\
 						/* 同じキーが並んでいないのでNG */\
-						goto end;\
+						return 0;\
 					}\
 				}\
 			}\
 		}\
 		Name##Node_Vector_clear(v);\
 	}\
+	return 1;\
+}\
+\
+CSTL_HASHTABLE_LINK(\
+/* \
+ * 全要素のリストが双方向につながり、要素数が一致すること。\
+ * また、バケットで最初に見つかる要素から同じキーの要素が全て連続して並んでいること。\
+ */\
+static int Name##_verify_list(Name *self)\
+{\
+	register Name##Iterator pos;\
+	register Name##Iterator i;\
+	size_t count = 0;\
+	size_t n;\
+	for (pos = self->end_node.succ; pos != &self->end_node; pos = pos->succ) {\
+		if (pos->succ->pred != pos) {\
+			return 0;\
+		}\
+		if (pos->pred == &self->end_node || Compare(pos->key, pos->pred->key) != 0) {\
+			/* 同じキーの並びの先頭 */\
+			if (Name##_find(self, pos->key) != pos) {\
+				return 0;\
+			}\
+			for (n = 0, i = *pos->bucket; i != 0; i = i->next) {\
+				if (Compare(pos->key, i->key) == 0) {\
+					n++;\
+				}\
+			}\
+			for (i = pos; i != &self->end_node && Compare(pos->key, i->key) == 0; i = i->succ) {\
+				n--;\
+			}\
+			if (n != 0) {\
+				return 0;\
+			}\
+		}\
+		count++;\
+	}\
+	if (self->end_node.succ->pred != &self->end_node) {\
+		return 0;\
+	}\
+	return count == self->size;\
+}\
+)\
+\
+/* bloomにhash_valのビットが全て立っていること */\
+static int Name##_verify_bloom(size_t *bloom, size_t nblocks, size_t hash_val)\
+{\
+	register size_t i;\
+	size_t y;\
+	size_t *block = Name##_bloom_block(bloom, nblocks, hash_val, &y);\
+	for (i = 0; i < CSTL_HASHTABLE_BLOOM_WORDS; i++) {\
+		if (!(block[i] & CSTL_HASHTABLE_BLOOM_MASK(y, Name##_bloom_salt[i]))) {\
+			return 0;\
+		}\
+	}\
+	return 1;\
+}\
+\
+int Name##_verify(Name *self)\
+{\
+	int ret = 0;\
+	Name##Node_Vector *v = Name##Node_Vector_new_reserve(1024);\
+	CSTL_ASSERT(v && "Unordered(Set|Map)_verify");\
+	if (!Name##_verify_buckets(self->buckets, v)) {\
+		goto end;\
+	}\
+	if (self->old_buckets) {\
+		register Name##Iterator pos;\
+		size_t n = 0;\
+		Name##Node_Vector_clear(v);\
+		if (!Name##_verify_buckets(self->old_buckets, v)) {\
+			goto end;\
+		}\
+		if (self->migrate_idx >= Name##Node_Vector_size(self->old_buckets) - 1) {\
+			goto end;\
+		}\
+		/* 旧バケット配列の終端は新しいバケット配列の先頭へつながる */\
+		if (*Name##Node_Vector_back(self->old_buckets) != &self->bridge_node) {\
+			goto end;\
+		}\
+		if (self->bridge_node.next != &self->bridge_node) {\
+			goto end;\
+		}\
+		if (self->bridge_node.bucket != Name##Node_Vector_at(self->buckets, 0)) {\
+			goto end;\
+		}\
+		/* 同じキーの要素が旧バケットと新しいバケットに分かれていないこと */\
+		for (pos = Name##_begin(self); pos != Name##_end(self); pos = Name##_next(pos)) {\
+			register Name##Iterator i;\
+			for (i = *Name##Node_Vector_at(self->buckets, Hasher(pos->key) % Name##_bucket_count(self)); i != 0; i = i->next) {\
+				if (Compare(pos->key, i->key) == 0 && i->bucket != pos->bucket) {\
+					goto end;\
+				}\
+			}\
+			n++;\
+		}\
+		if (n != self->size) {\
+			goto end;\
+		}\
+	}\
+	CSTL_HASHTABLE_LINK(\
+		if (!Name##_verify_list(self)) {\
+			goto end;\
+		}\
+	)\
 	if (*Name##Node_Vector_back(self->buckets) != &self->end_node) {\
 		goto end;\
 	}\
@@ -123,6 +242,26 @@ int Name##_verify(Name *self)\
 	if (self->end_node.bucket != 0) {\
 		goto end;\
 	}\
+	/* ブルームフィルタに偽陰性がないこと。新しいブルームフィルタには移した要素が全て入っていること */\
+	if (!self->bloom_bits != !self->bloom || (self->next_bloom && !self->old_buckets)) {\
+		goto end;\
+	}\
+	if (self->bloom) {\
+		register Name##Iterator pos;\
+		register size_t i;\
+		for (pos = Name##_begin(self); pos != Name##_end(self); pos = Name##_next(pos)) {\
+			if (!Name##_verify_bloom(self->bloom, self->bloom_blocks, Hasher(pos->key))) {\
+				goto end;\
+			}\
+		}\
+		for (i = 0; self->next_bloom && i < Name##_bucket_count(self); i++) {\
+			for (pos = *Name##Node_Vector_at(self->buckets, i); pos != 0; pos = pos->next) {\
+				if (!Name##_verify_bloom(self->next_bloom, self->next_bloom_blocks, Hasher(pos->key))) {\
+					goto end;\
+				}\
+			}\
+		}\
+	}\
 	ret = 1;\
 end:\
 	Name##Node_Vector_delete(v);\
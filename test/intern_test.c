@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <wchar.h>
+#include "../cstl/intern.h"
+#include "Pool.h"
+#ifdef MY_MALLOC
+double buf[1024*1024/sizeof(double)];
+Pool pool;
+#define malloc(s)		Pool_malloc(&pool, s)
+#define realloc(p, s)	Pool_realloc(&pool, p, s)
+#define free(p)			Pool_free(&pool, p)
+#endif
+
+
+CSTL_INTERN_INTERFACE(Intern, char)
+CSTL_INTERN_IMPLEMENT(Intern, char)
+
+CSTL_INTERN_INTERFACE(WIntern, wchar_t)
+CSTL_INTERN_IMPLEMENT(WIntern, wchar_t)
+
+#define SIZE	1000
+
+
+void InternTest_test_1_1(void)
+{
+	Intern *x;
+	InternHandle a, b, c, d;
+	printf("***** test_1_1 *****\n");
+	x = Intern_new();
+	assert(x);
+	assert(Intern_empty(x));
+	assert(Intern_size(x) == 0);
+	/* intern */
+	a = Intern_intern(x, "service");
+	b = Intern_intern_len(x, "service.name", 7);
+	c = Intern_intern(x, "tag");
+	assert(a && b && c);
+	assert(a == b);
+	assert(a != c);
+	assert(Intern_size(x) == 2);
+	assert(strcmp(Intern_c_str(a), "service") == 0);
+	assert(Intern_length(a) == 7);
+	assert(Intern_c_str(a)[7] == '\0');
+	assert(Intern_hash(a) == Intern_hash(b));
+	assert(Intern_refcount(a) == 2);
+	assert(Intern_refcount(c) == 1);
+	/* 空文字列 */
+	d = Intern_intern(x, "");
+	assert(d);
+	assert(Intern_length(d) == 0);
+	assert(Intern_intern_len(x, "abc", 0) == d);
+	assert(Intern_size(x) == 3);
+	/* lookup */
+	assert(Intern_lookup(x, "service") == a);
+	assert(Intern_lookup_len(x, "tags", 3) == c);
+	assert(Intern_lookup(x, "servic") == 0);
+	assert(Intern_refcount(a) == 2);
+	/* retain, release */
+	assert(Intern_retain(c) == c);
+	assert(Intern_refcount(c) == 2);
+	Intern_release(x, c);
+	Intern_release(x, c);
+	assert(Intern_lookup(x, "tag") == 0);
+	assert(Intern_size(x) == 2);
+	Intern_release(x, a);
+	assert(Intern_lookup(x, "service") == a);
+	Intern_release(x, b);
+	assert(Intern_lookup(x, "service") == 0);
+	Intern_release(x, d);
+	Intern_release(x, d);
+	assert(Intern_empty(x));
+	/* 再登録 */
+	a = Intern_intern(x, "service");
+	assert(Intern_refcount(a) == 1);
+	assert(Intern_size(x) == 1);
+	Intern_delete(x);
+}
+
+void InternTest_test_1_2(void)
+{
+	Intern *x;
+	InternHandle h[SIZE];
+	char buf[32];
+	size_t i;
+	printf("***** test_1_2 *****\n");
+	x = Intern_new();
+	for (i = 0; i < SIZE; i++) {
+		sprintf(buf, "key%d", (int) (i % (SIZE / 10)));
+		h[i] = Intern_intern(x, buf);
+		assert(h[i]);
+		assert(strcmp(Intern_c_str(h[i]), buf) == 0);
+	}
+	assert(Intern_size(x) == SIZE / 10);
+	for (i = 0; i < SIZE; i++) {
+		assert(h[i] == h[i % (SIZE / 10)]);
+		assert(Intern_refcount(h[i]) == 10);
+	}
+	for (i = 0; i < SIZE; i++) {
+		Intern_release(x, h[i]);
+		if (i == SIZE - SIZE / 10 - 1) {
+			assert(Intern_size(x) == SIZE / 10);
+		}
+	}
+	assert(Intern_empty(x));
+	/* 解放していない文字列はdeleteで解放される */
+	for (i = 0; i < SIZE; i++) {
+		sprintf(buf, "%d", (int) i);
+		assert(Intern_intern(x, buf));
+	}
+	assert(Intern_size(x) == SIZE);
+	Intern_delete(x);
+}
+
+void InternTest_test_2_1(void)
+{
+	WIntern *x;
+	WInternHandle a, b;
+	printf("***** test_2_1 *****\n");
+	x = WIntern_new();
+	a = WIntern_intern(x, L"wide");
+	b = WIntern_intern_len(x, L"wide string", 4);
+	assert(a == b);
+	assert(WIntern_length(a) == 4);
+	assert(wcscmp(WIntern_c_str(a), L"wide") == 0);
+	assert(WIntern_lookup(x, L"wid") == 0);
+	WIntern_delete(x);
+}
+
+
+void InternTest_run(void)
+{
+	printf("\n===== intern test =====\n");
+	InternTest_test_1_1();
+	InternTest_test_1_2();
+	InternTest_test_2_1();
+}
+
+
+int main(void)
+{
+#ifdef MY_MALLOC
+	Pool_init(&pool, buf, sizeof buf, sizeof buf[0]);
+#endif
+	InternTest_run();
+#ifdef MY_MALLOC
+	POOL_DUMP_LEAK(&pool, 0);
+#endif
+	return 0;
+}
@@ -378,6 +378,306 @@ void MapTest_test_1_2(void)
 
 
 
+void MapTest_test_1_3(void)
+{
+	int i, n;
+	int keys[100];
+	int values[100];
+	IntIntMapAIterator p;
+	IntIntMMapAIterator mp;
+	printf("***** test_1_3 *****\n");
+	/* build_from_sorted_array */
+	for (n = 0; n < 70; n++) {
+		ia = IntIntMapA_new();
+		for (i = 0; i < n; i++) {
+			keys[i] = i;
+			values[i] = -i;
+		}
+		assert(IntIntMapA_build_from_sorted_array(ia, keys, values, n));
+		assert(IntIntMapA_verify(ia));
+		assert(IntIntMapA_size(ia) == n);
+		for (p = IntIntMapA_begin(ia), i = 0; p != IntIntMapA_end(ia); p = IntIntMapA_next(p), i++) {
+			assert(*IntIntMapA_key(p) == i);
+			assert(*IntIntMapA_value(p) == -i);
+		}
+		assert(i == n);
+		IntIntMapA_delete(ia);
+	}
+	/* 同じキーは最初の要素が残り、既存の要素の値は変更されない */
+	ia = IntIntMapA_new();
+	assert(IntIntMapA_insert(ia, 10, 1000, NULL));
+	for (i = 0; i < 100; i++) {
+		keys[i] = i / 2;
+		values[i] = i;
+	}
+	assert(IntIntMapA_build_from_sorted_array(ia, keys, values, 100));
+	assert(IntIntMapA_verify(ia));
+	assert(IntIntMapA_size(ia) == 50);
+	assert(*IntIntMapA_at(ia, 10) == 1000);
+	assert(*IntIntMapA_at(ia, 11) == 22);
+	IntIntMapA_delete(ia);
+
+	/* multimap */
+	ima = IntIntMMapA_new();
+	assert(IntIntMMapA_insert(ima, 10, 1000));
+	assert(IntIntMMapA_build_from_sorted_array(ima, keys, values, 100));
+	assert(IntIntMMapA_verify(ima));
+	assert(IntIntMMapA_size(ima) == 101);
+	assert(IntIntMMapA_count(ima, 10) == 3);
+	mp = IntIntMMapA_lower_bound(ima, 10);
+	assert(*IntIntMMapA_value(mp) == 1000);
+	mp = IntIntMMapA_next(mp);
+	assert(*IntIntMMapA_value(mp) == 20);
+	mp = IntIntMMapA_next(mp);
+	assert(*IntIntMMapA_value(mp) == 21);
+	assert(IntIntMMapA_insert_range(ima, IntIntMMapA_begin(ima), IntIntMMapA_end(ima)));
+	assert(IntIntMMapA_verify(ima));
+	assert(IntIntMMapA_size(ima) == 202);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntMMapA_delete(ima);
+}
+
+void MapTest_test_1_4(void)
+{
+	int i;
+	int success;
+	IntIntMapAIterator p;
+	IntIntMMapAIterator mp;
+	printf("***** test_1_4 *****\n");
+	ia = IntIntMapA_new();
+	for (i = 0; i < 100; i++) {
+		p = IntIntMapA_insert_hint(ia, IntIntMapA_end(ia), i * 2, i, &success);
+		assert(p && success);
+		assert(*IntIntMapA_key(p) == i * 2);
+		assert(*IntIntMapA_value(p) == i);
+	}
+	assert(IntIntMapA_verify(ia));
+	for (i = 0; i < 100; i++) {
+		p = IntIntMapA_insert_hint(ia, IntIntMapA_find(ia, i * 2), i * 2 + 1, -i, &success);
+		assert(p && success);
+		assert(*IntIntMapA_key(p) == i * 2 + 1);
+		assert(IntIntMapA_verify(ia));
+	}
+	/* 既存の要素の値は変更しない */
+	p = IntIntMapA_insert_hint(ia, IntIntMapA_find(ia, 20), 21, 1000, &success);
+	assert(p == IntIntMapA_find(ia, 21) && !success);
+	assert(*IntIntMapA_value(p) == -10);
+	assert(IntIntMapA_size(ia) == 200);
+	for (p = IntIntMapA_begin(ia), i = 0; p != IntIntMapA_end(ia); p = IntIntMapA_next(p), i++) {
+		assert(*IntIntMapA_key(p) == i);
+		assert(*IntIntMapA_value(p) == (i % 2 ? -(i / 2) : i / 2));
+	}
+	IntIntMapA_delete(ia);
+
+	/* multimap */
+	ima = IntIntMMapA_new();
+	for (i = 0; i < 10; i++) {
+		assert(IntIntMMapA_insert_hint(ima, IntIntMMapA_end(ima), 1, i));
+	}
+	assert(IntIntMMapA_verify(ima));
+	for (mp = IntIntMMapA_begin(ima), i = 0; mp != IntIntMMapA_end(ima); mp = IntIntMMapA_next(mp), i++) {
+		assert(*IntIntMMapA_value(mp) == i);
+	}
+	mp = IntIntMMapA_insert_hint(ima, IntIntMMapA_begin(ima), 1, -1);
+	assert(mp == IntIntMMapA_begin(ima));
+	assert(IntIntMMapA_verify(ima));
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntMMapA_delete(ima);
+}
+
+#ifdef CSTL_RBTREE_RANK
+void MapTest_test_1_5(void)
+{
+	int i;
+	IntIntMapAIterator p;
+	printf("***** test_1_5 *****\n");
+	ia = IntIntMapA_new();
+	for (i = 0; i < 200; i++) {
+		assert(IntIntMapA_insert(ia, 199 - i, i, NULL));
+	}
+	assert(IntIntMapA_verify(ia));
+	for (i = 0; i < 200; i++) {
+		p = IntIntMapA_nth(ia, i);
+		assert(*IntIntMapA_key(p) == i);
+		assert(*IntIntMapA_value(p) == 199 - i);
+		assert(IntIntMapA_rank(ia, i) == (size_t) i);
+	}
+	assert(IntIntMapA_nth(ia, 200) == IntIntMapA_end(ia));
+	assert(IntIntMapA_erase_range(ia, IntIntMapA_nth(ia, 50), IntIntMapA_nth(ia, 150)));
+	assert(IntIntMapA_verify(ia));
+	assert(*IntIntMapA_key(IntIntMapA_nth(ia, 50)) == 150);
+	assert(IntIntMapA_rank(ia, 100) == 50);
+	IntIntMapA_delete(ia);
+
+	/* multimap */
+	ima = IntIntMMapA_new();
+	for (i = 0; i < 100; i++) {
+		assert(IntIntMMapA_insert(ima, i / 4, i));
+	}
+	assert(IntIntMMapA_verify(ima));
+	for (i = 0; i < 100; i++) {
+		assert(*IntIntMMapA_value(IntIntMMapA_nth(ima, i)) == i);
+	}
+	assert(IntIntMMapA_rank(ima, 10) == 40);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntMMapA_delete(ima);
+}
+
+void MapTest_test_1_6(void)
+{
+	int i;
+	IntIntMapA *x;
+	IntIntMapAIterator p;
+	IntIntMMapA *mx;
+	printf("***** test_1_6 *****\n");
+	ia = IntIntMapA_new();
+	x = IntIntMapA_new();
+	for (i = 0; i < 1000; i++) {
+		assert(IntIntMapA_insert(ia, i, -i, NULL));
+	}
+	IntIntMapA_split(ia, 600, x);
+	assert(IntIntMapA_verify(ia) && IntIntMapA_verify(x));
+	assert(IntIntMapA_size(ia) == 600 && IntIntMapA_size(x) == 400);
+	for (p = IntIntMapA_begin(x), i = 600; p != IntIntMapA_end(x); p = IntIntMapA_next(p), i++) {
+		assert(*IntIntMapA_key(p) == i && *IntIntMapA_value(p) == -i);
+	}
+	assert(i == 1000);
+	assert(IntIntMapA_find(ia, 600) == IntIntMapA_end(ia));
+	*IntIntMapA_at(x, 2000) = 1;
+	IntIntMapA_join(ia, x);
+	assert(IntIntMapA_verify(ia) && IntIntMapA_empty(x));
+	assert(IntIntMapA_size(ia) == 1001);
+	assert(*IntIntMapA_value(IntIntMapA_find(ia, 999)) == -999);
+	assert(*IntIntMapA_key(IntIntMapA_rbegin(ia)) == 2000);
+	IntIntMapA_delete(x);
+	IntIntMapA_delete(ia);
+
+	/* multimap */
+	ima = IntIntMMapA_new();
+	for (i = 0; i < 100; i++) {
+		assert(IntIntMMapA_insert(ima, i / 10, i));
+	}
+	mx = IntIntMMapA_new();
+	IntIntMMapA_split(ima, 3, mx);
+	assert(IntIntMMapA_verify(ima) && IntIntMMapA_verify(mx));
+	assert(IntIntMMapA_size(ima) == 30 && IntIntMMapA_size(mx) == 70);
+	IntIntMMapA_join(ima, mx);
+	assert(IntIntMMapA_verify(ima));
+	assert(IntIntMMapA_size(ima) == 100);
+	IntIntMMapA_delete(mx);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntMMapA_delete(ima);
+}
+#endif
+
+void MapTest_test_1_7(void)
+{
+	int i;
+	int success;
+	IntIntMapA *x;
+	IntIntMapAIterator p;
+	IntIntMMapA *mx;
+	IntIntMMapAIterator mp;
+	printf("***** test_1_7 *****\n");
+	ia = IntIntMapA_new();
+	x = IntIntMapA_new();
+	for (i = 0; i < 100; i++) {
+		assert(IntIntMapA_insert(ia, i, -i, NULL));
+	}
+	/* キーを付け替えて別のmapへ移す */
+	while (!IntIntMapA_empty(ia)) {
+		p = IntIntMapA_extract(ia, IntIntMapA_begin(ia));
+		assert(*IntIntMapA_key(p) == -*IntIntMapA_value(p));
+		*IntIntMapA_node_key(p) += 1000;
+		*IntIntMapA_value(p) *= 2;
+		assert(IntIntMapA_insert_node(x, p, &success) == p && success);
+	}
+	assert(IntIntMapA_verify(ia) && IntIntMapA_verify(x));
+	assert(IntIntMapA_size(x) == 100);
+	for (p = IntIntMapA_begin(x), i = 0; p != IntIntMapA_end(x); p = IntIntMapA_next(p), i++) {
+		assert(*IntIntMapA_key(p) == i + 1000 && *IntIntMapA_value(p) == -i * 2);
+	}
+	/* 同じキーがあれば挿入しない */
+	assert(IntIntMapA_insert(ia, 1050, 1, NULL));
+	p = IntIntMapA_extract(x, IntIntMapA_find(x, 1050));
+	assert(IntIntMapA_insert_node(ia, p, &success) != p && !success);
+	assert(*IntIntMapA_value(IntIntMapA_find(ia, 1050)) == 1);
+	assert(IntIntMapA_verify(ia) && IntIntMapA_verify(x));
+	assert(IntIntMapA_size(ia) == 1 && IntIntMapA_size(x) == 99);
+	IntIntMapA_node_delete(p);
+	IntIntMapA_delete(x);
+	IntIntMapA_delete(ia);
+
+	/* multimap */
+	ima = IntIntMMapA_new();
+	mx = IntIntMMapA_new();
+	for (i = 0; i < 100; i++) {
+		assert(IntIntMMapA_insert(ima, i / 10, i));
+	}
+	for (i = 0; i < 50; i++) {
+		mp = IntIntMMapA_extract(ima, IntIntMMapA_rbegin(ima));
+		assert(IntIntMMapA_insert_node(mx, mp) == mp);
+	}
+	assert(IntIntMMapA_verify(ima) && IntIntMMapA_verify(mx));
+	assert(IntIntMMapA_size(ima) == 50 && IntIntMMapA_size(mx) == 50);
+	assert(IntIntMMapA_count(mx, 7) == 10 && IntIntMMapA_count(ima, 7) == 0);
+	IntIntMMapA_delete(mx);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntMMapA_delete(ima);
+}
+
+static int MapTest_comp_long(const void *probe, int const *key)
+{
+	long x = *(const long *) probe;
+	return x < *key ? -1 : x > *key ? 1 : 0;
+}
+
+void MapTest_test_1_8(void)
+{
+	int i;
+	long l;
+	IntIntMapAIterator p;
+	printf("***** test_1_8 *****\n");
+	ia = IntIntMapA_new();
+	ima = IntIntMMapA_new();
+	for (i = 0; i < 100; i += 2) {
+		assert(IntIntMapA_insert(ia, i, -i, NULL));
+		assert(IntIntMMapA_insert(ima, i / 10, i));
+	}
+	for (i = -1; i <= 100; i++) {
+		p = IntIntMapA_find_ref(ia, &i);
+		assert(p == IntIntMapA_find(ia, i));
+		assert(IntIntMapA_count_ref(ia, &i) == IntIntMapA_count(ia, i));
+		assert(IntIntMapA_lower_bound_ref(ia, &i) == IntIntMapA_lower_bound(ia, i));
+		assert(IntIntMapA_upper_bound_ref(ia, &i) == IntIntMapA_upper_bound(ia, i));
+		assert(IntIntMMapA_count_ref(ima, &i) == IntIntMMapA_count(ima, i));
+		/* 異なる型のキーで検索 */
+		l = i;
+		assert(IntIntMapA_find_with(ia, &l, MapTest_comp_long) == p);
+		assert(IntIntMapA_lower_bound_with(ia, &l, MapTest_comp_long) == IntIntMapA_lower_bound(ia, i));
+		assert(IntIntMapA_upper_bound_with(ia, &l, MapTest_comp_long) == IntIntMapA_upper_bound(ia, i));
+		assert(IntIntMMapA_lower_bound_with(ima, &l, MapTest_comp_long) == IntIntMMapA_lower_bound(ima, i));
+		assert(IntIntMMapA_upper_bound_with(ima, &l, MapTest_comp_long) == IntIntMMapA_upper_bound(ima, i));
+	}
+	/* at_refは要素がなければ挿入する */
+	i = 51;
+	*IntIntMapA_at_ref(ia, &i) = 100;
+	assert(*IntIntMapA_at(ia, 51) == 100);
+	i = 50;
+	assert(*IntIntMapA_at_ref(ia, &i) == -50);
+	assert(IntIntMapA_size(ia) == 51);
+	assert(IntIntMapA_verify(ia));
+	IntIntMMapA_delete(ima);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntMapA_delete(ia);
+}
+
 void MapTest_run(void)
 {
 	printf("\n===== map test =====\n");
@@ -385,6 +685,14 @@ void MapTest_run(void)
 
 	MapTest_test_1_1();
 	MapTest_test_1_2();
+	MapTest_test_1_3();
+	MapTest_test_1_4();
+#ifdef CSTL_RBTREE_RANK
+	MapTest_test_1_5();
+	MapTest_test_1_6();
+#endif
+	MapTest_test_1_7();
+	MapTest_test_1_8();
 }
 
 
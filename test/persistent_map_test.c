@@ -0,0 +1,334 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "Pool.h"
+#ifdef MY_MALLOC
+double buf[1024*1024/sizeof(double)];
+Pool pool;
+/* Poolはスレッドセーフではないので排他する */
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static void *test_malloc(size_t s)
+{
+	void *p;
+	pthread_mutex_lock(&pool_mutex);
+	p = Pool_malloc(&pool, s);
+	pthread_mutex_unlock(&pool_mutex);
+	return p;
+}
+static void test_free(void *p)
+{
+	pthread_mutex_lock(&pool_mutex);
+	Pool_free(&pool, p);
+	pthread_mutex_unlock(&pool_mutex);
+}
+#define malloc(s)		test_malloc(s)
+#define free(p)			test_free(p)
+#endif
+#include "../cstl/persistent_map.h"
+
+
+CSTL_PERSISTENT_MAP_INTERFACE(IntIntPMap, int, int)
+CSTL_PERSISTENT_MAP_IMPLEMENT(IntIntPMap, int, int, CSTL_LESS)
+
+#define SIZE	1000
+
+static IntIntPMap *ia;
+
+
+/* 順序とAVL木の高さの条件を満たし、ノード数を返す */
+static size_t IntIntPMap_verify_node(IntIntPMapNode *t, int *prev, int *first)
+{
+	size_t n;
+	int l, r;
+	if (!t) return 0;
+	/* 他のスレッドが参照カウントを増減するのでアトミックに読む */
+	assert(CSTL_ATOMIC_LOAD(&t->refcount) >= 1);
+	l = IntIntPMap_height(t->left);
+	r = IntIntPMap_height(t->right);
+	assert(t->height == (l > r ? l : r) + 1);
+	assert(l - r <= 1 && r - l <= 1);
+	n = IntIntPMap_verify_node(t->left, prev, first);
+	assert(*first || *prev < t->key);
+	*first = 0;
+	*prev = t->key;
+	return n + 1 + IntIntPMap_verify_node(t->right, prev, first);
+}
+
+static int IntIntPMap_verify(IntIntPMap *self)
+{
+	int prev = 0;
+	int first = 1;
+	return IntIntPMap_verify_node(self->root, &prev, &first) == self->size;
+}
+
+/* 他の版と共有していないノードの数 */
+static size_t count_unshared(IntIntPMapNode *t)
+{
+	if (!t || t->refcount > 1) return 0;
+	return 1 + count_unshared(t->left) + count_unshared(t->right);
+}
+
+static void sum_value(int const *key, int const *value, void *arg)
+{
+	assert(*value == -*key);
+	*(long *) arg += *value;
+}
+
+static void check_order(int const *key, int const *value, void *arg)
+{
+	assert(*(int *) arg < *key);
+	*(int *) arg = *key;
+	(void) value;
+}
+
+void PMapTest_test_1_1(void)
+{
+	int i;
+	int success;
+	int prev;
+	long sum;
+	IntIntPMap *x;
+	printf("***** test_1_1 *****\n");
+	ia = IntIntPMap_new();
+	assert(ia);
+	assert(IntIntPMap_empty(ia));
+	assert(IntIntPMap_verify(ia));
+	/* 順不同に挿入 */
+	for (i = 0; i < SIZE; i++) {
+		int key = (i * 7) % SIZE;
+		assert(IntIntPMap_insert(ia, key, -key, &success) && success);
+		assert(IntIntPMap_size(ia) == (size_t) i + 1);
+	}
+	assert(IntIntPMap_verify(ia));
+	/* 高さはO(log N) */
+	assert(ia->root->height <= 15);
+	assert(IntIntPMap_insert(ia, 0, 100, &success) && !success);
+	assert(*IntIntPMap_find(ia, 0) == 0);
+	for (i = -1; i <= SIZE; i++) {
+		if (0 <= i && i < SIZE) {
+			assert(IntIntPMap_find(ia, i) && *IntIntPMap_find(ia, i) == -i);
+			assert(IntIntPMap_count(ia, i) == 1);
+		} else {
+			assert(!IntIntPMap_find(ia, i));
+			assert(IntIntPMap_count(ia, i) == 0);
+		}
+	}
+	sum = 0;
+	IntIntPMap_for_each(ia, sum_value, &sum);
+	assert(sum == -(long) SIZE * (SIZE - 1) / 2);
+	prev = -1;
+	IntIntPMap_for_each(ia, check_order, &prev);
+	assert(prev == SIZE - 1);
+	/* assign */
+	assert(IntIntPMap_assign(ia, 0, 100));
+	assert(*IntIntPMap_find(ia, 0) == 100);
+	assert(IntIntPMap_assign(ia, SIZE, 5));
+	assert(*IntIntPMap_find(ia, SIZE) == 5);
+	assert(IntIntPMap_size(ia) == SIZE + 1);
+	assert(IntIntPMap_assign(ia, 0, 0));
+	assert(IntIntPMap_erase_key(ia, SIZE) == 1);
+	assert(IntIntPMap_erase_key(ia, SIZE) == 0);
+	/* erase_key */
+	for (i = 0; i < SIZE; i += 2) {
+		assert(IntIntPMap_erase_key(ia, i) == 1);
+		assert(IntIntPMap_erase_key(ia, i) == 0);
+	}
+	assert(IntIntPMap_size(ia) == SIZE / 2);
+	assert(IntIntPMap_verify(ia));
+	for (i = 0; i < SIZE; i++) {
+		assert(IntIntPMap_count(ia, i) == (size_t) (i & 1));
+	}
+	/* swap */
+	x = IntIntPMap_new();
+	assert(IntIntPMap_insert(x, -1, 1, NULL));
+	IntIntPMap_swap(ia, x);
+	assert(IntIntPMap_size(ia) == 1 && IntIntPMap_count(ia, -1) == 1);
+	assert(IntIntPMap_size(x) == SIZE / 2 && IntIntPMap_count(x, 1) == 1);
+	IntIntPMap_delete(x);
+	/* clear */
+	IntIntPMap_clear(ia);
+	assert(IntIntPMap_empty(ia));
+	assert(IntIntPMap_verify(ia));
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntPMap_delete(ia);
+	IntIntPMap_delete(NULL);
+}
+
+void PMapTest_test_1_2(void)
+{
+	int i;
+	long sum;
+	IntIntPMap *s1, *s2;
+	IntIntPMapNode *root;
+	printf("***** test_1_2 *****\n");
+	ia = IntIntPMap_new();
+	for (i = 0; i < SIZE; i++) {
+		assert(IntIntPMap_insert(ia, i, -i, NULL));
+	}
+	/* スナップショットは根を共有する */
+	root = ia->root;
+	s1 = IntIntPMap_snapshot(ia);
+	assert(s1);
+	assert(s1->root == root && root->refcount == 2);
+	assert(IntIntPMap_size(s1) == SIZE);
+	/* 複製されるのは変更した経路だけで、他の部分木は共有したまま */
+	assert(IntIntPMap_assign(ia, SIZE / 2, -SIZE / 2));
+	assert(ia->root != root && root->refcount == 1);
+	assert(count_unshared(ia->root) <= (size_t) root->height);
+	/* 元を変更しても、スナップショットは変わらない */
+	assert(IntIntPMap_erase_key(ia, 0) == 1);
+	assert(IntIntPMap_assign(ia, 1, 100));
+	assert(IntIntPMap_insert(ia, SIZE, -SIZE, NULL));
+	assert(IntIntPMap_verify(ia));
+	assert(IntIntPMap_verify(s1));
+	assert(IntIntPMap_size(s1) == SIZE);
+	for (i = 0; i < SIZE; i++) {
+		assert(IntIntPMap_find(s1, i) && *IntIntPMap_find(s1, i) == -i);
+	}
+	assert(!IntIntPMap_find(s1, SIZE));
+	assert(!IntIntPMap_find(ia, 0));
+	assert(*IntIntPMap_find(ia, 1) == 100);
+	assert(*IntIntPMap_find(ia, SIZE) == -SIZE);
+	sum = 0;
+	IntIntPMap_for_each(s1, sum_value, &sum);
+	assert(sum == -(long) SIZE * (SIZE - 1) / 2);
+	/* スナップショットも変更でき、元には影響しない */
+	s2 = IntIntPMap_snapshot(s1);
+	for (i = 0; i < SIZE; i += 2) {
+		assert(IntIntPMap_erase_key(s1, i) == 1);
+	}
+	assert(IntIntPMap_verify(s1));
+	assert(IntIntPMap_size(s1) == SIZE / 2);
+	assert(IntIntPMap_size(s2) == SIZE);
+	assert(IntIntPMap_count(ia, 2) == 1);
+	assert(IntIntPMap_count(s2, 2) == 1);
+	/* 元を先に破棄してもスナップショットは使える */
+	IntIntPMap_delete(ia);
+	assert(IntIntPMap_verify(s2));
+	for (i = 0; i < SIZE; i++) {
+		assert(IntIntPMap_count(s2, i) == 1);
+	}
+	IntIntPMap_delete(s1);
+	IntIntPMap_delete(s2);
+	/* 空のスナップショット */
+	ia = IntIntPMap_new();
+	s1 = IntIntPMap_snapshot(ia);
+	assert(IntIntPMap_empty(s1));
+	assert(IntIntPMap_insert(s1, 1, -1, NULL));
+	assert(IntIntPMap_empty(ia));
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntPMap_delete(s1);
+	IntIntPMap_delete(ia);
+}
+
+/* ランダムな操作の後、スナップショットの内容が取った時点の配列と一致すること */
+void PMapTest_test_1_3(void)
+{
+	enum { N = 256, SNAP = 8 };
+	static int ref[SNAP][N];
+	IntIntPMap *snap[SNAP];
+	int cur[N];
+	unsigned int seed = 1;
+	int i, j, k;
+	printf("***** test_1_3 *****\n");
+	ia = IntIntPMap_new();
+	memset(cur, 0, sizeof cur);
+	for (i = 0; i < SNAP; i++) {
+		for (j = 0; j < 400; j++) {
+			seed = seed * 1103515245 + 12345;
+			k = (int) ((seed >> 8) % N);
+			switch ((seed >> 4) % 3) {
+			case 0:
+				assert(IntIntPMap_assign(ia, k, j + 1));
+				cur[k] = j + 1;
+				break;
+			case 1:
+				assert(IntIntPMap_erase_key(ia, k) == (cur[k] != 0));
+				cur[k] = 0;
+				break;
+			default:
+				assert(IntIntPMap_insert(ia, k, -(j + 1), NULL));
+				if (!cur[k]) cur[k] = -(j + 1);
+				break;
+			}
+		}
+		assert(IntIntPMap_verify(ia));
+		snap[i] = IntIntPMap_snapshot(ia);
+		memcpy(ref[i], cur, sizeof cur);
+	}
+	IntIntPMap_clear(ia);
+	for (i = 0; i < SNAP; i++) {
+		assert(IntIntPMap_verify(snap[i]));
+		for (k = 0; k < N; k++) {
+			if (ref[i][k]) {
+				assert(IntIntPMap_find(snap[i], k) && *IntIntPMap_find(snap[i], k) == ref[i][k]);
+			} else {
+				assert(!IntIntPMap_find(snap[i], k));
+			}
+		}
+		IntIntPMap_delete(snap[i]);
+	}
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntPMap_delete(ia);
+}
+
+/* 別のスレッドでスナップショットを走査・破棄する間も、元を変更し続けられること */
+static void *PMapTest_exporter(void *arg)
+{
+	IntIntPMap *s = (IntIntPMap *) arg;
+	long sum = 0;
+	IntIntPMap_for_each(s, sum_value, &sum);
+	assert(sum == -(long) SIZE * (SIZE - 1) / 2);
+	assert(IntIntPMap_verify(s));
+	IntIntPMap_delete(s);
+	return 0;
+}
+
+void PMapTest_test_2_1(void)
+{
+	int i, r;
+	pthread_t th[4];
+	printf("***** test_2_1 *****\n");
+	ia = IntIntPMap_new();
+	for (i = 0; i < SIZE; i++) {
+		assert(IntIntPMap_insert(ia, i, -i, NULL));
+	}
+	for (r = 0; r < 4; r++) {
+		assert(pthread_create(&th[r], 0, PMapTest_exporter, IntIntPMap_snapshot(ia)) == 0);
+		for (i = 0; i < SIZE; i++) {
+			assert(IntIntPMap_erase_key(ia, i) == 1);
+			assert(IntIntPMap_insert(ia, i, -i, NULL));
+		}
+	}
+	for (r = 0; r < 4; r++) {
+		pthread_join(th[r], 0);
+	}
+	assert(IntIntPMap_verify(ia));
+	assert(IntIntPMap_size(ia) == SIZE);
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntPMap_delete(ia);
+}
+
+
+void PMapTest_run(void)
+{
+	printf("\n===== persistent_map test =====\n");
+	PMapTest_test_1_1();
+	PMapTest_test_1_2();
+	PMapTest_test_1_3();
+	PMapTest_test_2_1();
+}
+
+
+int main(void)
+{
+#ifdef MY_MALLOC
+	Pool_init(&pool, buf, sizeof buf, sizeof buf[0]);
+#endif
+	PMapTest_run();
+#ifdef MY_MALLOC
+	POOL_DUMP_LEAK(&pool, 0);
+#endif
+	return 0;
+}
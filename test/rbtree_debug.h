@@ -142,6 +142,35 @@ static size_t Name##RBTree_black_count(Name##RBTree *t, Name##RBTree *root)\
 	}\
 }\
 \
+CSTL_RBTREE_LINK(\
+/* リストが木の中間順の走査と一致するか */\
+static int Name##RBTree_verify_link(Name##RBTree *tree)\
+{\
+	Name##RBTree *t;\
+	Name##RBTree *pos;\
+	pos = tree->next;\
+	t = Name##RBTree_get_root(tree);\
+	if (CSTL_RBTREE_IS_NIL(t, Name)) {\
+		return tree->next == tree && tree->prev == tree;\
+	}\
+	while (!CSTL_RBTREE_IS_NIL(t->left, Name)) t = t->left;\
+	while (!CSTL_RBTREE_IS_HEAD(t, Name)) {\
+		if (pos != t || pos->next->prev != pos) {\
+			return 0;\
+		}\
+		pos = pos->next;\
+		if (!CSTL_RBTREE_IS_NIL(t->right, Name)) {\
+			t = t->right;\
+			while (!CSTL_RBTREE_IS_NIL(t->left, Name)) t = t->left;\
+		} else {\
+			while (!CSTL_RBTREE_IS_ROOT(t, Name) && t == t->parent->right) t = t->parent;\
+			t = t->parent;\
+		}\
+	}\
+	return pos == tree && tree->next->prev == tree;\
+}\
+)\
+\
 int Name##_verify(Name *self)\
 {\
 	size_t len;\
@@ -149,12 +178,18 @@ int Name##_verify(Name *self)\
 	Name##RBTree *r;\
 	Name##Iterator pos;\
 	Name##RBTree *tree = self->tree;\
+	CSTL_RBTREE_LINK(if (!Name##RBTree_verify_link(tree)) return 0;)\
 	if (Name##RBTree_empty(tree) || Name##RBTree_begin(tree) == Name##RBTree_end(tree)) {\
 		return Name##RBTree_empty(tree) && Name##RBTree_begin(tree) == Name##RBTree_end(tree) &&\
+			Name##RBTree_rbegin(tree) == Name##RBTree_rend(tree) &&\
 			tree->left == (Name##RBTree *) &Name##RBTree_nil &&\
 			tree->right == (Name##RBTree *) &Name##RBTree_nil &&\
 			tree->parent == (Name##RBTree *) &Name##RBTree_nil;\
 	}\
+	for (pos = Name##RBTree_get_root(tree); !CSTL_RBTREE_IS_NIL(pos->right, Name); pos = pos->right) ;\
+	if (pos != Name##RBTree_rbegin(tree)) {\
+		return 0;\
+	}\
 	len = Name##RBTree_black_count(Name##RBTree_begin(tree), Name##RBTree_get_root(tree));\
 	for (pos = Name##RBTree_begin(tree); pos != Name##RBTree_end(tree); pos = Name##RBTree_next(pos)) {\
 		l = pos->left;\
@@ -175,7 +210,9 @@ int Name##_verify(Name *self)\
 			Name##RBTree_black_count(pos, Name##RBTree_get_root(tree)) != len) {\
 			return 0;\
 		}\
+		CSTL_RBTREE_SIZE(if (pos->size != l->size + r->size + 1) return 0;)\
 	}\
+	CSTL_RBTREE_SIZE(if (Name##RBTree_get_root(tree)->size != self->size) return 0;)\
 	return 1;\
 }\
 \
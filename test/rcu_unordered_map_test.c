@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "Pool.h"
+#ifdef MY_MALLOC
+double buf[1024*1024/sizeof(double)];
+Pool pool;
+/* Poolはスレッドセーフではないので排他する */
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static void *test_malloc(size_t s)
+{
+	void *p;
+	pthread_mutex_lock(&pool_mutex);
+	p = Pool_malloc(&pool, s);
+	pthread_mutex_unlock(&pool_mutex);
+	return p;
+}
+static void *test_realloc(void *ptr, size_t s)
+{
+	void *p;
+	pthread_mutex_lock(&pool_mutex);
+	p = Pool_realloc(&pool, ptr, s);
+	pthread_mutex_unlock(&pool_mutex);
+	return p;
+}
+static void test_free(void *p)
+{
+	pthread_mutex_lock(&pool_mutex);
+	Pool_free(&pool, p);
+	pthread_mutex_unlock(&pool_mutex);
+}
+#define malloc(s)		test_malloc(s)
+#define realloc(p, s)	test_realloc(p, s)
+#define free(p)			test_free(p)
+#endif
+#include "../cstl/concurrent_unordered_map.h"
+#include "../cstl/rcu_unordered_map.h"
+
+
+CSTL_RCU_UNORDERED_MAP_INTERFACE(IntIntRMap, int, int)
+CSTL_RCU_UNORDERED_MAP_IMPLEMENT(IntIntRMap, int, int, IntIntRMap_hash_int, CSTL_EQUAL_TO)
+
+#define READER_COUNT	4
+#define SIZE			1000
+#define ROUND			20
+
+static IntIntRMap *ia;
+static volatile int writer_done;
+
+
+static void sum_value(int const *key, int const *value, void *arg)
+{
+	assert(*value == -*key);
+	*(long *) arg += *value;
+}
+
+void RMapTest_test_1_1(void)
+{
+	int i;
+	int v;
+	int success;
+	long sum;
+	size_t n;
+	printf("***** test_1_1 *****\n");
+	ia = IntIntRMap_new();
+	assert(ia);
+	assert(IntIntRMap_empty(ia));
+	n = IntIntRMap_bucket_count(ia);
+	for (i = 0; i < SIZE; i++) {
+		assert(IntIntRMap_insert(ia, i, -i, &success) && success);
+		assert(IntIntRMap_size(ia) <= IntIntRMap_bucket_count(ia));
+	}
+	assert(IntIntRMap_bucket_count(ia) > n);
+	assert(IntIntRMap_insert(ia, 0, 100, &success) && !success);
+	assert(IntIntRMap_size(ia) == SIZE);
+	for (i = 0; i < SIZE; i++) {
+		assert(IntIntRMap_find(ia, i, &v) && v == -i);
+	}
+	assert(!IntIntRMap_find(ia, SIZE, &v));
+	assert(!IntIntRMap_find(ia, -1, NULL));
+	assert(IntIntRMap_find(ia, 1, NULL));
+	sum = 0;
+	IntIntRMap_for_each(ia, sum_value, &sum);
+	assert(sum == -(long) SIZE * (SIZE - 1) / 2);
+	/* assign */
+	assert(IntIntRMap_assign(ia, 0, 100));
+	assert(IntIntRMap_find(ia, 0, &v) && v == 100);
+	assert(IntIntRMap_assign(ia, SIZE, 5));
+	assert(IntIntRMap_find(ia, SIZE, &v) && v == 5);
+	assert(IntIntRMap_size(ia) == SIZE + 1);
+	assert(IntIntRMap_assign(ia, 0, 0));
+	assert(IntIntRMap_erase_key(ia, SIZE) == 1);
+	assert(IntIntRMap_erase_key(ia, SIZE) == 0);
+	/* erase_key */
+	for (i = 0; i < SIZE; i += 2) {
+		assert(IntIntRMap_erase_key(ia, i) == 1);
+	}
+	assert(IntIntRMap_size(ia) == SIZE / 2);
+	for (i = 0; i < SIZE; i++) {
+		assert(IntIntRMap_find(ia, i, &v) == (i & 1));
+	}
+	IntIntRMap_synchronize(ia);
+	IntIntRMap_synchronize(ia);
+	/* clear */
+	IntIntRMap_clear(ia);
+	assert(IntIntRMap_empty(ia));
+	assert(!IntIntRMap_find(ia, 1, NULL));
+	assert(IntIntRMap_insert(ia, 1, -1, &success) && success);
+	assert(IntIntRMap_find(ia, 1, &v) && v == -1);
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntRMap_delete(ia);
+	IntIntRMap_delete(NULL);
+}
+
+static void count_value(int const *key, int const *value, void *arg)
+{
+	assert(*value == *key || *value == -*key);
+	*(long *) arg += 1;
+}
+
+/*
+ * 0からSIZE-1のキーは常に存在し、値はキーか-キーのどちらかである。
+ * SIZE以上のキーは挿入と削除を繰り返すが、見つかれば値は-キーである。
+ */
+static void *RMapTest_reader(void *arg)
+{
+	int i;
+	int v;
+	long count;
+	(void) arg;
+	while (!CSTL_ATOMIC_LOAD(&writer_done)) {
+		for (i = 0; i < SIZE * 2; i++) {
+			if (i < SIZE) {
+				assert(IntIntRMap_find(ia, i, &v));
+				assert(v == i || v == -i);
+			} else if (IntIntRMap_find(ia, i, &v)) {
+				assert(v == -i);
+			}
+		}
+		count = 0;
+		IntIntRMap_for_each(ia, count_value, &count);
+		assert(count >= SIZE);
+	}
+	return 0;
+}
+
+void RMapTest_test_2_1(void)
+{
+	int i, r;
+	int v;
+	long count;
+	pthread_t th[READER_COUNT];
+	printf("***** test_2_1 *****\n");
+	ia = IntIntRMap_new();
+	for (i = 0; i < SIZE; i++) {
+		assert(IntIntRMap_insert(ia, i, -i, NULL));
+	}
+	writer_done = 0;
+	for (i = 0; i < READER_COUNT; i++) {
+		assert(pthread_create(&th[i], 0, RMapTest_reader, 0) == 0);
+	}
+	for (r = 0; r < ROUND; r++) {
+		for (i = 0; i < SIZE; i++) {
+			assert(IntIntRMap_assign(ia, i, (r & 1) ? -i : i));
+		}
+		/* バケット数の拡張中にも読み込み側は止まらない */
+		for (i = SIZE; i < SIZE * 2; i++) {
+			assert(IntIntRMap_insert(ia, i, -i, NULL));
+		}
+		for (i = SIZE; i < SIZE * 2; i++) {
+			assert(IntIntRMap_erase_key(ia, i) == 1);
+		}
+	}
+	CSTL_ATOMIC_STORE(&writer_done, 1);
+	for (i = 0; i < READER_COUNT; i++) {
+		pthread_join(th[i], 0);
+	}
+	for (i = 0; i < SIZE; i++) {
+		assert(IntIntRMap_find(ia, i, &v) && v == -i);
+	}
+	assert(IntIntRMap_size(ia) == SIZE);
+	count = 0;
+	IntIntRMap_for_each(ia, count_value, &count);
+	assert(count == SIZE);
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntRMap_delete(ia);
+}
+
+
+void RMapTest_run(void)
+{
+	printf("\n===== rcu_unordered_map test =====\n");
+	RMapTest_test_1_1();
+	RMapTest_test_2_1();
+}
+
+
+int main(void)
+{
+#ifdef MY_MALLOC
+	Pool_init(&pool, buf, sizeof buf, sizeof buf[0]);
+#endif
+	RMapTest_run();
+#ifdef MY_MALLOC
+	POOL_DUMP_LEAK(&pool, 0);
+#endif
+	return 0;
+}
@@ -0,0 +1,89 @@
+#ifndef CSTL_ROPE_DEBUG_H_INCLUDED
+#define CSTL_ROPE_DEBUG_H_INCLUDED
+
+#include <stdio.h>
+
+
+#define CSTL_ROPE_DEBUG_INTERFACE(Name, Type)	\
+int Name##_verify(Name *self);\
+size_t Name##_depth(Name *self);\
+void Name##_print(Name *self);\
+
+
+#define CSTL_ROPE_DEBUG_IMPLEMENT(Name, Type)	\
+static int Name##Node_verify(Name##Node *t)\
+{\
+	if (!t) {\
+		return 1;\
+	}\
+	if (t->len == 0 || t->len > Name##_CHUNK_SIZE) {\
+		return 0;\
+	}\
+	if (t->size != Name##Node_size(t->left) + t->len + Name##Node_size(t->right)) {\
+		return 0;\
+	}\
+	if (t->left && t->left->prio > t->prio) {\
+		return 0;\
+	}\
+	if (t->right && t->right->prio > t->prio) {\
+		return 0;\
+	}\
+	return Name##Node_verify(t->left) && Name##Node_verify(t->right);\
+}\
+\
+int Name##_verify(Name *self)\
+{\
+	size_t n = 0;\
+	Name##Node *p;\
+	for (p = self->pool; p; p = p->right) {\
+		n++;\
+	}\
+	if (n != self->npool || n > Name##_POOL_MAX) {\
+		return 0;\
+	}\
+	return Name##Node_verify(self->root);\
+}\
+\
+static size_t Name##Node_depth(Name##Node *t)\
+{\
+	size_t l;\
+	size_t r;\
+	if (!t) {\
+		return 0;\
+	}\
+	l = Name##Node_depth(t->left);\
+	r = Name##Node_depth(t->right);\
+	return (l > r ? l : r) + 1;\
+}\
+\
+size_t Name##_depth(Name *self)\
+{\
+	return Name##Node_depth(self->root);\
+}\
+\
+static size_t Name##Node_print(Name##Node *t, size_t depth)\
+{\
+	size_t i;\
+	size_t n = 0;\
+	if (!t) {\
+		return 0;\
+	}\
+	n += Name##Node_print(t->left, depth + 1);\
+	for (i = 0; i < depth; i++) {\
+		printf("  ");\
+	}\
+	printf("len[%d], size[%d], prio[%lu]\n", (int) t->len, (int) t->size, t->prio);\
+	n++;\
+	n += Name##Node_print(t->right, depth + 1);\
+	return n;\
+}\
+\
+void Name##_print(Name *self)\
+{\
+	size_t n;\
+	n = Name##Node_print(self->root, 0);\
+	printf("chunks[%d], size[%d], pool[%d]\n", (int) n, (int) Name##_size(self), (int) self->npool);\
+}\
+
+
+#endif /* CSTL_ROPE_DEBUG_H_INCLUDED */
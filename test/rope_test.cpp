@@ -0,0 +1,287 @@
+#include "../cstl/rope.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "rope_debug.h"
+
+#include "Pool.h"
+#ifdef MY_MALLOC
+double buf[1024*1024/sizeof(double)];
+Pool pool;
+#define malloc(s)		Pool_malloc(&pool, s)
+#define realloc(p, s)	Pool_realloc(&pool, p, s)
+#define free(p)			Pool_free(&pool, p)
+#endif
+
+CSTL_ROPE_INTERFACE(Rope, char)
+CSTL_ROPE_IMPLEMENT(Rope, char)
+CSTL_ROPE_DEBUG_INTERFACE(Rope, char)
+CSTL_ROPE_DEBUG_IMPLEMENT(Rope, char)
+
+CSTL_ROPE_INTERFACE(IntRope, int)
+CSTL_ROPE_IMPLEMENT(IntRope, int)
+CSTL_ROPE_DEBUG_INTERFACE(IntRope, int)
+CSTL_ROPE_DEBUG_IMPLEMENT(IntRope, int)
+
+using namespace std;
+
+
+static int equal(Rope *x, const string &s)
+{
+	static char tmp[65536];
+	size_t len;
+	assert(Rope_size(x) == s.size());
+	assert(s.size() <= sizeof tmp);
+	len = Rope_copy(x, tmp, 0, Rope_size(x));
+	return len == s.size() && memcmp(tmp, s.data(), len) == 0;
+}
+
+void RopeTest_test_1_1(void)
+{
+	Rope *x;
+	string s;
+	size_t i;
+	char tmp[16];
+	printf("***** test_1_1 *****\n");
+	/* 初期状態 */
+	x = Rope_new();
+	assert(Rope_empty(x));
+	assert(Rope_size(x) == 0);
+	assert(Rope_length(x) == 0);
+	assert(Rope_verify(x));
+	/* assign */
+	assert(Rope_assign(x, "abcdefghijklmn"));
+	s = "abcdefghijklmn";
+	assert(equal(x, s));
+	assert(Rope_assign_len(x, "abcdefghijklmn", 7));
+	s.assign("abcdefghijklmn", 7);
+	assert(equal(x, s));
+	/* at */
+	for (i = 0; i < Rope_length(x); i++) {
+		assert(s.at(i) == *Rope_at(x, i));
+	}
+	*Rope_at(x, 0) = 'z';
+	s[0] = 'z';
+	assert(equal(x, s));
+	/* copy */
+	assert(Rope_copy(x, tmp, 3, 100) == 4);
+	assert(memcmp(tmp, "defg", 4) == 0);
+	assert(Rope_copy(x, tmp, 7, 100) == 0);
+	/* push_back, append */
+	assert(Rope_push_back(x, 'h'));
+	s.push_back('h');
+	assert(Rope_append(x, "ijk"));
+	s.append("ijk");
+	assert(Rope_append_len(x, "lmnopq", 3));
+	s.append("lmnopq", 3);
+	assert(equal(x, s));
+	/* insert */
+	assert(Rope_insert(x, 0, "012"));
+	s.insert(0, "012");
+	assert(Rope_insert_len(x, 5, "345", 2));
+	s.insert(5, "345", 2);
+	assert(Rope_insert(x, Rope_size(x), "xyz"));
+	s.insert(s.size(), "xyz");
+	assert(equal(x, s));
+	/* erase */
+	assert(Rope_erase(x, 1, 2));
+	s.erase(1, 2);
+	assert(Rope_erase(x, 4, CSTL_NPOS));
+	s.erase(4);
+	assert(equal(x, s));
+	/* replace */
+	assert(Rope_replace(x, 1, 2, "AB"));
+	s.replace(1, 2, "AB");
+	assert(Rope_replace(x, 0, 1, "CDEFG"));
+	s.replace(0, 1, "CDEFG");
+	assert(Rope_replace_len(x, 2, 3, "HIJ", 1));
+	s.replace(2, 3, "HIJ", 1);
+	assert(Rope_replace(x, 0, CSTL_NPOS, ""));
+	s.replace(0, string::npos, "");
+	assert(equal(x, s));
+	assert(Rope_empty(x));
+	assert(Rope_verify(x));
+	/* new_assign, swap */
+	{
+		Rope *y = Rope_new_assign("hello");
+		Rope *z = Rope_new_assign_len("world!!", 5);
+		Rope_swap(y, z);
+		assert(equal(y, "world"));
+		assert(equal(z, "hello"));
+		Rope_clear(y);
+		assert(Rope_empty(y));
+		Rope_delete(y);
+		Rope_delete(z);
+	}
+	Rope_delete(x);
+}
+
+void RopeTest_test_1_2(void)
+{
+	Rope *x;
+	string s;
+	size_t i;
+	printf("***** test_1_2 *****\n");
+	x = Rope_new();
+	/* チャンクをまたぐ文字列 */
+	for (i = 0; i < 3000; i++) {
+		char c = 'a' + (char) (i % 26);
+		assert(Rope_push_back(x, c));
+		s.push_back(c);
+	}
+	assert(equal(x, s));
+	assert(Rope_verify(x));
+	/* find */
+	for (i = 0; i < s.size(); i += 7) {
+		assert(Rope_find(x, "xyzab", i) == s.find("xyzab", i));
+		assert(Rope_find_c(x, 'q', i) == s.find('q', i));
+		assert(Rope_find_len(x, "mnop", i, 2) == s.find("mnop", i, 2));
+		assert(Rope_rfind(x, "xyzab", i) == s.rfind("xyzab", i));
+		assert(Rope_rfind_c(x, 'q', i) == s.rfind('q', i));
+		assert(Rope_rfind_len(x, "mnop", i, 2) == s.rfind("mnop", i, 2));
+	}
+	assert(Rope_find(x, "", 5) == s.find("", 5));
+	assert(Rope_find(x, "abd", 0) == CSTL_NPOS);
+	assert(Rope_find(x, "a", Rope_size(x)) == CSTL_NPOS);
+	assert(Rope_rfind(x, "", CSTL_NPOS) == s.rfind("", string::npos));
+	assert(Rope_rfind(x, "xyz", CSTL_NPOS) == s.rfind("xyz", string::npos));
+	assert(Rope_rfind(x, "abd", CSTL_NPOS) == CSTL_NPOS);
+	/* 大きな挿入と削除 */
+	s.insert(1500, s.substr(0, 2000));
+	{
+		char *tmp = (char *) malloc(2000);
+		Rope_copy(x, tmp, 0, 2000);
+		assert(Rope_insert_len(x, 1500, tmp, 2000));
+		free(tmp);
+	}
+	assert(equal(x, s));
+	assert(Rope_verify(x));
+	assert(Rope_erase(x, 100, 3500));
+	s.erase(100, 3500);
+	assert(equal(x, s));
+	assert(Rope_verify(x));
+	Rope_delete(x);
+}
+
+void RopeTest_test_1_3(void)
+{
+	Rope *x;
+	string s;
+	size_t i;
+	char tmp[1024];
+	printf("***** test_1_3 *****\n");
+	/* 乱数による編集をstd::stringと比較 */
+	srand(0);
+	x = Rope_new();
+	for (i = 0; i < 20000; i++) {
+		size_t idx = s.empty() ? 0 : (size_t) rand() % (s.size() + 1);
+		size_t len = (size_t) rand() % ((rand() % 8) ? 8 : sizeof tmp);
+		size_t j;
+		for (j = 0; j < len; j++) {
+			tmp[j] = 'a' + (char) (rand() % 4);
+		}
+		switch (rand() % 4) {
+		case 0:
+		case 1:
+			if (s.size() > 30000) break;
+			assert(Rope_insert_len(x, idx, tmp, len));
+			s.insert(idx, tmp, len);
+			break;
+		case 2:
+			if (idx == s.size()) break;
+			assert(Rope_erase(x, idx, len));
+			s.erase(idx, len);
+			break;
+		default:
+			assert(Rope_replace_len(x, idx, len / 2, tmp, len));
+			s.replace(idx, len / 2, tmp, len);
+			break;
+		}
+		if (i % 1000 == 0) {
+			assert(Rope_verify(x));
+			assert(equal(x, s));
+			assert(Rope_find_len(x, tmp, idx, 3) == s.find(tmp, idx, 3));
+			assert(Rope_rfind_len(x, tmp, idx, 3) == s.rfind(tmp, idx, 3));
+		}
+	}
+	assert(Rope_verify(x));
+	assert(equal(x, s));
+	Rope_delete(x);
+}
+
+void RopeTest_test_1_4(void)
+{
+	Rope *x;
+	string s;
+	size_t i;
+	size_t chunks;
+	size_t log2;
+	printf("***** test_1_4 *****\n");
+	/* 1文字ずつの挿入でチャンクを分けても木が偏らない */
+	x = Rope_new();
+	for (i = 0; i < 200000; i++) {
+		assert(Rope_push_back(x, 'a' + (char) (i % 26)));
+	}
+	for (i = 0; i < 20000; i++) {
+		assert(Rope_insert_len(x, Rope_size(x) / 2 + i % 64, "xy", 2));
+	}
+	assert(Rope_verify(x));
+	chunks = Rope_size(x) / (Rope_CHUNK_SIZE / 2);
+	for (log2 = 0; chunks > 1; chunks /= 2) {
+		log2++;
+	}
+	/* treapの深さの期待値は約2.9 log2(n) */
+	printf("size[%d], depth[%d]\n", (int) Rope_size(x), (int) Rope_depth(x));
+	assert(Rope_depth(x) <= 6 * (log2 + 1));
+	Rope_delete(x);
+}
+
+void RopeTest_test_2_1(void)
+{
+	IntRope *x;
+	int a[1000];
+	int b[1000];
+	size_t i;
+	printf("***** test_2_1 *****\n");
+	for (i = 0; i < 1000; i++) {
+		a[i] = (int) i - 500;
+	}
+	x = IntRope_new_assign_len(a, 1000);
+	assert(x);
+	assert(IntRope_size(x) == 1000);
+	assert(IntRope_verify(x));
+	assert(IntRope_erase(x, 100, 800));
+	assert(IntRope_insert_len(x, 100, &a[100], 800));
+	assert(IntRope_copy(x, b, 0, 1000) == 1000);
+	assert(memcmp(a, b, sizeof a) == 0);
+	assert(IntRope_find_c(x, -1, 0) == 499);
+	assert(IntRope_rfind_len(x, &a[10], CSTL_NPOS, 5) == 10);
+	assert(IntRope_verify(x));
+	IntRope_delete(x);
+}
+
+
+void RopeTest_run(void)
+{
+	printf("\n===== rope test =====\n");
+	RopeTest_test_1_1();
+	RopeTest_test_1_2();
+	RopeTest_test_1_3();
+	RopeTest_test_1_4();
+	RopeTest_test_2_1();
+}
+
+
+int main(void)
+{
+#ifdef MY_MALLOC
+	Pool_init(&pool, buf, sizeof buf, sizeof buf[0]);
+#endif
+	RopeTest_run();
+#ifdef MY_MALLOC
+	POOL_DUMP_LEAK(&pool, 0);
+#endif
+	return 0;
+}
@@ -554,6 +554,592 @@ void SetTest_test_1_3(void)
 	IntMSetA_delete(x);
 }
 
+void SetTest_test_1_4(void)
+{
+	int i, j, n;
+	int data[100];
+	IntSetA *x;
+	IntSetAIterator p;
+	IntSetAIterator q;
+	IntMSetAIterator mp;
+	IntMSetAIterator mq;
+	printf("***** test_1_4 *****\n");
+	/* build_from_sorted_array */
+	for (n = 0; n < 70; n++) {
+		ia = IntSetA_new();
+		for (i = 0; i < n; i++) {
+			data[i] = i * 2;
+		}
+		assert(IntSetA_build_from_sorted_array(ia, data, n));
+		assert(IntSetA_verify(ia));
+		assert(IntSetA_size(ia) == n);
+		for (p = IntSetA_begin(ia), i = 0; p != IntSetA_end(ia); p = IntSetA_next(p), i++) {
+			assert(*IntSetA_data(p) == i * 2);
+		}
+		assert(i == n);
+		for (p = IntSetA_rbegin(ia), i = n - 1; p != IntSetA_rend(ia); p = IntSetA_prev(p), i--) {
+			assert(*IntSetA_data(p) == i * 2);
+		}
+		assert(i == -1);
+		/* 構築後も通常の挿入・削除ができる */
+		assert(IntSetA_insert(ia, -1, 0));
+		assert(IntSetA_insert(ia, n * 2 + 1, 0));
+		assert(IntSetA_verify(ia));
+		assert(IntSetA_erase_key(ia, n) == (n % 2 == 0 && n > 0));
+		assert(IntSetA_verify(ia));
+		IntSetA_delete(ia);
+	}
+	/* 重複した要素 */
+	ia = IntSetA_new();
+	for (i = 0; i < 100; i++) {
+		data[i] = i / 3;
+	}
+	assert(IntSetA_build_from_sorted_array(ia, data, 100));
+	assert(IntSetA_verify(ia));
+	assert(IntSetA_size(ia) == 34);
+	/* 既存の要素より多い要素の挿入(マージして再構築) */
+	p = IntSetA_find(ia, 10);
+	for (i = 0; i < 50; i++) {
+		data[i] = i * 2;
+	}
+	assert(IntSetA_build_from_sorted_array(ia, data, 50));
+	assert(IntSetA_verify(ia));
+	assert(IntSetA_size(ia) == 34 + 50 - 17);
+	/* 既存のイテレータは有効 */
+	assert(p == IntSetA_find(ia, 10));
+	assert(*IntSetA_data(p) == 10);
+	for (q = IntSetA_begin(ia), i = 0; q != IntSetA_end(ia); q = IntSetA_next(q), i++) {
+		assert(*IntSetA_data(q) == (i < 34 ? i : (i - 34) * 2 + 34));
+	}
+	/* 既存の要素より少ない要素の挿入 */
+	data[0] = -5;
+	data[1] = 5;
+	data[2] = 201;
+	assert(IntSetA_build_from_sorted_array(ia, data, 3));
+	assert(IntSetA_verify(ia));
+	assert(IntSetA_size(ia) == 34 + 50 - 17 + 2);
+	assert(*IntSetA_data(IntSetA_begin(ia)) == -5);
+	assert(*IntSetA_data(IntSetA_rbegin(ia)) == 201);
+	/* insert_range */
+	x = IntSetA_new();
+	for (i = 0; i < 300; i += 3) {
+		assert(IntSetA_insert(x, i, 0));
+	}
+	assert(IntSetA_insert_range(x, IntSetA_begin(ia), IntSetA_end(ia)));
+	assert(IntSetA_verify(x));
+	for (q = IntSetA_begin(x), i = -1000; q != IntSetA_end(x); q = IntSetA_next(q)) {
+		j = *IntSetA_data(q);
+		assert(i < j);
+		assert(IntSetA_count(ia, j) || (j % 3 == 0 && 0 <= j && j < 300));
+		i = j;
+	}
+	for (q = IntSetA_begin(ia); q != IntSetA_end(ia); q = IntSetA_next(q)) {
+		assert(IntSetA_count(x, *IntSetA_data(q)) == 1);
+	}
+	IntSetA_delete(x);
+	IntSetA_delete(ia);
+
+	/* multiset */
+	ima = IntMSetA_new();
+	for (i = 0; i < 100; i++) {
+		data[i] = i / 3;
+	}
+	assert(IntMSetA_build_from_sorted_array(ima, data, 100));
+	assert(IntMSetA_verify(ima));
+	assert(IntMSetA_size(ima) == 100);
+	assert(IntMSetA_count(ima, 5) == 3);
+	/* 同じ値の要素は既存の要素の後に挿入される */
+	mp = IntMSetA_lower_bound(ima, 5);
+	assert(IntMSetA_build_from_sorted_array(ima, data, 100));
+	assert(IntMSetA_verify(ima));
+	assert(IntMSetA_size(ima) == 200);
+	assert(IntMSetA_count(ima, 5) == 6);
+	assert(mp == IntMSetA_lower_bound(ima, 5));
+	for (mq = IntMSetA_begin(ima), i = 0; mq != IntMSetA_end(ima); mq = IntMSetA_next(mq), i++) {
+		assert(*IntMSetA_data(mq) == i / 6);
+	}
+	assert(IntMSetA_insert_range(ima, IntMSetA_begin(ima), IntMSetA_end(ima)));
+	assert(IntMSetA_verify(ima));
+	assert(IntMSetA_size(ima) == 400);
+	assert(IntMSetA_count(ima, 33) == 4);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntMSetA_delete(ima);
+}
+
+void SetTest_test_1_5(void)
+{
+	int i, j;
+	int success;
+	int present[200];
+	IntSetAIterator p;
+	IntSetAIterator q;
+	IntMSetAIterator mp;
+	IntMSetAIterator mq;
+	printf("***** test_1_5 *****\n");
+	ia = IntSetA_new();
+	/* 末尾への追加 */
+	for (i = 0; i < 100; i++) {
+		p = IntSetA_insert_hint(ia, IntSetA_end(ia), i * 2, &success);
+		assert(p && success);
+		assert(*IntSetA_data(p) == i * 2);
+		assert(IntSetA_verify(ia));
+	}
+	/* 先頭への追加 */
+	for (i = -1; i > -50; i--) {
+		p = IntSetA_insert_hint(ia, IntSetA_begin(ia), i * 2, &success);
+		assert(p && success);
+		assert(p == IntSetA_begin(ia));
+		assert(IntSetA_verify(ia));
+	}
+	/* 既存の要素 */
+	p = IntSetA_find(ia, 10);
+	assert(IntSetA_insert_hint(ia, p, 10, &success) == p);
+	assert(!success);
+	assert(IntSetA_insert_hint(ia, IntSetA_next(p), 10, &success) == p);
+	assert(!success);
+	assert(IntSetA_insert_hint(ia, IntSetA_prev(p), 10, &success) == p);
+	assert(!success);
+	assert(IntSetA_insert_hint(ia, IntSetA_begin(ia), 10, &success) == p);
+	assert(!success);
+	assert(IntSetA_size(ia) == 149);
+	/* hintの直前・直後・離れた位置 */
+	for (i = 0; i < 200; i++) {
+		present[i] = (i % 2 == 0);
+	}
+	for (i = 0; i < 200; i++) {
+		j = (i * 7) % 200;
+		switch (i % 4) {
+		case 0:
+			q = IntSetA_lower_bound(ia, j);
+			break;
+		case 1:
+			q = IntSetA_upper_bound(ia, j);
+			q = (q == IntSetA_end(ia)) ? IntSetA_rbegin(ia) : (q == IntSetA_begin(ia)) ? q : IntSetA_prev(q);
+			break;
+		case 2:
+			q = IntSetA_end(ia);
+			break;
+		default:
+			q = IntSetA_find(ia, (i * 13) % 200 & ~1);
+			break;
+		}
+		p = IntSetA_insert_hint(ia, q, j, &success);
+		assert(p && *IntSetA_data(p) == j);
+		assert(success == !present[j]);
+		present[j] = 1;
+		assert(IntSetA_verify(ia));
+	}
+	assert(IntSetA_size(ia) == 49 + 200);
+	for (p = IntSetA_find(ia, 0), i = 0; p != IntSetA_end(ia); p = IntSetA_next(p), i++) {
+		assert(*IntSetA_data(p) == i);
+	}
+	IntSetA_delete(ia);
+
+	/* multiset */
+	ima = IntMSetA_new();
+	for (i = 0; i < 10; i++) {
+		assert(IntMSetA_insert_hint(ima, IntMSetA_end(ima), i));
+		assert(IntMSetA_insert_hint(ima, IntMSetA_end(ima), i));
+	}
+	assert(IntMSetA_verify(ima));
+	assert(IntMSetA_size(ima) == 20);
+	/* 同じ値の要素はhintの直前に挿入される */
+	mq = IntMSetA_upper_bound(ima, 5);
+	mp = IntMSetA_insert_hint(ima, mq, 5);
+	assert(mp && IntMSetA_next(mp) == mq);
+	mq = IntMSetA_lower_bound(ima, 5);
+	mp = IntMSetA_insert_hint(ima, mq, 5);
+	assert(mp && IntMSetA_next(mp) == mq);
+	assert(mp == IntMSetA_lower_bound(ima, 5));
+	assert(IntMSetA_count(ima, 5) == 4);
+	/* 隣接しないhint */
+	mp = IntMSetA_insert_hint(ima, IntMSetA_begin(ima), 7);
+	assert(mp && IntMSetA_next(mp) == IntMSetA_lower_bound(ima, 8));
+	assert(IntMSetA_verify(ima));
+	assert(IntMSetA_size(ima) == 23);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntMSetA_delete(ima);
+}
+
+#ifdef CSTL_RBTREE_RANK
+void SetTest_test_1_6(void)
+{
+	int i;
+	int data[100];
+	IntSetAIterator p;
+	printf("***** test_1_6 *****\n");
+	ia = IntSetA_new();
+	assert(IntSetA_nth(ia, 0) == IntSetA_end(ia));
+	assert(IntSetA_rank(ia, 0) == 0);
+	for (i = 0; i < 300; i++) {
+		assert(IntSetA_insert(ia, (i * 7) % 300 * 2, NULL));
+		assert(IntSetA_verify(ia));
+	}
+	for (i = 0; i < 300; i++) {
+		p = IntSetA_nth(ia, i);
+		assert(*IntSetA_data(p) == i * 2);
+		assert(IntSetA_rank(ia, i * 2) == (size_t) i);
+		assert(IntSetA_rank(ia, i * 2 + 1) == (size_t) i + 1);
+	}
+	assert(IntSetA_nth(ia, 300) == IntSetA_end(ia));
+	assert(IntSetA_rank(ia, -1) == 0);
+	/* 削除後も順位が保たれる */
+	for (i = 0; i < 300; i += 3) {
+		assert(IntSetA_erase_key(ia, i * 2) == 1);
+		assert(IntSetA_verify(ia));
+	}
+	for (i = 0; i < 200; i++) {
+		p = IntSetA_nth(ia, i);
+		assert(*IntSetA_data(p) == (i / 2 * 3 + i % 2 + 1) * 2);
+		assert(IntSetA_rank(ia, *IntSetA_data(p)) == (size_t) i);
+	}
+	assert(IntSetA_nth(ia, 200) == IntSetA_end(ia));
+	/* 一括構築 */
+	for (i = 0; i < 100; i++) {
+		data[i] = i * 2 + 1;
+	}
+	assert(IntSetA_build_from_sorted_array(ia, data, 100));
+	assert(IntSetA_verify(ia));
+	assert(IntSetA_size(ia) == 300);
+	assert(*IntSetA_data(IntSetA_nth(ia, 1)) == 2);
+	assert(IntSetA_rank(ia, 4) == 3);
+	IntSetA_clear(ia);
+	assert(IntSetA_build_from_sorted_array(ia, data, 100));
+	assert(IntSetA_verify(ia));
+	assert(*IntSetA_data(IntSetA_nth(ia, 1)) == 3);
+	assert(IntSetA_rank(ia, 4) == 2);
+	IntSetA_clear(ia);
+	assert(IntSetA_verify(ia));
+	assert(IntSetA_nth(ia, 0) == IntSetA_end(ia));
+	IntSetA_delete(ia);
+
+	/* multiset */
+	ima = IntMSetA_new();
+	for (i = 0; i < 100; i++) {
+		assert(IntMSetA_insert(ima, i % 10));
+	}
+	assert(IntMSetA_verify(ima));
+	for (i = 0; i < 10; i++) {
+		assert(IntMSetA_rank(ima, i) == (size_t) i * 10);
+		assert(IntMSetA_nth(ima, i * 10) == IntMSetA_lower_bound(ima, i));
+	}
+	IntMSetA_erase_key(ima, 3);
+	assert(IntMSetA_verify(ima));
+	assert(IntMSetA_rank(ima, 5) == 40);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntMSetA_delete(ima);
+}
+#endif
+
+void SetTest_test_1_7(void)
+{
+	int i;
+	IntSetA *x;
+	IntSetA *y;
+	IntSetA *z;
+	IntSetAIterator p;
+	IntMSetA *mx;
+	IntMSetA *my;
+	IntMSetAIterator mp;
+	int mdata[] = {1, 1, 1, 2};
+	int mdata2[] = {1, 2, 2, 3};
+	int munion[] = {1, 1, 1, 2, 2, 3};
+	int mdiff[] = {1, 1, 2, 3};
+	printf("***** test_1_7 *****\n");
+	x = IntSetA_new();
+	y = IntSetA_new();
+	for (i = 0; i < 300; i += 2) {
+		assert(IntSetA_insert(x, i, NULL));
+	}
+	for (i = 0; i < 300; i += 3) {
+		assert(IntSetA_insert(y, i, NULL));
+	}
+	ia = IntSetA_new();
+	assert(IntSetA_set_union(ia, x, y));
+	assert(IntSetA_verify(ia));
+	for (i = 0; i < 300; i++) {
+		assert(IntSetA_count(ia, i) == (i % 2 == 0 || i % 3 == 0));
+	}
+	IntSetA_clear(ia);
+	assert(IntSetA_set_intersection(ia, x, y));
+	assert(IntSetA_verify(ia));
+	assert(IntSetA_size(ia) == 50);
+	for (p = IntSetA_begin(ia), i = 0; p != IntSetA_end(ia); p = IntSetA_next(p), i += 6) {
+		assert(*IntSetA_data(p) == i);
+	}
+	IntSetA_clear(ia);
+	assert(IntSetA_set_difference(ia, x, y));
+	assert(IntSetA_verify(ia));
+	for (i = 0; i < 300; i++) {
+		assert(IntSetA_count(ia, i) == (i % 2 == 0 && i % 3 != 0));
+	}
+	IntSetA_clear(ia);
+	assert(IntSetA_set_symmetric_difference(ia, x, y));
+	assert(IntSetA_verify(ia));
+	for (i = 0; i < 300; i++) {
+		assert(IntSetA_count(ia, i) == ((i % 2 == 0) != (i % 3 == 0)));
+	}
+	/* 既存の要素とマージされる */
+	IntSetA_clear(ia);
+	assert(IntSetA_insert(ia, 1, NULL));
+	assert(IntSetA_insert(ia, 6, NULL));
+	assert(IntSetA_set_intersection(ia, x, y));
+	assert(IntSetA_verify(ia));
+	assert(IntSetA_size(ia) == 51);
+	/* 空集合 */
+	z = IntSetA_new();
+	IntSetA_clear(ia);
+	assert(IntSetA_set_union(ia, x, z));
+	assert(IntSetA_size(ia) == IntSetA_size(x));
+	IntSetA_clear(ia);
+	assert(IntSetA_set_intersection(ia, z, y));
+	assert(IntSetA_empty(ia));
+	assert(IntSetA_set_difference(ia, z, y));
+	assert(IntSetA_empty(ia));
+	/* 要素数が大きく異なる場合 */
+	for (i = 0; i < 2000; i++) {
+		assert(IntSetA_insert(z, i, NULL));
+	}
+	IntSetA_clear(y);
+	assert(IntSetA_insert(y, -1, NULL));
+	assert(IntSetA_insert(y, 1000, NULL));
+	assert(IntSetA_insert(y, 1001, NULL));
+	assert(IntSetA_insert(y, 1999, NULL));
+	assert(IntSetA_insert(y, 20000, NULL));
+	IntSetA_clear(ia);
+	assert(IntSetA_set_intersection(ia, z, y));
+	assert(IntSetA_verify(ia));
+	assert(IntSetA_size(ia) == 3);
+	assert(IntSetA_count(ia, 1000) && IntSetA_count(ia, 1001) && IntSetA_count(ia, 1999));
+	IntSetA_clear(ia);
+	assert(IntSetA_set_intersection(ia, y, z));
+	assert(IntSetA_size(ia) == 3);
+	IntSetA_clear(ia);
+	assert(IntSetA_set_difference(ia, y, z));
+	assert(IntSetA_verify(ia));
+	assert(IntSetA_size(ia) == 2);
+	assert(IntSetA_count(ia, -1) && IntSetA_count(ia, 20000));
+	IntSetA_clear(ia);
+	assert(IntSetA_set_difference(ia, z, y));
+	assert(IntSetA_size(ia) == 1997);
+	IntSetA_delete(ia);
+	IntSetA_delete(x);
+	IntSetA_delete(y);
+	IntSetA_delete(z);
+
+	/* multiset */
+	mx = IntMSetA_new();
+	my = IntMSetA_new();
+	ima = IntMSetA_new();
+	assert(IntMSetA_build_from_sorted_array(mx, mdata, 4));
+	assert(IntMSetA_build_from_sorted_array(my, mdata2, 4));
+	assert(IntMSetA_set_union(ima, mx, my));
+	assert(IntMSetA_verify(ima));
+	assert(IntMSetA_size(ima) == 6);
+	for (mp = IntMSetA_begin(ima), i = 0; mp != IntMSetA_end(ima); mp = IntMSetA_next(mp), i++) {
+		assert(*IntMSetA_data(mp) == munion[i]);
+	}
+	IntMSetA_clear(ima);
+	assert(IntMSetA_set_intersection(ima, mx, my));
+	assert(IntMSetA_size(ima) == 2);
+	assert(IntMSetA_count(ima, 1) == 1 && IntMSetA_count(ima, 2) == 1);
+	IntMSetA_clear(ima);
+	assert(IntMSetA_set_difference(ima, mx, my));
+	assert(IntMSetA_size(ima) == 2);
+	assert(IntMSetA_count(ima, 1) == 2);
+	IntMSetA_clear(ima);
+	assert(IntMSetA_set_symmetric_difference(ima, mx, my));
+	assert(IntMSetA_verify(ima));
+	assert(IntMSetA_size(ima) == 4);
+	for (mp = IntMSetA_begin(ima), i = 0; mp != IntMSetA_end(ima); mp = IntMSetA_next(mp), i++) {
+		assert(*IntMSetA_data(mp) == mdiff[i]);
+	}
+	IntMSetA_delete(mx);
+	IntMSetA_delete(my);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntMSetA_delete(ima);
+}
+
+void SetTest_test_1_8(void)
+{
+	int i;
+#ifdef CSTL_RBTREE_RANK
+	int j;
+	IntSetAIterator p;
+#endif
+	IntSetA *x;
+	IntMSetA *mx;
+	printf("***** test_1_8 *****\n");
+	ia = IntSetA_new();
+	x = IntSetA_new();
+#ifdef CSTL_RBTREE_RANK
+	/* 空のsetの分割 */
+	IntSetA_split(ia, 0, x);
+	assert(IntSetA_empty(ia) && IntSetA_empty(x));
+	assert(IntSetA_verify(ia) && IntSetA_verify(x));
+	/* 様々な大きさ・位置で分割し、連結して元に戻す */
+	for (i = 1; i < 70; i++) {
+		IntSetA_clear(ia);
+		for (j = 0; j < i; j++) {
+			assert(IntSetA_insert(ia, (j * 71) % i * 2, NULL));
+		}
+		for (j = -1; j <= i * 2 + 1; j++) {
+			IntSetA_split(ia, j, x);
+			assert(IntSetA_verify(ia));
+			assert(IntSetA_verify(x));
+			assert(IntSetA_size(ia) == (size_t) (j < 0 ? 0 : j / 2 + j % 2 > i ? i : j / 2 + j % 2));
+			assert(IntSetA_size(ia) + IntSetA_size(x) == (size_t) i);
+			assert(IntSetA_empty(ia) || *IntSetA_data(IntSetA_rbegin(ia)) < j);
+			assert(IntSetA_empty(x) || *IntSetA_data(IntSetA_begin(x)) >= j);
+			IntSetA_join(ia, x);
+			assert(IntSetA_verify(ia));
+			assert(IntSetA_verify(x));
+			assert(IntSetA_empty(x));
+			assert(IntSetA_size(ia) == (size_t) i);
+		}
+		for (p = IntSetA_begin(ia), j = 0; p != IntSetA_end(ia); p = IntSetA_next(p), j++) {
+			assert(*IntSetA_data(p) == j * 2);
+		}
+		assert(j == i);
+	}
+#endif
+	/* 大きさの異なる木の連結 */
+	IntSetA_clear(ia);
+	for (i = 0; i < 1000; i++) {
+		assert(IntSetA_insert(ia, i, NULL));
+	}
+	assert(IntSetA_insert(x, 1000, NULL));
+	IntSetA_join(ia, x);
+	assert(IntSetA_verify(ia));
+	assert(IntSetA_size(ia) == 1001);
+	assert(*IntSetA_data(IntSetA_rbegin(ia)) == 1000);
+	assert(IntSetA_insert(x, -1, NULL));
+	IntSetA_join(x, ia);
+	assert(IntSetA_verify(x));
+	assert(IntSetA_verify(ia));
+	assert(IntSetA_size(x) == 1002);
+	assert(*IntSetA_data(IntSetA_begin(x)) == -1);
+#ifdef CSTL_RBTREE_RANK
+	/* 分割後も挿入・削除できる */
+	IntSetA_split(x, 500, ia);
+	for (i = 0; i < 500; i++) {
+		assert(IntSetA_insert(ia, i + 2000, NULL));
+		assert(IntSetA_erase_key(x, i) == 1);
+	}
+	assert(IntSetA_verify(x) && IntSetA_verify(ia));
+	assert(IntSetA_size(x) == 1 && IntSetA_size(ia) == 1001);
+#endif
+	IntSetA_delete(x);
+	IntSetA_delete(ia);
+
+	/* multiset */
+	ima = IntMSetA_new();
+	mx = IntMSetA_new();
+	for (i = 0; i < 100; i++) {
+#ifdef CSTL_RBTREE_RANK
+		assert(IntMSetA_insert(ima, i % 10));
+#else
+		assert(IntMSetA_insert(i % 10 < 5 ? ima : mx, i % 10));
+#endif
+	}
+#ifdef CSTL_RBTREE_RANK
+	IntMSetA_split(ima, 5, mx);
+#endif
+	assert(IntMSetA_verify(ima) && IntMSetA_verify(mx));
+	assert(IntMSetA_size(ima) == 50 && IntMSetA_size(mx) == 50);
+	assert(IntMSetA_count(mx, 5) == 10 && IntMSetA_count(ima, 5) == 0);
+	assert(IntMSetA_insert(ima, 5));
+	IntMSetA_join(ima, mx);
+	assert(IntMSetA_verify(ima) && IntMSetA_verify(mx));
+	assert(IntMSetA_size(ima) == 101);
+	assert(IntMSetA_count(ima, 5) == 11);
+	IntMSetA_delete(mx);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntMSetA_delete(ima);
+}
+
+void SetTest_test_1_9(void)
+{
+	int i;
+	int success;
+	IntSetA *x;
+	IntSetAIterator p;
+	IntSetAIterator node;
+	IntMSetA *mx;
+	IntMSetAIterator mp;
+	printf("***** test_1_9 *****\n");
+	ia = IntSetA_new();
+	x = IntSetA_new();
+	for (i = 0; i < 100; i++) {
+		assert(IntSetA_insert(ia, i, NULL));
+	}
+	/* 取り外したノードを別のsetにそのまま挿入する */
+	for (p = IntSetA_begin(ia); p != IntSetA_end(ia);) {
+		node = p;
+		p = IntSetA_next(p);
+		if (*IntSetA_data(node) % 2) {
+			assert(IntSetA_extract(ia, node) == node);
+			assert(*IntSetA_data(node) % 2);
+			assert(IntSetA_insert_node(x, node, &success) == node && success);
+		}
+	}
+	assert(IntSetA_verify(ia) && IntSetA_verify(x));
+	assert(IntSetA_size(ia) == 50 && IntSetA_size(x) == 50);
+	for (i = 0; i < 100; i++) {
+		assert(IntSetA_count(i % 2 ? x : ia, i) == 1);
+		assert(IntSetA_count(i % 2 ? ia : x, i) == 0);
+	}
+	/* キーを書き換えて戻す */
+	node = IntSetA_extract(x, IntSetA_find(x, 51));
+	assert(IntSetA_verify(x) && IntSetA_size(x) == 49);
+	*IntSetA_node_data(node) = 1000;
+	assert(IntSetA_insert_node(ia, node, &success) == node && success);
+	assert(*IntSetA_data(IntSetA_rbegin(ia)) == 1000);
+	/* 同じキーが既にあれば挿入せず、ノードは呼び出し側に残る */
+	node = IntSetA_extract(x, IntSetA_begin(x));
+	assert(*IntSetA_data(node) == 1);
+	*IntSetA_node_data(node) = 0;
+	p = IntSetA_insert_node(ia, node, &success);
+	assert(!success && p != node && *IntSetA_data(p) == 0);
+	assert(IntSetA_verify(ia) && IntSetA_size(ia) == 51);
+	IntSetA_node_delete(node);
+	IntSetA_node_delete(NULL);
+	/* 最後の要素 */
+	IntSetA_clear(x);
+	assert(IntSetA_insert(x, 7, NULL));
+	node = IntSetA_extract(x, IntSetA_begin(x));
+	assert(IntSetA_empty(x) && IntSetA_verify(x));
+	assert(IntSetA_insert_node(x, node, NULL) == node);
+	assert(IntSetA_verify(x) && IntSetA_size(x) == 1);
+	IntSetA_delete(x);
+	IntSetA_delete(ia);
+
+	/* multiset */
+	ima = IntMSetA_new();
+	mx = IntMSetA_new();
+	for (i = 0; i < 100; i++) {
+		assert(IntMSetA_insert(ima, i % 10));
+	}
+	while (!IntMSetA_empty(ima)) {
+		mp = IntMSetA_extract(ima, IntMSetA_begin(ima));
+		assert(IntMSetA_insert_node(mx, mp) == mp);
+	}
+	assert(IntMSetA_verify(ima) && IntMSetA_verify(mx));
+	assert(IntMSetA_size(mx) == 100);
+	for (i = 0; i < 10; i++) {
+		assert(IntMSetA_count(mx, i) == 10);
+	}
+	IntMSetA_delete(mx);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntMSetA_delete(ima);
+}
+
 void SetTest_test_2_1(void)
 {
 	int i;
@@ -1032,6 +1618,14 @@ void SetTest_run(void)
 	SetTest_test_1_1();
 	SetTest_test_1_2();
 	SetTest_test_1_3();
+	SetTest_test_1_4();
+	SetTest_test_1_5();
+#ifdef CSTL_RBTREE_RANK
+	SetTest_test_1_6();
+#endif
+	SetTest_test_1_7();
+	SetTest_test_1_8();
+	SetTest_test_1_9();
 	SetTest_test_2_1();
 	SetTest_test_3_1();
 	SetTest_test_4_1();
@@ -16,10 +16,17 @@ Pool pool;
 
 #ifdef CSTLGEN
 #include "String.h"
+#include "WString.h"
 #else
 CSTL_STRING_INTERFACE(String, char)
 CSTL_STRING_IMPLEMENT(String, char)
+CSTL_STRING_INTERFACE(WString, wchar_t)
+CSTL_STRING_IMPLEMENT(WString, wchar_t)
 #endif
+CSTL_STRING_INTERFACE(UCharString, unsigned char)
+CSTL_STRING_IMPLEMENT(UCharString, unsigned char)
+CSTL_STRING_INTERFACE(IntString, int)
+CSTL_STRING_IMPLEMENT(IntString, int)
 
 #define SIZE	16
 
@@ -677,6 +684,203 @@ void StringTest_test_1_5(void)
 
 }
 
+void StringTest_test_1_6(void)
+{
+	String *x;
+	String *y;
+	UCharString *ux;
+	UCharString *uy;
+	WString *wx;
+	WString *wy;
+	IntString *ix;
+	IntString *iy;
+	const unsigned char uhigh[] = {'a', 0x80, 0};
+	const unsigned char ulow[] = {'a', 0x7f, 0};
+	const int ineg[] = {1, -1, 0};
+	const int ipos[] = {1, 1, 0};
+	const size_t mismatch[] = {0, 63, 64, 127, 150, 199};
+	size_t i;
+	printf("***** test_1_6 *****\n");
+	/* char: 符号付きの比較 */
+	x = String_new_assign("a\x80");
+	y = String_new_assign("a\x7f");
+	assert(String_size(x) == 2);
+	if ((char) -1 < 0) {
+		assert(String_compare(x, y) < 0);
+		assert(String_compare(y, x) > 0);
+	} else {
+		assert(String_compare(x, y) > 0);
+		assert(String_compare(y, x) < 0);
+	}
+	String_assign(y, "a\x80");
+	assert(String_compare(x, y) == 0);
+	String_append(y, "bc");
+	assert(String_size(y) == 4);
+	assert(String_compare(x, y) < 0);
+	/* char: ブロック(CSTL_STRING_COMPARE_BLOCK)単位の比較を跨ぐ長い文字列 */
+	for (i = 0; i < sizeof mismatch / sizeof mismatch[0]; i++) {
+		String_assign_c(x, 200, 'a');
+		String_assign_c(y, 200, 'a');
+		assert(String_compare(x, y) == 0);
+		*String_at(x, mismatch[i]) = '\x80';
+		*String_at(y, mismatch[i]) = '\x7f';
+		if ((char) -1 < 0) {
+			assert(String_compare(x, y) < 0);
+			assert(String_compare(y, x) > 0);
+		} else {
+			assert(String_compare(x, y) > 0);
+			assert(String_compare(y, x) < 0);
+		}
+		*String_at(y, mismatch[i]) = '\x80';
+		assert(String_compare(x, y) == 0);
+		String_erase(y, 199, 1);
+		assert(String_compare(x, y) > 0);
+		assert(String_compare(y, x) < 0);
+	}
+	/* char: 複数のブロック全体が一致する */
+	String_assign_c(x, CSTL_STRING_COMPARE_BLOCK * 3, '\x80');
+	String_assign_c(y, CSTL_STRING_COMPARE_BLOCK * 3, '\x80');
+	assert(String_compare(x, y) == 0);
+	String_append_c(y, 1, '\x80');
+	assert(String_compare(x, y) < 0);
+	assert(String_compare(y, x) > 0);
+	String_delete(x);
+	String_delete(y);
+	/* unsigned char */
+	ux = UCharString_new_assign(uhigh);
+	uy = UCharString_new_assign(ulow);
+	assert(UCharString_size(ux) == 2);
+	assert(UCharString_compare(ux, uy) > 0);
+	assert(UCharString_compare(uy, ux) < 0);
+	UCharString_assign(uy, uhigh);
+	assert(UCharString_compare(ux, uy) == 0);
+	UCharString_delete(ux);
+	UCharString_delete(uy);
+	/* wchar_t */
+	wx = WString_new_assign(L"abcdefg");
+	wy = WString_new_assign(L"abcdefgh");
+	assert(WString_size(wx) == 7);
+	assert(WString_compare(wx, wy) < 0);
+	assert(WString_compare(wy, wx) > 0);
+	WString_append(wx, L"h");
+	assert(WString_size(wx) == 8);
+	assert(WString_compare(wx, wy) == 0);
+	assert(WString_find(wx, L"efg", 0) == 4);
+	*WString_at(wx, 0) = L'z';
+	assert(WString_compare(wx, wy) > 0);
+	WString_delete(wx);
+	WString_delete(wy);
+	/* int */
+	ix = IntString_new_assign(ineg);
+	iy = IntString_new_assign(ipos);
+	assert(IntString_size(ix) == 2);
+	assert(IntString_compare(ix, iy) < 0);
+	assert(IntString_compare(iy, ix) > 0);
+	IntString_assign(iy, ineg);
+	assert(IntString_compare(ix, iy) == 0);
+	IntString_delete(ix);
+	IntString_delete(iy);
+
+	POOL_DUMP_OVERFLOW(&pool);
+}
+
+
+void StringTest_test_1_7(void)
+{
+	String *x;
+	String *y;
+	StringView v;
+	StringView w;
+	string s;
+	printf("***** test_1_7 *****\n");
+	/* make */
+	v = StringView_make("key = value; other = 1", CSTL_NPOS);
+	assert(StringView_size(v) == 22);
+	assert(StringView_length(v) == 22);
+	assert(!StringView_empty(v));
+	assert(*StringView_at(v, 4) == '=');
+	assert(StringView_empty(StringView_make(0, 0)));
+	s = string(StringView_data(v), StringView_size(v));
+	/* substr */
+	w = StringView_substr(v, 6, 5);
+	assert(StringView_size(w) == 5);
+	assert(StringView_data(w) == StringView_data(v) + 6);
+	assert(StringView_compare(w, StringView_make("value", CSTL_NPOS)) == 0);
+	assert(StringView_compare(w, StringView_make("valuf", CSTL_NPOS)) < 0);
+	assert(StringView_compare(w, StringView_make("valu", CSTL_NPOS)) > 0);
+	assert(StringView_compare(w, StringView_make(0, 0)) > 0);
+	assert(StringView_size(StringView_substr(v, 20, 100)) == 2);
+	assert(StringView_size(StringView_substr(v, 22, 100)) == 0);
+	/* remove_prefix, remove_suffix */
+	w = v;
+	StringView_remove_prefix(&w, 13);
+	StringView_remove_suffix(&w, 4);
+	assert(StringView_compare(w, StringView_make("other", CSTL_NPOS)) == 0);
+	/* find */
+	w = StringView_make("e", CSTL_NPOS);
+	assert(StringView_find(v, w, 0) == s.find("e", 0));
+	assert(StringView_find(v, w, 2) == s.find("e", 2));
+	assert(StringView_find_c(v, ';', 0) == s.find(';', 0));
+	assert(StringView_find(v, StringView_make("zz", 2), 0) == CSTL_NPOS);
+	assert(StringView_rfind(v, w, CSTL_NPOS) == s.rfind("e", string::npos));
+	assert(StringView_rfind(v, w, 10) == s.rfind("e", 10));
+	assert(StringView_rfind_c(v, '=', CSTL_NPOS) == s.rfind('=', string::npos));
+	w = StringView_make("=;", CSTL_NPOS);
+	assert(StringView_find_first_of(v, w, 0) == s.find_first_of("=;", 0));
+	assert(StringView_find_first_of_c(v, ';', 0) == s.find_first_of(';', 0));
+	assert(StringView_find_last_of(v, w, CSTL_NPOS) == s.find_last_of("=;", string::npos));
+	assert(StringView_find_last_of_c(v, 'k', CSTL_NPOS) == s.find_last_of('k', string::npos));
+	w = StringView_make("key ", CSTL_NPOS);
+	assert(StringView_find_first_not_of(v, w, 0) == s.find_first_not_of("key ", 0));
+	assert(StringView_find_first_not_of_c(v, 'k', 0) == s.find_first_not_of('k', 0));
+	assert(StringView_find_last_not_of(v, StringView_make("1 ", CSTL_NPOS), CSTL_NPOS) == s.find_last_not_of("1 ", string::npos));
+	assert(StringView_find_last_not_of_c(v, '1', CSTL_NPOS) == s.find_last_not_of('1', string::npos));
+	/* stringからビューを取得 */
+	x = String_new_assign("hello, world");
+	v = String_view(x);
+	assert(StringView_data(v) == String_c_str(x));
+	assert(StringView_size(v) == String_size(x));
+	w = String_substr_view(x, 7, CSTL_NPOS);
+	assert(StringView_compare(w, StringView_make("world", CSTL_NPOS)) == 0);
+	assert(String_compare_view(x, v) == 0);
+	assert(String_compare_view(x, w) < 0);
+	assert(String_find_view(x, StringView_make("o", 1), 5) == 8);
+	assert(String_rfind_view(x, StringView_make("o", 1), CSTL_NPOS) == 8);
+	/* ビューを引数に取るstringの関数 */
+	y = String_new_assign_view(w);
+	assert(strcmp(String_c_str(y), "world") == 0);
+	assert(String_assign_view(y, String_substr_view(x, 0, 5)));
+	assert(strcmp(String_c_str(y), "hello") == 0);
+	assert(String_append_view(y, StringView_make("!!", CSTL_NPOS)));
+	assert(strcmp(String_c_str(y), "hello!!") == 0);
+	assert(String_insert_view(y, 5, String_substr_view(x, 5, 7)));
+	assert(strcmp(String_c_str(y), "hello, world!!") == 0);
+	assert(String_replace_view(y, 7, 5, StringView_make("cstl", CSTL_NPOS)));
+	assert(strcmp(String_c_str(y), "hello, cstl!!") == 0);
+	/* self内の文字列のビュー */
+	assert(String_append_view(x, String_view(x)));
+	assert(strcmp(String_c_str(x), "hello, worldhello, world") == 0);
+	assert(String_replace_view(x, 0, 5, String_substr_view(x, 7, 5)));
+	assert(strcmp(String_c_str(x), "world, worldhello, world") == 0);
+	/* dataがNULLの空のビュー */
+	v = StringView_make(NULL, 0);
+	assert(String_compare_view(x, v) > 0);
+	assert(String_find_view(x, v, 3) == 3);
+	assert(String_rfind_view(x, v, CSTL_NPOS) == String_size(x));
+	assert(String_append_view(x, v));
+	assert(String_insert_view(x, 5, v));
+	assert(String_replace_view(x, 0, 7, v));
+	assert(strcmp(String_c_str(x), "worldhello, world") == 0);
+	assert(String_assign_view(x, v));
+	assert(String_empty(x));
+	assert(String_compare_view(x, v) == 0);
+	assert(String_find_view(x, v, 0) == 0);
+	String_delete(y);
+	y = String_new_assign_view(v);
+	assert(y && String_empty(y));
+	String_delete(x);
+	String_delete(y);
+}
 
 void StringTest_run(void)
 {
@@ -686,6 +890,8 @@ void StringTest_run(void)
 	StringTest_test_1_3();
 	StringTest_test_1_4();
 	StringTest_test_1_5();
+	StringTest_test_1_6();
+	StringTest_test_1_7();
 }
 
 
@@ -41,6 +41,20 @@ CSTL_UNORDERED_MAP_DEBUG_IMPLEMENT(IntIntUMMap, int, int, IntIntUMap_hash_int, C
 static IntIntUMap *ia;
 static IntIntUMMap *ima;
 
+/* 
+ * ITER_KEY(i): hoge_intを挿入したときにi番目に並ぶキー
+ * SORTED_KEY(i): キーの昇順に並べるためにi番目に挿入するキー
+ */
+#ifdef CSTL_HASHTABLE_THREAD
+/* 要素は挿入した順に並ぶ */
+#define ITER_KEY(i)		hoge_int[i]
+#define SORTED_KEY(i)	((i) < SIZE/2 ? (i) : (i)/2)
+#else
+/* キーがバケット数より小さいint型ならば、キーの昇順に並ぶ */
+#define ITER_KEY(i)		(i)
+#define SORTED_KEY(i)	hoge_int[i]
+#endif
+
 
 
 #define SIZE	32
@@ -116,12 +130,12 @@ void UMapTest_test_1_1(void)
 	}
 	/* begin, end, next, key, value, at */
 	for (p = IntIntUMap_begin(ia), i = 0; p != IntIntUMap_end(ia); p = IntIntUMap_next(p), i++) {
-		assert(*IntIntUMap_key(p) == i);
-		assert(*IntIntUMap_value(p) == i);
-		assert(*IntIntUMap_at(ia, *IntIntUMap_key(p)) == i);
-		*IntIntUMap_value(p) = ~i;
-		assert(*IntIntUMap_at(ia, *IntIntUMap_key(p)) == ~i);
-		*IntIntUMap_at(ia, *IntIntUMap_key(p)) = i;
+		assert(*IntIntUMap_key(p) == ITER_KEY(i));
+		assert(*IntIntUMap_value(p) == ITER_KEY(i));
+		assert(*IntIntUMap_at(ia, *IntIntUMap_key(p)) == ITER_KEY(i));
+		*IntIntUMap_value(p) = ~ITER_KEY(i);
+		assert(*IntIntUMap_at(ia, *IntIntUMap_key(p)) == ~ITER_KEY(i));
+		*IntIntUMap_at(ia, *IntIntUMap_key(p)) = ITER_KEY(i);
 	}
 	assert(i == SIZE/2);
 	/* erase */
@@ -137,7 +151,7 @@ void UMapTest_test_1_1(void)
 	assert(count == 0);
 	/* erase_range */
 	for (i = 0; i < SIZE/2; i++) {
-		pos[i] = IntIntUMap_insert(ia, hoge_int[i], hoge_int[i], NULL);
+		pos[i] = IntIntUMap_insert(ia, SORTED_KEY(i), SORTED_KEY(i), NULL);
 		assert(pos[i] && pos[i] != IntIntUMap_end(ia));
 	}
 	assert(IntIntUMap_size(ia) == SIZE/2);
@@ -267,7 +281,11 @@ void UMapTest_test_1_2(void)
 			assert(0);
 		}
 	}
+#ifdef CSTL_HASHTABLE_THREAD
+	assert(*IntIntUMMap_key(IntIntUMMap_begin(ima)) == hoge_int[0]);
+#else
 	assert(IntIntUMMap_find(ima, *IntIntUMMap_key(IntIntUMMap_begin(ima)) -1) == IntIntUMMap_end(ima));
+#endif
 	/* begin, end, next, key, value */
 	for (p = IntIntUMMap_begin(ima), i = 0; p != IntIntUMMap_end(ima); p = IntIntUMMap_next(p), i++) {
 /*        printf("%d, %d, %d\n", i, *IntIntUMMap_key(p), *IntIntUMMap_value(p));*/
@@ -284,7 +302,7 @@ void UMapTest_test_1_2(void)
 	assert(count == 0);
 	/* erase_range */
 	for (i = 0; i < SIZE; i++) {
-		pos[i] = IntIntUMMap_insert(ima, hoge_int[i], hoge_int[i]);
+		pos[i] = IntIntUMMap_insert(ima, SORTED_KEY(i), SORTED_KEY(i));
 		assert(pos[i] && pos[i] != IntIntUMMap_end(ima));
 	}
 	assert(IntIntUMMap_size(ima) == SIZE);
@@ -342,6 +360,223 @@ void UMapTest_test_1_2(void)
 
 
 
+void UMapTest_test_1_3(void)
+{
+	int i;
+	int success;
+	IntIntUMap *x;
+	IntIntUMapIterator p;
+	IntIntUMMap *mx;
+	IntIntUMMapIterator mp;
+	printf("***** test_1_3 *****\n");
+	ia = IntIntUMap_new();
+	x = IntIntUMap_new();
+	for (i = 0; i < 100; i++) {
+		assert(IntIntUMap_insert(ia, i, -i, NULL));
+	}
+	/* キーを付け替えて別のunordered_mapへ移す */
+	while (!IntIntUMap_empty(ia)) {
+		p = IntIntUMap_extract(ia, IntIntUMap_begin(ia));
+		assert(*IntIntUMap_key(p) == -*IntIntUMap_value(p));
+		*IntIntUMap_node_key(p) += 1000;
+		assert(IntIntUMap_insert_node(x, p, &success) == p && success);
+	}
+	assert(IntIntUMap_verify(ia) && IntIntUMap_verify(x));
+	assert(IntIntUMap_size(x) == 100);
+	for (i = 0; i < 100; i++) {
+		assert(*IntIntUMap_value(IntIntUMap_find(x, i + 1000)) == -i);
+	}
+	/* 同じキーがあれば挿入しない */
+	assert(IntIntUMap_insert(ia, 1050, 1, NULL));
+	p = IntIntUMap_extract(x, IntIntUMap_find(x, 1050));
+	assert(IntIntUMap_insert_node(ia, p, &success) != p && !success);
+	assert(*IntIntUMap_value(IntIntUMap_find(ia, 1050)) == 1);
+	assert(IntIntUMap_size(ia) == 1 && IntIntUMap_size(x) == 99);
+	IntIntUMap_node_delete(p);
+	IntIntUMap_delete(x);
+	IntIntUMap_delete(ia);
+
+	/* multimap */
+	ima = IntIntUMMap_new();
+	mx = IntIntUMMap_new();
+	for (i = 0; i < 100; i++) {
+		assert(IntIntUMMap_insert(ima, i / 10, i));
+	}
+	for (i = 0; i < 100; i++) {
+		mp = IntIntUMMap_extract(ima, IntIntUMMap_find(ima, i / 10));
+		assert(IntIntUMMap_insert_node(mx, mp) == mp);
+	}
+	assert(IntIntUMMap_verify(ima) && IntIntUMMap_verify(mx));
+	assert(IntIntUMMap_empty(ima) && IntIntUMMap_size(mx) == 100);
+	for (i = 0; i < 10; i++) {
+		assert(IntIntUMMap_count(mx, i) == 10);
+	}
+	IntIntUMMap_delete(mx);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntUMMap_delete(ima);
+}
+
+static size_t UMapTest_hash_long(const void *probe)
+{
+	return IntIntUMap_hash_int((int) *(const long *) probe);
+}
+
+static int UMapTest_comp_long(const void *probe, int const *key)
+{
+	return *(const long *) probe != *key;
+}
+
+void UMapTest_test_1_4(void)
+{
+	int i;
+	long l;
+	IntIntUMapIterator p;
+	printf("***** test_1_4 *****\n");
+	ia = IntIntUMap_new();
+	ima = IntIntUMMap_new();
+	for (i = 0; i < 100; i += 2) {
+		assert(IntIntUMap_insert(ia, i, -i, NULL));
+		assert(IntIntUMMap_insert(ima, i / 10, i));
+	}
+	for (i = -1; i <= 100; i++) {
+		p = IntIntUMap_find_ref(ia, &i);
+		assert(p == IntIntUMap_find(ia, i));
+		assert(IntIntUMap_count_ref(ia, &i) == IntIntUMap_count(ia, i));
+		assert(IntIntUMMap_count_ref(ima, &i) == IntIntUMMap_count(ima, i));
+		/* 異なる型のキーで検索 */
+		l = i;
+		assert(IntIntUMap_find_with(ia, &l, UMapTest_hash_long, UMapTest_comp_long) == p);
+		assert(IntIntUMMap_find_with(ima, &l, UMapTest_hash_long, UMapTest_comp_long) == IntIntUMMap_find(ima, i));
+	}
+	/* at_refは要素がなければ挿入する */
+	i = 51;
+	*IntIntUMap_at_ref(ia, &i) = 100;
+	assert(*IntIntUMap_at(ia, 51) == 100);
+	i = 50;
+	assert(*IntIntUMap_at_ref(ia, &i) == -50);
+	assert(IntIntUMap_size(ia) == 51);
+	assert(IntIntUMap_verify(ia));
+	IntIntUMMap_delete(ima);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntUMap_delete(ia);
+}
+
+void UMapTest_test_1_5(void)
+{
+	int i;
+	IntIntUMap *x;
+	IntIntUMMapIterator pos;
+	IntIntUMMapIterator last;
+	size_t count;
+	printf("***** test_1_5 *****\n");
+	/* インクリメンタル再ハッシュ */
+	ia = IntIntUMap_new();
+	ima = IntIntUMMap_new();
+	IntIntUMap_set_incremental_rehash(ia, 1);
+	IntIntUMMap_set_incremental_rehash(ima, 1);
+	for (i = 0; i < SIZE * 32; i++) {
+		*IntIntUMap_at(ia, i) = -i;
+		assert(IntIntUMMap_insert(ima, i % SIZE, i));
+		assert(IntIntUMap_verify(ia));
+		assert(IntIntUMMap_verify(ima));
+		assert(*IntIntUMap_at(ia, i / 2) == -(i / 2));
+	}
+	for (i = 0; i < SIZE; i++) {
+		IntIntUMMap_equal_range(ima, i, &pos, &last);
+		for (count = 0; pos != last; pos = IntIntUMMap_next(pos)) {
+			assert(*IntIntUMMap_key(pos) == i);
+			count++;
+		}
+		assert(count == 32);
+	}
+	/* 再ハッシュの途中のinsert_range, swap */
+	x = IntIntUMap_new();
+	IntIntUMap_set_incremental_rehash(x, 4);
+	for (i = 0; i < SIZE * 2; i++) {
+		assert(IntIntUMap_insert(x, -1 - i, i, NULL));
+	}
+	assert(IntIntUMap_insert_range(x, IntIntUMap_begin(ia), IntIntUMap_end(ia)));
+	assert(IntIntUMap_verify(x));
+	assert(IntIntUMap_size(x) == SIZE * 34);
+	IntIntUMap_swap(ia, x);
+	assert(IntIntUMap_get_incremental_rehash(ia) == 4);
+	assert(IntIntUMap_get_incremental_rehash(x) == 1);
+	assert(IntIntUMap_verify(ia) && IntIntUMap_verify(x));
+	assert(IntIntUMap_size(ia) == SIZE * 34);
+	assert(IntIntUMap_size(x) == SIZE * 32);
+	IntIntUMap_delete(x);
+	IntIntUMMap_delete(ima);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntUMap_delete(ia);
+}
+
+void UMapTest_test_1_6(void)
+{
+	int i;
+	size_t bc;
+	printf("***** test_1_6 *****\n");
+	/* reserve, shrink_to_fit */
+	ia = IntIntUMap_new();
+	assert(IntIntUMap_reserve(ia, SIZE * 32));
+	bc = IntIntUMap_bucket_count(ia);
+	for (i = 0; i < SIZE * 32; i++) {
+		*IntIntUMap_at(ia, i) = i;
+	}
+	assert(IntIntUMap_bucket_count(ia) == bc);
+	for (i = SIZE; i < SIZE * 32; i++) {
+		assert(IntIntUMap_erase_key(ia, i) == 1);
+	}
+	assert(IntIntUMap_shrink_to_fit(ia));
+	assert(IntIntUMap_bucket_count(ia) < bc);
+	assert(IntIntUMap_verify(ia));
+	for (i = 0; i < SIZE; i++) {
+		assert(*IntIntUMap_at(ia, i) == i);
+	}
+	assert(IntIntUMap_size(ia) == SIZE);
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntUMap_delete(ia);
+}
+
+void UMapTest_test_1_7(void)
+{
+	int i;
+	int keys[SIZE * 8 + 3];
+	IntIntUMapIterator iters[SIZE * 8 + 3];
+	IntIntUMMapIterator miters[SIZE * 8 + 3];
+	printf("***** test_1_7 *****\n");
+	/* find_batch */
+	ia = IntIntUMap_new();
+	ima = IntIntUMMap_new();
+	IntIntUMMap_set_incremental_rehash(ima, 1);
+	for (i = 0; i < SIZE * 4; i++) {
+		assert(IntIntUMap_insert(ia, i * 2, i, NULL));
+		assert(IntIntUMMap_insert(ima, i % SIZE, i));
+	}
+	for (i = 0; i < SIZE * 8 + 3; i++) {
+		keys[i] = (i * 7) % (SIZE * 8) - 1;
+	}
+	IntIntUMap_find_batch(ia, keys, 0, 0);
+	IntIntUMap_find_batch(ia, keys, SIZE * 8 + 3, iters);
+	IntIntUMMap_find_batch(ima, keys, SIZE * 8 + 3, miters);
+	for (i = 0; i < SIZE * 8 + 3; i++) {
+		assert(iters[i] == IntIntUMap_find(ia, keys[i]));
+		assert(miters[i] == IntIntUMMap_find(ima, keys[i]));
+		if (keys[i] >= 0 && keys[i] % 2 == 0) {
+			assert(*IntIntUMap_value(iters[i]) == keys[i] / 2);
+		} else {
+			assert(iters[i] == IntIntUMap_end(ia));
+		}
+	}
+	assert(IntIntUMMap_verify(ima));
+	IntIntUMMap_delete(ima);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntIntUMap_delete(ia);
+}
+
 void UMapTest_run(void)
 {
 	printf("\n===== unordered_map test =====\n");
@@ -349,6 +584,11 @@ void UMapTest_run(void)
 
 	UMapTest_test_1_1();
 	UMapTest_test_1_2();
+	UMapTest_test_1_3();
+	UMapTest_test_1_4();
+	UMapTest_test_1_5();
+	UMapTest_test_1_6();
+	UMapTest_test_1_7();
 }
 
 
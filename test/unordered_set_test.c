@@ -456,6 +456,69 @@ void USetTest_test_1_3(void)
 }
 
 
+void USetTest_test_1_4(void)
+{
+	int i;
+	int success;
+	IntUSet *x;
+	IntUSetIterator p;
+	IntUMSet *mx;
+	IntUMSetIterator mp;
+	printf("***** test_1_4 *****\n");
+	ia = IntUSet_new();
+	x = IntUSet_new();
+	for (i = 0; i < 1000; i++) {
+		assert(IntUSet_insert(ia, i, NULL));
+	}
+	/* 取り外したノードを別のunordered_setにそのまま挿入する(再ハッシュも起きる) */
+	for (i = 0; i < 1000; i += 2) {
+		p = IntUSet_extract(ia, IntUSet_find(ia, i));
+		assert(*IntUSet_data(p) == i);
+		assert(IntUSet_insert_node(x, p, &success) == p && success);
+	}
+	assert(IntUSet_verify(ia) && IntUSet_verify(x));
+	assert(IntUSet_size(ia) == 500 && IntUSet_size(x) == 500);
+	for (i = 0; i < 1000; i++) {
+		assert(IntUSet_count(i % 2 ? ia : x, i) == 1);
+		assert(IntUSet_count(i % 2 ? x : ia, i) == 0);
+	}
+	/* キーを書き換えて戻す */
+	p = IntUSet_extract(x, IntUSet_find(x, 0));
+	*IntUSet_node_data(p) = -1;
+	assert(IntUSet_insert_node(x, p, &success) == p && success);
+	assert(IntUSet_count(x, -1) == 1 && IntUSet_count(x, 0) == 0);
+	/* 同じキーがあれば挿入せず、ノードは呼び出し側に残る */
+	p = IntUSet_extract(x, IntUSet_find(x, 2));
+	*IntUSet_node_data(p) = 1;
+	assert(IntUSet_insert_node(ia, p, &success) != p && !success);
+	assert(IntUSet_verify(ia) && IntUSet_verify(x));
+	assert(IntUSet_size(ia) == 500 && IntUSet_size(x) == 499);
+	IntUSet_node_delete(p);
+	IntUSet_node_delete(NULL);
+	IntUSet_delete(x);
+
+	/* multiset */
+	ima = IntUMSet_new();
+	mx = IntUMSet_new();
+	for (i = 0; i < 100; i++) {
+		assert(IntUMSet_insert(ima, i % 10));
+	}
+	while (!IntUMSet_empty(ima)) {
+		mp = IntUMSet_extract(ima, IntUMSet_begin(ima));
+		assert(IntUMSet_insert_node(mx, mp) == mp);
+	}
+	assert(IntUMSet_verify(ima) && IntUMSet_verify(mx));
+	assert(IntUMSet_size(mx) == 100);
+	for (i = 0; i < 10; i++) {
+		assert(IntUMSet_count(mx, i) == 10);
+	}
+	IntUMSet_delete(mx);
+
+	POOL_DUMP_OVERFLOW(&pool);
+	IntUMSet_delete(ima);
+	IntUSet_delete(ia);
+}
+
 void USetTest_test_4_1(void)
 {
 	int i;
@@ -577,6 +640,323 @@ void USetTest_test_4_1(void)
 
 
 
+void USetTest_test_4_2(void)
+{
+	char buf[64];
+	size_t i;
+	printf("***** test_4_2 *****\n");
+	/* hash_chars, hash_bytes */
+	for (i = 0; i < sizeof buf - 1; i++) {
+		buf[i] = (char) ('a' + i % 26);
+	}
+	buf[sizeof buf - 1] = '\0';
+	for (i = 0; i < sizeof buf; i++) {
+		char tmp[64];
+		memcpy(tmp, buf, i);
+		tmp[i] = '\0';
+		assert(StrUSet_hash_chars(buf, i) == StrUSet_hash_string(tmp));
+		assert(StrUSet_hash_bytes(buf, i) == StrUSet_hash_string(tmp));
+		if (i > 0) {
+			/* 末尾の1文字が違えば異なるハッシュ値になる */
+			tmp[i - 1] = 'A';
+			assert(StrUSet_hash_chars(buf, i) != StrUSet_hash_chars(tmp, i));
+			/* 長さが違えば異なるハッシュ値になる */
+			assert(StrUSet_hash_chars(buf, i) != StrUSet_hash_chars(buf, i - 1));
+		}
+	}
+	assert(StrUSet_hash_wchars(L"hoge", 4) == StrUSet_hash_wstring(L"hoge"));
+	assert(StrUSet_hash_wchars(L"hoge", 3) != StrUSet_hash_wstring(L"hoge"));
+	assert(StrUSet_hash_string("") == StrUSet_hash_chars(NULL, 0));
+	assert(StrUSet_hash_string("abc") != StrUSet_hash_string("acb"));
+}
+
+
+
+
+void USetTest_test_1_5(void)
+{
+	int i;
+	size_t bc;
+	size_t count;
+	int success;
+	char *visited;
+	IntUSetIterator pos;
+	IntUMSetIterator mpos;
+	IntUMSetIterator mlast;
+	printf("***** test_1_5 *****\n");
+	/* インクリメンタル再ハッシュ */
+	ia = IntUSet_new();
+	assert(IntUSet_get_incremental_rehash(ia) == 0);
+	IntUSet_set_incremental_rehash(ia, 1);
+	assert(IntUSet_get_incremental_rehash(ia) == 1);
+	for (i = 0; i < SIZE * 32; i++) {
+		bc = IntUSet_bucket_count(ia);
+		assert(IntUSet_insert(ia, i, &success) && success);
+		assert(IntUSet_verify(ia));
+		if (bc != IntUSet_bucket_count(ia)) {
+			/* 再ハッシュの途中でも全要素を辿れる */
+			count = 0;
+			for (pos = IntUSet_begin(ia); pos != IntUSet_end(ia); pos = IntUSet_next(pos)) {
+				count++;
+			}
+			assert(count == IntUSet_size(ia));
+			assert(*IntUSet_data(IntUSet_find(ia, i)) == i);
+			assert(IntUSet_verify(ia));
+		}
+		assert(IntUSet_insert(ia, i, &success) && !success);
+		if (i % 3 == 0) {
+			assert(IntUSet_erase_key(ia, i / 2) == 1);
+			assert(IntUSet_verify(ia));
+		}
+	}
+	for (i = 0; i < SIZE * 32; i++) {
+		/* 2*i, 2*i+1のどちらかが3の倍数ならばiは削除済み */
+		if (i < SIZE * 16 && ((2 * i) % 3 == 0 || (2 * i + 1) % 3 == 0)) {
+			assert(IntUSet_count(ia, i) == 0);
+		} else {
+			assert(IntUSet_count(ia, i) == 1);
+		}
+	}
+	count = 0;
+	for (pos = IntUSet_begin(ia); pos != IntUSet_end(ia); pos = IntUSet_next(pos)) {
+		count++;
+	}
+	assert(count == IntUSet_size(ia));
+	/* 無効にすると再ハッシュを完了する */
+	IntUSet_set_incremental_rehash(ia, 0);
+	assert(IntUSet_verify(ia));
+	IntUSet_clear(ia);
+	assert(IntUSet_empty(ia));
+	IntUSet_delete(ia);
+
+	/* 再ハッシュの途中でclear, delete */
+	ia = IntUSet_new();
+	IntUSet_set_incremental_rehash(ia, 1);
+	for (i = 0; i < SIZE * 4; i++) {
+		assert(IntUSet_insert(ia, i, NULL));
+	}
+	IntUSet_clear(ia);
+	assert(IntUSet_verify(ia));
+	for (i = 0; i < SIZE * 4; i++) {
+		assert(IntUSet_insert(ia, i, NULL));
+	}
+	IntUSet_delete(ia);
+
+	/* 再ハッシュの途中で検索しながら全要素を辿る */
+	ia = IntUSet_new();
+	IntUSet_set_incremental_rehash(ia, 1);
+	for (i = 0; i < SIZE * 32; i++) {
+		assert(IntUSet_insert(ia, i, NULL));
+	}
+	bc = IntUSet_bucket_count(ia);
+	for (; IntUSet_bucket_count(ia) == bc; i++) {
+		assert(IntUSet_insert(ia, i, NULL));
+	}
+	visited = (char *) malloc(i);
+	assert(visited);
+	memset(visited, 0, i);
+	count = 0;
+	for (pos = IntUSet_begin(ia); pos != IntUSet_end(ia); pos = IntUSet_next(pos)) {
+		assert(!visited[*IntUSet_data(pos)]);
+		visited[*IntUSet_data(pos)] = 1;
+		assert(IntUSet_find(ia, *IntUSet_data(pos)) == pos);
+		assert(IntUSet_count(ia, (int) (count * 7 % i)) == 1);
+		assert(IntUSet_find(ia, -1) == IntUSet_end(ia));
+		count++;
+	}
+	assert(count == IntUSet_size(ia));
+	assert(IntUSet_verify(ia));
+	free(visited);
+	IntUSet_delete(ia);
+
+	/* multiset */
+	ima = IntUMSet_new();
+	IntUMSet_set_incremental_rehash(ima, 2);
+	for (i = 0; i < SIZE * 32; i++) {
+		assert(IntUMSet_insert(ima, i % (SIZE * 4)));
+		assert(IntUMSet_verify(ima));
+	}
+	for (i = 0; i < SIZE * 4; i++) {
+		assert(IntUMSet_count(ima, i) == 8);
+		IntUMSet_equal_range(ima, i, &mpos, &mlast);
+		for (count = 0; mpos != mlast; mpos = IntUMSet_next(mpos)) {
+			assert(*IntUMSet_data(mpos) == i);
+			count++;
+		}
+		assert(count == 8);
+	}
+	assert(IntUMSet_erase_key(ima, 0) == 8);
+	assert(IntUMSet_verify(ima));
+	assert(IntUMSet_size(ima) == SIZE * 32 - 8);
+	POOL_DUMP_OVERFLOW(&pool);
+	IntUMSet_delete(ima);
+}
+
+
+
+
+void USetTest_test_1_6(void)
+{
+	int i;
+	size_t bc;
+	printf("***** test_1_6 *****\n");
+	/* reserve, shrink_to_fit */
+	ia = IntUSet_new();
+	bc = IntUSet_bucket_count(ia);
+	assert(IntUSet_shrink_to_fit(ia));
+	assert(IntUSet_bucket_count(ia) == bc);
+	assert(IntUSet_reserve(ia, SIZE * 32));
+	bc = IntUSet_bucket_count(ia);
+	assert(bc >= SIZE * 32);
+	for (i = 0; i < SIZE * 32; i++) {
+		assert(IntUSet_insert(ia, i, NULL));
+	}
+	/* 予約した要素数までは再ハッシュしない */
+	assert(IntUSet_bucket_count(ia) == bc);
+	assert(IntUSet_reserve(ia, SIZE)); /* 小さくはならない */
+	assert(IntUSet_bucket_count(ia) == bc);
+	for (i = 0; i < SIZE * 32; i++) {
+		if (i % 64 != 0) {
+			assert(IntUSet_erase_key(ia, i) == 1);
+		}
+	}
+	assert(IntUSet_size(ia) == SIZE / 2);
+	assert(IntUSet_shrink_to_fit(ia));
+	assert(IntUSet_bucket_count(ia) < bc);
+	assert(IntUSet_bucket_count(ia) * IntUSet_get_max_load_factor(ia) >= IntUSet_size(ia));
+	assert(IntUSet_verify(ia));
+	for (i = 0; i < SIZE * 32; i++) {
+		assert(IntUSet_count(ia, i) == (i % 64 == 0));
+	}
+	/* ロードファクターの上限を考慮する */
+	IntUSet_set_max_load_factor(ia, 4.0f);
+	assert(IntUSet_shrink_to_fit(ia));
+	assert(IntUSet_bucket_count(ia) * 4 >= IntUSet_size(ia));
+	assert(IntUSet_verify(ia));
+	IntUSet_set_max_load_factor(ia, 0.5f);
+	assert(IntUSet_reserve(ia, SIZE * 2));
+	assert(IntUSet_bucket_count(ia) >= SIZE * 4);
+	assert(IntUSet_verify(ia));
+	IntUSet_delete(ia);
+
+	/* multiset */
+	ima = IntUMSet_new();
+	IntUMSet_set_incremental_rehash(ima, 1);
+	for (i = 0; i < SIZE * 32; i++) {
+		assert(IntUMSet_insert(ima, i % SIZE));
+	}
+	bc = IntUMSet_bucket_count(ima);
+	for (i = 0; i < SIZE / 2; i++) {
+		assert(IntUMSet_erase_key(ima, i) == 32);
+	}
+	assert(IntUMSet_shrink_to_fit(ima));
+	assert(IntUMSet_bucket_count(ima) < bc);
+	assert(IntUMSet_verify(ima));
+	for (i = 0; i < SIZE; i++) {
+		assert(IntUMSet_count(ima, i) == (i < SIZE / 2 ? 0 : 32));
+	}
+	IntUMSet_clear(ima);
+	assert(IntUMSet_shrink_to_fit(ima));
+	assert(IntUMSet_verify(ima));
+	POOL_DUMP_OVERFLOW(&pool);
+	IntUMSet_delete(ima);
+}
+
+
+
+
+void USetTest_test_1_7(void)
+{
+	int i;
+	size_t fp;
+	IntUSet *x;
+	int keys[SIZE * 4];
+	IntUSetIterator iters[SIZE * 4];
+	printf("***** test_1_7 *****\n");
+	/* ブルームフィルタ */
+	ia = IntUSet_new();
+	assert(IntUSet_get_bloom_filter(ia) == 0);
+	assert(IntUSet_may_contain(ia, 1));
+	assert(IntUSet_set_bloom_filter(ia, 10));
+	assert(IntUSet_get_bloom_filter(ia) == 10);
+	assert(!IntUSet_may_contain(ia, 1));
+	IntUSet_set_incremental_rehash(ia, 1);
+	for (i = 0; i < SIZE * 32; i++) {
+		assert(IntUSet_insert(ia, i * 2, NULL));
+		assert(IntUSet_verify(ia));
+	}
+	/* 偽陰性はなく、偽陽性は要素あたり10ビットならば数%程度 */
+	fp = 0;
+	for (i = 0; i < SIZE * 32; i++) {
+		assert(IntUSet_may_contain(ia, i * 2));
+		assert(IntUSet_count(ia, i * 2) == 1);
+		assert(IntUSet_count(ia, i * 2 + 1) == 0);
+		assert(IntUSet_find(ia, i * 2 + 1) == IntUSet_end(ia));
+		fp += IntUSet_may_contain(ia, i * 2 + 1);
+	}
+	assert(fp < SIZE * 32 / 10);
+	for (i = 0; i < SIZE * 4; i++) {
+		keys[i] = i - 1;
+	}
+	IntUSet_find_batch(ia, keys, SIZE * 4, iters);
+	for (i = 0; i < SIZE * 4; i++) {
+		assert(iters[i] == IntUSet_find(ia, keys[i]));
+	}
+	/* 削除した要素は再ハッシュでブルームフィルタから消える */
+	for (i = SIZE * 4; i < SIZE * 32; i++) {
+		assert(IntUSet_erase_key(ia, i * 2) == 1);
+	}
+	assert(IntUSet_verify(ia));
+	assert(IntUSet_shrink_to_fit(ia));
+	assert(IntUSet_verify(ia));
+	fp = 0;
+	for (i = SIZE * 4; i < SIZE * 32; i++) {
+		assert(IntUSet_count(ia, i * 2) == 0);
+		fp += IntUSet_may_contain(ia, i * 2);
+	}
+	assert(fp < SIZE * 28 / 10);
+	/* insert_range, swap */
+	x = IntUSet_new();
+	assert(IntUSet_insert_range(x, IntUSet_begin(ia), IntUSet_end(ia)));
+	assert(IntUSet_insert(x, -1, NULL));
+	IntUSet_swap(ia, x);
+	assert(IntUSet_get_bloom_filter(ia) == 0);
+	assert(IntUSet_get_bloom_filter(x) == 10);
+	assert(IntUSet_verify(ia) && IntUSet_verify(x));
+	assert(IntUSet_count(ia, -1) == 1);
+	assert(IntUSet_count(x, -1) == 0);
+	/* 既存の要素から作り直す */
+	assert(IntUSet_set_bloom_filter(ia, 16));
+	assert(IntUSet_verify(ia));
+	assert(IntUSet_may_contain(ia, -1));
+	assert(IntUSet_set_bloom_filter(x, 0));
+	assert(IntUSet_get_bloom_filter(x) == 0);
+	assert(IntUSet_may_contain(x, -1));
+	assert(IntUSet_verify(x));
+	IntUSet_clear(ia);
+	assert(!IntUSet_may_contain(ia, -1));
+	assert(IntUSet_verify(ia));
+	IntUSet_delete(x);
+
+	/* multiset */
+	ima = IntUMSet_new();
+	assert(IntUMSet_set_bloom_filter(ima, 8));
+	IntUMSet_set_incremental_rehash(ima, 2);
+	for (i = 0; i < SIZE * 32; i++) {
+		assert(IntUMSet_insert(ima, i % (SIZE * 4)));
+		assert(IntUMSet_verify(ima));
+	}
+	for (i = 0; i < SIZE * 4; i++) {
+		assert(IntUMSet_count(ima, i) == 8);
+		assert(IntUMSet_count(ima, -1 - i) == 0);
+	}
+	assert(IntUMSet_erase_key(ima, 0) == 8);
+	assert(IntUMSet_verify(ima));
+	POOL_DUMP_OVERFLOW(&pool);
+	IntUMSet_delete(ima);
+	IntUSet_delete(ia);
+}
+
 void USetTest_run(void)
 {
 	printf("\n===== unordered_set test =====\n");
@@ -584,7 +964,12 @@ void USetTest_run(void)
 
 	USetTest_test_1_1();
 	USetTest_test_1_3();
+	USetTest_test_1_4();
+	USetTest_test_1_5();
+	USetTest_test_1_6();
+	USetTest_test_1_7();
 	USetTest_test_4_1();
+	USetTest_test_4_2();
 }
 
 